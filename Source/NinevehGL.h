@@ -48,6 +48,7 @@
 #import <NinevehGL/NGLFunctions.h>
 #import <NinevehGL/NGLGlobal.h>
 #import <NinevehGL/NGLGroup3D.h>
+#import <NinevehGL/NGLJob.h>
 #import <NinevehGL/NGLMesh.h>
 #import <NinevehGL/NGLMeshElements.h>
 #import <NinevehGL/NGLObject3D.h>
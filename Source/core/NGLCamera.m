@@ -23,6 +23,7 @@
 #import "NGLCamera.h"
 #import "NGLTween.h"
 #import "NGLView.h"
+#import "NGLParserMesh.h"
 
 #pragma mark -
 #pragma mark Constants
@@ -135,6 +136,9 @@ NGLvec3 nglProject(NGLvec4 vertex, NGLmat4 viewProjectionMatrix, CGRect frame)
 // Creates the projection matrix.
 - (void) createProjection;
 
+// Chooses the level of detail of a mesh from the size of its bounding box on the screen.
+- (UInt32) levelOfMesh:(NGLMesh *)mesh height:(float)height;
+
 // Invocates the adjust to the screen orientation. (NGLCameraInteractive category).
 - (void) didChangeOrientation:(NSNotification *)notification;
 
@@ -366,6 +370,37 @@ NGLvec3 nglProject(NGLvec4 vertex, NGLmat4 viewProjectionMatrix, CGRect frame)
 	_cCache = NO;
 }
 
+- (UInt32) levelOfMesh:(NGLMesh *)mesh height:(float)height
+{
+	NGLBoundingBox box;
+	NGLvec3 center;
+	NGLmat4 *matrix;
+	float w, size;
+	
+	// Meshes without levels of detail don't need the bounding box.
+	if (mesh.detailLevels < 2 || nglDefaultLODThreshold <= 0.0f)
+	{
+		return 0;
+	}
+	
+	// The clip W of the bounding box's center is its distance to the camera (1.0 in orthographic).
+	box = mesh.boundingBox;
+	center = nglVec3Multiplyf(nglVec3Add(box.aligned.min, box.aligned.max), 0.5f);
+	matrix = self.matrixViewProjection;
+	w = (*matrix)[3] * center.x + (*matrix)[7] * center.y + (*matrix)[11] * center.z + (*matrix)[15];
+	
+	// The camera is inside the mesh or behind it.
+	if (w <= 0.0f)
+	{
+		return 0;
+	}
+	
+	// The size of the bounding box's diagonal on the screen, in pixels.
+	size = nglVec3Length(nglVec3Subtract(box.aligned.max, box.aligned.min)) * _pMatrix[5] * 0.5f * height / w;
+	
+	return nglLevelForSize(mesh.detailErrors, mesh.detailLevels, size, nglDefaultLODThreshold);
+}
+
 - (void) didChangeOrientation:(NSNotification *)notification
 {
 	[self adjustAspectRatioAnimated:_rotateAnimated];
@@ -454,13 +489,15 @@ NGLvec3 nglProject(NGLvec4 vertex, NGLmat4 viewProjectionMatrix, CGRect frame)
 - (void) drawCamera
 {
 	NGLMesh *mesh;
+	float height = getPreferredViewSize(_preferredView).height;
 	
-	// Render loop.
+	// Render loop. Loops through a snapshot, so the meshes can be added from other threads meanwhile.
 	//for (mesh in _meshes)
-	nglFor(mesh, _meshes)
+	nglForSnapshot(mesh, _meshes)
 	{
 		if (mesh.visible)
 		{
+			mesh.level = [self levelOfMesh:mesh height:height];
 			[mesh drawMeshWithCamera:self];
 		}
 	}
@@ -478,7 +515,7 @@ NGLvec3 nglProject(NGLvec4 vertex, NGLmat4 viewProjectionMatrix, CGRect frame)
 	
 	// Render loop.
 	//for (mesh in _meshes)
-	nglFor(mesh, _meshes)
+	nglForSnapshot(mesh, _meshes)
 	{
 		if (mesh.visible)
 		{
@@ -710,8 +747,9 @@ NGLvec3 nglProject(NGLvec4 vertex, NGLmat4 viewProjectionMatrix, CGRect frame)
 	NGLvec3 direction = nglUnproject((NGLvec4){ xp, yp, 1.0f, 1.0f }, vpIMatrix);
 	NGLray ray = (NGLray){ origin, direction };
 	
+	// The loop ends with a break, the snapshot loop doesn't leave the array locked in this case.
 	NGLMesh *mesh = nil;
-	nglFor(mesh, _meshes)
+	nglForSnapshot(mesh, _meshes)
 	{
 		if (nglBoundingBoxCollisionWithRay(mesh.boundingBox, ray))
 		{
@@ -77,6 +77,59 @@
  */
 - (void) defineBuffers;
 
+/*!
+ *					Constructs the mesh on the buffers of another core mesh, instead of uploading new ones.
+ *
+ *					The buffers are shared by reference counting, they are deleted after the last core
+ *					mesh releases them. This method is used by the copies of a mesh, which has the same
+ *					structure of the original mesh.
+ *
+ *					The buffers can be shared only if the other core mesh is ready and its buffers hold
+ *					the surfaces of this mesh, otherwise nothing is done.
+ *
+ *	@param			coreMesh
+ *					The core mesh that holds the buffers.
+ *
+ *	@result			A BOOL indicating if the buffers were shared.
+ */
+- (BOOL) defineBuffersWithCore:(id <NGLCoreMesh>)coreMesh;
+
+/*!
+ *					Replaces a range of vertices of a dynamic mesh. The parent's array of structures
+ *					receives the new vertices at once and the buffers receive them before being drawn.
+ *
+ *	@param			data
+ *					Pointer to the new vertices, with the stride of the parent's array of structures.
+ *
+ *	@param			first
+ *					The first vertex to replace.
+ *
+ *	@param			count
+ *					The number of vertices to replace.
+ *
+ *	@result			A BOOL indicating if the vertices were replaced. Only the dynamic meshes can be
+ *					updated.
+ */
+- (BOOL) updateStructures:(const float *)data vertex:(UInt32)first count:(UInt32)count;
+
+/*!
+ *					Replaces a range of indices of a dynamic mesh. The parent's array of indices receives
+ *					the new indices at once and the buffers receive them before being drawn.
+ *
+ *	@param			data
+ *					Pointer to the new indices.
+ *
+ *	@param			start
+ *					The first index to replace.
+ *
+ *	@param			count
+ *					The number of indices to replace.
+ *
+ *	@result			A BOOL indicating if the indices were replaced. Only the dynamic meshes can be
+ *					updated and each new index must lie in the window of vertices of its surface.
+ */
+- (BOOL) updateIndices:(const UInt32 *)data start:(UInt32)start count:(UInt32)count;
+
 /*!
  *					Clean up all the buffers. Must be called to delete the OpenGL buffers.
  *
@@ -368,6 +368,120 @@ typedef struct
 	NGLbounds aligned;
 } NGLBoundingBox;
 
+/*!
+ *					One range of indices in a level of detail. The levels of detail are simplified copies of
+ *					the array of indices, each range of the original array (usually a surface) has its own
+ *					simplified range in each level. The level 0 is the original array, it has no ranges.
+ *
+ *	@var			NGLLevel::level
+ *					The level of detail, starting at 1. Each level has about half of the previous triangles.
+ *
+ *	@var			NGLLevel::rangeStart
+ *					The first index of the original range in the array of indices.
+ *
+ *	@var			NGLLevel::rangeLength
+ *					The number of indices of the original range in the array of indices.
+ *
+ *	@var			NGLLevel::start
+ *					The first index of the simplified range in the array of levels' indices.
+ *
+ *	@var			NGLLevel::length
+ *					The number of indices of the simplified range.
+ *
+ *	@var			NGLLevel::error
+ *					The distance from the simplified surface to the original one, relative to the diagonal
+ *					of the mesh's bounding box.
+ */
+typedef struct
+{
+	UInt32	level;
+	UInt32	rangeStart;
+	UInt32	rangeLength;
+	UInt32	start;
+	UInt32	length;
+	float	error;
+} NGLLevel;
+
+/*!
+ *					A cluster of consecutive triangles in the array of indices, with its own bounds and
+ *					normal cone. The clusters out of the screen or facing away from the camera are skipped
+ *					at the draw time, they partition the ranges of indices (usually the surfaces).
+ *
+ *	@see			NGLbounds
+ *
+ *	@var			NGLCluster::start
+ *					The first index of the cluster in the array of indices.
+ *
+ *	@var			NGLCluster::length
+ *					The number of indices of the cluster.
+ *
+ *	@var			NGLCluster::bounds
+ *					The box that contains all the triangles of the cluster, in the mesh's space.
+ *
+ *	@var			NGLCluster::axis
+ *					The unit axis of the cone that contains the normals of all the triangles.
+ *
+ *	@var			NGLCluster::cutoff
+ *					The sine of the cone's half angle. The value 1.0 means the cone is too wide and the
+ *					cluster never faces away from the camera.
+ */
+typedef struct
+{
+	UInt32		start;
+	UInt32		length;
+	NGLbounds	bounds;
+	NGLvec3		axis;
+	float		cutoff;
+} NGLCluster;
+
+/*!
+ *					The window of vertices referenced by a range of indices (usually a surface) and by its
+ *					levels of detail. The ranges whose windows have up to 65536 vertices are uploaded with
+ *					16 bits indices, rebased to the first vertex of the window.
+ *
+ *	@var			NGLWindow::rangeStart
+ *					The first index of the range in the array of indices.
+ *
+ *	@var			NGLWindow::rangeLength
+ *					The number of indices of the range in the array of indices.
+ *
+ *	@var			NGLWindow::base
+ *					The first vertex referenced by the range.
+ *
+ *	@var			NGLWindow::count
+ *					The number of vertices from the first to the last one referenced by the range.
+ *
+ *	@var			NGLWindow::dataSize
+ *					The size of the range's indices on the GPU, NGL_SIZE_USHORT or NGL_SIZE_UINT.
+ */
+typedef struct
+{
+	UInt32	rangeStart;
+	UInt32	rangeLength;
+	UInt32	base;
+	UInt32	count;
+	UInt32	dataSize;
+} NGLWindow;
+
+/*!
+ *					The precision lost by the compact formats of the elements in the GPU.
+ *
+ *	@var			NGLPrecisionMetrics::position
+ *					The maximum error of the positions, relative to the mesh's diagonal.
+ *
+ *	@var			NGLPrecisionMetrics::direction
+ *					The maximum deviation of the normals, tangents and bitangents, in degrees.
+ *
+ *	@var			NGLPrecisionMetrics::texcoord
+ *					The maximum error of the texture coordinates.
+ */
+typedef struct
+{
+	float	position;
+	float	direction;
+	float	texcoord;
+} NGLPrecisionMetrics;
+
 #pragma mark -
 #pragma mark Constants Definitions
 #pragma mark -
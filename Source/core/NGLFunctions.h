@@ -112,6 +112,21 @@ NGL_API NSString *nglSourceFromFile(NSString *named);
  */
 NGL_API NSData *nglDataFromFile(NSString *named);
 
+/*!
+ *					Maps a file into the virtual memory using the NinevehGL Global Path API.
+ *
+ *					This function returns an autoreleased instance of NSData whose bytes are paged in
+ *					directly from the file system, without copying the file into the heap. This function
+ *					is indicated to read large files sequentially, byte by byte. The bytes are not
+ *					null terminated.
+ *
+ *	@param			named
+ *					A NSString (name or path) containing the file's name.
+ *
+ *	@result			An autoreleased NSData containing the mapped file or nil if the file doesn't exist.
+ */
+NGL_API NSData *nglMappedDataFromFile(NSString *named);
+
 /*!
  *					Extracts a content from a NSString without including the pattern.
  *
@@ -182,6 +197,103 @@ NGL_API NSRange nglRangeWith(NSString *init, NSString *end, NSString *source);
  */
 NGL_API NSArray *nglGetArray(NSString *string);
 
+/*!
+ *					Parses an ASCII decimal number into a float.
+ *
+ *					This function skips any leading white space or new line and parses a number in the
+ *					format [sign] digits [. digits] [e|E [sign] digits]. It also accepts "inf", "infinity"
+ *					and "nan". The parsing never reads beyond the "end" pointer, so the bytes don't need to
+ *					be null terminated, and it's independent of the current locale.
+ *
+ *					If no number is found, the value will be 0.0 and the returned pointer will be the
+ *					same as the "bytes" parameter.
+ *
+ *	@param			bytes
+ *					A pointer to the first character.
+ *
+ *	@param			end
+ *					A pointer to one character past the last one that can be read.
+ *
+ *	@param			value
+ *					A pointer to the float that will receive the result.
+ *
+ *	@result			A pointer to the first character after the parsed number.
+ */
+NGL_API const char *nglParseFloat(const char *bytes, const char *end, float *value);
+
+/*!
+ *					Parses an ASCII decimal integer into an int.
+ *
+ *					This function follows the same rules of <code>#nglParseFloat#</code>, but only
+ *					accepts the format [sign] digits.
+ *
+ *	@param			bytes
+ *					A pointer to the first character.
+ *
+ *	@param			end
+ *					A pointer to one character past the last one that can be read.
+ *
+ *	@param			value
+ *					A pointer to the int that will receive the result.
+ *
+ *	@result			A pointer to the first character after the parsed number.
+ *
+ *	@see			nglParseFloat
+ */
+NGL_API const char *nglParseInt(const char *bytes, const char *end, int *value);
+
+/*!
+ *					Parses a run of numbers separated by white spaces or new lines into a buffer of floats.
+ *
+ *					This function parses the numbers straight into the buffer, without any intermediate
+ *					object. The parsing stops when the buffer is full, when the bytes end or at the
+ *					first invalid number.
+ *
+ *	@param			bytes
+ *					A pointer to the first character.
+ *
+ *	@param			end
+ *					A pointer to one character past the last one that can be read.
+ *
+ *	@param			values
+ *					A buffer of floats that will receive the results.
+ *
+ *	@param			count
+ *					The maximum number of values to parse.
+ *
+ *	@param			next
+ *					A pointer that will receive the position after the last parsed number. It can be NULL.
+ *
+ *	@result			The number of parsed values.
+ */
+NGL_API UInt32 nglParseFloats(const char *bytes, const char *end, float *values, UInt32 count, const char **next);
+
+/*!
+ *					Parses a run of integers separated by white spaces or new lines into a buffer of UInt32.
+ *
+ *					This function follows the same rules of <code>#nglParseFloats#</code>.
+ *
+ *	@param			bytes
+ *					A pointer to the first character.
+ *
+ *	@param			end
+ *					A pointer to one character past the last one that can be read.
+ *
+ *	@param			values
+ *					A buffer of UInt32 that will receive the results.
+ *
+ *	@param			count
+ *					The maximum number of values to parse.
+ *
+ *	@param			next
+ *					A pointer that will receive the position after the last parsed number. It can be NULL.
+ *
+ *	@result			The number of parsed values.
+ *
+ *	@see			nglParseFloats
+ */
+NGL_API UInt32 nglParseUInts(const char *bytes, const char *end, UInt32 *values, UInt32 count, const char **next);
+
 /*!
  *					Replaces a pattern inside a C string by another.
  *
@@ -134,6 +134,11 @@ NSData *nglDataFromFile(NSString *named)
 	return [NSData dataWithContentsOfFile:nglMakePath(named)];
 }
 
+NSData *nglMappedDataFromFile(NSString *named)
+{
+	return [NSData dataWithContentsOfFile:nglMakePath(named) options:NSDataReadingMappedIfSafe error:nil];
+}
+
 NSRange nglRangeWithout(NSString *init, NSString *end, NSString *source)
 {
 	NSUInteger start;
@@ -181,6 +186,238 @@ NSArray *nglGetArray(NSString *string)
 	return array;
 }
 
+// Exact powers of ten in double precision. Up to 10^22 all of them are exactly representable.
+static const double kNGLPow10[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// Checks for the separators between numbers: white spaces and new lines.
+NGL_INLINE BOOL nglIsSpace(char c)
+{
+	return (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f');
+}
+
+// Compares the next characters with a lower case word, ignoring the case of the characters.
+NGL_INLINE BOOL nglHasWord(const char *bytes, const char *end, const char *word)
+{
+	size_t length = strlen(word);
+	return ((size_t)(end - bytes) >= length && strncasecmp(bytes, word, length) == 0);
+}
+
+const char *nglParseFloat(const char *bytes, const char *end, float *value)
+{
+	const char *c = bytes;
+	const char *exponentStart;
+	UInt64 mantissa = 0;
+	int digits = 0, exponent = 0, exponentValue = 0;
+	BOOL negative = NO, negativeExponent = NO, hasDigits = NO;
+	double result;
+	
+	*value = 0.0f;
+	
+	while (c < end && nglIsSpace(*c))
+	{
+		++c;
+	}
+	
+	if (c < end && (*c == '-' || *c == '+'))
+	{
+		negative = (*c++ == '-');
+	}
+	
+	// Special values.
+	if (c < end && (*c == 'i' || *c == 'I' || *c == 'n' || *c == 'N'))
+	{
+		if (nglHasWord(c, end, "infinity"))
+		{
+			*value = negative ? -INFINITY : INFINITY;
+			return c + 8;
+		}
+		else if (nglHasWord(c, end, "inf"))
+		{
+			*value = negative ? -INFINITY : INFINITY;
+			return c + 3;
+		}
+		else if (nglHasWord(c, end, "nan"))
+		{
+			*value = NAN;
+			return c + 3;
+		}
+		
+		return bytes;
+	}
+	
+	// Integer part. Only the first 19 significant digits fit in the mantissa, the rest just scales it.
+	for (; c < end && *c >= '0' && *c <= '9'; ++c)
+	{
+		hasDigits = YES;
+		
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + (*c - '0');
+			digits += (mantissa != 0);
+		}
+		else
+		{
+			++exponent;
+		}
+	}
+	
+	// Fractional part.
+	if (c < end && *c == '.')
+	{
+		for (++c; c < end && *c >= '0' && *c <= '9'; ++c)
+		{
+			hasDigits = YES;
+			
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + (*c - '0');
+				digits += (mantissa != 0);
+				--exponent;
+			}
+		}
+	}
+	
+	if (!hasDigits)
+	{
+		return bytes;
+	}
+	
+	// Exponent part, it's only consumed if it's a valid exponent.
+	if (c < end && (*c == 'e' || *c == 'E'))
+	{
+		exponentStart = c++;
+		
+		if (c < end && (*c == '-' || *c == '+'))
+		{
+			negativeExponent = (*c++ == '-');
+		}
+		
+		if (c < end && *c >= '0' && *c <= '9')
+		{
+			for (; c < end && *c >= '0' && *c <= '9'; ++c)
+			{
+				exponentValue = (exponentValue < 10000) ? exponentValue * 10 + (*c - '0') : exponentValue;
+			}
+			
+			exponent += negativeExponent ? -exponentValue : exponentValue;
+		}
+		else
+		{
+			c = exponentStart;
+		}
+	}
+	
+	// The fast path is exact: both the mantissa and the power of ten are exact doubles, so the result
+	// has a single rounding. Any float printed with 9 significant digits comes back to the same float.
+	if (mantissa == 0)
+	{
+		result = 0.0;
+	}
+	else if (mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+	{
+		result = (exponent < 0) ? (double)mantissa / kNGLPow10[-exponent] : (double)mantissa * kNGLPow10[exponent];
+	}
+	else
+	{
+		result = (double)mantissa * pow(10.0, exponent);
+	}
+	
+	*value = (float)(negative ? -result : result);
+	
+	return c;
+}
+
+const char *nglParseInt(const char *bytes, const char *end, int *value)
+{
+	const char *c = bytes;
+	SInt64 result = 0;
+	BOOL negative = NO;
+	
+	*value = 0;
+	
+	while (c < end && nglIsSpace(*c))
+	{
+		++c;
+	}
+	
+	if (c < end && (*c == '-' || *c == '+'))
+	{
+		negative = (*c++ == '-');
+	}
+	
+	if (c == end || *c < '0' || *c > '9')
+	{
+		return bytes;
+	}
+	
+	// Saturates the value instead of overflowing it.
+	for (; c < end && *c >= '0' && *c <= '9'; ++c)
+	{
+		result = (result <= NGL_MAX_32) ? result * 10 + (*c - '0') : result;
+	}
+	
+	result = negative ? -result : result;
+	*value = (int)MAX(MIN(result, INT_MAX), INT_MIN);
+	
+	return c;
+}
+
+UInt32 nglParseFloats(const char *bytes, const char *end, float *values, UInt32 count, const char **next)
+{
+	const char *c;
+	UInt32 i;
+	
+	for (i = 0; i < count; ++i)
+	{
+		c = nglParseFloat(bytes, end, &values[i]);
+		
+		if (c == bytes)
+		{
+			break;
+		}
+		
+		bytes = c;
+	}
+	
+	if (next != NULL)
+	{
+		*next = bytes;
+	}
+	
+	return i;
+}
+
+UInt32 nglParseUInts(const char *bytes, const char *end, UInt32 *values, UInt32 count, const char **next)
+{
+	const char *c;
+	int value;
+	UInt32 i;
+	
+	for (i = 0; i < count; ++i)
+	{
+		c = nglParseInt(bytes, end, &value);
+		
+		if (c == bytes)
+		{
+			break;
+		}
+		
+		values[i] = (UInt32)value;
+		bytes = c;
+	}
+	
+	if (next != NULL)
+	{
+		*next = bytes;
+	}
+	
+	return i;
+}
+
 void nglCStringReplaceChar(char *string, char searchFor, char replaceFor)
 {
 	char *pointer;
@@ -193,6 +430,8 @@ void nglCStringReplaceChar(char *string, char searchFor, char replaceFor)
 	}
 }
 
+#ifndef NGL_HEADLESS
+
 BOOL nglDeviceOrientationIsValid(void)
 {
 	UIDeviceOrientation orientation = [[UIDevice currentDevice] orientation];
@@ -228,4 +467,14 @@ float nglDeviceSystemVersion(void)
 	}
 	
 	return osVersion;
-}
\ No newline at end of file
+}
+
+#else
+
+// The headless builds have no device, its orientation is always invalid.
+BOOL nglDeviceOrientationIsValid(void) { return NO; }
+BOOL nglDeviceOrientationIsPortrait(void) { return NO; }
+BOOL nglDeviceOrientationIsLandscape(void) { return NO; }
+float nglDeviceSystemVersion(void) { return 0.0f; }
+
+#endif
\ No newline at end of file
@@ -515,6 +515,27 @@ NGL_API NGLLightEffects nglDefaultLightEffects;
  */
 NGL_API NGLMultithreading nglDefaultMultithreading;
 
+/*!
+ *					The NinevehGL global disk budget to the NinevehGL Binary cache, in bytes.
+ *
+ *	@see			nglGlobalCacheBudget
+ */
+NGL_API UInt64 nglDefaultCacheBudget;
+
+/*!
+ *					The NinevehGL global error threshold to the levels of detail, in pixels.
+ *
+ *	@see			nglGlobalLODThreshold
+ */
+NGL_API float nglDefaultLODThreshold;
+
+/*!
+ *					The NinevehGL global state of the clusters' culling.
+ *
+ *	@see			nglGlobalClusterCulling
+ */
+NGL_API BOOL nglDefaultClusterCulling;
+
 #pragma mark -
 #pragma mark Global Functions
 #pragma mark -
@@ -902,4 +923,54 @@ NGL_API void nglGlobalLightEffects(NGLLightEffects effect);
  *
  *	@see			NGLMultithreading
  */
-NGL_API void nglGlobalMultithreading(NGLMultithreading option);
\ No newline at end of file
+NGL_API void nglGlobalMultithreading(NGLMultithreading option);
+
+/*!
+ *					Defines the global disk budget to the NinevehGL Binary cache.
+ *
+ *					Every parsed 3D file generates a cached NGL Binary file in the Library folder. When the
+ *					cached files exceed this budget, the least recently used ones are deleted. The new
+ *					budget is applied at the next saved cache.
+ *
+ *					By default, the budget is 64MB. A budget of 0 means no limit.
+ *	
+ *	@param			bytes
+ *					The maximum size of the cache, in bytes.
+ *
+ *	@see			nglCacheStats
+ */
+NGL_API void nglGlobalCacheBudget(UInt64 bytes);
+
+/*!
+ *					Defines the global error threshold to the levels of detail.
+ *
+ *					The meshes are imported with simplified levels of detail. At each render cycle, the
+ *					cameras draw each mesh with its simplest level whose error, projected on the screen,
+ *					doesn't exceed this threshold. So the distant meshes are drawn with less triangles.
+ *
+ *					By default, the threshold is 1.0 pixel. A threshold of 0.0 always draws the original
+ *					meshes.
+ *	
+ *	@param			pixels
+ *					The maximum error on the screen, in pixels.
+ *
+ *	@see			nglLevelForSize
+ */
+NGL_API void nglGlobalLODThreshold(float pixels);
+
+/*!
+ *					Enables or disables the culling of the clusters.
+ *
+ *					The meshes are imported with their triangles partitioned in clusters. At each render
+ *					cycle, the cameras skip the clusters out of the screen or facing away from them, so
+ *					the hidden parts of large meshes are not sent to the GPU. The clusters are culled only
+ *					when the original mesh is drawn, the levels of detail are always drawn entirely.
+ *
+ *					By default, the culling is enabled.
+ *	
+ *	@param			value
+ *					A BOOL indicating if the clusters are culled.
+ *
+ *	@see			nglCullClusters
+ */
+NGL_API void nglGlobalClusterCulling(BOOL value);
\ No newline at end of file
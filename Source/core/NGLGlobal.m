@@ -23,10 +23,14 @@
 #import "NGLGlobal.h"
 
 #import "NGLMath.h"
+
+// The headless builds have only the global properties, there are no views, meshes or timers to update.
+#ifndef NGL_HEADLESS
 #import "NGLTimer.h"
 #import "NGLView.h"
 #import "NGLMesh.h"
 #import "NGLThread.h"
+#endif
 
 #pragma mark -
 #pragma mark Private Interface
@@ -79,6 +83,9 @@ NGLRotationOrder		nglDefaultRotationOrder			= NGL_NULL;
 NSDictionary			*nglDefaultImportSettings		= nil;
 NGLLightEffects			nglDefaultLightEffects			= NGLLightEffectsON;
 NGLMultithreading		nglDefaultMultithreading		= NGLMultithreadingFull;
+UInt64					nglDefaultCacheBudget			= NGL_CACHE_BUDGET;
+float					nglDefaultLODThreshold			= NGL_LOD_THRESHOLD;
+BOOL					nglDefaultClusterCulling		= YES;
 
 #pragma mark -
 #pragma mark Global Functions
@@ -89,6 +96,8 @@ NGLMultithreading		nglDefaultMultithreading		= NGLMultithreadingFull;
 //
 //**********************************************************************************************************
 
+#ifndef NGL_HEADLESS
+
 void nglGlobalFlush(void)
 {
 	// Updates all engines.
@@ -106,18 +115,24 @@ void nglGlobalFlush(void)
 	_globalChange = NGLGlobalChangeNone;
 }
 
+#endif
+
 void nglGlobalFilePath(NSString *filePath)
 {
 	nglRelease(nglDefaultPath);
 	nglDefaultPath = [filePath copy];
 }
 
+#ifndef NGL_HEADLESS
+
 void nglGlobalFPS(unsigned short fps)
 {
 	nglDefaultFPS = nglClamp(fps, 1, NGL_MAX_FPS);
 	[[NGLTimer defaultTimer] setPaused:NO];
 }
 
+#endif
+
 void nglGlobalEngine(NGLEngineVersion engine)
 {
 	nglDefaultEngine = engine;
@@ -198,6 +213,8 @@ void nglGlobalLightEffects(NGLLightEffects effect)
 	_globalChange |= NGLGlobalChangeMeshes;
 }
 
+#ifndef NGL_HEADLESS
+
 void nglGlobalMultithreading(NGLMultithreading option)
 {
 	// Pauses the NGLTimer.
@@ -219,4 +236,21 @@ void nglGlobalMultithreading(NGLMultithreading option)
 	
 	// Resumes the NGLTimer.
 	[[NGLTimer defaultTimer] setPaused:NO];
+}
+
+#endif
+
+void nglGlobalCacheBudget(UInt64 bytes)
+{
+	nglDefaultCacheBudget = bytes;
+}
+
+void nglGlobalLODThreshold(float pixels)
+{
+	nglDefaultLODThreshold = pixels;
+}
+
+void nglGlobalClusterCulling(BOOL value)
+{
+	nglDefaultClusterCulling = value;
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+/*
+ *	Copyright (c) 2011-2015 NinevehGL. More information at: http://nineveh.gl
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ */
+
+#import "NGLRuntime.h"
+#import "NGLGlobal.h"
+#import "NGLArray.h"
+
+@class NGLJob;
+
+/*!
+ *					Identifies the priority of a job. The workers always perform the most urgent jobs first.
+ *
+ *					The new jobs inherit the priority of the job that creates them, so the stages of a load
+ *					have the same priority as the load. The jobs created outside the job system are
+ *					#NGLJobPriorityVisible#.
+ *
+ *	@see			nglJobPerformPriority
+ *	
+ *	@var			NGLJobPriorityVisible
+ *					The result is needed right now, like a mesh on the screen.
+ *	
+ *	@var			NGLJobPriorityPrefetch
+ *					The result will be needed soon, like a mesh about to enter the screen.
+ *	
+ *	@var			NGLJobPriorityBackground
+ *					The result may be needed someday.
+ */
+typedef enum
+{
+	// To ensure the NGL integrity, the default priority is set to 0.
+	NGLJobPriorityVisible		= 0x00,	// Default
+	NGLJobPriorityPrefetch		= 0x01,
+	NGLJobPriorityBackground	= 0x02,
+} NGLJobPriority;
+
+/*!
+ *					Returns the number of workers in the NinevehGL job system, one to each processor core.
+ *
+ *					The workers are started by the first job. Each worker has its own deque of jobs, it
+ *					performs its newest jobs first and, when its deque is empty, it steals the oldest jobs
+ *					of the other workers. The idle workers sleep until a new job arrives.
+ *
+ *					Without multithreading, the jobs are performed by the caller and no worker is started.
+ *
+ *	@result			The number of workers, 1 without multithreading.
+ */
+NGL_API UInt32 nglJobWorkers(void);
+
+/*!
+ *					Performs a message in the job system, asynchronously.
+ *
+ *					The job waits for all its dependencies to be done before it starts. Without the parser
+ *					multithreading (see #NGLMultithreading#), the job is performed immediately.
+ *
+ *					The target is retained until the job is done.
+ *
+ *	@param			selector
+ *					A SEL object.
+ *
+ *	@param			target
+ *					The target object that will receive the method.
+ *
+ *	@param			dependencies
+ *					A NSArray of NGLJob which must be done before this job. It can be nil.
+ *
+ *	@result			The handle of the job.
+ */
+NGL_API NGLJob *nglJobPerform(SEL selector, id target, NSArray *dependencies);
+
+/*!
+ *					Performs a message in the job system with a specific priority, asynchronously.
+ *
+ *					Works just like #nglJobPerform#.
+ *
+ *	@param			selector
+ *					A SEL object.
+ *
+ *	@param			target
+ *					The target object that will receive the method.
+ *
+ *	@param			dependencies
+ *					A NSArray of NGLJob which must be done before this job. It can be nil.
+ *
+ *	@param			priority
+ *					The priority of the job.
+ *
+ *	@result			The handle of the job.
+ */
+NGL_API NGLJob *nglJobPerformPriority(SEL selector, id target, NSArray *dependencies, NGLJobPriority priority);
+
+/*!
+ *					Performs a block in the job system, asynchronously.
+ *
+ *					Works just like #nglJobPerform#, the block is copied until the job is done.
+ *
+ *	@param			block
+ *					The block to perform.
+ *
+ *	@param			dependencies
+ *					A NSArray of NGLJob which must be done before this job. It can be nil.
+ *
+ *	@result			The handle of the job.
+ */
+NGL_API NGLJob *nglJobPerformBlock(void (^block)(void), NSArray *dependencies);
+
+/*!
+ *					Performs a block to each index of a range, spread across the workers, and waits until
+ *					all the indices are done.
+ *
+ *					The indices are split in a few jobs to each worker, so the faster workers steal the
+ *					jobs of the slower ones. When called from a job, the calling worker performs the jobs
+ *					while it waits. The order of the indices is not defined.
+ *
+ *	@param			count
+ *					The number of indices, from 0 to count - 1.
+ *
+ *	@param			block
+ *					The block performed to each index.
+ */
+NGL_API void nglJobFor(UInt32 count, void (^block)(UInt32 index));
+
+/*!
+ *					The handle of a job in the NinevehGL job system.
+ *
+ *					A job can be waited, polled, canceled or be a dependency of other jobs. A worker waiting
+ *					for a job performs the other jobs meanwhile, so the jobs can wait for each other without
+ *					blocking the workers.
+ *
+ *	@see			nglJobPerform
+ */
+@interface NGLJob : NSObject
+{
+@private
+	// Work
+	id						_target;
+	SEL						_selector;
+	void					(^_block)(void);
+	void					(^_forBlock)(UInt32);
+	UInt32					_first, _last;
+	NGLJobPriority			_priority;
+	
+	// Dependencies
+	int32_t					_waiting;
+	NGLArray				*_dependents;
+	BOOL					_queued;
+	BOOL					_started;
+	BOOL					_cancelled;
+	BOOL					_done;
+	
+	pthread_mutex_t			_mutex;
+	pthread_cond_t			_condition;
+}
+
+/*!
+ *					Indicates if this job has been performed.
+ */
+@property (nonatomic, readonly, getter = isDone) BOOL done;
+
+/*!
+ *					Indicates if this job was canceled. A running job can check it to stop earlier.
+ */
+@property (nonatomic, readonly, getter = isCancelled) BOOL cancelled;
+
+/*!
+ *					The priority of this job. Raising the priority of a pending job moves it ahead of the
+ *					less urgent jobs. Lowering it only affects the jobs created by this one.
+ */
+@property (nonatomic) NGLJobPriority priority;
+
+/*!
+ *					Blocks the current thread until this job is done. A worker performs other jobs while
+ *					it waits.
+ */
+- (void) waitUntilDone;
+
+/*!
+ *					Cancels this job. A pending job is done right away, without being performed, and
+ *					its slot in the queue is just skipped later on, so canceling doesn't search the queues.
+ *					The jobs depending on a canceled job are canceled too.
+ *
+ *					A running job is only marked as canceled, it's up to the work to check it.
+ *
+ *	@result			A BOOL indicating if the job was dropped before it started.
+ */
+- (BOOL) cancel;
+
+@end
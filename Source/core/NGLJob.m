@@ -0,0 +1,797 @@
+/*
+ *	Copyright (c) 2011-2015 NinevehGL. More information at: http://nineveh.gl
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ */
+
+#import <objc/message.h>
+
+#import "NGLJob.h"
+
+#pragma mark -
+#pragma mark Constants
+#pragma mark -
+//**********************************************************************************************************
+//
+//	Constants
+//
+//**********************************************************************************************************
+
+// Number of jobs to each worker in a parallel loop. More jobs balance better the uneven indices.
+#define NGL_JOB_SPLIT			4
+
+// Initial capacity of a deque of jobs.
+#define NGL_JOB_CAPACITY		64
+
+// Number of priorities, each worker has one deque to each of them.
+#define NGL_JOB_PRIORITIES		3
+
+#pragma mark -
+#pragma mark Private Interface
+#pragma mark -
+//**********************************************************************************************************
+//
+//	Private Interface
+//
+//**********************************************************************************************************
+
+#pragma mark -
+#pragma mark Private Definitions
+//**************************************************
+//	Private Definitions
+//**************************************************
+
+// The jobs waiting for a worker. The owner works on the tail, the other workers steal from the head.
+// The deques are grouped by worker, the deque of a priority is at (worker * NGL_JOB_PRIORITIES + priority).
+typedef struct
+{
+	NGLJob					**jobs;
+	UInt32					head;
+	UInt32					tail;
+	UInt32					capacity;
+	pthread_mutex_t			mutex;
+} NGLJobDeque;
+
+static NGLJobDeque *_deques = NULL;
+static UInt32 _workersCount = 0;
+static UInt32 _nextDeque = 0;
+
+// The key of each worker holds its index plus one, the other threads have 0.
+static pthread_key_t _workerKey;
+
+// The job being performed by each worker.
+static pthread_key_t _jobKey;
+
+// The queued jobs not yet taken and the sleeping workers, the sleep variables are guarded by the sleep mutex.
+static volatile int32_t _pending = 0;
+static UInt32 _sleeping = 0;
+static UInt32 _helping = 0;
+static pthread_mutex_t _sleepMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _sleepCondition = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t _helpCondition = PTHREAD_COND_INITIALIZER;
+
+#pragma mark -
+#pragma mark Private Category
+//**************************************************
+//	Private Category
+//**************************************************
+
+@interface NGLJob()
+
+// The entry point of each worker thread.
++ (void) runWorker:(NSNumber *)index;
+
+// Initializes a job with a message, a block or a range of a parallel loop. A job without work is done right
+// after its dependencies.
+- (id) initWithTarget:(id)target selector:(SEL)selector;
+- (id) initWithBlock:(void (^)(void))block;
+- (id) initWithForBlock:(void (^)(UInt32))block first:(UInt32)first last:(UInt32)last;
+
+// Queues this job after its dependencies and returns it autoreleased.
+- (NGLJob *) submitAfter:(NSArray *)dependencies;
+
+// Makes a job wait for this one. Returns NO if this job is already done.
+- (BOOL) addDependent:(NGLJob *)job;
+
+// Performs the work and finishes this job.
+- (void) run;
+
+// Marks this job as done and releases its dependents. The dependents of a canceled job are canceled too.
+- (void) finish;
+
+// One of the dependencies is done. The last one queues this job.
+- (void) dependencyDone;
+
+@end
+
+#pragma mark -
+#pragma mark Private Functions
+//**************************************************
+//	Private Functions
+//**************************************************
+
+// The jobs only go to the workers when the parsers are allowed to run in parallel.
+static BOOL jobCheck(void)
+{
+#ifdef NGL_MULTITHREADING
+	return (nglDefaultMultithreading == NGLMultithreadingFull ||
+			nglDefaultMultithreading == NGLMultithreadingParser);
+#else
+	return NO;
+#endif
+}
+
+// Starts the workers once.
+static void jobStart(void)
+{
+	static dispatch_once_t safer;
+	dispatch_once(&safer, ^(void)
+	{
+		UInt32 i;
+		
+		_workersCount = (UInt32)MAX([[NSProcessInfo processInfo] activeProcessorCount], 1);
+		_deques = calloc(_workersCount * NGL_JOB_PRIORITIES, sizeof(NGLJobDeque));
+		pthread_key_create(&_workerKey, NULL);
+		pthread_key_create(&_jobKey, NULL);
+		
+		for (i = 0; i < _workersCount * NGL_JOB_PRIORITIES; ++i)
+		{
+			_deques[i].capacity = NGL_JOB_CAPACITY;
+			_deques[i].jobs = malloc(NGL_JOB_CAPACITY * sizeof(NGLJob *));
+			pthread_mutex_init(&_deques[i].mutex, NULL);
+		}
+		
+		for (i = 0; i < _workersCount; ++i)
+		{
+			[NSThread detachNewThreadSelector:@selector(runWorker:)
+									 toTarget:[NGLJob class]
+								   withObject:[NSNumber numberWithUnsignedInt:i]];
+		}
+	});
+}
+
+// Returns the index of the current worker plus one, or 0 if the current thread is not a worker.
+static UInt32 jobWorker(void)
+{
+	return (_workersCount > 0) ? (UInt32)(uintptr_t)pthread_getspecific(_workerKey) : 0;
+}
+
+// Pushes a retained job into the tail of a deque.
+static void jobPush(NGLJobDeque *deque, NGLJob *job)
+{
+	pthread_mutex_lock(&deque->mutex);
+	
+	// Reuses the free space at the head before growing the deque.
+	if (deque->tail == deque->capacity)
+	{
+		if (deque->head > 0)
+		{
+			memmove(deque->jobs, deque->jobs + deque->head, (deque->tail - deque->head) * sizeof(NGLJob *));
+			deque->tail -= deque->head;
+			deque->head = 0;
+		}
+		else
+		{
+			deque->capacity *= 2;
+			deque->jobs = realloc(deque->jobs, deque->capacity * sizeof(NGLJob *));
+		}
+	}
+	
+	deque->jobs[deque->tail++] = [job retain];
+	
+	pthread_mutex_unlock(&deque->mutex);
+}
+
+// Takes a job from a deque, the newest one from the tail or the oldest one from the head.
+// The taken job is retained.
+static NGLJob *jobTakeFrom(NGLJobDeque *deque, BOOL fromTail)
+{
+	NGLJob *job = nil;
+	
+	pthread_mutex_lock(&deque->mutex);
+	
+	if (deque->tail > deque->head)
+	{
+		job = (fromTail) ? deque->jobs[--deque->tail] : deque->jobs[deque->head++];
+		
+		if (deque->head == deque->tail)
+		{
+			deque->head = deque->tail = 0;
+		}
+	}
+	
+	pthread_mutex_unlock(&deque->mutex);
+	
+	return job;
+}
+
+// Takes the next job to a worker: its newest job or the oldest job of another worker, from the most urgent
+// priority to the least one. The taken job is retained.
+static NGLJob *jobTake(UInt32 worker)
+{
+	NGLJob *job = nil;
+	UInt32 i, priority;
+	
+	for (priority = 0; job == nil && priority < NGL_JOB_PRIORITIES; ++priority)
+	{
+		job = jobTakeFrom(&_deques[worker * NGL_JOB_PRIORITIES + priority], YES);
+		
+		for (i = 1; job == nil && i < _workersCount; ++i)
+		{
+			job = jobTakeFrom(&_deques[((worker + i) % _workersCount) * NGL_JOB_PRIORITIES + priority], NO);
+		}
+	}
+	
+	if (job != nil)
+	{
+		__sync_fetch_and_sub(&_pending, 1);
+	}
+	
+	return job;
+}
+
+// Performs a taken job inside its own autorelease pool. A waiting worker performs jobs inside another job,
+// so the current job is restored at the end.
+static void jobRun(NGLJob *job)
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+	void *current = pthread_getspecific(_jobKey);
+	
+	pthread_setspecific(_jobKey, job);
+	[job run];
+	pthread_setspecific(_jobKey, current);
+	
+	[pool drain];
+	[job release];
+}
+
+// Returns the priority to the new jobs, the same of the current job.
+static NGLJobPriority jobInherit(void)
+{
+	NGLJob *current = (jobWorker() > 0) ? pthread_getspecific(_jobKey) : nil;
+	
+	return (current != nil) ? current.priority : NGLJobPriorityVisible;
+}
+
+// Queues a job ready to run. A worker keeps its new jobs, the other threads spread them across the workers.
+static void jobQueue(NGLJob *job, NGLJobPriority priority)
+{
+	UInt32 worker;
+	
+	if (!jobCheck())
+	{
+		[job run];
+		return;
+	}
+	
+	jobStart();
+	worker = jobWorker();
+	
+	if (worker == 0)
+	{
+		worker = __sync_fetch_and_add(&_nextDeque, 1) % _workersCount + 1;
+	}
+	
+	jobPush(&_deques[(worker - 1) * NGL_JOB_PRIORITIES + priority], job);
+	
+	// Wakes a sleeping worker and all the waiting ones, which could help with the new job.
+	__sync_fetch_and_add(&_pending, 1);
+	
+	pthread_mutex_lock(&_sleepMutex);
+	
+	if (_sleeping > 0)
+	{
+		pthread_cond_signal(&_sleepCondition);
+	}
+	
+	if (_helping > 0)
+	{
+		pthread_cond_broadcast(&_helpCondition);
+	}
+	
+	pthread_mutex_unlock(&_sleepMutex);
+}
+
+#pragma mark -
+#pragma mark Public Interface
+#pragma mark -
+//**********************************************************************************************************
+//
+//	Public Interface
+//
+//**********************************************************************************************************
+
+UInt32 nglJobWorkers(void)
+{
+	// Without multithreading the jobs run in the caller, no worker is started.
+	if (!jobCheck())
+	{
+		return 1;
+	}
+	
+	jobStart();
+	
+	return _workersCount;
+}
+
+NGLJob *nglJobPerform(SEL selector, id target, NSArray *dependencies)
+{
+	return nglJobPerformPriority(selector, target, dependencies, jobInherit());
+}
+
+NGLJob *nglJobPerformPriority(SEL selector, id target, NSArray *dependencies, NGLJobPriority priority)
+{
+	NGLJob *job = [[NGLJob alloc] initWithTarget:target selector:selector];
+	
+	job.priority = priority;
+	
+	return [job submitAfter:dependencies];
+}
+
+NGLJob *nglJobPerformBlock(void (^block)(void), NSArray *dependencies)
+{
+	NGLJob *job = [[NGLJob alloc] initWithBlock:block];
+	
+	job.priority = jobInherit();
+	
+	return [job submitAfter:dependencies];
+}
+
+void nglJobFor(UInt32 count, void (^block)(UInt32 index))
+{
+	NSMutableArray *jobs;
+	NGLJob *job;
+	NGLJobPriority priority;
+	UInt32 i, chunks;
+	
+	// Without workers, the loop is serial.
+	if (!jobCheck() || count <= 1 || nglJobWorkers() <= 1)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			block(i);
+		}
+		
+		return;
+	}
+	
+	// Each job performs a contiguous range of indices.
+	chunks = MIN(count, _workersCount * NGL_JOB_SPLIT);
+	jobs = [[NSMutableArray alloc] initWithCapacity:chunks];
+	priority = jobInherit();
+	
+	for (i = 0; i < chunks; ++i)
+	{
+		job = [[NGLJob alloc] initWithForBlock:block
+										 first:(UInt32)((UInt64)count * i / chunks)
+										  last:(UInt32)((UInt64)count * (i + 1) / chunks)];
+		job.priority = priority;
+		
+		[jobs addObject:[job submitAfter:nil]];
+	}
+	
+	// An empty job is done right after all the ranges.
+	job = [[NGLJob alloc] init];
+	job.priority = priority;
+	[[job submitAfter:jobs] waitUntilDone];
+	
+	[jobs release];
+}
+
+@implementation NGLJob
+
+#pragma mark -
+#pragma mark Properties
+//**************************************************
+//	Properties
+//**************************************************
+
+@dynamic done, cancelled, priority;
+
+- (BOOL) isDone
+{
+	BOOL done;
+	
+	pthread_mutex_lock(&_mutex);
+	done = _done;
+	pthread_mutex_unlock(&_mutex);
+	
+	return done;
+}
+
+- (BOOL) isCancelled
+{
+	BOOL cancelled;
+	
+	pthread_mutex_lock(&_mutex);
+	cancelled = _cancelled;
+	pthread_mutex_unlock(&_mutex);
+	
+	return cancelled;
+}
+
+- (NGLJobPriority) priority
+{
+	NGLJobPriority priority;
+	
+	pthread_mutex_lock(&_mutex);
+	priority = _priority;
+	pthread_mutex_unlock(&_mutex);
+	
+	return priority;
+}
+
+- (void) setPriority:(NGLJobPriority)value
+{
+	BOOL raised;
+	
+	pthread_mutex_lock(&_mutex);
+	raised = (value < _priority && _queued && !_started);
+	_priority = value;
+	pthread_mutex_unlock(&_mutex);
+	
+	// A pending job is queued again with the new priority. Whichever copy is taken first performs it,
+	// the other one is skipped.
+	if (raised)
+	{
+		jobQueue(self, value);
+	}
+}
+
+#pragma mark -
+#pragma mark Constructors
+//**************************************************
+//	Constructors
+//**************************************************
+
+- (id) init
+{
+	if ((self = [super init]))
+	{
+		pthread_mutex_init(&_mutex, NULL);
+		pthread_cond_init(&_condition, NULL);
+	}
+	
+	return self;
+}
+
+- (id) initWithTarget:(id)target selector:(SEL)selector
+{
+	if ((self = [self init]))
+	{
+		_target = [target retain];
+		_selector = selector;
+	}
+	
+	return self;
+}
+
+- (id) initWithBlock:(void (^)(void))block
+{
+	if ((self = [self init]))
+	{
+		_block = [block copy];
+	}
+	
+	return self;
+}
+
+- (id) initWithForBlock:(void (^)(UInt32))block first:(UInt32)first last:(UInt32)last
+{
+	if ((self = [self init]))
+	{
+		_forBlock = [block copy];
+		_first = first;
+		_last = last;
+	}
+	
+	return self;
+}
+
+#pragma mark -
+#pragma mark Private Methods
+//**************************************************
+//	Private Methods
+//**************************************************
+
++ (void) runWorker:(NSNumber *)index
+{
+	UInt32 worker = [index unsignedIntValue];
+	NGLJob *job;
+	
+	pthread_setspecific(_workerKey, (void *)(uintptr_t)(worker + 1));
+	
+	// The worker routine never ends, an idle worker sleeps until a new job is queued.
+	while (YES)
+	{
+		job = jobTake(worker);
+		
+		if (job != nil)
+		{
+			jobRun(job);
+			continue;
+		}
+		
+		pthread_mutex_lock(&_sleepMutex);
+		
+		while (_pending == 0)
+		{
+			++_sleeping;
+			pthread_cond_wait(&_sleepCondition, &_sleepMutex);
+			--_sleeping;
+		}
+		
+		pthread_mutex_unlock(&_sleepMutex);
+	}
+}
+
+- (NGLJob *) submitAfter:(NSArray *)dependencies
+{
+	NGLJob *dependency;
+	BOOL cancelled = NO;
+	
+	// The job starts with one extra dependency, released at the end, so the dependencies finishing
+	// meanwhile can't queue it earlier.
+	_waiting = 1;
+	
+	for (dependency in dependencies)
+	{
+		__sync_fetch_and_add(&_waiting, 1);
+		
+		if (![dependency addDependent:self])
+		{
+			__sync_fetch_and_sub(&_waiting, 1);
+			cancelled = (cancelled || dependency.isCancelled);
+		}
+	}
+	
+	// Depending on a canceled job cancels this one.
+	if (cancelled)
+	{
+		[self cancel];
+	}
+	
+	[self dependencyDone];
+	
+	return [self autorelease];
+}
+
+- (BOOL) addDependent:(NGLJob *)job
+{
+	BOOL added = NO;
+	
+	pthread_mutex_lock(&_mutex);
+	
+	if (!_done)
+	{
+		if (_dependents == nil)
+		{
+			_dependents = [[NGLArray alloc] initWithRetainOption];
+		}
+		
+		[_dependents addPointer:job];
+		added = YES;
+	}
+	
+	pthread_mutex_unlock(&_mutex);
+	
+	return added;
+}
+
+- (void) run
+{
+	BOOL skip;
+	UInt32 i;
+	
+	pthread_mutex_lock(&_mutex);
+	skip = _started || _done;
+	_started = YES;
+	pthread_mutex_unlock(&_mutex);
+	
+	// The job was already performed by another copy in the queues or it was canceled.
+	if (skip)
+	{
+		return;
+	}
+	
+	if (_forBlock != nil)
+	{
+		for (i = _first; i < _last; ++i)
+		{
+			_forBlock(i);
+		}
+	}
+	else if (_block != nil)
+	{
+		_block();
+	}
+	else if (_target != nil)
+	{
+		nglMsg(_target, _selector);
+	}
+	
+	[self finish];
+}
+
+- (void) finish
+{
+	NGLArray *dependents;
+	NGLJob *job;
+	BOOL cancelled;
+	
+	pthread_mutex_lock(&_mutex);
+	
+	if (_done)
+	{
+		pthread_mutex_unlock(&_mutex);
+		return;
+	}
+	
+	_done = YES;
+	cancelled = _cancelled;
+	dependents = _dependents;
+	_dependents = nil;
+	pthread_cond_broadcast(&_condition);
+	pthread_mutex_unlock(&_mutex);
+	
+	// The work is not needed anymore, the retained objects are released right away.
+	nglRelease(_target);
+	nglRelease(_block);
+	nglRelease(_forBlock);
+	
+	// The workers waiting for any job check it again.
+	pthread_mutex_lock(&_sleepMutex);
+	
+	if (_helping > 0)
+	{
+		pthread_cond_broadcast(&_helpCondition);
+	}
+	
+	pthread_mutex_unlock(&_sleepMutex);
+	
+	nglFor (job, dependents)
+	{
+		if (cancelled)
+		{
+			[job cancel];
+		}
+		else
+		{
+			[job dependencyDone];
+		}
+	}
+	
+	nglRelease(dependents);
+}
+
+- (void) dependencyDone
+{
+	NGLJobPriority priority;
+	BOOL cancelled;
+	
+	if (__sync_sub_and_fetch(&_waiting, 1) == 0)
+	{
+		pthread_mutex_lock(&_mutex);
+		cancelled = _cancelled;
+		priority = _priority;
+		_queued = !_cancelled;
+		pthread_mutex_unlock(&_mutex);
+		
+		// The canceled jobs are already done.
+		if (cancelled)
+		{
+			return;
+		}
+		
+		// The jobs without work, like the end of a parallel loop, are done right away.
+		if (_target == nil && _block == nil && _forBlock == nil)
+		{
+			[self finish];
+		}
+		else
+		{
+			jobQueue(self, priority);
+		}
+	}
+}
+
+#pragma mark -
+#pragma mark Self Public Methods
+//**************************************************
+//	Self Public Methods
+//**************************************************
+
+- (void) waitUntilDone
+{
+	UInt32 worker = jobWorker();
+	NGLJob *job;
+	
+	// A worker performs the other jobs meanwhile. Without jobs to perform, it sleeps until a new job is
+	// queued or any job is done, so the workers never wait for a job which nobody would perform.
+	while (worker > 0 && !self.isDone)
+	{
+		job = jobTake(worker - 1);
+		
+		if (job != nil)
+		{
+			jobRun(job);
+			continue;
+		}
+		
+		pthread_mutex_lock(&_sleepMutex);
+		
+		if (_pending == 0 && !self.isDone)
+		{
+			++_helping;
+			pthread_cond_wait(&_helpCondition, &_sleepMutex);
+			--_helping;
+		}
+		
+		pthread_mutex_unlock(&_sleepMutex);
+	}
+	
+	// The other threads just sleep.
+	pthread_mutex_lock(&_mutex);
+	
+	while (!_done)
+	{
+		pthread_cond_wait(&_condition, &_mutex);
+	}
+	
+	pthread_mutex_unlock(&_mutex);
+}
+
+- (BOOL) cancel
+{
+	BOOL dropped;
+	
+	pthread_mutex_lock(&_mutex);
+	dropped = (!_started && !_done);
+	_cancelled = (_cancelled || !_done);
+	pthread_mutex_unlock(&_mutex);
+	
+	// A pending job is done right away. Its slot in the queues is skipped when a worker takes it.
+	if (dropped)
+	{
+		[self finish];
+	}
+	
+	return dropped;
+}
+
+#pragma mark -
+#pragma mark Override Public Methods
+//**************************************************
+//	Override Public Methods
+//**************************************************
+
+- (void) dealloc
+{
+	nglRelease(_target);
+	nglRelease(_block);
+	nglRelease(_forBlock);
+	nglRelease(_dependents);
+	
+	pthread_cond_destroy(&_condition);
+	pthread_mutex_destroy(&_mutex);
+	
+	[super dealloc];
+}
+
+@end
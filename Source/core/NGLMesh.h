@@ -33,6 +33,7 @@
 #import "NGLShadersMulti.h"
 #import "NGLCamera.h"
 #import "NGLGestures.h"
+#import "NGLJob.h"
 #import "NGLArray.h"
 
 @class NGLMesh, NGLMeshElements, NGLCamera;
@@ -222,6 +223,50 @@ NGL_API NSString *const kNGLMeshKeyNormalize;
  */
 NGL_API NSString *const kNGLMeshKeyOriginal;
 
+/*!
+ *					This key represents if the NinevehGL Binary cached file will be saved with compressed
+ *					geometry. The compressed file is around 2 times smaller, but its geometry must be
+ *					decoded while loading instead of being used directly from the file.
+ *
+ *					The positions are quantized inside the mesh's bounding box, with a maximum error of
+ *					1/131070 of the mesh's size in each axis.
+ *
+ *					The data type for this key is a BOOL.
+ *
+ *	@see			NGLMesh::initWithFile:settings:delegate:
+ *	@see			NGLMesh::loadFile:file:settings:
+ */
+NGL_API NSString *const kNGLMeshKeyCompression;
+
+/*!
+ *					This key represents the format of the vertices in the GPU. The compact format packs
+ *					each element in a smaller data type, usually reducing the vertices to less than a
+ *					half, with a small precision loss reported by the mesh.
+ *
+ *					The array of structures in the CPU always keeps the floats.
+ *
+ *					The data type for this key is a BOOL.
+ *
+ *	@see			NGLMesh::precision
+ *	@see			nglDefineFormats
+ */
+NGL_API NSString *const kNGLMeshKeyFormat;
+
+/*!
+ *					This key represents if the mesh can be changed after loading. A dynamic mesh keeps
+ *					its arrays in the CPU and draws a ring of buffers in the GPU, so its vertices and
+ *					indices can be updated at every frame without uploading the whole mesh again.
+ *
+ *					The dynamic meshes always use floats in the GPU, ignoring the compact formats, and
+ *					don't cull their clusters. Their copies have their own buffers.
+ *
+ *					The data type for this key is a BOOL.
+ *
+ *	@see			NGLMesh::updateStructures:vertex:count:
+ *	@see			NGLMesh::updateIndices:start:count:
+ */
+NGL_API NSString *const kNGLMeshKeyDynamic;
+
 #pragma mark -
 #pragma mark Mesh Values
 #pragma mark -
@@ -246,6 +291,27 @@ NGL_API NSString *const kNGLMeshCentralizeYes;
  */
 NGL_API NSString *const kNGLMeshOriginalYes;
 
+/*!
+ *					Value to the #kNGLMeshKeyCompression#.
+ *
+ *					With this value the NinevehGL Binary cached file will be saved with compressed geometry.
+ */
+NGL_API NSString *const kNGLMeshCompressionYes;
+
+/*!
+ *					Value to the #kNGLMeshKeyFormat#.
+ *
+ *					With this value the vertices will be packed with compact formats in the GPU.
+ */
+NGL_API NSString *const kNGLMeshFormatCompact;
+
+/*!
+ *					Value to the #kNGLMeshKeyDynamic#.
+ *
+ *					With this value the mesh can be updated after loading.
+ */
+NGL_API NSString *const kNGLMeshDynamicYes;
+
 /*!
  *					The base class to every mesh in NinevehGL.
  *
@@ -292,7 +358,8 @@ NGL_API NSString *const kNGLMeshOriginalYes;
  *					Any copy (simple copy or copyInstance) of NGLMesh will be made asynchronous (when using
  *					multithreading) and after the loading process finishes. So, you can make a copy of a
  *					NGLMesh even if it's loading a 3D file. The structure will be copied into the new
- *					NGLMesh after the loading, respecting the copy type.
+ *					NGLMesh after the loading, respecting the copy type. The copies share the buffers of
+ *					the original NGLMesh in the GPU, so a copy doesn't parse or upload the 3D file again.
  *
  *					The loading process is one of the most expensive tasks in NinevehGL. If you are using
  *					NinevehGL with multithreading mode turned ON, the loading process task will use two
@@ -326,8 +393,44 @@ NGL_API NSString *const kNGLMeshOriginalYes;
 	UInt32                  _iCount;
 	UInt32                  _sCount;
 	UInt32                  _stride;
+	NSData					*_mappedData;
 	NGLMeshElements			*_meshElements;
 	
+	// Levels of Detail
+	NGLLevel				*_levels;
+	UInt32                  *_lodIndices;
+	UInt32                  _levelsCount;
+	UInt32                  _lodCount;
+	UInt32                  _level;
+	UInt32                  _detailLevels;
+	float					_detailErrors[NGL_LOD_LEVELS];
+	UInt32                  _detailIndices[NGL_LOD_LEVELS];
+	
+	// Clusters
+	NGLCluster				*_clusters;
+	BOOL					*_visibleClusters;
+	UInt32                  _clustersCount;
+	UInt32                  _visibleIndices;
+	BOOL					_clustersCulled;
+	
+	// Windows
+	NGLWindow				*_windows;
+	UInt32                  _windowsCount;
+	
+	// Formats
+	NGLPrecisionMetrics		_precision;
+	
+	// Instances
+	float					*_instances;
+	UInt32                  _instancesCount;
+	UInt32                  _instancesVersion;
+	
+	// Skeleton
+	NGLJoint				*_joints;
+	NSArray					*_jointNames;
+	NGLmat4					*_palette;
+	UInt32                  _jointsCount;
+	
 	// Properties
 	id <NGLMaterial>		_material;
 	id <NGLShaders>			_shaders;
@@ -348,7 +451,8 @@ NGL_API NSString *const kNGLMeshOriginalYes;
 	UInt32                  _inspector;
 	
 	// Helpers
-	UInt32                  _slot;
+	NGLJob					*_loading;
+	NGLJobPriority			_loadingPriority;
 	NGLParsing				_parsing;
 	BOOL					_isParsing;
 	BOOL					_isCompiling;
@@ -386,6 +490,22 @@ NGL_API NSString *const kNGLMeshOriginalYes;
  */
 @property (nonatomic, readonly) NGLParsing parsing;
 
+/*!
+ *					The handle of the current or the last loading. It can be waited or be a dependency of
+ *					other jobs. It's nil until the first loading.
+ *
+ *	@see			NGLJob
+ */
+@property (nonatomic, readonly) NGLJob *loading;
+
+/*!
+ *					The priority of the loadings of this mesh. Raising it during a loading that has not
+ *					started yet moves the loading ahead of the less urgent ones.
+ *
+ *					The default value is NGLJobPriorityVisible.
+ */
+@property (nonatomic) NGLJobPriority loadingPriority;
+
 /*!
  *					The array of indices's length.
  */
@@ -404,15 +524,167 @@ NGL_API NSString *const kNGLMeshOriginalYes;
 /*!
  *					Pointer to the array of indices containing the instructions to work with OpenGL
  *					programmable pipeline.
+ *
+ *					When the mesh is loaded from a NGL Binary file, this array can point directly to the
+ *					memory-mapped file, which is read only. Use #setIndices:count:# to change it.
  */
 @property (nonatomic, readonly) UInt32 *indices;
 
 /*!
  *					Pointer to the array of structures containing all the information about this
  *					mesh' structure.
+ *
+ *					When the mesh is loaded from a NGL Binary file, this array can point directly to the
+ *					memory-mapped file, which is read only. Use #setStructures:count:stride:# to change it.
  */
 @property (nonatomic, readonly) float *structures;
 
+/*!
+ *					The number of ranges in the levels of detail, all the levels together.
+ */
+@property (nonatomic, readonly) UInt32 levelsCount;
+
+/*!
+ *					The ranges of the levels of detail, sorted by level. Unlike the arrays of indices and
+ *					structures, the ranges remain after the upload, they are used to draw the levels.
+ *
+ *	@see			NGLLevel
+ */
+@property (nonatomic, readonly) NGLLevel *levels;
+
+/*!
+ *					The array of levels' indices's length.
+ */
+@property (nonatomic, readonly) UInt32 lodCount;
+
+/*!
+ *					Pointer to the array of levels' indices. It's freed after the upload, just like the
+ *					array of indices.
+ */
+@property (nonatomic, readonly) UInt32 *lodIndices;
+
+/*!
+ *					The number of levels of detail, including the original mesh (level 0). It's 1 when the
+ *					mesh has no simplified levels.
+ */
+@property (nonatomic, readonly) UInt32 detailLevels;
+
+/*!
+ *					The errors of the levels of detail, relative to the mesh's diagonal. There is one error
+ *					for each level, the level 0 has no error.
+ *
+ *	@see			nglLevelForSize
+ */
+@property (nonatomic, readonly) const float *detailErrors;
+
+/*!
+ *					The level of detail drawn by this mesh. The cameras choose it at each render cycle from
+ *					the size of the mesh on the screen. The level 0 is the original mesh.
+ *
+ *					Values greater than the last level are clamped.
+ */
+@property (nonatomic) UInt32 level;
+
+/*!
+ *					The number of clusters.
+ */
+@property (nonatomic, readonly) UInt32 clustersCount;
+
+/*!
+ *					The clusters of the array of indices, sorted by their starts. Like the levels, they
+ *					remain after the upload, they are used to skip the hidden parts of the mesh.
+ *
+ *	@see			NGLCluster
+ */
+@property (nonatomic, readonly) NGLCluster *clusters;
+
+/*!
+ *					The visibility of each cluster in the last render cycle. It's NULL when the clusters
+ *					are not culled, then the whole mesh is drawn.
+ */
+@property (nonatomic, readonly) BOOL *visibleClusters;
+
+/*!
+ *					The number of windows.
+ */
+@property (nonatomic, readonly) UInt32 windowsCount;
+
+/*!
+ *					The windows of vertices of each surface. They choose the size of the surfaces' indices
+ *					on the GPU, the surfaces without a window get one when the mesh is uploaded.
+ *
+ *	@see			NGLWindow
+ */
+@property (nonatomic, readonly) NGLWindow *windows;
+
+/*!
+ *					The precision lost by the compact formats of the vertices in the GPU. All the errors
+ *					are 0.0 when the vertices are not compact.
+ *
+ *	@see			kNGLMeshKeyFormat
+ *	@see			NGLPrecisionMetrics
+ */
+@property (nonatomic, readonly) NGLPrecisionMetrics precision;
+
+/*!
+ *					Indicates if this mesh was loaded as a dynamic mesh, which can be updated.
+ *
+ *	@see			kNGLMeshKeyDynamic
+ */
+@property (nonatomic, readonly, getter = isDynamic) BOOL dynamic;
+
+/*!
+ *					The number of instances. It's 0 when the mesh is not instanced.
+ *
+ *	@see			setInstances:colors:count:
+ */
+@property (nonatomic, readonly) UInt32 instancesCount;
+
+/*!
+ *					The data of the instances, NGL_INSTANCE_LENGTH floats to each instance: its matrix
+ *					followed by its color.
+ */
+@property (nonatomic, readonly) float *instances;
+
+/*!
+ *					<strong>(Internal only)</strong> Changes every time the instances are set, so the
+ *					core mesh knows when to upload them again.
+ */
+@property (nonatomic, readonly) UInt32 instancesVersion;
+
+/*!
+ *					The number of joints in the skeleton. It's 0 when the mesh is not skinned.
+ *
+ *	@see			setJoints:names:count:
+ */
+@property (nonatomic, readonly) UInt32 jointsCount;
+
+/*!
+ *					The joints of the skeleton, at the rest pose, in the mesh's space.
+ *
+ *	@see			NGLJoint
+ */
+@property (nonatomic, readonly) NGLJoint *joints;
+
+/*!
+ *					The names of the joints, in the same order of the joints.
+ */
+@property (nonatomic, readonly) NSArray *jointNames;
+
+/*!
+ *					The matrices of the current pose, one to each joint. They move the vertices from the rest
+ *					pose to the current pose, so they are all identities at the rest pose.
+ *
+ *	@see			setPose:
+ */
+@property (nonatomic, readonly) NGLmat4 *palette;
+
+/*!
+ *					The number of indices drawn with the current level of detail and the visible clusters,
+ *					for all the instances when the mesh is instanced.
+ */
+@property (nonatomic, readonly) UInt32 drawnIndicesCount;
+
 /*!
  *					Pointer to the elements of this mesh.
  *
@@ -561,7 +833,8 @@ NGL_API NSString *const kNGLMeshOriginalYes;
 
 /*!
  *					Stops the loading process. Cancelling the process is not immediately, it can
- *					take few more cycles to release all the allocated memory.
+ *					take few more cycles to release all the allocated memory. A loading that has not
+ *					started yet is dropped right away.
  *
  *					If you are using NinevehGL with multithreading, remember that the load will retain
  *					this mesh to work on a background thread. So, if you want to release and dealloc
@@ -628,6 +901,175 @@ NGL_API NSString *const kNGLMeshOriginalYes;
  */
 - (void) setStructures:(float *)newStructures count:(UInt32)newCount stride:(UInt32)newStride;
 
+/*!
+ *					Sets the levels of detail.
+ *
+ *					The ranges and the array of levels' indices must match the array of indices, so this
+ *					method should be called after #setIndices:count:#, which removes the old levels.
+ *
+ *	@param			newLevels
+ *					Pointer to the ranges of the levels. All the memory pointed by this parameter will be
+ *					copied internally.
+ *
+ *	@param			newCount
+ *					The number of ranges.
+ *
+ *	@param			newIndices
+ *					Pointer to the array of levels' indices. All the memory pointed by this parameter will
+ *					be copied internally.
+ *					It can be NULL when the levels' indices are already in the buffers of the mesh.
+ *
+ *	@param			newLodCount
+ *					The array of levels' indices's length.
+ */
+- (void) setLevels:(NGLLevel *)newLevels
+			 count:(UInt32)newCount
+		   indices:(UInt32 *)newIndices
+		  lodCount:(UInt32)newLodCount;
+
+/*!
+ *					Sets the clusters.
+ *
+ *					The clusters must match the array of indices, so this method should be called after
+ *					#setIndices:count:#, which removes the old clusters.
+ *
+ *	@param			newClusters
+ *					Pointer to the clusters, sorted by their starts. All the memory pointed by this
+ *					parameter will be copied internally.
+ *
+ *	@param			newCount
+ *					The number of clusters.
+ */
+- (void) setClusters:(NGLCluster *)newClusters count:(UInt32)newCount;
+
+/*!
+ *					Sets the windows of vertices.
+ *
+ *					The windows must match the array of indices and the levels of detail, so this method
+ *					should be called after #setIndices:count:# and
+ *					#setLevels:count:indices:lodCount:#, which remove the old windows.
+ *
+ *	@param			newWindows
+ *					Pointer to the windows. All the memory pointed by this parameter will be copied
+ *					internally.
+ *
+ *	@param			newCount
+ *					The number of windows.
+ */
+- (void) setWindows:(NGLWindow *)newWindows count:(UInt32)newCount;
+
+/*!
+ *					Updates a range of vertices of a dynamic mesh.
+ *
+ *					Only the changed range is uploaded, in the next frame. The bounding box keeps the
+ *					original vertices. Changing the whole structure still needs
+ *					#setStructures:count:stride#.
+ *
+ *	@param			newStructures
+ *					Pointer to the new vertices, with the stride of the mesh. All the memory pointed by
+ *					this parameter will be copied internally.
+ *
+ *	@param			first
+ *					The first vertex to update.
+ *
+ *	@param			count
+ *					The number of vertices to update.
+ *
+ *	@see			kNGLMeshKeyDynamic
+ */
+- (void) updateStructures:(const float *)newStructures vertex:(UInt32)first count:(UInt32)count;
+
+/*!
+ *					Updates a range of indices of a dynamic mesh.
+ *
+ *					Only the changed range is uploaded, in the next frame. Each new index must use a
+ *					vertex of the same surface it belongs to. The levels of detail keep the original
+ *					indices.
+ *
+ *	@param			newIndices
+ *					Pointer to the new indices. All the memory pointed by this parameter will be copied
+ *					internally.
+ *
+ *	@param			start
+ *					The first index to update.
+ *
+ *	@param			count
+ *					The number of indices to update.
+ *
+ *	@see			kNGLMeshKeyDynamic
+ */
+- (void) updateIndices:(const UInt32 *)newIndices start:(UInt32)start count:(UInt32)count;
+
+/*!
+ *					Sets the instances of this mesh.
+ *
+ *					Each instance draws the whole mesh with its own matrix and color, all of them in a
+ *					single draw call when the device supports instanced arrays. The matrix of an instance
+ *					is applied before the mesh's matrix, so it places the instance in the mesh's space.
+ *					Moving the mesh moves all its instances together. The instances' matrices should not
+ *					have non-uniform scales, since they also rotate the normals.
+ *
+ *					Without instanced arrays, the instances are drawn in batches of NGL_INSTANCE_BATCH
+ *					copies of the mesh, one draw call to each batch. The copies are created from the mesh's
+ *					arrays, so the first instances set after the loading reload the cached file.
+ *
+ *					The instances are drawn entirely, without the culling of the clusters, and the
+ *					telemetry only sees the mesh itself. Setting 0 instances draws the mesh alone again.
+ *
+ *	@param			matrices
+ *					Pointer to the instances' matrices. All the memory pointed by this parameter will be
+ *					copied internally.
+ *
+ *	@param			colors
+ *					Pointer to the instances' colors, which multiply the final color of each instance.
+ *					It can be NULL, then all the instances are white.
+ *
+ *	@param			count
+ *					The number of instances.
+ */
+- (void) setInstances:(const NGLmat4 *)matrices colors:(const NGLvec4 *)colors count:(UInt32)count;
+
+/*!
+ *					Sets the skeleton of this mesh.
+ *
+ *					The skinned vertices are moved by the GPU, each one by up to 4 joints. The skeleton
+ *					starts at the rest pose. The bounding box and the clusters always keep the rest pose,
+ *					so the skinned meshes are not culled by their clusters. Setting 0 joints draws the
+ *					mesh without skinning again.
+ *
+ *	@param			newJoints
+ *					Pointer to the joints, each parent before its children. All the memory pointed by
+ *					this parameter will be copied internally.
+ *
+ *	@param			names
+ *					The names of the joints. It can be nil.
+ *
+ *	@param			count
+ *					The number of joints, up to NGL_MAX_JOINTS.
+ */
+- (void) setJoints:(const NGLJoint *)newJoints names:(NSArray *)names count:(UInt32)count;
+
+/*!
+ *					Poses the skeleton.
+ *
+ *					Each matrix replaces the local matrix of its joint, in the space of its parent. The
+ *					new pose is uploaded in the next frame.
+ *
+ *	@param			pose
+ *					Pointer to the local matrices, one to each joint. NULL returns to the rest pose.
+ */
+- (void) setPose:(NGLmat4 *)pose;
+
+/*!
+ *					Finds a joint by its name.
+ *
+ *	@param			name
+ *					The name of the joint.
+ *
+ *	@result			The index of the joint or NGL_NOT_FOUND if there is no joint with that name.
+ */
+- (UInt32) jointWithName:(NSString *)name;
+
 /*!
  *					<strong>(Internal only)</strong> You should not call this one manually.
  *
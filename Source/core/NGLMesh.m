@@ -51,6 +51,9 @@
 
 static NSString *const MSH_ERROR_HEADER = @"Error while processing NGLMesh.";
 
+static NSString *const MSH_ERROR_UPDATE = @"The NGLMesh could not be updated.\n\
+Only the meshes loaded with kNGLMeshKeyDynamic can be updated, inside their ranges and their surfaces.";
+
 static NSString *const MSH_ERROR_DATA_TYPE = @"The NGLMesh settings must be a NSString or a NSNumber.\n\
 You are passing the argument:%@, which is not a NSString nor a NSNumber.";
 
@@ -63,9 +66,15 @@ You are passing the argument:%@, which is not a NSString nor a NSNumber.";
 NSString *const kNGLMeshKeyCentralize = @"autoCentralize";
 NSString *const kNGLMeshKeyNormalize = @"autoNormalize";
 NSString *const kNGLMeshKeyOriginal = @"useOriginal";
+NSString *const kNGLMeshKeyCompression = @"compression";
+NSString *const kNGLMeshKeyFormat = @"format";
+NSString *const kNGLMeshKeyDynamic = @"dynamic";
 
 NSString *const kNGLMeshCentralizeYes = @"autoCentralizeYes";
 NSString *const kNGLMeshOriginalYes = @"useOriginalYes";
+NSString *const kNGLMeshCompressionYes = @"compressionYes";
+NSString *const kNGLMeshFormatCompact = @"formatCompact";
+NSString *const kNGLMeshDynamicYes = @"dynamicYes";
 
 #pragma mark -
 #pragma mark Private Interface
@@ -82,9 +91,6 @@ NSString *const kNGLMeshOriginalYes = @"useOriginalYes";
 //	Private Definitions
 //**************************************************
 
-// Global thread slots to the loading.
-static UInt32 *_slots = NULL;
-
 // Global pointer library to the meshes.
 static NGLArray *_meshes;
 
@@ -127,45 +133,6 @@ static NGL3DFileType fileTypeForFile(NSString *fileNamed)
 	return type;
 }
 
-// Choose the best thread slot at this time. The best thread will be the one with less pending job.
-static UInt32 parseSlot(void)
-{
-	int i;
-	UInt32 min, index;
-	
-	// Initialize the slots once, setting all items to 0.
-	if (_slots == NULL)
-	{
-		_slots = calloc(NGL_PARSE_THREADS, NGL_SIZE_UINT);
-	}
-	
-	// Searches for the thread index with less work on it.
-	for (i = NGL_PARSE_THREADS - 1, min = 0, index = 0; i >= 0; --i)
-	{
-		if (min >= _slots[i])
-		{
-			min = _slots[i];
-			index = i;
-		}
-	}
-	
-	// Sums one on the selected slot.
-	_slots[index] += 1;
-	
-	return ++index;
-}
-
-// Frees one number in a specific slot.
-static void parseFreeSlot(UInt32 slot)
-{
-	--slot;
-	
-	if (slot < NGL_PARSE_THREADS)
-	{
-		_slots[slot] -= 1;
-	}
-}
-
 // Recreates the buffers. This method sends a synchronous task to the core mesh thread.
 static void fillCoreMesh(id <NGLCoreMesh> coreMesh)
 {
@@ -187,6 +154,36 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	}
 }
 
+// Recreates the buffers sharing the buffers of another core mesh, synchronously on the core mesh thread.
+// Returns NO if the buffers could not be shared.
+static BOOL shareCoreMesh(id <NGLCoreMesh> coreMesh, id <NGLCoreMesh> sharedCore)
+{
+	BOOL isShared = NO;
+	
+	if (coreMesh != nil && [sharedCore isReady])
+	{
+		SEL selector = @selector(defineBuffersWithCore:);
+		NSMethodSignature *sig = [(id)coreMesh methodSignatureForSelector:selector];
+		NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:sig];
+		[invocation setTarget:coreMesh];
+		[invocation setSelector:selector];
+		[invocation setArgument:&sharedCore atIndex:2];
+		
+		nglThreadPerformSync(kNGLThreadHelper, @selector(invoke), invocation);
+		[invocation getReturnValue:&isShared];
+	}
+	
+	return isShared;
+}
+
+// Checks if an array lies inside a memory-mapped data. Mapped arrays are not owned by the mesh.
+static BOOL meshIsMapped(const void *pointer, NSData *data)
+{
+	const char *bytes = [data bytes];
+	
+	return (data != nil && (const char *)pointer >= bytes && (const char *)pointer < bytes + [data length]);
+}
+
 #pragma mark -
 #pragma mark Private Category
 //**************************************************
@@ -204,6 +201,9 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 // Deletes the current current core mesh.
 - (void) deleteCoreMesh;
 
+// Creates a new core mesh on the buffers of another mesh. Returns NO if the buffers could not be shared.
+- (BOOL) shareCoreMesh:(NGLMesh *)mesh;
+
 // Defines the bounding box based on the current mesh's structure.
 - (void) defineBoundingBox;
 
@@ -213,6 +213,18 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 // Constructs the mesh based on a NGLParserMesh model.
 - (void) defineMeshFromParser;
 
+// Takes the arrays of a parser. The memory-mapped ones are retained instead of copied.
+- (void) defineStructureFromParser:(NGLParserMesh *)parser;
+
+// Frees the array of indices and the array of structures, the mapped ones are just released.
+- (void) freeStructure;
+
+// Sums up the errors and the drawn indices of each level of detail from its ranges.
+- (void) defineDetails;
+
+// Finds the clusters visible by a camera. Must be called after the MODEL_VIEW_PROJECTION matrix.
+- (void) cullClustersWithCamera:(NGLCamera *)camera;
+
 // Defines the parser settings.
 - (void) defineParserSettings:(NGLParserMesh *)parser;
 
@@ -249,9 +261,15 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 @synthesize parsing = _parsing, indices = _indices, structures = _structures, indicesCount = _iCount,
 			structuresCount = _sCount, stride = _stride, meshElements = _meshElements,
 			material = _material, surface = _surface, shaders = _shaders, visible = _visible,
-			touchable = _touchable, gestureRecognizers = _gestures;
+			touchable = _touchable, gestureRecognizers = _gestures, levels = _levels, levelsCount = _levelsCount,
+			lodIndices = _lodIndices, lodCount = _lodCount, detailLevels = _detailLevels,
+			clusters = _clusters, clustersCount = _clustersCount, windows = _windows, windowsCount = _windowsCount,
+			precision = _precision, instances = _instances, instancesCount = _instancesCount,
+			instancesVersion = _instancesVersion, jointsCount = _jointsCount, joints = _joints,
+			jointNames = _jointNames, palette = _palette, loading = _loading;
 
-@dynamic matrixMVP, matrixMInverse, matrixMVInverse, delegate, fileNamed, fileSettings;
+@dynamic matrixMVP, matrixMInverse, matrixMVInverse, delegate, fileNamed, fileSettings, detailErrors, level,
+		 visibleClusters, drawnIndicesCount, loadingPriority;
 
 - (NGLmat4 *) matrixMVP
 {
@@ -268,6 +286,35 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	return &_mvIMatrix;
 }
 
+- (const float *) detailErrors
+{
+	return _detailErrors;
+}
+
+- (UInt32) level { return _level; }
+- (void) setLevel:(UInt32)value
+{
+	_level = MIN(value, _detailLevels - 1);
+}
+
+- (BOOL *) visibleClusters
+{
+	return (_clustersCulled) ? _visibleClusters : NULL;
+}
+
+- (BOOL) isDynamic
+{
+	return [[_fileSettings objectForKey:kNGLMeshKeyDynamic] isEqualToString:kNGLMeshDynamicYes];
+}
+
+- (UInt32) drawnIndicesCount
+{
+	UInt32 count = (_level > 0) ? _detailIndices[_level] : ((_clustersCulled) ? _visibleIndices : _iCount);
+	
+	// Each instance draws the same indices again.
+	return (_instancesCount > 0) ? count * _instancesCount : count;
+}
+
 - (id <NGLMeshDelegate>) delegate { return _delegate; }
 - (void) setDelegate:(id<NGLMeshDelegate>)value
 {
@@ -305,6 +352,15 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	}
 }
 
+- (NGLJobPriority) loadingPriority { return _loadingPriority; }
+- (void) setLoadingPriority:(NGLJobPriority)value
+{
+	_loadingPriority = value;
+	
+	// Moves the pending loading, if any.
+	_loading.priority = value;
+}
+
 #pragma mark -
 #pragma mark Constructors
 //**************************************************
@@ -362,6 +418,7 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	
 	// Settings.
 	_visible = YES;
+	_detailLevels = 1;
 	_meshElements = [[NGLMeshElements alloc] init];
 	_gestures = [[NGLArray alloc] initWithRetainOption];
 }
@@ -408,9 +465,45 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	// Defining the bounding box for the new structure. Must be done before free the structures.
 	[self defineBoundingBox];
 	
-	// Frees the data.
-	nglFree(_indices);
-	nglFree(_structures);
+	// Frees the data. The dynamic meshes keep it to be updated.
+	if (!self.isDynamic)
+	{
+		[self freeStructure];
+	}
+}
+
+- (BOOL) shareCoreMesh:(NGLMesh *)mesh
+{
+	id <NGLCoreMesh> newCore, oldCore = _coreMesh, sharedCore = [mesh->_coreMesh retain];
+	BOOL isShared;
+	
+	// Starts the new engine.
+	switch (nglDefaultEngine)
+	{
+		case NGLEngineVersionES2:
+		default:
+			newCore = [[NGLES2Mesh alloc] initWithParent:self];
+			break;
+	}
+	
+	isShared = shareCoreMesh(newCore, sharedCore);
+	nglRelease(sharedCore);
+	
+	if (isShared)
+	{
+		_coreMesh = newCore;
+		
+		// Clears the buffers and release the instance.
+		emptyCoreMesh(oldCore);
+		nglRelease(oldCore);
+	}
+	else
+	{
+		// The new core never made buffers, there is nothing to clear.
+		nglRelease(newCore);
+	}
+	
+	return isShared;
 }
 
 - (void) deleteCoreMesh
@@ -519,8 +612,7 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	[self defineParserSettings:parser];
 	
 	// Sets the array of indices and array of structures.
-	[self setIndices:parser.indices count:parser.indicesCount];
-	[self setStructures:parser.structures count:parser.structuresCount stride:parser.stride];
+	[self defineStructureFromParser:parser];
 	
 	if (!_isCompiling)
 	{
@@ -540,10 +632,149 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 		}
 	}
 	
+	// The compact formats are chosen from the final array of structures, after the adjusts.
+	// The half floats are only used when the GPU reads them.
+	if ([[_fileSettings objectForKey:kNGLMeshKeyFormat] isEqualToString:kNGLMeshFormatCompact] && !self.isDynamic)
+	{
+		_precision = nglDefineFormats(_meshElements, _structures, _sCount, _stride,
+									  ngles2HasExtension(@"GL_OES_vertex_half_float"));
+	}
+	
 	// Updates the mesh's core, only if this mesh has a valid structure.
 	[self updateCoreMesh];
 }
 
+- (void) defineStructureFromParser:(NGLParserMesh *)parser
+{
+	NSData *mappedData = parser.mappedData;
+	UInt32 *indices = parser.indices;
+	float *structures = parser.structures;
+	
+	[self freeStructure];
+	
+	// Arrays inside a memory-mapped file are used directly, as long as the mapped data is alive.
+	// Any other array, like an adjusted array of structures, is copied. The dynamic arrays are always copied.
+	_mappedData = (self.isDynamic) ? nil : [mappedData retain];
+	
+	if (meshIsMapped(indices, mappedData))
+	{
+		_indices = indices;
+		_iCount = parser.indicesCount;
+	}
+	else
+	{
+		[self setIndices:indices count:parser.indicesCount];
+	}
+	
+	if (meshIsMapped(structures, mappedData))
+	{
+		_structures = structures;
+		_sCount = parser.structuresCount;
+		_stride = parser.stride;
+	}
+	else
+	{
+		[self setStructures:structures count:parser.structuresCount stride:parser.stride];
+	}
+	
+	// The levels of detail and the clusters are always copied, they are small.
+	[self setLevels:parser.levels count:parser.levelsCount indices:parser.lodIndices lodCount:parser.lodCount];
+	[self setClusters:parser.clusters count:parser.clustersCount];
+	[self setWindows:parser.windows count:parser.windowsCount];
+	[self setJoints:parser.joints names:parser.jointNames count:parser.jointsCount];
+}
+
+- (void) freeStructure
+{
+	// The mapped arrays belong to the mapped data.
+	if (meshIsMapped(_indices, _mappedData))
+	{
+		_indices = NULL;
+	}
+	
+	if (meshIsMapped(_structures, _mappedData))
+	{
+		_structures = NULL;
+	}
+	
+	nglFree(_indices);
+	nglFree(_structures);
+	nglFree(_lodIndices);
+	nglRelease(_mappedData);
+}
+
+- (void) defineDetails
+{
+	UInt32 i, level;
+	
+	// The level 0 is the original mesh.
+	_detailLevels = 1;
+	memset(_detailErrors, 0, sizeof(_detailErrors));
+	memset(_detailIndices, 0, sizeof(_detailIndices));
+	
+	for (i = 0; i < _levelsCount; ++i)
+	{
+		level = _levels[i].level;
+		
+		if (level > 0 && level < NGL_LOD_LEVELS)
+		{
+			_detailLevels = MAX(_detailLevels, level + 1);
+			_detailErrors[level] = MAX(_detailErrors[level], _levels[i].error);
+			_detailIndices[level] += _levels[i].length;
+		}
+	}
+	
+	// The errors never decrease along the levels.
+	for (i = 1; i < _detailLevels; ++i)
+	{
+		_detailErrors[i] = MAX(_detailErrors[i], _detailErrors[i - 1]);
+	}
+	
+	_level = MIN(_level, _detailLevels - 1);
+}
+
+- (void) cullClustersWithCamera:(NGLCamera *)camera
+{
+	NGLmat4 inverse;
+	NGLmat4 *matrix;
+	NGLvec3 eye;
+	float facing = 0.0f;
+	
+	// The clusters belong to the original mesh, the levels of detail are drawn entirely.
+	_clustersCulled = (nglDefaultClusterCulling && _level == 0 && _clustersCount > 1);
+	
+	if (!_clustersCulled)
+	{
+		return;
+	}
+	
+	// The cones are tested only against the faces culled by the GPU, from the eye of a perspective.
+	if (camera.projection == NGLProjectionPerspective)
+	{
+		switch (nglDefaultCullFace)
+		{
+			case NGLCullFaceBack:
+				facing = 1.0f;
+				break;
+			case NGLCullFaceFront:
+				facing = -1.0f;
+				break;
+			default:
+				break;
+		}
+		
+		// The normals of the cones follow the counterclockwise triangles.
+		facing *= (nglDefaultFrontFace == NGLFrontFaceCCW) ? 1.0f : -1.0f;
+	}
+	
+	// The eye is the camera's position, in the mesh's space.
+	matrix = camera.matrix;
+	nglMatrixInverse(*self.matrix, inverse);
+	eye = nglVec3ByMatrix((NGLvec3){(*matrix)[12], (*matrix)[13], (*matrix)[14]}, inverse);
+	
+	_visibleIndices = nglCullClusters(_clusters, _clustersCount, _mvpMatrix, eye, facing, _visibleClusters);
+}
+
 - (void) defineParserSettings:(NGLParserMesh *)parser
 {
 	id object, value;
@@ -679,12 +910,20 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	NGLParserNGL *nglFile = [[NGLParserNGL alloc] init];
 	NSString *useOriginal = [_fileSettings objectForKey:kNGLMeshKeyOriginal];
 	BOOL isBinary = (_parserClass == [NGLParserNGL class]);
-	BOOL hasCache = [nglFile hasCache:_fileNamed];
-	BOOL useCache = (![useOriginal isEqualToString:kNGLMeshOriginalYes] && hasCache);
+	BOOL hasCache, useCache;
+	
+	// The cached files are identified by the import settings, the cache ignores the ones that don't change it.
+	hasCache = [nglFile hasCache:_fileNamed settings:_fileSettings];
+	useCache = (![useOriginal isEqualToString:kNGLMeshOriginalYes] && hasCache);
 	
-	// Allocates the parser memory.
+	// Allocates the parser memory. A loading canceled while it was starting doesn't parse anything.
 	_parser = (useCache) ? [nglFile retain] : [[_parserClass alloc] init];
 	
+	if (_loading.isCancelled)
+	{
+		[_parser cancelLoading];
+	}
+	
 	//*************************
 	//	Notifications
 	//*************************
@@ -699,7 +938,7 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	if (useCache)
 	{
 		// Decodes the cached file.
-		[nglFile decodeCache:_fileNamed];
+		[nglFile decodeCache:_fileNamed settings:_fileSettings];
 	}
 	// If the original is requested or no valid caches are found, parses the original.
 	else
@@ -724,7 +963,9 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 		// NGL encoding automatically aborts in case of invalid original targets.
 		if (!isBinary && !useCache)
 		{
-			[nglFile encodeCache:_parser withName:_fileNamed];
+			nglFile.compressed = [[_fileSettings objectForKey:kNGLMeshKeyCompression]
+								  isEqualToString:kNGLMeshCompressionYes];
+			[nglFile encodeCache:_parser withName:_fileNamed settings:_fileSettings];
 		}
 		
 		// Gets information from the parser.
@@ -735,9 +976,6 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	nglRelease(_parser);
 	nglRelease(nglFile);
 	
-	// Frees the used slot in the NinevehGL Parser threads.
-	parseFreeSlot(_slot);
-	
 	//*************************
 	//	Notifications
 	//*************************
@@ -756,13 +994,9 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	
 	// Copying properties.
 	copy.visible = _visible;
-	
-	//TODO create shared MeshCore (OpenGL ES 2), instead of this.
 	copy.fileNamed = _fileNamed;
 	copy.fileSettings = _fileSettings;
 	[copy.meshElements addFromElements:_meshElements];
-	//TODO
-	//self.volumeBox;
 	
 	if (isShared)
 	{
@@ -785,7 +1019,23 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 		nglRelease(cSurface);
 	}
 	
-	[copy compileCoreMesh];
+	// Copying the parsed structure. The arrays were freed after the upload, the counts describe the buffers.
+	copy->_iCount = _iCount;
+	copy->_sCount = _sCount;
+	copy->_stride = _stride;
+	copy->_precision = _precision;
+	copy->_boundingBox = _boundingBox;
+	[copy setLevels:_levels count:_levelsCount indices:_lodIndices lodCount:_lodCount];
+	[copy setClusters:_clusters count:_clustersCount];
+	[copy setWindows:_windows count:_windowsCount];
+	[copy setJoints:_joints names:_jointNames count:_jointsCount];
+	
+	// The copy uses the same buffers of this mesh. Only if they can't be shared, like while this mesh has
+	// no buffers, the copy reloads the cached file and uploads its own buffers.
+	if (![copy shareCoreMesh:self])
+	{
+		[copy compileCoreMesh];
+	}
 }
 
 #pragma mark -
@@ -837,17 +1087,22 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 				break;
 		}
 		
-		// Chooses a slot in the NinevehGL Parser threads. This slot must be freed after parsing.
-		_slot = parseSlot();
-		
-		// Starts or queue this load in the selected parser tread. The Parser Thread is a short-lived one.
-		NSString *threadName = [NSString stringWithFormat:@"%@-%i", kNGLThreadParser, (unsigned int)_slot];
-		nglThreadPerformAsync(threadName, @selector(loadFile), self);
+		// Starts this load in the job system. The idle workers steal it, so a slow file doesn't hold the others.
+		nglRelease(_loading);
+		_loading = [nglJobPerformPriority(@selector(loadFile), self, nil, _loadingPriority) retain];
 	}
 }
 
 - (void) cancelLoading
 {
+	// A loading still waiting for a worker is dropped right away, without any notification.
+	// A running one stops at the next checkpoint of the parser.
+	if ([_loading cancel])
+	{
+		_isParsing = NO;
+		_isCompiling = NO;
+	}
+	
 	[_parser cancelLoading];
 }
 
@@ -860,9 +1115,9 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 		NGLParserNGL *parser = [[NGLParserNGL alloc] init];
 		
 		// Reload the saved cache if it's valid.
-		if ([parser hasCache:_fileNamed])
+		if ([parser hasCache:_fileNamed settings:_fileSettings])
 		{
-			[parser decodeCache:_fileNamed];
+			[parser decodeCache:_fileNamed settings:_fileSettings];
 			
 			// Sets the change's properties to the parser.
 			[self defineParserSettings:parser];
@@ -911,6 +1166,9 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 		// This inverse matrix is used to calculate the Eye vector in shaders.
 		nglMatrixMultiply(_mIMatrix, *camera.matrix, _mvIMatrix);
 		
+		// Skips the clusters out of the screen or facing away from the camera.
+		[self cullClustersWithCamera:camera];
+		
 		// Draws this mesh.
 		[_coreMesh drawCoreMesh];
 	}
@@ -926,6 +1184,9 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 		// This matrix is used to calculate the final position for each vertex.
 		nglMatrixMultiply(*camera.matrixViewProjection, *self.matrix, _mvpMatrix);
 		
+		// The hidden clusters can't be touched either.
+		[self cullClustersWithCamera:camera];
+		
 		// Draws this mesh.
 		[_coreMesh drawTelemetry:telemetry];
 	}
@@ -933,15 +1194,31 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 
 - (void) setIndices:(UInt32 *)newIndices count:(UInt32)newCount
 {
+	// A mapped array can't be reallocated, the copy starts a new one.
+	if (meshIsMapped(_indices, _mappedData))
+	{
+		_indices = NULL;
+	}
+	
 	// Copies the memory of array of indices.
 	_indices = realloc(_indices, newCount * NGL_SIZE_UINT);
     NSAssert(_indices != NULL, @"Invalid Indices reallocation");
 	memcpy(_indices, newIndices, newCount * NGL_SIZE_UINT);
 	_iCount = newCount;
+	
+	// The old levels of detail and clusters don't match the new indices.
+	[self setLevels:NULL count:0 indices:NULL lodCount:0];
+	[self setClusters:NULL count:0];
 }
 
 - (void) setStructures:(float *)newStructures count:(UInt32)newCount stride:(UInt32)newStride
 {
+	// A mapped array can't be reallocated, the copy starts a new one.
+	if (meshIsMapped(_structures, _mappedData))
+	{
+		_structures = NULL;
+	}
+	
 	// Copies the memory of array of structures.
 	_structures = realloc(_structures, newCount * NGL_SIZE_FLOAT);
     NSAssert(_structures != NULL, @"Invalid Structures reallocation");
@@ -950,6 +1227,169 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	_stride = newStride;
 }
 
+- (void) setLevels:(NGLLevel *)newLevels
+			 count:(UInt32)newCount
+		   indices:(UInt32 *)newIndices
+		  lodCount:(UInt32)newLodCount
+{
+	nglFree(_levels);
+	nglFree(_lodIndices);
+	_levelsCount = _lodCount = 0;
+	
+	// Copies the memory of the ranges and the array of levels' indices.
+	if (newCount > 0)
+	{
+		_levels = malloc(newCount * sizeof(NGLLevel));
+		memcpy(_levels, newLevels, newCount * sizeof(NGLLevel));
+		_levelsCount = newCount;
+	}
+	
+	// The levels' indices are freed after the upload, the ranges alone still describe the buffers.
+	if (newIndices != NULL && newLodCount > 0)
+	{
+		_lodIndices = malloc(newLodCount * NGL_SIZE_UINT);
+		memcpy(_lodIndices, newIndices, newLodCount * NGL_SIZE_UINT);
+		_lodCount = newLodCount;
+	}
+	
+	// The old windows may not include the new levels.
+	[self setWindows:NULL count:0];
+	[self defineDetails];
+}
+
+- (void) setClusters:(NGLCluster *)newClusters count:(UInt32)newCount
+{
+	nglFree(_clusters);
+	nglFree(_visibleClusters);
+	_clustersCount = 0;
+	_clustersCulled = NO;
+	
+	// Copies the memory of the clusters, all of them are visible until the first culling.
+	if (newCount > 0)
+	{
+		_clusters = malloc(newCount * sizeof(NGLCluster));
+		_visibleClusters = malloc(newCount * sizeof(BOOL));
+		memcpy(_clusters, newClusters, newCount * sizeof(NGLCluster));
+		memset(_visibleClusters, YES, newCount * sizeof(BOOL));
+		_clustersCount = newCount;
+	}
+}
+
+- (void) setWindows:(NGLWindow *)newWindows count:(UInt32)newCount
+{
+	nglFree(_windows);
+	_windowsCount = 0;
+	
+	// Copies the memory of the windows.
+	if (newCount > 0)
+	{
+		_windows = malloc(newCount * sizeof(NGLWindow));
+		memcpy(_windows, newWindows, newCount * sizeof(NGLWindow));
+		_windowsCount = newCount;
+	}
+}
+
+- (void) updateStructures:(const float *)newStructures vertex:(UInt32)first count:(UInt32)count
+{
+	if (![_coreMesh updateStructures:newStructures vertex:first count:count])
+	{
+		[NGLError errorInstantlyWithHeader:MSH_ERROR_HEADER andMessage:MSH_ERROR_UPDATE];
+	}
+}
+
+- (void) updateIndices:(const UInt32 *)newIndices start:(UInt32)start count:(UInt32)count
+{
+	if (![_coreMesh updateIndices:newIndices start:start count:count])
+	{
+		[NGLError errorInstantlyWithHeader:MSH_ERROR_HEADER andMessage:MSH_ERROR_UPDATE];
+	}
+}
+
+- (void) setInstances:(const NGLmat4 *)matrices colors:(const NGLvec4 *)colors count:(UInt32)count
+{
+	UInt32 i;
+	float *instance;
+	BOOL wasInstanced = (_instancesCount > 0);
+	
+	nglFree(_instances);
+	_instancesCount = 0;
+	
+	// Each instance holds its matrix followed by its color.
+	if (count > 0)
+	{
+		_instances = malloc(count * NGL_INSTANCE_LENGTH * NGL_SIZE_FLOAT);
+		
+		for (i = 0; i < count; ++i)
+		{
+			instance = _instances + i * NGL_INSTANCE_LENGTH;
+			memcpy(instance, matrices[i], sizeof(NGLmat4));
+			*(NGLvec4 *)(instance + 16) = (colors != NULL) ? colors[i] : (NGLvec4){1.0f, 1.0f, 1.0f, 1.0f};
+		}
+		
+		_instancesCount = count;
+	}
+	
+	++_instancesVersion;
+	
+	// The instances use other shaders, so the polygons are constructed again on the same buffers.
+	// The dynamic buffers can't be shared, but the dynamic meshes still have their arrays to upload.
+	// The batches of instances need the arrays too, the other meshes reload them from the cached file.
+	if (wasInstanced != (count > 0) && _coreMesh.isReady && ![self shareCoreMesh:self])
+	{
+		if (self.isDynamic)
+		{
+			[self updateCoreMesh];
+		}
+		else if (_fileNamed != nil)
+		{
+			[self compileCoreMesh];
+		}
+	}
+}
+
+- (void) setJoints:(const NGLJoint *)newJoints names:(NSArray *)names count:(UInt32)count
+{
+	BOOL wasSkinned = (_jointsCount > 0);
+	
+	nglFree(_joints);
+	nglFree(_palette);
+	nglRelease(_jointNames);
+	_jointsCount = 0;
+	
+	if (count > 0 && count <= NGL_MAX_JOINTS)
+	{
+		_joints = malloc(count * sizeof(NGLJoint));
+		memcpy(_joints, newJoints, count * sizeof(NGLJoint));
+		_palette = malloc(count * sizeof(NGLmat4));
+		_jointNames = [names copy];
+		_jointsCount = count;
+		
+		// Starts at the rest pose.
+		nglSkinPalette(_joints, NULL, _jointsCount, _palette);
+	}
+	
+	// The skeleton uses other shaders, pointing to the new palette, so the polygons are constructed again.
+	if ((wasSkinned || _jointsCount > 0) && _coreMesh.isReady && ![self shareCoreMesh:self] && self.isDynamic)
+	{
+		[self updateCoreMesh];
+	}
+}
+
+- (void) setPose:(NGLmat4 *)pose
+{
+	if (_jointsCount > 0)
+	{
+		nglSkinPalette(_joints, pose, _jointsCount, _palette);
+	}
+}
+
+- (UInt32) jointWithName:(NSString *)name
+{
+	NSUInteger index = (name != nil) ? [_jointNames indexOfObject:name] : NSNotFound;
+	
+	return (index != NSNotFound) ? (UInt32)index : NGL_NOT_FOUND;
+}
+
 + (void) updateAllMeshes
 {
 	NGLMesh *mesh;
@@ -1025,9 +1465,8 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	}
 	else
 	{
-		// Starts or queue this load in the selected parser tread.
-		NSString *name = [NSString stringWithFormat:@"%@-%i", kNGLThreadParser, (unsigned int)_slot];
-		nglThreadPerformAsync(name, @selector(invoke), invocation);
+		// Copies right after the current loading.
+		nglJobPerform(@selector(invoke), invocation, [NSArray arrayWithObject:_loading]);
 	}
 }
 /*
@@ -1054,8 +1493,15 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	nglGestureRemoveAll(self);
 	
 	// Mesh data.
-	nglFree(_indices);
-	nglFree(_structures);
+	[self freeStructure];
+	nglFree(_levels);
+	nglFree(_clusters);
+	nglFree(_visibleClusters);
+	nglFree(_windows);
+	nglFree(_instances);
+	nglFree(_joints);
+	nglFree(_palette);
+	nglRelease(_jointNames);
 	nglRelease(_meshElements);
 	nglRelease(_material);
 	nglRelease(_surface);
@@ -1064,6 +1510,7 @@ static void emptyCoreMesh(id <NGLCoreMesh> coreMesh)
 	// Parser settings.
 	nglRelease(_fileNamed);
 	nglRelease(_fileSettings);
+	nglRelease(_loading);
 	
 	// Gestures
 	nglRelease(_gestures);
@@ -48,6 +48,12 @@
  *	
  *	@var			NGLComponentBitangent
  *					Represents the vertex bitangent.
+ *	
+ *	@var			NGLComponentBoneIndices
+ *					Represents the indices of the joints which move the vertex, up to four.
+ *	
+ *	@var			NGLComponentBoneWeights
+ *					Represents the weights of the joints which move the vertex, up to four.
  */
 typedef enum
 {
@@ -56,8 +62,44 @@ typedef enum
 	NGLComponentNormal,
 	NGLComponentTangent,
 	NGLComponentBitangent,
+	NGLComponentBoneIndices,
+	NGLComponentBoneWeights,
 } NGLComponent;
 
+/*!
+ *					Defines the format of an element in the GPU.
+ *
+ *					The array of structures always holds floats, the compact formats are only used by the
+ *					buffers in the GPU, saving memory and bandwidth of the vertex fetch. The normalized
+ *					integers are converted to the range from -1.0 to 1.0 (0.0 to 1.0 when unsigned) in
+ *					the shaders.
+ *
+ *	@see			nglElementFormatSize
+ *	
+ *	@var			NGLElementFormatFloat
+ *					Represents 32 bits floats.
+ *	
+ *	@var			NGLElementFormatHalf
+ *					Represents 16 bits floats.
+ *	
+ *	@var			NGLElementFormatShort
+ *					Represents normalized 16 bits signed integers.
+ *	
+ *	@var			NGLElementFormatUShort
+ *					Represents normalized 16 bits unsigned integers.
+ *	
+ *	@var			NGLElementFormatByte
+ *					Represents normalized 8 bits signed integers.
+ */
+typedef enum
+{
+	NGLElementFormatFloat,
+	NGLElementFormatHalf,
+	NGLElementFormatShort,
+	NGLElementFormatUShort,
+	NGLElementFormatByte,
+} NGLElementFormat;
+
 /*!
  *					<strong>(Internal only)</strong> An object that holds the element scalar values.
  *
@@ -80,6 +122,16 @@ typedef enum
  *	@var			NGLElement::offsetInFace
  *					<strong>(Internal only)</strong> Represents the position of the element
  *					in the array of faces.
+ *	
+ *	@var			NGLElement::format
+ *					Represents the format of the element in the GPU.
+ *	
+ *	@var			NGLElement::size
+ *					Represents the number of components in the GPU. It can be less than the length, like
+ *					the positions without the w. The elements with size 0 are not packed.
+ *	
+ *	@var			NGLElement::offset
+ *					Represents the offset of the element in the packed vertex, in bytes.
  */
 typedef struct
 {
@@ -87,8 +139,21 @@ typedef struct
 	unsigned char			start;
 	unsigned char			length;
 	unsigned char			offsetInFace;
+	NGLElementFormat		format;
+	unsigned char			size;
+	unsigned char			offset;
 } NGLElement;
 
+/*!
+ *					Returns the size of one component in a format.
+ *
+ *	@param			format
+ *					The NGLElementFormat.
+ *
+ *	@result			The size in bytes.
+ */
+NGL_API UInt32 nglElementFormatSize(NGLElementFormat format);
+
 /*!
  *					A library that holds the elements for a mesh.
  *
@@ -161,6 +226,15 @@ typedef struct
  */
 - (NGLElement *) elementWithComponent:(NGLComponent)component;
 
+/*!
+ *					Returns the size of a packed vertex, with the formats, sizes and offsets of the
+ *					elements. It's always a multiple of 4 bytes.
+ *
+ *	@result			The size in bytes. It returns 0 if any element is not packed, then the GPU uses the
+ *					array of structures as it is.
+ */
+- (UInt32) packedStride;
+
 /*!
  *					Removes a structure instance based on a component.
  *
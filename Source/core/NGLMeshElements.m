@@ -68,6 +68,12 @@ static NSString *stringFromElement(NGLComponent component)
 		case NGLComponentBitangent:
 			string = @"Bitangent";
 			break;
+		case NGLComponentBoneIndices:
+			string = @"BoneIndices";
+			break;
+		case NGLComponentBoneWeights:
+			string = @"BoneWeights";
+			break;
 	}
 	
 	return string;
@@ -82,6 +88,28 @@ static NSString *stringFromElement(NGLComponent component)
 //
 //**********************************************************************************************************
 
+UInt32 nglElementFormatSize(NGLElementFormat format)
+{
+	UInt32 size;
+	
+	switch (format)
+	{
+		case NGLElementFormatHalf:
+		case NGLElementFormatShort:
+		case NGLElementFormatUShort:
+			size = 2;
+			break;
+		case NGLElementFormatByte:
+			size = 1;
+			break;
+		default:
+			size = NGL_SIZE_FLOAT;
+			break;
+	}
+	
+	return size;
+}
+
 @implementation NGLMeshElements
 
 #pragma mark -
@@ -131,6 +159,9 @@ static NSString *stringFromElement(NGLComponent component)
 		(*oldElement).start = element.start;
 		(*oldElement).length = element.length;
 		(*oldElement).offsetInFace = element.offsetInFace;
+		(*oldElement).format = element.format;
+		(*oldElement).size = element.size;
+		(*oldElement).offset = element.offset;
 	}
 	else
 	{
@@ -172,6 +203,25 @@ static NSString *stringFromElement(NGLComponent component)
 	return NULL;
 }
 
+- (UInt32) packedStride
+{
+	UInt32 stride = 0;
+	int i;
+	
+	for (i = 0; i < _pCount; ++i)
+	{
+		if (_elements[i].size == 0)
+		{
+			return 0;
+		}
+		
+		stride = MAX(stride, _elements[i].offset + _elements[i].size * nglElementFormatSize(_elements[i].format));
+	}
+	
+	// Each vertex starts aligned to 4 bytes.
+	return (stride + 3) & ~3;
+}
+
 - (void) removeElementWithComponent:(NGLComponent)component
 {
 	NGLElement *elements = _elements;
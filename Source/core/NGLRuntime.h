@@ -21,7 +21,16 @@
  */
 
 #import <Foundation/Foundation.h>
-#import <UIKit/UIKit.h>
+
+// NinevehGL headless builds, like the command line tools, have no UIKit neither OpenGL ES.
+// Only the math, the parsers and the NGL Binary files are available to them.
+#if !TARGET_OS_IPHONE && !defined(NGL_HEADLESS)
+	#define NGL_HEADLESS
+#endif
+
+#ifndef NGL_HEADLESS
+	#import <UIKit/UIKit.h>
+#endif
 
 #pragma mark -
 #pragma mark Basic Definitions
@@ -44,9 +53,6 @@
 // NinevehGL supports Multithreading.
 #define NGL_MULTITHREADING
 
-// NinevehGL max parsing threads.
-#define NGL_PARSE_THREADS	5
-
 #pragma mark -
 #pragma mark iOS Definitions
 //**************************************************
@@ -54,7 +60,7 @@
 //**************************************************
 
 // Checks for iOS 4 or above.
-#if __IPHONE_OS_VERSION_MIN_REQUIRED < __IPHONE_4_0
+#if !defined(NGL_HEADLESS) && __IPHONE_OS_VERSION_MIN_REQUIRED < __IPHONE_4_0
 	
 	// Prevents compiling for iOS 3.x or earlier.
 	#error NinevehGL only works with iOS 4.0 and later.
@@ -180,6 +186,16 @@
 #define NGL_CYCLE_NSEC		NGL_CYCLE * NGL_NSEC
 #define NGL_TIME_RESIZE		0.3f
 
+// Sizes.
+#define NGL_CACHE_BUDGET	(64ull * 1024ull * 1024ull)
+#define NGL_VERTEX_CACHE	16
+#define NGL_LOD_LEVELS		4
+#define NGL_LOD_THRESHOLD	1.0f
+#define NGL_INSTANCE_LENGTH	20
+#define NGL_INSTANCE_BATCH	12
+#define NGL_BUFFERS_RING	3
+#define NGL_MAX_JOINTS		24
+
 // Invalid datas.
 #define NGL_BLANK_CHAR		' '
 #define NGL_NOT_FOUND		NGL_MAX_32
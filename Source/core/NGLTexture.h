@@ -24,6 +24,11 @@
 #import "NGLGlobal.h"
 #import "NGLCopying.h"
 
+// The headless builds keep the image only as a reference.
+#ifdef NGL_HEADLESS
+@class UIImage;
+#endif
+
 @class NSString;
 
 /*!
@@ -212,7 +212,11 @@
 	}
 	else
 	{
+#ifndef NGL_HEADLESS
 		copy.image = (_image != nil) ? [UIImage imageWithCGImage:[_image CGImage]] : nil;
+#else
+		copy.image = _image;
+#endif
 	}
 }
 
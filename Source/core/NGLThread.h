@@ -24,7 +24,7 @@
 #import "NGLGlobal.h"
 #import "NGLArray.h"
 
-@class NGLThread;
+@class NGLThread, NGLThreadTask;
 
 /*!
  *					This key represents the "helper" thread. Often, it's used as a helper that performs
@@ -35,8 +35,9 @@
 NGL_API NSString *const kNGLThreadHelper;
 
 /*!
- *					This key represents the "parser" thread. NinevehGL can spawn few "parser" threads,
- *					up to a limit defined by the global property.
+ *					This key represents the "parser" thread. The meshes are not loaded on named threads
+ *					anymore, they use the job system (see #nglJobPerform#). The global property still
+ *					enables the parser multithreading.
  */
 NGL_API NSString *const kNGLThreadParser;
 
@@ -72,8 +73,10 @@ NGL_API NGLThread *nglThreadGet(NSString *name);
  *
  *	@param			target
  *					The target object that will receive the method.
+ *
+ *	@result			The handle of the task, which can be waited, polled or chained.
  */
-NGL_API void nglThreadPerformAsync(NSString *name, SEL selector, id target);
+NGL_API NGLThreadTask *nglThreadPerformAsync(NSString *name, SEL selector, id target);
 
 /*!
  *					Executes a task synchronously on a NGLThread.
@@ -146,6 +149,76 @@ NGL_API void nglThreadExit(NSString *name);
  */
 NGL_API void nglThreadExitAll(void);
 
+/*!
+ *					The handle of a task queued into a NGLThread.
+ *
+ *					The thread that queued the task can wait for it, poll it or chain other tasks to it.
+ *					A task is done when it has been performed or canceled. The canceled tasks don't perform
+ *					their chained tasks, which are canceled as well, so nothing waits forever.
+ *
+ *	@see			NGLThread
+ */
+@interface NGLThreadTask : NSObject
+{
+@private
+	id						_target;
+	SEL						_selector;
+	NSString				*_threadName;
+	BOOL					_done, _cancelled;
+	NGLArray				*_chain;
+	
+	pthread_mutex_t			_mutex;
+	pthread_cond_t			_condition;
+}
+
+/*!
+ *					The target object that will receive the method.
+ */
+@property (nonatomic, readonly) id target;
+
+/*!
+ *					The method performed by this task.
+ */
+@property (nonatomic, readonly) SEL selector;
+
+/*!
+ *					Indicates if this task has been performed or canceled.
+ */
+@property (nonatomic, readonly, getter = isDone) BOOL done;
+
+/*!
+ *					Indicates if this task has been canceled before being performed.
+ */
+@property (nonatomic, readonly, getter = isCancelled) BOOL cancelled;
+
+/*!
+ *					Blocks the current thread until this task is done.
+ *
+ *					Waiting for a task of the current thread never returns, the current thread must be
+ *					free to perform its own tasks.
+ */
+- (void) waitUntilDone;
+
+/*!
+ *					Queues another task into a thread as soon as this one is performed.
+ *
+ *					If this task is already performed, the new task is queued immediately.
+ *
+ *	@param			selector
+ *					A SEL object.
+ *
+ *	@param			target
+ *					The target object that will receive the method.
+ *
+ *	@param			name
+ *					A NSString containing the name of the thread.
+ *
+ *	@result			The handle of the chained task.
+ */
+- (NGLThreadTask *) chainAsync:(SEL)selector target:(id)target thread:(NSString *)name;
+
+@end
+
 /*!
  *					The NinevehGL thread class.
  *
@@ -161,10 +234,11 @@ NGL_API void nglThreadExitAll(void);
  *					into its queue, those new tasks will be processed as well and then it will exit.
  *
  *					The thread routine of NGLThread includes a Run Loop and an Autorelease pool, which
- *					means that obj-c messages can be queued. The Run Loop has the same interval as the
- *					maximum NinevehGL FPS. However, changing the current FPS has no effects over the
- *					Run Loops. This class always exits the thread using the best approach, letting it
- *					finish itself.
+ *					means that obj-c messages can be queued. The Run Loop sleeps until a new task arrives
+ *					or one of its timers fires, the tasks wake it up through a source of the Run Loop. A
+ *					paused thread sleeps until it's resumed. The Autorelease pool is drained every time
+ *					the Run Loop goes to sleep. This class always exits the thread using the best approach,
+ *					letting it finish itself.
  *
  *					The NinevehGL thread pipeline works as following:
  *
@@ -202,9 +276,17 @@ NGL_API void nglThreadExitAll(void);
 	NSThread				*_thread;
 	BOOL					_alive, _paused, _autoExit;
 	
-	BOOL					_changed;
 	//NSMutableArray			*_queue;
 	NGLArray				*_queue;
+	NGLArray				*_batch;
+	
+	// Sleeping
+	pthread_mutex_t			_mutex;
+	pthread_cond_t			_condition;
+	CFRunLoopRef			_runLoop;
+	CFRunLoopSourceRef		_source;
+	CFRunLoopObserverRef	_observer;
+	NSAutoreleasePool		*_pool;
 }
 
 /*!
@@ -218,13 +300,14 @@ NGL_API void nglThreadExitAll(void);
 @property (nonatomic, readonly) NSThread *thread;
 
 /*!
- *					Indicates if this thread is running. It'll return NO if the thread is not started yet
- *					or if it is finishing.
+ *					Indicates if this thread is running. It'll return NO if the thread is finishing or if
+ *					it has no thread, like when the multithreading is off.
  */
 @property (nonatomic, readonly, getter = isAlive) BOOL alive;
 
 /*!
- *					Pauses or resumes this thread.
+ *					Pauses or resumes this thread. A paused thread sleeps, keeping its queue and its timers
+ *					for when it's resumed.
  */
 @property (nonatomic, getter = isPaused) BOOL paused;
 
@@ -263,12 +346,16 @@ NGL_API void nglThreadExitAll(void);
  *
  *	@param			target
  *					The target object that will receive the method.
+ *
+ *	@result			The handle of the task, which can be waited, polled or chained.
  */
-- (void) performAsync:(SEL)selector target:(id)target;
+- (NGLThreadTask *) performAsync:(SEL)selector target:(id)target;
 
 /*!
  *					Inserts a new item in the queue of this thread and wait until it is performed.
  *
+ *					The calling thread sleeps on the task's handle until this thread has performed it.
+ *
  *					The items in the queue are retained to avoid bad accesses.
  *
  *	@param			selector
@@ -280,7 +367,7 @@ NGL_API void nglThreadExitAll(void);
 - (void) performSync:(SEL)selector target:(id)target;
 
 /*!
- *					Cancels all the pending requests to this thread.
+ *					Cancels all the pending requests to this thread. Their handles are done and canceled.
  */
 - (void) cancelAllPendingRequests;
 
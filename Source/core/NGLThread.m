@@ -39,6 +39,9 @@ NSString *const kNGLThreadHelper = @"NinevehGLHelper";
 NSString *const kNGLThreadParser = @"NinevehGLParser";
 NSString *const kNGLThreadRender = @"NinevehGLRender";
 
+// The longest sleep of a run loop, in seconds. The threads are woken up by their tasks way before that.
+#define NGL_THREAD_SLEEP		1.0e10
+
 #pragma mark -
 #pragma mark Private Interface
 #pragma mark -
@@ -48,66 +51,16 @@ NSString *const kNGLThreadRender = @"NinevehGLRender";
 //
 //**********************************************************************************************************
 
-#pragma mark -
-#pragma mark Private Definitions
-//**************************************************
-//	Private Definitions
-//**************************************************
-
-//*************************
-//	Thread Task
-//*************************
-
-/*!
- *					<strong>(Internal only)</strong> Helps to hold and manage tasks into a thread.
- */
-@interface NGLThreadTask : NSObject
-
-@property (nonatomic, retain) id target;
-@property (nonatomic, assign) SEL selector;
-
-- (id) initWithTarget:(id)target selector:(SEL)selector;
-
-- (void) execute;
-
-@end
-
-@implementation NGLThreadTask
-
-@synthesize target = _target, selector = _selector;
-
-- (id) initWithTarget:(id)target selector:(SEL)selector
-{
-	if ((self = [super init]))
-	{
-		self.target = target;
-		self.selector = selector;
-	}
-	
-	return self;
-}
-
-- (void) execute
-{
-	nglMsg(_target, _selector);
-}
-
-- (void) dealloc
-{
-	nglRelease(_target);
-	_selector = nil;
-	
-	[super dealloc];
-}
-
-@end
-
 #pragma mark -
 #pragma mark Private Functions
 //**************************************************
 //	Private Functions
 //**************************************************
 
+// The registry of the threads, by name. Every access to it must be done with this mutex locked.
+// It's locked after the mutex of a thread, never before, so it's held just to read or change the registry.
+static pthread_mutex_t _threadsMutex = PTHREAD_MUTEX_INITIALIZER;
+
 static NSMutableDictionary *threads()
 {
 	// Persistent instance.
@@ -123,6 +76,30 @@ static NSMutableDictionary *threads()
 	return _default;
 }
 
+// Finds a thread in the registry. It's retained by the caller's pool, so it outlives a concurrent exit.
+static NGLThread *threadFind(NSString *name)
+{
+	NGLThread *thread;
+	
+	pthread_mutex_lock(&_threadsMutex);
+	thread = [[[threads() objectForKey:name] retain] autorelease];
+	pthread_mutex_unlock(&_threadsMutex);
+	
+	return thread;
+}
+
+// Counts the threads in the registry.
+static NSUInteger threadCount(void)
+{
+	NSUInteger count;
+	
+	pthread_mutex_lock(&_threadsMutex);
+	count = [threads() count];
+	pthread_mutex_unlock(&_threadsMutex);
+	
+	return count;
+}
+
 static BOOL threadCheck(NSString *name)
 {
 	BOOL result;
@@ -154,14 +131,50 @@ static BOOL threadCheck(NSString *name)
 //	Private Category
 //**************************************************
 
+@interface NGLThreadTask()
+
+- (id) initWithTarget:(id)target selector:(SEL)selector thread:(NSString *)name;
+
+// Performs the message and finishes this task.
+- (void) execute;
+
+// Marks this task as done, wakes up the waiting threads and queues or cancels the chained tasks.
+- (void) finish:(BOOL)isCancelled;
+
+@end
+
 @interface NGLThread()
 
+// Adds a task to the queue or performs it right away when there is no thread.
+- (void) queueTask:(NGLThreadTask *)task;
+
 - (void) spawnThread;
 
 - (void) killThread;
 
+// Wakes the thread up to process its queue. Must be called inside the mutex.
+- (void) wakeThread;
+
+// Runs all the tasks in the queue. It's called by the run loop's source, inside the thread.
+- (void) processQueue;
+
+// Drains the autorelease pool. It's called by the run loop's observer, inside the thread.
+- (void) drainPool;
+
 @end
 
+// The run loop's source, signaled by the new tasks.
+static void threadSourcePerform(void *info)
+{
+	[(NGLThread *)info processQueue];
+}
+
+// The run loop's observer, called before the run loop goes to sleep.
+static void threadObserverCallBack(CFRunLoopObserverRef observer, CFRunLoopActivity activity, void *info)
+{
+	[(NGLThread *)info drainPool];
+}
+
 #pragma mark -
 #pragma mark Public Interface
 #pragma mark -
@@ -173,38 +186,36 @@ static BOOL threadCheck(NSString *name)
 
 NGLThread *nglThreadGet(NSString *name)
 {
-    __block NGLThread *thread = nil;
-    
-    static dispatch_once_t onceToken;
-    static pthread_mutex_t mutex;
-    dispatch_once(&onceToken, ^{
-        pthread_mutex_init(&mutex, NULL);
-    });
-
-    // Serialize getting or making a thread.
-    pthread_mutex_lock(&mutex);
-    
-    thread = [threads() objectForKey:name];
-    
-    // Just start new threads. Old threads will be reused.
-    if (thread == nil)
-    {
-        // The thread is retained internally by the class and will be released only when it exit.
-        thread = [[[NGLThread alloc] initWithName:name] autorelease];
-    }
-    
-    pthread_mutex_unlock(&mutex);
-
-    
+	NGLThread *thread;
+	
+	// Serialize getting or making a thread, with the same lock of every other access to the registry.
+	pthread_mutex_lock(&_threadsMutex);
+	
+	thread = [threads() objectForKey:name];
+	
+	// Just start new threads. Old threads will be reused.
+	if (thread == nil)
+	{
+		// The thread is retained internally by the registry and will be released only when it exit.
+		thread = [[NGLThread alloc] initWithName:name];
+		[threads() setObject:thread forKey:name];
+		[thread release];
+	}
+	
+	// An auto exit thread can leave the registry right after, the caller still holds it.
+	thread = [[thread retain] autorelease];
+	
+	pthread_mutex_unlock(&_threadsMutex);
+	
 	return thread;
 }
 
-void nglThreadPerformAsync(NSString *name, SEL selector, id target)
+NGLThreadTask *nglThreadPerformAsync(NSString *name, SEL selector, id target)
 {
 	// Creates the thread once, if necessary.
 	NGLThread *thread = nglThreadGet(name);
 	
-	[thread performAsync:selector target:target];
+	return [thread performAsync:selector target:target];
 }
 
 void nglThreadPerformSync(NSString *name, SEL selector, id target)
@@ -219,34 +230,38 @@ void nglThreadPerformSync(NSString *name, SEL selector, id target)
 
 void nglThreadSetPaused(NSString *name, BOOL paused)
 {
-	[[threads() objectForKey:name] setPaused:paused];
+	[threadFind(name) setPaused:paused];
 }
 
 BOOL nglThreadIsPaused(NSString *name)
 {
-	return [[threads() objectForKey:name] isPaused];
+	return [threadFind(name) isPaused];
 }
 
 void nglThreadSetAutoExit(NSString *name, BOOL autoExit)
 {
-	[[threads() objectForKey:name] setAutoExit:autoExit];
+	[threadFind(name) setAutoExit:autoExit];
 }
 
 BOOL nglThreadIsAutoExit(NSString *name)
 {
-	return [[threads() objectForKey:name] isAutoExit];
+	return [threadFind(name) isAutoExit];
 }
 
 void nglThreadExit(NSString *name)
 {
-	[[threads() objectForKey:name] killThread];
+	[threadFind(name) killThread];
 }
 
 void nglThreadExitAll(void)
 {
-	NSDictionary *running = [threads() copy];
+	NSDictionary *running;
 	NSString *name;
 	
+	pthread_mutex_lock(&_threadsMutex);
+	running = [threads() copy];
+	pthread_mutex_unlock(&_threadsMutex);
+	
 	// Kills all threads.
 	for (name in running)
 	{
@@ -258,13 +273,189 @@ void nglThreadExitAll(void)
 	if ([NSThread isMainThread])
 	{
 		// Stuck while the threads are exiting.
-		while ([threads() count] > 0)
+		while (threadCount() > 0)
 		{
 			usleep(NGL_CYCLE_USEC);
 		}
 	}
 }
 
+@implementation NGLThreadTask
+
+#pragma mark -
+#pragma mark Properties
+//**************************************************
+//	Properties
+//**************************************************
+
+@synthesize target = _target, selector = _selector;
+
+@dynamic done, cancelled;
+
+- (BOOL) isDone
+{
+	BOOL done;
+	
+	pthread_mutex_lock(&_mutex);
+	done = _done;
+	pthread_mutex_unlock(&_mutex);
+	
+	return done;
+}
+
+- (BOOL) isCancelled
+{
+	BOOL cancelled;
+	
+	pthread_mutex_lock(&_mutex);
+	cancelled = _cancelled;
+	pthread_mutex_unlock(&_mutex);
+	
+	return cancelled;
+}
+
+#pragma mark -
+#pragma mark Constructors
+//**************************************************
+//	Constructors
+//**************************************************
+
+- (id) initWithTarget:(id)target selector:(SEL)selector thread:(NSString *)name
+{
+	if ((self = [super init]))
+	{
+		_target = [target retain];
+		_selector = selector;
+		_threadName = [name copy];
+		
+		pthread_mutex_init(&_mutex, NULL);
+		pthread_cond_init(&_condition, NULL);
+	}
+	
+	return self;
+}
+
+#pragma mark -
+#pragma mark Private Methods
+//**************************************************
+//	Private Methods
+//**************************************************
+
+- (void) execute
+{
+	nglMsg(_target, _selector);
+	[self finish:NO];
+}
+
+- (void) finish:(BOOL)isCancelled
+{
+	NGLArray *chain;
+	NGLThreadTask *task;
+	
+	pthread_mutex_lock(&_mutex);
+	
+	if (_done)
+	{
+		pthread_mutex_unlock(&_mutex);
+		return;
+	}
+	
+	_done = YES;
+	_cancelled = isCancelled;
+	chain = _chain;
+	_chain = nil;
+	pthread_cond_broadcast(&_condition);
+	pthread_mutex_unlock(&_mutex);
+	
+	// The chained tasks follow this one, they are queued after it's performed or canceled with it.
+	nglFor (task, chain)
+	{
+		if (isCancelled)
+		{
+			[task finish:YES];
+		}
+		else
+		{
+			[nglThreadGet(task->_threadName) queueTask:task];
+		}
+	}
+	
+	nglRelease(chain);
+}
+
+#pragma mark -
+#pragma mark Self Public Methods
+//**************************************************
+//	Self Public Methods
+//**************************************************
+
+- (void) waitUntilDone
+{
+	pthread_mutex_lock(&_mutex);
+	
+	while (!_done)
+	{
+		pthread_cond_wait(&_condition, &_mutex);
+	}
+	
+	pthread_mutex_unlock(&_mutex);
+}
+
+- (NGLThreadTask *) chainAsync:(SEL)selector target:(id)target thread:(NSString *)name
+{
+	NGLThreadTask *task = [[NGLThreadTask alloc] initWithTarget:target selector:selector thread:name];
+	BOOL done, cancelled;
+	
+	pthread_mutex_lock(&_mutex);
+	done = _done;
+	cancelled = _cancelled;
+	
+	if (!done)
+	{
+		if (_chain == nil)
+		{
+			_chain = [[NGLArray alloc] initWithRetainOption];
+		}
+		
+		[_chain addPointer:task];
+	}
+	
+	pthread_mutex_unlock(&_mutex);
+	
+	// This task is already done, so the chained one doesn't wait.
+	if (done && cancelled)
+	{
+		[task finish:YES];
+	}
+	else if (done)
+	{
+		[nglThreadGet(name) queueTask:task];
+	}
+	
+	return [task autorelease];
+}
+
+#pragma mark -
+#pragma mark Override Public Methods
+//**************************************************
+//	Override Public Methods
+//**************************************************
+
+- (void) dealloc
+{
+	nglRelease(_target);
+	nglRelease(_threadName);
+	nglRelease(_chain);
+	_selector = nil;
+	
+	pthread_cond_destroy(&_condition);
+	pthread_mutex_destroy(&_mutex);
+	
+	[super dealloc];
+}
+
+@end
+
 @implementation NGLThread
 
 #pragma mark -
@@ -287,19 +478,29 @@ void nglThreadExitAll(void)
 	{
 		// Settings.
 		_name = [name copy];
-		_changed = NO;
 		_paused = NO;
 		
+		// The recursive mutex allows the tasks to release their targets while the queue is changed.
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(&_mutex, &attr);
+		pthread_mutexattr_destroy(&attr);
+		pthread_cond_init(&_condition, NULL);
+		
 		// Only the render thread is a long-lived one.
 		_autoExit = (!([name isEqualToString:kNGLThreadRender]||[name isEqualToString:kNGLThreadHelper]));
 		
-		// The threads are internally retained to make future changes on it.
-		[threads() setObject:self forKey:_name];
-		
 #ifdef NGL_MULTITHREADING
 		if (threadCheck(_name))
 		{
+			CFRunLoopSourceContext context = { 0, self, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+												threadSourcePerform };
+			
 			_queue = [[NGLArray alloc] initWithRetainOption];
+			_batch = [[NGLArray alloc] initWithRetainOption];
+			_source = CFRunLoopSourceCreate(kCFAllocatorDefault, 0, &context);
+			_alive = YES;
 			_thread = [[NSThread alloc] initWithTarget:self selector:@selector(spawnThread) object:nil];
 			_thread.name = _name;
 			[_thread start];
@@ -318,78 +519,172 @@ void nglThreadExitAll(void)
 
 - (void) spawnThread
 {
+	CFRunLoopObserverContext context = { 0, self, NULL, NULL, NULL };
+	
 	// Thread settings.
-	_alive = YES;
+	_pool = [[NSAutoreleasePool alloc] init];
+	_observer = CFRunLoopObserverCreate(kCFAllocatorDefault, kCFRunLoopBeforeWaiting, YES, 0,
+										&threadObserverCallBack, &context);
 	
-	// Task settings.
-	NGLThreadTask *task;
-	BOOL oneTaskDone = NO;
+	// The tasks queued before the thread has started are processed by the first pass of the run loop.
+	pthread_mutex_lock(&_mutex);
+	_runLoop = CFRunLoopGetCurrent();
+	CFRunLoopAddSource(_runLoop, _source, kCFRunLoopDefaultMode);
+	CFRunLoopAddObserver(_runLoop, _observer, kCFRunLoopDefaultMode);
+	
+	if ([_queue count] > 0)
+	{
+		CFRunLoopSourceSignal(_source);
+	}
+	
+	pthread_mutex_unlock(&_mutex);
 	
 	// Thread routine
 	while (_alive)
 	{
-		// Ignores thread processing when paused.
-		if (_paused)
-		{
-			continue;
-		}
+		// The paused thread sleeps until it's resumed or killed.
+		pthread_mutex_lock(&_mutex);
 		
-		// Autorelease pool.
-		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
-		
-		// The thread's run loop. When there is no timer or sources in the run loop it will not wait the
-		// NGL cycle (in seconds), so this thread must sleep for a NGL cycle.
-		if (CFRunLoopRunInMode(kCFRunLoopDefaultMode, NGL_CYCLE, NO) == kCFRunLoopRunFinished)
+		while (_paused && _alive)
 		{
-			usleep(NGL_CYCLE_USEC);
+			pthread_cond_wait(&_condition, &_mutex);
 		}
 		
-		// Processes the Objc-C messages and frees the previous allocated memory for the message.
-		// First-in First-out rule.
-        while (_queue.count) {
-            // Grab the task off the queue, minimizing thread contention.
-            task = [_queue pointerAtIndex:0];
-
-            // Executes the Obj-C message as fast as possible.
-            [task execute];
-            
-            // Then remove and release task.
-            [_queue removeFirst];
-
-            // Defines one task done.
-            oneTaskDone = YES;
-        }
+		pthread_mutex_unlock(&_mutex);
 		
-		// Draining the pool.
-		nglRelease(pool);
-		
-		// The autoExit and changed status will wait for at least one task be done.
-		if (oneTaskDone)
-		{
-			// Autoexit thread after processing the queue.
-			if (_autoExit && [_queue count] == 0)
-			{
-				[self killThread];
-			}
-			
-			// Unflaging the changes.
-			_changed = NO;
-		}
+		// The thread's run loop. It sleeps until its source is signaled by a new task, firing the timers
+		// meanwhile, and returns after the source has processed the queue.
+		CFRunLoopRunInMode(kCFRunLoopDefaultMode, NGL_THREAD_SLEEP, YES);
 	}
 	
+	// The run loop can't wake up this thread anymore.
+	pthread_mutex_lock(&_mutex);
+	CFRunLoopRemoveSource(_runLoop, _source, kCFRunLoopDefaultMode);
+	CFRunLoopRemoveObserver(_runLoop, _observer, kCFRunLoopDefaultMode);
+	_runLoop = NULL;
+	pthread_mutex_unlock(&_mutex);
+	
 	// Freeing the non-used memory and exiting thread.
 	[self cancelAllPendingRequests];
+	CFRelease(_observer);
+	_observer = NULL;
+	nglRelease(_pool);
 	
 	// Sends a message to delete the current EAGLContext, because the context is thread dependent.
 	nglContextDeleteCurrent();
 }
 
+- (void) queueTask:(NGLThreadTask *)task
+{
+#ifdef NGL_MULTITHREADING
+	if (threadCheck(_name))
+	{
+		pthread_mutex_lock(&_mutex);
+		
+		// New messages goes to the end of the queue and wake the thread up.
+		if (_alive)
+		{
+			[_queue addPointer:task];
+			[self wakeThread];
+			pthread_mutex_unlock(&_mutex);
+			return;
+		}
+		
+		pthread_mutex_unlock(&_mutex);
+		
+		// A finishing thread is not in the threads anymore, so the task goes to a new thread.
+		[nglThreadGet(_name) queueTask:task];
+		return;
+	}
+#endif
+	[task execute];
+}
+
 - (void) killThread
 {
 	// The thread will exit its entry point routine normally. This is the best approach.
-	// The running thread will complete its current queue.
+	// The sleeping thread is woken up to leave its routine. It leaves the threads at the same time it
+	// stops accepting tasks, so no task is left behind.
+	[self retain];
+	pthread_mutex_lock(&_mutex);
+	
+	pthread_mutex_lock(&_threadsMutex);
+	
+	if ([threads() objectForKey:_name] == self)
+	{
+		[threads() removeObjectForKey:_name];
+	}
+	
+	pthread_mutex_unlock(&_threadsMutex);
+	
 	_alive = NO;
-	[threads() removeObjectForKey:_name];
+	pthread_cond_signal(&_condition);
+	[self wakeThread];
+	pthread_mutex_unlock(&_mutex);
+	[self release];
+}
+
+- (void) wakeThread
+{
+	if (_source != NULL)
+	{
+		CFRunLoopSourceSignal(_source);
+		
+		if (_runLoop != NULL)
+		{
+			CFRunLoopWakeUp(_runLoop);
+		}
+	}
+}
+
+- (void) processQueue
+{
+	NGLThreadTask *task;
+	
+	// The paused or dead thread keeps its tasks, the source is signaled again when it's resumed.
+	// The autoExit will wait for at least one task be done.
+	pthread_mutex_lock(&_mutex);
+	
+	if (_paused || !_alive || [_queue count] == 0)
+	{
+		pthread_mutex_unlock(&_mutex);
+		return;
+	}
+	
+	// Takes all the pending tasks at once, so the new tasks can be queued while these ones are running.
+	[_batch addPointersFromNGLArray:_queue];
+	[_queue removeAll];
+	pthread_mutex_unlock(&_mutex);
+	
+	// Executes the Obj-C messages following the First-in First-out rule.
+	nglFor (task, _batch)
+	{
+		[task execute];
+	}
+	
+	[_batch removeAll];
+	
+	// The tasks queued meanwhile are processed by the next pass of the run loop.
+	pthread_mutex_lock(&_mutex);
+	
+	if ([_queue count] > 0)
+	{
+		CFRunLoopSourceSignal(_source);
+	}
+	
+	// Autoexit thread after processing the queue, before any other task can be queued.
+	else if (_autoExit)
+	{
+		[self killThread];
+	}
+	
+	pthread_mutex_unlock(&_mutex);
+}
+
+- (void) drainPool
+{
+	nglRelease(_pool);
+	_pool = [[NSAutoreleasePool alloc] init];
 }
 
 #pragma mark -
@@ -398,25 +693,14 @@ void nglThreadExitAll(void)
 //	Self Public Methods
 //**************************************************
 
-- (void) performAsync:(SEL)selector target:(id)target
+- (NGLThreadTask *) performAsync:(SEL)selector target:(id)target
 {
-#ifdef NGL_MULTITHREADING
-	if (threadCheck(_name))
-	{
-		// New messages goes to the end of the queue.
-		// The memory allocated here will be free inside the thread.
-		NGLThreadTask *task = [[NGLThreadTask alloc] initWithTarget:target selector:selector];
-		
-		// Adds the new task and change the task queue status.
-		[_queue addPointer:task];
-		_changed = YES;
-		
-		nglRelease(task);
-		
-		return;
-	}
-#endif
-	nglMsg(target, selector);
+	// The handle is shared by the queue and the caller.
+	NGLThreadTask *task = [[NGLThreadTask alloc] initWithTarget:target selector:selector thread:_name];
+	
+	[self queueTask:task];
+	
+	return [task autorelease];
 }
 
 - (void) performSync:(SEL)selector target:(id)target
@@ -424,13 +708,7 @@ void nglThreadExitAll(void)
 	// If the target thread is not the current thread, waits until the task is finished.
 	if (_thread != [NSThread currentThread])
 	{
-		[self performAsync:selector target:target];
-		
-		// Waiting for the task be performed.
-		while (_changed)
-		{
-			usleep(NGL_CYCLE_USEC);
-		}
+		[[self performAsync:selector target:target] waitUntilDone];
 	}
 	// If the target thread is the current thread, just performs the task.
 	else
@@ -439,26 +717,51 @@ void nglThreadExitAll(void)
 	}
 }
 
+- (void) setPaused:(BOOL)value
+{
+	// The paused thread leaves its run loop to sleep, the resumed one goes back to its queue.
+	pthread_mutex_lock(&_mutex);
+	_paused = value;
+	pthread_cond_signal(&_condition);
+	[self wakeThread];
+	pthread_mutex_unlock(&_mutex);
+}
+
 - (void) cancelAllPendingRequests
-{	
+{
+	NGLThreadTask *task;
+	
+	pthread_mutex_lock(&_mutex);
+	
+	nglFor (task, _queue)
+	{
+		[task finish:YES];
+	}
+	
 	[_queue removeAll];
+	pthread_mutex_unlock(&_mutex);
 }
 
 - (void) cancelAllPendingRequestsForTarget:(id)target
 {
-	unsigned int i = 0;
+	unsigned int i;
 	NGLThreadTask *task;
 	
-	// Searches for all occurrences of the target.
-	nglFor(task, _queue)
+	// Searches for all occurrences of the target, from the end, so the removals don't skip any task.
+	pthread_mutex_lock(&_mutex);
+	
+	for (i = [_queue count]; i > 0; --i)
 	{
+		task = [_queue pointerAtIndex:i - 1];
+		
 		if (task.target == target)
 		{
-			[_queue removePointerAtIndex:i];
+			[task finish:YES];
+			[_queue removePointerAtIndex:i - 1];
 		}
-		
-		++i;
 	}
+	
+	pthread_mutex_unlock(&_mutex);
 }
 
 - (void) exit
@@ -476,8 +779,17 @@ void nglThreadExitAll(void)
 {
 	nglRelease(_name);
 	nglRelease(_queue);
+	nglRelease(_batch);
 	nglRelease(_thread);
 	
+	if (_source != NULL)
+	{
+		CFRelease(_source);
+	}
+	
+	pthread_cond_destroy(&_condition);
+	pthread_mutex_destroy(&_mutex);
+	
 	[super dealloc];
 }
 
@@ -179,24 +179,16 @@ double nglBackgroundTime(void)
 
 - (void) timerCycle:(NSTimer *)timer
 {
-	/*
-	//[_collection makeAllPointersPerformSelector:_selCallBack];
-	/*/
-    [_collection lock];
-    NSArray *ptrCopy = [_collection allPointers];
-    [_collection unlock];
-
-    for( id item in ptrCopy ) {
-        nglMsg(item, _selCallBack);
-    }
-
-// AH: Avoid array locking durring execution, so timer can be modified while dispatching.
-//	id item;
-//	nglFor (item, _collection)
-//	{
-//		nglMsg(item, _selCallBack);
-//	}
-	//*/
+	id item;
+	
+	// Avoids array locking during execution, so the timer can be modified while dispatching.
+	// The snapshot is only copied again after a change, not on every cycle. The timer doesn't retain
+	// its items, so they are retained for the cycle, a callback can release another item safely.
+	nglForSnapshotRetaining (item, _collection)
+	{
+		nglMsg(item, _selCallBack);
+	}
+	
 	_backgroundTime = 0.0;
 }
 
@@ -24,6 +24,7 @@
 #import <OpenGLES/ES2/glext.h>
 
 #import "NGLRuntime.h"
+#import "NGLES2Functions.h"
 
 /*!
  *					Defines if a buffer will be VBO or IBO.
@@ -96,7 +97,7 @@ typedef enum
  *
  *					This method just creates one kind of buffer. You should call this twice to create
  *					a VBO and an IBO. If this method was called twice or more for the same type of buffer
- *					object, it will delete the oldest buffer of the same type.
+ *					object, it will replace the data of the oldest buffer of the same type.
  *
  *	@param			data
  *					A pointer to the data which will be stored in the buffer.
@@ -115,6 +116,28 @@ typedef enum
 			 type:(NGLES2BuffersType)type
 			usage:(NGLES2BuffersUsage)usage;
 
+/*!
+ *					Replaces a range of the data of a buffer object, which keeps its size.
+ *
+ *					The buffer object must be already loaded. This method leaves the buffer bound.
+ *
+ *	@param			data
+ *					A pointer to the new data of the range.
+ *
+ *	@param			offset
+ *					The start of the range in the buffer, in basic machine units (bytes).
+ *
+ *	@param			size
+ *					The range size in basic machine units (bytes).
+ *
+ *	@param			type
+ *					The type of data to be replaced, that means, a VBO or an IBO.
+ */
+- (void) updateData:(const void *)data
+			 offset:(int)offset
+			   size:(int)size
+			   type:(NGLES2BuffersType)type;
+
 /*!
  *					Binds the buffers, making it the current buffer of it's type.
  *
@@ -123,6 +146,14 @@ typedef enum
  */
 - (void) bind;
 
+/*!
+ *					Binds only one kind of buffer, leaving the current buffer of the other kind bound.
+ *
+ *	@param			type
+ *					The type of the buffer to bind, a VBO or an IBO.
+ */
+- (void) bindType:(NGLES2BuffersType)type;
+
 /*!
  *					Unbinds all buffer objects.
  *
@@ -97,20 +97,34 @@
 	// Chooses the type of the buffer.
 	GLuint *name = (type == NGLES2BuffersTypeIndex) ? &_ibo : &_vbo;
 	
-	// Creates a Buffer Object's.
-	glGenBuffers(1, name);
+	// Creates a Buffer Object's, the old one receives the new data.
+	if (*name == 0)
+	{
+		ngles2GenBuffer(name);
+	}
 	
 	// Makes this Buffer the current Buffer for its type.
 	// This step will really create the Buffer Object.
 	glBindBuffer(type, *name);
 	
 	// Sets the buffer's data
-	glBufferData(type, size, data, usage);
+	ngles2BufferData(type, *name, size, data, usage);
 	
 	// Unbids this buffer.
 	glBindBuffer(type, 0);
 }
 
+- (void) updateData:(const void *)data
+			 offset:(int)offset
+			   size:(int)size
+			   type:(NGLES2BuffersType)type
+{
+	GLuint name = (type == NGLES2BuffersTypeIndex) ? _ibo : _vbo;
+	
+	glBindBuffer(type, name);
+	ngles2BufferSubData(type, name, offset, size, data);
+}
+
 - (void) bind
 {
 	// Binds the buffers.
@@ -118,6 +132,11 @@
 	glBindBuffer(NGLES2BuffersTypeStructure, _vbo);
 }
 
+- (void) bindType:(NGLES2BuffersType)type
+{
+	glBindBuffer(type, (type == NGLES2BuffersTypeIndex) ? _ibo : _vbo);
+}
+
 - (void) unbind
 {
 	// Unbinds both buffers.
@@ -27,6 +27,70 @@
 #import "NGLContext.h"
 #import "NGLVector.h"
 
+/*!
+ *					<strong>(Internal only)</strong> The OpenGL functions seen by the recording layer.
+ *
+ *	@see			ngles2Record
+ *
+ *	@var			NGLES2CallGenBuffers
+ *					Represents glGenBuffers, once to each buffer object.
+ *
+ *	@var			NGLES2CallBufferData
+ *					Represents glBufferData.
+ *
+ *	@var			NGLES2CallBufferSubData
+ *					Represents glBufferSubData.
+ *
+ *	@var			NGLES2CallDrawElements
+ *					Represents glDrawElements.
+ *
+ *	@var			NGLES2CallDrawElementsInstanced
+ *					Represents glDrawElementsInstancedEXT.
+ *
+ *	@var			NGLES2CallCreateProgram
+ *					Represents glCreateProgram.
+ */
+typedef enum
+{
+	NGLES2CallGenBuffers,
+	NGLES2CallBufferData,
+	NGLES2CallBufferSubData,
+	NGLES2CallDrawElements,
+	NGLES2CallDrawElementsInstanced,
+	NGLES2CallCreateProgram,
+} NGLES2CallName;
+
+/*!
+ *					<strong>(Internal only)</strong> A call recorded by the recording layer.
+ *
+ *	@var			NGLES2Call::name
+ *					The OpenGL function.
+ *
+ *	@var			NGLES2Call::type
+ *					The target of the buffer functions or the data type of the indices of the draw functions.
+ *
+ *	@var			NGLES2Call::buffer
+ *					The buffer object of the buffer functions.
+ *
+ *	@var			NGLES2Call::offset
+ *					The offset in bytes of the data in the buffer or of the first index drawn.
+ *
+ *	@var			NGLES2Call::size
+ *					The size in bytes of the data or the number of indices drawn.
+ *
+ *	@var			NGLES2Call::instances
+ *					The number of instances drawn. It's 1 to the draw calls without instances.
+ */
+typedef struct
+{
+	NGLES2CallName		name;
+	GLenum				type;
+	GLuint				buffer;
+	UInt32				offset;
+	UInt32				size;
+	UInt32				instances;
+} NGLES2Call;
+
 /*!
  *					Defines the initial default state for NinevehGL/OpenGL.
  *
@@ -161,3 +225,131 @@ NGL_API void ngles2FrontCullFace(GLenum front, GLenum cull);
  *					If YES the alpha blend will be turned ON, otherwise it will be turned OFF.
  */
 NGL_API void ngles2BlendAlpha(BOOL activate);
+
+/*!
+ *					Checks if the OpenGL ES of this device supports an extension.
+ *
+ *					The extensions are read once, they are the same to all the contexts of a device.
+ *	
+ *	@param			name
+ *					The name of the extension, like GL_EXT_instanced_arrays.
+ *
+ *	@result			A BOOL indicating if the extension is supported.
+ */
+NGL_API BOOL ngles2HasExtension(NSString *name);
+
+/*!
+ *					Creates a buffer object name, like glGenBuffers does for a single buffer.
+ *
+ *					As all the functions that create, fill or draw from buffers, this one is seen by
+ *					the recording layer.
+ *	
+ *	@param			buffer
+ *					A pointer to receive the new name.
+ */
+NGL_API void ngles2GenBuffer(GLuint *buffer);
+
+/*!
+ *					Creates the data store of the buffer object bound to a target, with glBufferData.
+ *	
+ *	@param			target
+ *					The target of the buffer, GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+ *
+ *	@param			buffer
+ *					The buffer object bound to the target.
+ *
+ *	@param			size
+ *					The data size in bytes.
+ *
+ *	@param			data
+ *					A pointer to the data.
+ *
+ *	@param			usage
+ *					The intended usage of the buffer.
+ */
+NGL_API void ngles2BufferData(GLenum target, GLuint buffer, GLsizeiptr size, const GLvoid *data, GLenum usage);
+
+/*!
+ *					Replaces a range of the data of the buffer object bound to a target, with glBufferSubData.
+ *	
+ *	@param			target
+ *					The target of the buffer, GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+ *
+ *	@param			buffer
+ *					The buffer object bound to the target.
+ *
+ *	@param			offset
+ *					The start of the range in bytes.
+ *
+ *	@param			size
+ *					The range size in bytes.
+ *
+ *	@param			data
+ *					A pointer to the new data of the range.
+ */
+NGL_API void ngles2BufferSubData(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid *data);
+
+/*!
+ *					Draws triangles from the bound IBO, with glDrawElements or, to the instances, with
+ *					glDrawElementsInstancedEXT.
+ *	
+ *	@param			count
+ *					The number of indices.
+ *
+ *	@param			type
+ *					The data type of the indices, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+ *
+ *	@param			indices
+ *					The offset in bytes of the first index in the IBO.
+ *
+ *	@param			instances
+ *					The number of instances. Only the value 0 draws without the instanced arrays.
+ */
+NGL_API void ngles2DrawElements(GLsizei count, GLenum type, const GLvoid *indices, GLsizei instances);
+
+/*!
+ *					Creates a program object, with glCreateProgram.
+ *
+ *	@result			The name of the new program.
+ */
+NGL_API GLuint ngles2CreateProgram(void);
+
+/*!
+ *					Starts or stops the recording layer.
+ *
+ *					While recording, the calls made through the NGLES2 buffer, draw and program functions
+ *					are kept in order, from any thread. They still reach OpenGL, the recording doesn't change
+ *					the rendering. Starting a new recording discards the last one. The recording layer is
+ *					made to inspect the traffic to OpenGL in the tests and benchmarks, without a view.
+ *	
+ *	@param			recording
+ *					If YES starts a new recording, if NO stops the current one and keeps its calls.
+ */
+NGL_API void ngles2Record(BOOL recording);
+
+/*!
+ *					Returns the calls of the last recording.
+ *
+ *					The pointer is valid until the next recording starts.
+ *	
+ *	@param			count
+ *					A pointer to receive the number of calls.
+ *
+ *	@result			A pointer to the calls, in the order they were made.
+ */
+NGL_API const NGLES2Call *ngles2RecordedCalls(UInt32 *count);
+
+/*!
+ *					Hides or shows again an extension to ngles2HasExtension.
+ *
+ *					The extensions are checked while the polygons are compiled, so the meshes compiled after
+ *					hiding an extension take the paths made to the devices without it. Only the supported
+ *					extensions can be hidden and shown, the other ones are never shown.
+ *	
+ *	@param			name
+ *					The name of the extension, like GL_EXT_instanced_arrays.
+ *
+ *	@param			hidden
+ *					YES hides the extension, NO shows it again.
+ */
+NGL_API void ngles2HideExtension(NSString *name, BOOL hidden);
@@ -20,6 +20,8 @@
  *	THE SOFTWARE.
  */
 
+#import <pthread.h>
+
 #import "NGLES2Functions.h"
 
 #pragma mark -
@@ -60,6 +62,14 @@ static GLuint				_nglRenderbuffer;
 static EAGLContext			*_currentContext;
 static NSMutableDictionary	*_currentStates;
 
+// The recording layer.
+static BOOL					_recording;
+static NGLES2Call			*_calls;
+static UInt32				_callsCount;
+static UInt32				_callsCapacity;
+static NSMutableSet			*_hiddenExtensions;
+static pthread_mutex_t		_recordMutex = PTHREAD_MUTEX_INITIALIZER;
+
 #pragma mark -
 #pragma mark Private Functions
 //**************************************************
@@ -149,6 +159,30 @@ static void contextSetValue(unsigned int name, unsigned int value)
 	[currentContext() setObject:number forKey:key];
 }
 
+// Keeps a call in the current recording, if there is one.
+static void recordCall(NGLES2CallName name, GLenum type, GLuint buffer, UInt32 offset, UInt32 size, UInt32 instances)
+{
+	if (!_recording)
+	{
+		return;
+	}
+	
+	pthread_mutex_lock(&_recordMutex);
+	
+	if (_recording)
+	{
+		if (_callsCount == _callsCapacity)
+		{
+			_callsCapacity = MAX(_callsCapacity * 2, 256);
+			_calls = realloc(_calls, _callsCapacity * sizeof(NGLES2Call));
+		}
+		
+		_calls[_callsCount++] = (NGLES2Call){ name, type, buffer, offset, size, instances };
+	}
+	
+	pthread_mutex_unlock(&_recordMutex);
+}
+
 #pragma mark -
 #pragma mark Public Interface
 #pragma mark -
@@ -392,6 +426,116 @@ void ngles2BlendAlpha(BOOL value)
 }
 //*/
 
+BOOL ngles2HasExtension(NSString *name)
+{
+	static NSSet *_extensions;
+	
+	// Allocates once with Grand Central Dispatch (GCD) routine. Thread safe.
+	static dispatch_once_t safer;
+	dispatch_once(&safer, ^(void)
+	{
+		// The extensions can only be read with a current context.
+		nglContextEAGL();
+		const char *string = (const char *)glGetString(GL_EXTENSIONS);
+		NSString *extensions = [NSString stringWithUTF8String:(string != NULL) ? string : ""];
+		_extensions = [[NSSet alloc] initWithArray:[extensions componentsSeparatedByString:@" "]];
+	});
+	
+	BOOL isHidden = NO;
+	
+	if (_hiddenExtensions != nil)
+	{
+		pthread_mutex_lock(&_recordMutex);
+		isHidden = [_hiddenExtensions containsObject:name];
+		pthread_mutex_unlock(&_recordMutex);
+	}
+	
+	return [_extensions containsObject:name] && !isHidden;
+}
+
+void ngles2GenBuffer(GLuint *buffer)
+{
+	glGenBuffers(1, buffer);
+	recordCall(NGLES2CallGenBuffers, 0, *buffer, 0, 0, 0);
+}
+
+void ngles2BufferData(GLenum target, GLuint buffer, GLsizeiptr size, const GLvoid *data, GLenum usage)
+{
+	glBufferData(target, size, data, usage);
+	recordCall(NGLES2CallBufferData, target, buffer, 0, (UInt32)size, 0);
+}
+
+void ngles2BufferSubData(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid *data)
+{
+	glBufferSubData(target, offset, size, data);
+	recordCall(NGLES2CallBufferSubData, target, buffer, (UInt32)offset, (UInt32)size, 0);
+}
+
+void ngles2DrawElements(GLsizei count, GLenum type, const GLvoid *indices, GLsizei instances)
+{
+	if (instances > 0)
+	{
+		glDrawElementsInstancedEXT(GL_TRIANGLES, count, type, indices, instances);
+		recordCall(NGLES2CallDrawElementsInstanced, type, 0, (UInt32)(UInt64)indices, count, instances);
+	}
+	else
+	{
+		glDrawElements(GL_TRIANGLES, count, type, indices);
+		recordCall(NGLES2CallDrawElements, type, 0, (UInt32)(UInt64)indices, count, 1);
+	}
+}
+
+GLuint ngles2CreateProgram(void)
+{
+	GLuint name = glCreateProgram();
+	recordCall(NGLES2CallCreateProgram, 0, 0, 0, 0, 0);
+	
+	return name;
+}
+
+void ngles2Record(BOOL recording)
+{
+	pthread_mutex_lock(&_recordMutex);
+	
+	// A new recording starts empty, the calls of the last one are kept until then.
+	if (recording)
+	{
+		_callsCount = 0;
+	}
+	
+	_recording = recording;
+	
+	pthread_mutex_unlock(&_recordMutex);
+}
+
+const NGLES2Call *ngles2RecordedCalls(UInt32 *count)
+{
+	*count = _callsCount;
+	
+	return _calls;
+}
+
+void ngles2HideExtension(NSString *name, BOOL hidden)
+{
+	pthread_mutex_lock(&_recordMutex);
+	
+	if (_hiddenExtensions == nil)
+	{
+		_hiddenExtensions = [[NSMutableSet alloc] init];
+	}
+	
+	if (hidden)
+	{
+		[_hiddenExtensions addObject:name];
+	}
+	else
+	{
+		[_hiddenExtensions removeObject:name];
+	}
+	
+	pthread_mutex_unlock(&_recordMutex);
+}
+
 #pragma mark -
 #pragma mark Properties
 //**************************************************
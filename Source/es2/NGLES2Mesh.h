@@ -20,6 +20,8 @@
  *	THE SOFTWARE.
  */
 
+#import <pthread.h>
+
 #import "NGLRuntime.h"
 #import "NGLVector.h"
 #import "NGLMesh.h"
@@ -32,6 +34,60 @@
 
 @class NGLES2Polygon;
 
+/*!
+ *					<strong>(Internal only)</strong> The place of a surface's indices in the IBO.
+ *
+ *					The indices of the surface and its levels of detail use the data size of the window.
+ *
+ *	@var			NGLES2Range::window
+ *					The window of vertices of the surface.
+ *
+ *	@var			NGLES2Range::offset
+ *					The offset in bytes of the surface's indices in the IBO.
+ *
+ *	@var			NGLES2Range::lodFirst
+ *					The first index of the surface's levels in the array of levels' indices.
+ *
+ *	@var			NGLES2Range::lodLength
+ *					The number of indices of the surface's levels.
+ *
+ *	@var			NGLES2Range::lodOffset
+ *					The offset in bytes of the surface's levels in the IBO.
+ */
+typedef struct
+{
+	NGLWindow		window;
+	UInt32			offset;
+	UInt32			lodFirst;
+	UInt32			lodLength;
+	UInt32			lodOffset;
+} NGLES2Range;
+
+/*!
+ *					<strong>(Internal only)</strong> The ranges of a buffer object not updated yet.
+ *
+ *					The ranges are empty when their ends are not greater than their starts.
+ *
+ *	@var			NGLES2Dirty::vertexStart
+ *					The first vertex not updated.
+ *
+ *	@var			NGLES2Dirty::vertexEnd
+ *					The end of the vertices not updated.
+ *
+ *	@var			NGLES2Dirty::indexStart
+ *					The first index not updated.
+ *
+ *	@var			NGLES2Dirty::indexEnd
+ *					The end of the indices not updated.
+ */
+typedef struct
+{
+	UInt32			vertexStart;
+	UInt32			vertexEnd;
+	UInt32			indexStart;
+	UInt32			indexEnd;
+} NGLES2Dirty;
+
 /*!
  *					<strong>(Internal only)</strong> It's the bridge between #NGLMesh# and the
  *					OpenGL ES 2 API.
@@ -44,6 +100,17 @@
  *					indices to appropriated buffers. The buffers are given by OpenGL ES 2 API and stores the
  *					mesh data in an optimized format to the GPU.
  *
+ *					The dynamic meshes use a ring of buffers, the next buffers in the ring receive the
+ *					changes made since they were drawn and are drawn in the next frame, while the GPU may
+ *					still be reading the others.
+ *
+ *					The buffers can be shared by the copies of a mesh, each copy constructs its own
+ *					polygons on the same buffers and the buffers are deleted after the last copy releases
+ *					them.
+ *
+ *					Without the instanced arrays, the instances are drawn from batch buffers, which hold
+ *					NGL_INSTANCE_BATCH copies of the mesh. They are shared as well.
+ *
  *	@see			NGLMesh
  *	@see			NGLSurface
  *	@see			NGLES2Buffers
@@ -55,6 +122,24 @@
 	NGLMesh					*_parent;
 	NGLES2Buffers			*_buffers;
 	NGLArray				*_polygons;
+	NGLES2Range				*_ranges;
+	UInt32					_rangesCount;
+	BOOL					_hasLevels;
+	
+	// Instances
+	NGLES2Buffers			*_instances;
+	UInt32					_instancesVersion;
+	NGLES2Buffers			*_batch;
+	UInt32					_batchSize;
+	UInt32					_batchIndex;
+	BOOL					_batched;
+	
+	// Dynamic
+	NGLES2Buffers			*_ring[NGL_BUFFERS_RING];
+	NGLES2Dirty				_dirty[NGL_BUFFERS_RING];
+	UInt32					_ringCount;
+	UInt32					_ringIndex;
+	pthread_mutex_t			_dirtyMutex;
 	
 	// Monitor
 	double					_loadedData;
@@ -21,6 +21,7 @@
  */
 
 #import "NGLES2Mesh.h"
+#import "NGLParserMesh.h"
 
 #pragma mark -
 #pragma mark Constants
@@ -41,6 +42,76 @@
 //
 //**********************************************************************************************************
 
+#pragma mark -
+#pragma mark Private Definitions
+//**************************************************
+//	Private Definitions
+//**************************************************
+
+#pragma mark -
+#pragma mark Private Functions
+//**************************************************
+//	Private Functions
+//**************************************************
+
+// Copies indices to the IBO data, relative to the base vertex and with the size of the IBO indices.
+// The NGL Binary files keep the indices in 32 bits with their windows, so they are only narrowed here,
+// in a single pass when the IBO is created, and the same file serves any change to the surfaces.
+static void copyIndices(const UInt32 *indices, UInt32 count, UInt32 base, UInt32 dataSize, void *output)
+{
+	UInt16 *shorts = output;
+	UInt32 *ints = output;
+	UInt32 i;
+	
+	if (dataSize == NGL_SIZE_USHORT)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			shorts[i] = (UInt16)(indices[i] - base);
+		}
+	}
+	else
+	{
+		for (i = 0; i < count; ++i)
+		{
+			ints[i] = indices[i] - base;
+		}
+	}
+}
+
+// Copies the indices of a range once to each copy of the vertices of a batch, one copy after the other.
+// Returns the size of the copies in bytes.
+static UInt32 copyBatch(const UInt32 *indices, UInt32 count, UInt32 vertices, UInt32 dataSize, void *output)
+{
+	UInt16 *shorts = output;
+	UInt32 *ints = output;
+	UInt32 i, k;
+	
+	for (k = 0; k < NGL_INSTANCE_BATCH; ++k)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			if (dataSize == NGL_SIZE_USHORT)
+			{
+				*shorts++ = (UInt16)(indices[i] + k * vertices);
+			}
+			else
+			{
+				*ints++ = indices[i] + k * vertices;
+			}
+		}
+	}
+	
+	return NGL_INSTANCE_BATCH * count * dataSize;
+}
+
+// Extends a range to include another one. The empty range just takes the other one.
+static void extendRange(UInt32 *start, UInt32 *end, UInt32 first, UInt32 last)
+{
+	*start = (*end > *start) ? MIN(*start, first) : first;
+	*end = MAX(*end, last);
+}
+
 #pragma mark -
 #pragma mark Private Category
 //**************************************************
@@ -49,8 +120,47 @@
 
 @interface NGLES2Mesh()
 
-// Creates the buffer objects to the array of indices and array of structures.
-- (void) createBuffers;
+// Returns a new multi surface from the parent's surface, each surface clamped to the mesh's indices.
+- (NGLSurfaceMulti *) newSurfaces;
+
+// Creates the buffer objects to the array of indices and array of structures. Each surface is placed in the IBO
+// with the data size of its window, followed by its levels of detail. The ranges receive the places.
+- (void) createBuffers:(NGLSurfaceMulti *)surfaces ranges:(NGLES2Range *)ranges;
+
+// Creates the batch buffers to the instances. The VBO holds the copies of the vertices followed by the copy of
+// each vertex, as floats. The IBO holds the copies of the range of each surface and of each one of its levels.
+- (void) createBatch:(NGLSurfaceMulti *)surfaces;
+
+// Defines the ranges drawn by each level of detail of a polygon, from the levels of its surface.
+- (void) defineLevels:(NGLES2Polygon *)polygon surface:(NGLSurface *)surface range:(NGLES2Range *)range;
+
+// Defines the batches of a polygon and of its levels, which lie from the offset in the batch IBO, in the order
+// of the surfaces. Returns the offset after them.
+- (UInt32) defineBatch:(NGLES2Polygon *)polygon surface:(NGLSurface *)surface offset:(UInt32)offset;
+
+// Defines the clusters of a polygon, the sequence of clusters that partitions exactly its surface.
+- (void) defineClusters:(NGLES2Polygon *)polygon surface:(NGLSurface *)surface;
+
+// Releases the buffers and the ring of buffers.
+- (void) releaseBuffers;
+
+// Loads the same data in the buffers, or in every buffer of the ring.
+- (void) loadData:(const void *)data size:(UInt32)size type:(NGLES2BuffersType)type;
+
+// Constructs one polygon to each surface, placed at the ranges of the buffer objects.
+- (void) definePolygons:(NGLSurfaceMulti *)surfaces;
+
+// Makes the next buffers of the ring the current ones, they receive the ranges changed since they were drawn.
+- (void) nextBuffers;
+
+// Uploads a range of the parent's array of structures to the buffers.
+- (void) uploadStructures:(NGLES2Buffers *)buffers first:(UInt32)first end:(UInt32)end;
+
+// Uploads a range of the parent's array of indices to the buffers, relative to the windows of their surfaces.
+- (void) uploadIndices:(NGLES2Buffers *)buffers start:(UInt32)start end:(UInt32)end;
+
+// Uploads the parent's instances when they changed and sets them to the polygons. Returns the instances count.
+- (UInt32) defineInstances;
 
 @end
 
@@ -101,6 +211,8 @@
 		self.parent = mesh;
 		_loadedData = 0.0;
 		_totalData = 1.0;
+		
+		pthread_mutex_init(&_dirtyMutex, NULL);
 	}
 	
 	return self;
@@ -112,127 +224,361 @@
 //	Private Methods
 //**************************************************
 
-- (void) createBuffers
+- (NGLSurfaceMulti *) newSurfaces
+{
+	NGLSurfaceMulti *sufLib = [[NGLSurfaceMulti alloc] initWithSurfaceKind:_parent.surface];
+	NGLSurface *surface;
+	
+	// Avoiding empty multi-surface.
+	if ([sufLib count] == 0)
+	{
+		[sufLib addSurface:[NGLSurface surface]];
+	}
+	
+	// Define the data length for each surface, it can't be large than the mesh's data.
+	for (surface in sufLib)
+	{
+		surface.lengthData = MIN(surface.lengthData, _parent.indicesCount - surface.startData);
+	}
+	
+	return sufLib;
+}
+
+- (void) releaseBuffers
 {
-	// TODO remove all this shit when iOS 6 comes out.
-	//*
-	void *indices;
-	UInt32 dataSize;
-	UInt16 *newData = NULL;
+	UInt32 i;
 	
-	if (nglDeviceSystemVersion() < NGL_IOS_5_0)
+	for (i = 0; i < _ringCount; ++i)
 	{
-		UInt32 *data = _parent.indices;
-		UInt32 count = _parent.indicesCount;
+		nglRelease(_ring[i]);
+	}
+	
+	_ringCount = 0;
+	nglRelease(_buffers);
+	nglRelease(_batch);
+}
+
+- (void) loadData:(const void *)data size:(UInt32)size type:(NGLES2BuffersType)type
+{
+	UInt32 i;
+	
+	if (_ringCount == 0)
+	{
+		[_buffers loadData:data size:size type:type usage:NGLES2BuffersUsageStatic];
+	}
+	
+	for (i = 0; i < _ringCount; ++i)
+	{
+		[_ring[i] loadData:data size:size type:type usage:NGLES2BuffersUsageDynamic];
+	}
+}
+
+- (void) createBuffers:(NGLSurfaceMulti *)surfaces ranges:(NGLES2Range *)ranges
+{
+	NGLSurface *surface;
+	NGLES2Range *range;
+	NGLLevel *levels = _parent.levels;
+	NGLWindow *windows = _parent.windows;
+	UInt32 *indices = _parent.indices;
+	UInt32 *lodIndices = _parent.lodIndices;
+	UInt32 levelsCount = (lodIndices != NULL) ? _parent.levelsCount : 0;
+	UInt32 windowsCount = _parent.windowsCount;
+	UInt32 i, l, w, lodEnd, dataSize, size = 0, count = [surfaces count];
+	UInt32 packed = [_parent.meshElements packedStride];
+	UInt8 *data;
+	
+	_hasLevels = NO;
+	
+	//*************************
+	//	Layout
+	//*************************
+	for (i = 0; i < count; ++i)
+	{
+		surface = [surfaces surfaceAtIndex:i];
+		range = &ranges[i];
 		
-		if (count > NGL_MAX_16)
+		// The window found by the parser, the surfaces changed after the import need a new one.
+		for (w = 0; w < windowsCount; ++w)
 		{
-			count = NGL_MAX_16;
-			NSLog(@"Exceeded max data type for iOS 4.");
-			[NGLError errorInstantlyWithHeader:@"Error while processing NGLES2Mesh."
-									andMessage:@"Exceeded the max data for iOS 4.x. (~120.000 faces).\
-			 The iOS 5.x supports up to 4 billions faces."];
+			if (windows[w].rangeStart == surface.startData && windows[w].rangeLength == surface.lengthData)
+			{
+				break;
+			}
 		}
 		
-		newData = malloc(count * NGL_SIZE_USHORT);
+		range->window = (w < windowsCount) ? windows[w] :
+						nglVertexWindow(indices, surface.startData, surface.lengthData,
+										levels, levelsCount, lodIndices);
 		
-		UInt32 i;
-		UInt32 length = count;
-		for (i = 0; i < length; ++i)
+		// The levels of a surface lie together in the array of levels' indices.
+		range->lodFirst = NGL_MAX_32;
+		lodEnd = 0;
+		for (l = 0; l < levelsCount; ++l)
 		{
-			newData[i] = (UInt16)data[i];
+			if (levels[l].rangeStart == surface.startData && levels[l].rangeLength == surface.lengthData)
+			{
+				range->lodFirst = MIN(range->lodFirst, levels[l].start);
+				lodEnd = MAX(lodEnd, levels[l].start + levels[l].length);
+			}
 		}
 		
-		indices = newData;
-		dataSize = NGL_SIZE_USHORT;
+		range->lodFirst = (range->lodFirst < lodEnd) ? range->lodFirst : 0;
+		range->lodLength = lodEnd - range->lodFirst;
+		
+		// TODO remove all this shit when iOS 6 comes out.
+		// The iOS 4 has only 16 bits indices, even the rebased ones must fit in it.
+		if (nglDeviceSystemVersion() < NGL_IOS_5_0)
+		{
+			if (range->window.count > NGL_MAX_16 + 1)
+			{
+				range->lodLength = 0;
+				NSLog(@"Exceeded max data type for iOS 4.");
+				[NGLError errorInstantlyWithHeader:@"Error while processing NGLES2Mesh."
+										andMessage:@"Exceeded the max data for iOS 4.x. (65536 vertices per surface).\
+				 The iOS 5.x supports up to 4 billions vertices."];
+			}
+			
+			range->window.dataSize = NGL_SIZE_USHORT;
+		}
+		
+		// Each range is aligned to its data size.
+		dataSize = range->window.dataSize;
+		size = (size + dataSize - 1) / dataSize * dataSize;
+		range->offset = size;
+		size += range->window.rangeLength * dataSize;
+		range->lodOffset = size;
+		size += range->lodLength * dataSize;
+		
+		_hasLevels = _hasLevels || (range->lodLength > 0);
 	}
-	else
+	
+	//*************************
+	//	Buffers
+	//*************************
+	data = malloc(MAX(size, 1));
+	
+	for (i = 0; i < count; ++i)
 	{
-		indices = _parent.indices;
-		dataSize = NGL_SIZE_UINT;
+		range = &ranges[i];
+		dataSize = range->window.dataSize;
+		
+		copyIndices(indices + range->window.rangeStart, range->window.rangeLength, range->window.base,
+					dataSize, data + range->offset);
+		copyIndices(lodIndices + range->lodFirst, range->lodLength, range->window.base,
+					dataSize, data + range->lodOffset);
 	}
 	
 	// Creates a new IBO.
-	[_buffers loadData:indices
-				  size:_parent.indicesCount * dataSize
-				  type:NGLES2BuffersTypeIndex
-				 usage:NGLES2BuffersUsageStatic];
+	[self loadData:data size:size type:NGLES2BuffersTypeIndex];
+	
+	nglFree(data);
 	
-	// Creates a new VBO.
-	[_buffers loadData:_parent.structures
+	// Creates a new VBO, with the compact formats of the elements when they are packed.
+	if (packed > 0)
+	{
+		size = _parent.structuresCount / MAX(_parent.stride, 1) * packed;
+		data = malloc(MAX(size, 1));
+		nglPackStructures(_parent.meshElements, _parent.structures, _parent.structuresCount, _parent.stride, data);
+		
+		[self loadData:data size:size type:NGLES2BuffersTypeStructure];
+		
+		nglFree(data);
+	}
+	else
+	{
+		[self loadData:_parent.structures
 				  size:_parent.structuresCount * NGL_SIZE_FLOAT
-				  type:NGLES2BuffersTypeStructure
-				 usage:NGLES2BuffersUsageStatic];
+				  type:NGLES2BuffersTypeStructure];
+	}
+}
+
+- (void) createBatch:(NGLSurfaceMulti *)surfaces
+{
+	NGLSurface *surface;
+	NGLLevel *levels = _parent.levels;
+	UInt32 *lodIndices = _parent.lodIndices;
+	UInt32 levelsCount = (_hasLevels) ? _parent.levelsCount : 0;
+	UInt32 packed = [_parent.meshElements packedStride];
+	UInt32 vertices = _parent.structuresCount / MAX(_parent.stride, 1);
+	UInt32 vertexSize = (packed > 0) ? packed : _parent.stride * NGL_SIZE_FLOAT;
+	UInt32 i, copy = vertices * vertexSize, size = 0;
+	UInt8 *data, *output;
+	float *index;
 	
-	nglFree(newData);
-	/*/
-	// Creates a new IBO.
-	[_buffers loadData:_parent.indices
-				  size:_parent.indicesCount * NGL_SIZE_UINT//UINT POINT
-				  type:NGLES2BuffersTypeIndex
-				 usage:NGLES2BuffersUsageStatic];
+	_batch = [[NGLES2Buffers alloc] init];
+	_batchSize = (vertices * NGL_INSTANCE_BATCH <= NGL_MAX_16 + 1) ? NGL_SIZE_USHORT : NGL_SIZE_UINT;
+	_batchIndex = (copy * NGL_INSTANCE_BATCH + 3) & ~3;
 	
-	// Creates a new VBO.
-	[_buffers loadData:_parent.structures
-				  size:_parent.structuresCount * NGL_SIZE_FLOAT
-				  type:NGLES2BuffersTypeStructure
-				 usage:NGLES2BuffersUsageStatic];
-	//*/
+	//*************************
+	//	VBO
+	//*************************
+	// The first copy is the same data of the mesh's VBO, the others repeat it.
+	size = _batchIndex + vertices * NGL_INSTANCE_BATCH * NGL_SIZE_FLOAT;
+	data = malloc(MAX(size, 1));
+	
+	if (packed > 0)
+	{
+		nglPackStructures(_parent.meshElements, _parent.structures, _parent.structuresCount, _parent.stride, data);
+	}
+	else
+	{
+		memcpy(data, _parent.structures, copy);
+	}
+	
+	for (i = 1; i < NGL_INSTANCE_BATCH; ++i)
+	{
+		memcpy(data + i * copy, data, copy);
+	}
+	
+	index = (float *)(data + _batchIndex);
+	for (i = 0; i < vertices * NGL_INSTANCE_BATCH; ++i)
+	{
+		index[i] = (float)(i / vertices);
+	}
+	
+	[_batch loadData:data size:size type:NGLES2BuffersTypeStructure usage:NGLES2BuffersUsageStatic];
+	
+	nglFree(data);
+	
+	//*************************
+	//	IBO
+	//*************************
+	// The same order is taken by the polygons, see defineBatch:surface:offset:.
+	size = 0;
+	for (surface in surfaces)
+	{
+		size += surface.lengthData;
+		
+		for (i = 0; i < levelsCount; ++i)
+		{
+			if (levels[i].rangeStart == surface.startData && levels[i].rangeLength == surface.lengthData)
+			{
+				size += levels[i].length;
+			}
+		}
+	}
+	
+	size *= NGL_INSTANCE_BATCH * _batchSize;
+	data = malloc(MAX(size, 1));
+	output = data;
+	
+	for (surface in surfaces)
+	{
+		output += copyBatch(_parent.indices + surface.startData, surface.lengthData, vertices, _batchSize, output);
+		
+		for (i = 0; i < levelsCount; ++i)
+		{
+			if (levels[i].rangeStart == surface.startData && levels[i].rangeLength == surface.lengthData)
+			{
+				output += copyBatch(lodIndices + levels[i].start, levels[i].length, vertices, _batchSize, output);
+			}
+		}
+	}
+	
+	[_batch loadData:data size:size type:NGLES2BuffersTypeIndex usage:NGLES2BuffersUsageStatic];
+	
+	nglFree(data);
 }
 
-#pragma mark -
-#pragma mark Self Public Methods
-//**************************************************
-//	Self Public Methods
-//**************************************************
+- (UInt32) defineBatch:(NGLES2Polygon *)polygon surface:(NGLSurface *)surface offset:(UInt32)offset
+{
+	NGLLevel *levels = _parent.levels;
+	UInt32 i, count = (_hasLevels) ? _parent.levelsCount : 0;
+	UInt32 copies = NGL_INSTANCE_BATCH * _batchSize;
+	
+	[polygon defineBatch:0 offset:offset dataSize:_batchSize index:_batchIndex];
+	offset += surface.lengthData * copies;
+	
+	// The levels lie in the same order they were created.
+	for (i = 0; i < count; ++i)
+	{
+		if (levels[i].rangeStart == surface.startData && levels[i].rangeLength == surface.lengthData)
+		{
+			[polygon defineBatch:levels[i].level offset:offset dataSize:_batchSize index:_batchIndex];
+			offset += levels[i].length * copies;
+		}
+	}
+	
+	return offset;
+}
 
-- (void) defineBuffers
+- (void) defineLevels:(NGLES2Polygon *)polygon surface:(NGLSurface *)surface range:(NGLES2Range *)range
 {
-	nglContextEAGL();
+	NGLLevel *levels = _parent.levels;
+	UInt32 i, count = _parent.levelsCount;
+	UInt32 offset;
 	
-	// Clears the old polygons.
-	nglRelease(_polygons);
-	_polygons = [[NGLArray alloc] initWithRetainOption];
+	// The ranges are sorted by level, the surfaces changed after the import keep the original range.
+	for (i = 0; i < count; ++i)
+	{
+		if (levels[i].rangeStart == surface.startData && levels[i].rangeLength == surface.lengthData)
+		{
+			offset = range->lodOffset + (levels[i].start - range->lodFirst) * range->window.dataSize;
+			[polygon defineLevel:levels[i].level offset:offset length:levels[i].length];
+		}
+	}
+}
+
+- (void) defineClusters:(NGLES2Polygon *)polygon surface:(NGLSurface *)surface
+{
+	NGLCluster *clusters = _parent.clusters;
+	UInt32 first = 0, last, count = _parent.clustersCount;
+	UInt32 end = surface.startData + surface.lengthData;
 	
-	// Clears the old buffer objects.
-	nglRelease(_buffers);
-	_buffers = [[NGLES2Buffers alloc] init];
+	// The clusters are sorted by their starts.
+	while (first < count && clusters[first].start < surface.startData)
+	{
+		++first;
+	}
 	
-	// Creates the Buffer Objects.
-	[self createBuffers];
+	// The surfaces changed after the import may not match the clusters, then they are drawn entirely.
+	for (last = first; last < count && clusters[last].start + clusters[last].length <= end; ++last)
+	{
+		if (last > first && clusters[last].start != clusters[last - 1].start + clusters[last - 1].length)
+		{
+			return;
+		}
+	}
 	
+	if (last > first && clusters[first].start == surface.startData &&
+		clusters[last - 1].start + clusters[last - 1].length == end)
+	{
+		[polygon defineClusters:first count:last - first];
+	}
+}
+
+- (void) definePolygons:(NGLSurfaceMulti *)surfaces
+{
 	NGLMaterialMulti *mtlLib;
 	NGLShadersMulti *shdLib;
-	NGLSurfaceMulti *sufLib;
 	
 	NGLSurface *surface;
+	NGLES2Range *range = _ranges;
+	UInt32 batchOffset = 0;
 	UInt16 sufId;
 	BOOL multiMtl = [_parent.material isKindOfClass:[NGLMaterialMulti class]];
 	BOOL multiShd = [_parent.shaders isKindOfClass:[NGLShadersMulti class]];
 	
 	NGLES2Polygon *polygon;
 	
+	// Clears the old polygons.
+	nglRelease(_polygons);
+	_polygons = [[NGLArray alloc] initWithRetainOption];
+	
 	// First checks for Multi/Sub Libraries.
 	mtlLib = (multiMtl) ? [[NGLMaterialMulti alloc] initWithMaterialKind:_parent.material] : nil;
 	shdLib = (multiShd) ? [[NGLShadersMulti alloc] initWithShadersKind:_parent.shaders] : nil;
-	sufLib = [[NGLSurfaceMulti alloc] initWithSurfaceKind:_parent.surface];
 	
-	// Avoiding empty multi-surface.
-	if ([sufLib count] == 0)
-	{
-		[sufLib addSurface:[NGLSurface surface]];
-	}
+	// The polygons are compiled with batches when the mesh has them.
+	_batched = (_batch != nil && nglInstancesBatched(_parent));
 	
 	// Monitoring uploading.
 	_loadedData = 0.0;
-	_totalData = (double)[sufLib count];
+	_totalData = (double)[surfaces count];
 	
 	// Takes the Multi/Sub Surface count, otherwise this mesh will work with only one polygon.
-	for (surface in sufLib)
+	for (surface in surfaces)
 	{
-		// Define the data length for the current surface, it can't be large than the mesh's data.
-		surface.lengthData = MIN(surface.lengthData, _parent.indicesCount - surface.startData);
-		
 		// Get the current identifier, if the doesn't have a surface set the identifier to the default.
 		sufId = surface.identifier;
 		
@@ -246,6 +592,25 @@
 						shaders:(multiShd) ? [shdLib shadersWithIdentifier:sufId] : _parent.shaders
 						surface:surface];
 		
+		// The indices of each surface are relative to its window, its levels of detail lie right after it.
+		[polygon defineIndices:range->offset dataSize:range->window.dataSize base:range->window.base];
+		
+		if (_hasLevels)
+		{
+			[self defineLevels:polygon surface:surface range:range];
+		}
+		
+		if (_batched)
+		{
+			batchOffset = [self defineBatch:polygon surface:surface offset:batchOffset];
+		}
+		
+		// The dynamic and skinned vertices may leave the bounds of their clusters.
+		if (_ringCount == 0 && _parent.jointsCount == 0)
+		{
+			[self defineClusters:polygon surface:surface];
+		}
+		
 		// Commiting changes to the OpenGL server.
 		// This single instruction will update the render core,
 		// then the NinevehGL render thread will be able to make render, even without finish the parser.
@@ -257,14 +622,295 @@
 		
 		// Updates the loaded data.
 		++_loadedData;
+		++range;
 	}
 	
 	// Frees the memory.
 	nglRelease(mtlLib);
 	nglRelease(shdLib);
+}
+
+- (UInt32) defineInstances
+{
+	UInt32 count = _parent.instancesCount;
+	UInt32 version = _parent.instancesVersion;
+	NGLES2Polygon *polygon;
+	
+	// The instances are uploaded only when they change, into the same buffer. The batches use uniforms instead.
+	if (count > 0 && version != _instancesVersion && !_batched)
+	{
+		if (_instances == nil)
+		{
+			_instances = [[NGLES2Buffers alloc] init];
+		}
+		
+		[_instances loadData:_parent.instances
+						size:count * NGL_INSTANCE_LENGTH * NGL_SIZE_FLOAT
+						type:NGLES2BuffersTypeStructure
+					   usage:NGLES2BuffersUsageStream];
+		
+		_instancesVersion = version;
+	}
+	
+	nglFor (polygon, _polygons)
+	{
+		[polygon useInstances:_instances data:_parent.instances count:count];
+	}
+	
+	return count;
+}
+
+- (void) nextBuffers
+{
+	NGLES2Buffers *buffers;
+	NGLES2Dirty dirty;
+	
+	pthread_mutex_lock(&_dirtyMutex);
+	
+	_ringIndex = (_ringIndex + 1) % _ringCount;
+	buffers = _ring[_ringIndex];
+	dirty = _dirty[_ringIndex];
+	
+	if (dirty.vertexEnd > dirty.vertexStart)
+	{
+		[self uploadStructures:buffers first:dirty.vertexStart end:dirty.vertexEnd];
+	}
+	
+	if (dirty.indexEnd > dirty.indexStart)
+	{
+		[self uploadIndices:buffers start:dirty.indexStart end:dirty.indexEnd];
+	}
+	
+	_dirty[_ringIndex] = (NGLES2Dirty){0, 0, 0, 0};
+	
+	pthread_mutex_unlock(&_dirtyMutex);
+	
+	nglRelease(_buffers);
+	_buffers = [buffers retain];
+}
+
+- (void) uploadStructures:(NGLES2Buffers *)buffers first:(UInt32)first end:(UInt32)end
+{
+	UInt32 stride = _parent.stride * NGL_SIZE_FLOAT;
+	
+	// The dynamic meshes never use the compact formats, the floats are uploaded directly.
+	[buffers updateData:(UInt8 *)_parent.structures + first * stride
+				 offset:first * stride
+				   size:(end - first) * stride
+				   type:NGLES2BuffersTypeStructure];
+}
+
+- (void) uploadIndices:(NGLES2Buffers *)buffers start:(UInt32)start end:(UInt32)end
+{
+	NGLES2Range *range;
+	UInt32 i, first, last, dataSize;
+	UInt32 *indices = _parent.indices;
+	UInt8 *data = malloc((end - start) * NGL_SIZE_UINT);
+	
+	// Each surface has its own place and data size in the IBO.
+	for (i = 0; i < _rangesCount; ++i)
+	{
+		range = &_ranges[i];
+		first = MAX(start, range->window.rangeStart);
+		last = MIN(end, range->window.rangeStart + range->window.rangeLength);
+		dataSize = range->window.dataSize;
+		
+		if (first < last)
+		{
+			copyIndices(indices + first, last - first, range->window.base, dataSize, data);
+			[buffers updateData:data
+						 offset:range->offset + (first - range->window.rangeStart) * dataSize
+						   size:(last - first) * dataSize
+						   type:NGLES2BuffersTypeIndex];
+		}
+	}
+	
+	nglFree(data);
+}
+
+#pragma mark -
+#pragma mark Self Public Methods
+//**************************************************
+//	Self Public Methods
+//**************************************************
+
+- (void) defineBuffers
+{
+	nglContextEAGL();
+	
+	UInt32 i;
+	
+	// Clears the old buffer objects. The dynamic meshes use a ring of buffers, one of them in each frame.
+	[self releaseBuffers];
+	_ringCount = (_parent.isDynamic) ? NGL_BUFFERS_RING : 0;
+	_ringIndex = 0;
+	memset(_dirty, 0, sizeof(_dirty));
+	
+	for (i = 0; i < _ringCount; ++i)
+	{
+		_ring[i] = [[NGLES2Buffers alloc] init];
+	}
+	
+	_buffers = (_ringCount > 0) ? [_ring[0] retain] : [[NGLES2Buffers alloc] init];
+	
+	NGLSurfaceMulti *sufLib = [self newSurfaces];
+	
+	// Creates the Buffer Objects, the surfaces define the places of the indices.
+	nglFree(_ranges);
+	_rangesCount = [sufLib count];
+	_ranges = malloc(_rangesCount * sizeof(NGLES2Range));
+	[self createBuffers:sufLib ranges:_ranges];
+	
+	// Without the instanced arrays, the instances are drawn from copies of the mesh.
+	if (nglInstancesBatched(_parent))
+	{
+		[self createBatch:sufLib];
+	}
+	
+	[self definePolygons:sufLib];
+	
+	// Frees the memory.
 	nglRelease(sufLib);
 }
 
+- (BOOL) defineBuffersWithCore:(id <NGLCoreMesh>)coreMesh
+{
+	NGLES2Mesh *core = coreMesh;
+	NGLSurfaceMulti *sufLib;
+	NGLSurface *surface;
+	NGLES2Range *range;
+	BOOL isShared;
+	
+	// Only the buffers of a ready core of the same engine can be shared. The dynamic buffers change.
+	if (![core isKindOfClass:[NGLES2Mesh class]] || core->_buffers == nil || core->_ranges == NULL ||
+		core->_ringCount > 0 || _parent.isDynamic)
+	{
+		return NO;
+	}
+	
+	nglContextEAGL();
+	
+	// The surfaces must lie exactly on the ranges of the shared IBO.
+	sufLib = [self newSurfaces];
+	isShared = ([sufLib count] == core->_rangesCount);
+	range = core->_ranges;
+	
+	for (surface in sufLib)
+	{
+		if (!isShared || range->window.rangeStart != surface.startData ||
+			range->window.rangeLength != surface.lengthData)
+		{
+			isShared = NO;
+			break;
+		}
+		
+		++range;
+	}
+	
+	// The batches are created from the arrays, which are freed after the upload, unless they can be shared too.
+	if (isShared && core->_batch == nil && nglInstancesBatched(_parent) &&
+		(_parent.structures == NULL || _parent.indices == NULL))
+	{
+		isShared = NO;
+	}
+	
+	// The buffers are retained, they will be deleted only after the last core releases them.
+	if (isShared)
+	{
+		[self releaseBuffers];
+		_buffers = [core->_buffers retain];
+		
+		nglFree(_ranges);
+		_rangesCount = core->_rangesCount;
+		_ranges = malloc(_rangesCount * sizeof(NGLES2Range));
+		memcpy(_ranges, core->_ranges, _rangesCount * sizeof(NGLES2Range));
+		_hasLevels = core->_hasLevels;
+		
+		if (core->_batch != nil)
+		{
+			_batch = [core->_batch retain];
+			_batchSize = core->_batchSize;
+			_batchIndex = core->_batchIndex;
+		}
+		else if (nglInstancesBatched(_parent))
+		{
+			[self createBatch:sufLib];
+		}
+		
+		[self definePolygons:sufLib];
+	}
+	
+	nglRelease(sufLib);
+	
+	return isShared;
+}
+
+- (BOOL) updateStructures:(const float *)data vertex:(UInt32)first count:(UInt32)count
+{
+	UInt32 i, stride = _parent.stride;
+	float *structures = _parent.structures;
+	
+	if (_ringCount == 0 || structures == NULL || stride == 0 || first + count > _parent.structuresCount / stride)
+	{
+		return NO;
+	}
+	
+	pthread_mutex_lock(&_dirtyMutex);
+	
+	memcpy(structures + first * stride, data, count * stride * NGL_SIZE_FLOAT);
+	
+	// Every buffer of the ring receives the new vertices before being drawn again.
+	for (i = 0; i < _ringCount; ++i)
+	{
+		extendRange(&_dirty[i].vertexStart, &_dirty[i].vertexEnd, first, first + count);
+	}
+	
+	pthread_mutex_unlock(&_dirtyMutex);
+	
+	return YES;
+}
+
+- (BOOL) updateIndices:(const UInt32 *)data start:(UInt32)start count:(UInt32)count
+{
+	NGLWindow *window;
+	UInt32 i, r, last;
+	UInt32 *indices = _parent.indices;
+	
+	if (_ringCount == 0 || indices == NULL || start + count > _parent.indicesCount)
+	{
+		return NO;
+	}
+	
+	// The indices in the IBO are relative to the windows, so the new ones must lie inside them.
+	for (r = 0; r < _rangesCount; ++r)
+	{
+		window = &_ranges[r].window;
+		last = MIN(start + count, window->rangeStart + window->rangeLength);
+		
+		for (i = MAX(start, window->rangeStart); i < last; ++i)
+		{
+			if (data[i - start] < window->base || data[i - start] - window->base >= window->count)
+			{
+				return NO;
+			}
+		}
+	}
+	
+	pthread_mutex_lock(&_dirtyMutex);
+	
+	memcpy(indices + start, data, count * NGL_SIZE_UINT);
+	
+	// Every buffer of the ring receives the new indices before being drawn again.
+	for (i = 0; i < _ringCount; ++i)
+	{
+		extendRange(&_dirty[i].indexStart, &_dirty[i].indexEnd, start, start + count);
+	}
+	
+	pthread_mutex_unlock(&_dirtyMutex);
+	
+	return YES;
+}
+
 - (void) clearBuffers
 {
 	_loadedData = 0;
@@ -273,24 +919,51 @@
 	// Makes sure the current context is valid.
 	nglContextEAGL();
 	
-	// Releases the buffers.
-	nglRelease(_buffers);
+	// Releases the buffers, the shared ones are deleted only by their last core.
+	[self releaseBuffers];
 	nglRelease(_polygons);
+	nglRelease(_instances);
+	_instancesVersion = 0;
+	nglFree(_ranges);
+	_rangesCount = 0;
 }
 
 - (void) drawCoreMesh
 {
+	// The dynamic meshes draw the next buffers of the ring, while the GPU may still read the last ones.
+	if (_ringCount > 0)
+	{
+		[self nextBuffers];
+	}
+	
+	// The instances are set before binding the mesh's buffers. The batches of instances use their own buffers.
+	UInt32 instances = [self defineInstances];
+	NGLES2Buffers *buffers = (instances > 0 && _batched) ? _batch : _buffers;
+	
 	// Binds the ABO and IBO for this mesh.
-	[_buffers bind];
+	[buffers bind];
+	
+	// The level of detail chosen by the camera and the clusters visible by it.
+	UInt32 level = _parent.level;
+	NGLCluster *clusters = _parent.clusters;
+	BOOL *visible = _parent.visibleClusters;
 	
 	NGLES2Polygon *polygon;
     nglFor (polygon, _polygons)
 	{
+		polygon.level = level;
+		[polygon useClusters:clusters visible:visible];
 		[polygon drawPolygon];
+		
+		// The instanced polygons leave the instances' VBO bound.
+		if (instances > 0)
+		{
+			[buffers bindType:NGLES2BuffersTypeStructure];
+		}
 	}
 	
 	// Unbid all BOs.
-	[_buffers unbind];
+	[buffers unbind];
 }
 
 - (void) drawTelemetry:(UInt32)telemetry
@@ -300,9 +973,15 @@
 	// Binds the ABO and IBO for this mesh.
 	[_buffers bind];
 	
+	UInt32 level = _parent.level;
+	NGLCluster *clusters = _parent.clusters;
+	BOOL *visible = _parent.visibleClusters;
+	
 	NGLES2Polygon *polygon;
 	nglFor (polygon, _polygons)
 	{
+		polygon.level = level;
+		[polygon useClusters:clusters visible:visible];
 		[polygon drawPolygonTelemetry:color];
 		
 		color.b += kNGL_COLOR_UNIT;
@@ -322,6 +1001,9 @@
 {
 	// IMPORTANT: clearBuffers must be called by the owner before in the same thread as defineBuffers was.
 	
+	nglFree(_ranges);
+	pthread_mutex_destroy(&_dirtyMutex);
+	
 	[super dealloc];
 }
 
@@ -31,6 +31,7 @@
 #import "NGLMaterial.h"
 #import "NGLShaders.h"
 
+#import "NGLES2Buffers.h"
 #import "NGLES2Program.h"
 #import "NGLES2Textures.h"
 #import "NGLES2Functions.h"
@@ -72,6 +73,33 @@
 	GLsizei					_length;
 	GLenum					_dataType;
 	GLenum					_dataTypeSize;
+	UInt32					_baseVertex;
+	
+	// Levels of Detail
+	void					*_starts[NGL_LOD_LEVELS];
+	GLsizei					_lengths[NGL_LOD_LEVELS];
+	UInt32					_level;
+	
+	// Clusters
+	const NGLCluster		*_clusters;
+	const BOOL				*_visibleClusters;
+	UInt32					_clustersFirst;
+	UInt32					_clustersCount;
+	
+	// Instances
+	NGLES2Buffers			*_instances;
+	const float				*_instancesData;
+	UInt32					_instancesCount;
+	GLint					_instanceLocation;
+	GLint					_instanceColorLocation;
+	BOOL					_instancedArrays;
+	
+	// Batches
+	GLint					_instanceIndexLocation;
+	GLint					_instancesUniform;
+	void					*_batchStarts[NGL_LOD_LEVELS];
+	GLenum					_batchDataType;
+	UInt32					_batchIndex;
 	
 	NGLES2Program			*_program;
 	NGLES2Textures			*_textures;
@@ -80,6 +108,12 @@
 	NGLvec4					_telemetry;
 }
 
+/*!
+ *					The level of detail drawn by this polygon. The levels without a range draw the same
+ *					range of the previous level.
+ */
+@property (nonatomic) UInt32 level;
+
 /*!
  *					Compiles this polygon with the current information.
  *
@@ -104,6 +138,111 @@
  */
 - (void) drawPolygon;
 
+/*!
+ *					Defines where the indices of this polygon lie in the IBO, replacing the range of the
+ *					surface. The indices are relative to a base vertex, so a surface with up to 65536
+ *					vertices can use 16 bits indices in a bigger mesh.
+ *
+ *					This method must be called after the compilation and before defining the levels.
+ *
+ *	@param			offset
+ *					The offset of the first index, in bytes.
+ *
+ *	@param			dataSize
+ *					The size of each index, NGL_SIZE_USHORT or NGL_SIZE_UINT.
+ *
+ *	@param			base
+ *					The vertex referenced by the index 0.
+ */
+- (void) defineIndices:(UInt32)offset dataSize:(UInt32)dataSize base:(UInt32)base;
+
+/*!
+ *					Defines the range of indices drawn by a level of detail and by the next levels, until
+ *					they get their own ranges. The levels use the same data type and base vertex of the
+ *					level 0.
+ *
+ *					This method must be called after the compilation, in the ascending order of the levels.
+ *
+ *	@param			level
+ *					The level of detail, from 1 to NGL_LOD_LEVELS - 1.
+ *
+ *	@param			offset
+ *					The offset of the first index of the range in the IBO, in bytes.
+ *
+ *	@param			length
+ *					The number of indices of the range.
+ */
+- (void) defineLevel:(UInt32)level offset:(UInt32)offset length:(UInt32)length;
+
+/*!
+ *					Defines the clusters that partition the range of the level 0, they are a sequence of
+ *					the mesh's clusters.
+ *
+ *					This method must be called after the compilation.
+ *
+ *	@param			first
+ *					The index of the first cluster in the mesh's clusters.
+ *
+ *	@param			count
+ *					The number of clusters.
+ */
+- (void) defineClusters:(UInt32)first count:(UInt32)count;
+
+/*!
+ *					Sets the visibility of the clusters to the next drawing. Only the visible clusters
+ *					of the level 0 are drawn, the consecutive ones with a single draw call.
+ *
+ *	@param			clusters
+ *					The mesh's clusters.
+ *
+ *	@param			visible
+ *					The visibility of each one of the mesh's clusters. NULL draws all of them.
+ */
+- (void) useClusters:(const NGLCluster *)clusters visible:(const BOOL *)visible;
+
+/*!
+ *					Sets the instances drawn by this polygon. Only the polygons compiled with instances
+ *					draw them, the others ignore the instances.
+ *
+ *					The instances are drawn in a single draw call with the instanced arrays, otherwise
+ *					in batches of NGL_INSTANCE_BATCH instances, or each instance with its own draw call to
+ *					the polygons compiled without batches, always without setting the shader again.
+ *
+ *	@param			buffers
+ *					The buffers holding the instances in the VBO, it's not retained.
+ *
+ *	@param			data
+ *					Pointer to the instances' data, NGL_INSTANCE_LENGTH floats to each instance. This
+ *					pointer must be valid during the drawing.
+ *
+ *	@param			count
+ *					The number of instances.
+ */
+- (void) useInstances:(NGLES2Buffers *)buffers data:(const float *)data count:(UInt32)count;
+
+/*!
+ *					Defines where the batches of instances of a level of detail and of the next levels, until
+ *					they get their own batches, lie in the batch buffers. The batch buffers are bound in the
+ *					place of the mesh's buffers to draw the batches.
+ *
+ *					The batch IBO holds NGL_INSTANCE_BATCH copies of the range of the level, one after the
+ *					other, each copy with the indices of its own copy of the vertices. This method must be
+ *					called after the compilation, in the ascending order of the levels, starting at 0.
+ *
+ *	@param			level
+ *					The level of detail, from 0 to NGL_LOD_LEVELS - 1.
+ *
+ *	@param			offset
+ *					The offset of the first copy of the range in the batch IBO, in bytes.
+ *
+ *	@param			dataSize
+ *					The size of each index of the batch IBO, NGL_SIZE_USHORT or NGL_SIZE_UINT.
+ *
+ *	@param			index
+ *					The offset in the batch VBO of the copy of each vertex, as floats, in bytes.
+ */
+- (void) defineBatch:(UInt32)level offset:(UInt32)offset dataSize:(UInt32)dataSize index:(UInt32)index;
+
 - (void) drawPolygonTelemetry:(NGLvec4)color;
 
 @end
\ No newline at end of file
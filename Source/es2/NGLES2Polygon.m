@@ -127,6 +127,56 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 	}
 }
 
+// Sets the pointer of an attribute in the bound VBO, with the data type of its format.
+// The indices are relative to the base vertex. The half floats only exist with GL_OES_vertex_half_float,
+// without it the formats are chosen with floats instead, see nglDefineFormats.
+static void setAttributePointer(GLuint location, NGLSLVariable *variable, UInt32 base)
+{
+	GLenum type;
+	GLboolean normalized = GL_TRUE;
+	
+	switch ((*variable).format)
+	{
+		case NGLElementFormatHalf:
+			type = GL_HALF_FLOAT_OES;
+			normalized = GL_FALSE;
+			break;
+		case NGLElementFormatShort:
+			type = GL_SHORT;
+			break;
+		case NGLElementFormatUShort:
+			type = GL_UNSIGNED_SHORT;
+			break;
+		case NGLElementFormatByte:
+			type = GL_BYTE;
+			break;
+		default:
+			type = GL_FLOAT;
+			normalized = GL_FALSE;
+			break;
+	}
+	
+	glVertexAttribPointer(location, (*variable).count, type, normalized, (*variable).stride,
+						  (UInt8 *)(*variable).data + base * (*variable).stride);
+}
+
+#pragma mark -
+#pragma mark Private Category
+//**************************************************
+//	Private Category
+//**************************************************
+
+@interface NGLES2Polygon()
+
+// Draws the range of the current level of detail. In the level 0, draws only the visible clusters.
+- (void) drawElements;
+
+// Draws the range of the current level of detail once to each instance, with the instances' attributes, or in
+// batches of copies with the instances' uniforms.
+- (void) drawInstances;
+
+@end
+
 #pragma mark -
 #pragma mark Public Interface
 #pragma mark -
@@ -144,6 +194,14 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 //	Properties
 //**************************************************
 
+- (UInt32) level { return _level; }
+- (void) setLevel:(UInt32)value
+{
+	_level = MIN(value, NGL_LOD_LEVELS - 1);
+	_start = _starts[_level];
+	_length = _lengths[_level];
+}
+
 #pragma mark -
 #pragma mark Constructors
 //**************************************************
@@ -168,6 +226,115 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 //	Private Methods
 //**************************************************
 
+- (void) drawElements
+{
+	UInt32 i, start, length, last = _clustersFirst + _clustersCount;
+	UInt8 *first = _starts[0];
+	
+	// The levels of detail and the polygons without culling draw the whole range.
+	if (_level > 0 || _visibleClusters == NULL || _clustersCount == 0)
+	{
+		ngles2DrawElements(_length, _dataType, _start, 0);
+		return;
+	}
+	
+	// The consecutive clusters lie in consecutive ranges, so the visible ones are merged.
+	// The first cluster starts at the range of the level 0, wherever it lies in the IBO.
+	for (i = _clustersFirst; i < last; ++i)
+	{
+		if (_visibleClusters[i])
+		{
+			start = _clusters[i].start - _clusters[_clustersFirst].start;
+			length = 0;
+			
+			while (i < last && _visibleClusters[i])
+			{
+				length += _clusters[i].length;
+				++i;
+			}
+			
+			ngles2DrawElements(length, _dataType, first + start * _dataTypeSize, 0);
+		}
+	}
+}
+
+- (void) drawInstances
+{
+	UInt32 i, c, count;
+	GLint location;
+	GLsizei stride = NGL_INSTANCE_LENGTH * NGL_SIZE_FLOAT;
+	const float *instance;
+	
+	// The instances use the whole range, the clusters were culled to the mesh alone.
+	if (_instanceIndexLocation >= 0)
+	{
+		// The batch buffers are bound, each vertex of a copy knows its copy. A batch draws a copy to each
+		// instance, the last one draws only the copies it needs.
+		glEnableVertexAttribArray(_instanceIndexLocation);
+		glVertexAttribPointer(_instanceIndexLocation, 1, GL_FLOAT, GL_FALSE, 0, (void *)(UInt64)_batchIndex);
+		
+		for (i = 0; i < _instancesCount; i += NGL_INSTANCE_BATCH)
+		{
+			count = MIN(NGL_INSTANCE_BATCH, _instancesCount - i);
+			glUniform4fv(_instancesUniform, count * NGL_INSTANCE_LENGTH / 4, _instancesData + i * NGL_INSTANCE_LENGTH);
+			ngles2DrawElements(count * _length, _batchDataType, _batchStarts[_level], 0);
+		}
+		
+		glDisableVertexAttribArray(_instanceIndexLocation);
+	}
+	else if (_instancedArrays)
+	{
+		// The matrix takes 4 locations, one to each column, and the color takes the next one.
+		[_instances bindType:NGLES2BuffersTypeStructure];
+		
+		for (c = 0; c < 5; ++c)
+		{
+			location = (c < 4) ? _instanceLocation + c : _instanceColorLocation;
+			
+			if (location >= 0)
+			{
+				glEnableVertexAttribArray(location);
+				glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void *)(UInt64)(c * NGL_SIZE_VEC4));
+				glVertexAttribDivisorEXT(location, 1);
+			}
+		}
+		
+		ngles2DrawElements(_length, _dataType, _start, _instancesCount);
+		
+		// The divisors are states of the locations, the other programs must not use them.
+		for (c = 0; c < 5; ++c)
+		{
+			location = (c < 4) ? _instanceLocation + c : _instanceColorLocation;
+			
+			if (location >= 0)
+			{
+				glVertexAttribDivisorEXT(location, 0);
+				glDisableVertexAttribArray(location);
+			}
+		}
+	}
+	else
+	{
+		// Without arrays, the instances' attributes are constant values, changed between the draw calls.
+		for (i = 0; i < _instancesCount; ++i)
+		{
+			instance = _instancesData + i * NGL_INSTANCE_LENGTH;
+			
+			for (c = 0; c < 4; ++c)
+			{
+				glVertexAttrib4fv(_instanceLocation + c, instance + c * 4);
+			}
+			
+			if (_instanceColorLocation >= 0)
+			{
+				glVertexAttrib4fv(_instanceColorLocation, instance + 16);
+			}
+			
+			ngles2DrawElements(_length, _dataType, _start, 0);
+		}
+	}
+}
+
 #pragma mark -
 #pragma mark Self Public Methods
 //**************************************************
@@ -200,6 +367,16 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 	_start = (void *)(UInt64)(surface.startData * _dataTypeSize); // FIXME: What is going on with this address calculation??
 	_length = surface.lengthData;
 	
+	// All the levels of detail draw the original range until they get their own ranges.
+	for (_level = 0; _level < NGL_LOD_LEVELS; ++_level)
+	{
+		_starts[_level] = _start;
+		_lengths[_level] = _length;
+	}
+	
+	_level = 0;
+	_baseVertex = 0;
+	
 	// Sets the default material.
 	if (material == nil)
 	{
@@ -299,6 +476,15 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 			}
 		}
 	}
+	
+	// The instances' attributes exist only in the shaders compiled with instances.
+	_instanceLocation = [_program attributeLocation:@"a_nglInstance"];
+	_instanceColorLocation = [_program attributeLocation:@"a_nglInstanceColor"];
+	_instancedArrays = ngles2HasExtension(@"GL_EXT_instanced_arrays");
+	
+	// The batches exist only in the shaders compiled with instances and without the instanced arrays.
+	_instanceIndexLocation = [_program attributeLocation:@"a_nglInstanceIndex"];
+	_instancesUniform = [_program uniformLocation:@"u_nglInstances"];
 }
 
 - (void) drawPolygon
@@ -306,6 +492,10 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 	// Starts using the program to this polygon.
 	[_program use];
 	
+	// The batches of instances draw from the batch buffers, their indices are relative to the first vertex.
+	BOOL isInstanced = ((_instanceLocation >= 0 || _instanceIndexLocation >= 0) && _instancesCount > 0);
+	UInt32 base = (isInstanced && _instanceIndexLocation >= 0) ? 0 : _baseVertex;
+	
 	// Enables dynamic locations.
 	setDynamicVariables(_variables, YES);
 	
@@ -317,7 +507,7 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 		
 		if (var.isDynamic)
 		{
-			glVertexAttribPointer(var.location, var.count, GL_FLOAT, GL_FALSE, var.stride, var.data);
+			setAttributePointer(var.location, &var, base);
 		}
 		else
 		{
@@ -340,13 +530,79 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 		}
 	}
 	
-	// Draws the primitives.
-	glDrawElements(GL_TRIANGLES, _length, _dataType, _start);
+	// Draws the primitives, once to each instance when this polygon has instances.
+	if (isInstanced)
+	{
+		[self drawInstances];
+	}
+	else
+	{
+		[self drawElements];
+	}
 	
 	// Disables the dynamic locations.
 	setDynamicVariables(_variables, NO);
 }
 
+- (void) defineIndices:(UInt32)offset dataSize:(UInt32)dataSize base:(UInt32)base
+{
+	UInt32 i;
+	
+	_dataType = (dataSize == NGL_SIZE_USHORT) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	_dataTypeSize = dataSize;
+	_baseVertex = base;
+	
+	for (i = 0; i < NGL_LOD_LEVELS; ++i)
+	{
+		_starts[i] = (void *)(UInt64)offset;
+	}
+	
+	_start = _starts[_level];
+}
+
+- (void) defineLevel:(UInt32)level offset:(UInt32)offset length:(UInt32)length
+{
+	UInt32 i;
+	
+	for (i = MIN(level, NGL_LOD_LEVELS); i < NGL_LOD_LEVELS; ++i)
+	{
+		_starts[i] = (void *)(UInt64)offset;
+		_lengths[i] = length;
+	}
+}
+
+- (void) defineClusters:(UInt32)first count:(UInt32)count
+{
+	_clustersFirst = first;
+	_clustersCount = count;
+}
+
+- (void) useClusters:(const NGLCluster *)clusters visible:(const BOOL *)visible
+{
+	_clusters = clusters;
+	_visibleClusters = visible;
+}
+
+- (void) useInstances:(NGLES2Buffers *)buffers data:(const float *)data count:(UInt32)count
+{
+	_instances = buffers;
+	_instancesData = data;
+	_instancesCount = count;
+}
+
+- (void) defineBatch:(UInt32)level offset:(UInt32)offset dataSize:(UInt32)dataSize index:(UInt32)index
+{
+	UInt32 i;
+	
+	_batchDataType = (dataSize == NGL_SIZE_USHORT) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	_batchIndex = index;
+	
+	for (i = MIN(level, NGL_LOD_LEVELS); i < NGL_LOD_LEVELS; ++i)
+	{
+		_batchStarts[i] = (void *)(UInt64)offset;
+	}
+}
+
 - (void) drawPolygonTelemetry:(NGLvec4)color
 {
 	NGLES2Program *telemetry = telemetryProgram();
@@ -368,7 +624,7 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 	
 	telVar = *[telVars variableWithName:@"a_nglPosition"];
 	selfVar = *[selfVars variableWithName:@"a_nglPosition"];
-	glVertexAttribPointer(telVar.location, selfVar.count, GL_FLOAT, GL_FALSE, selfVar.stride, selfVar.data);
+	setAttributePointer(telVar.location, &selfVar, _baseVertex);
 	
 	telVar = *[telVars variableWithName:@"u_nglMVPMatrix"];
 	selfVar = *[selfVars variableWithName:@"u_nglMVPMatrix"];
@@ -379,7 +635,7 @@ static void setDynamicVariables(NGLSLVariables *variables, BOOL activate)
 	glUniform4fv(telVar.location, selfVar.count, selfVar.data);
 	
 	// Draws the primitives.
-	glDrawElements(GL_TRIANGLES, _length, _dataType, _start);
+	[self drawElements];
 	
 	// Disables the dynamic locations.
 	setDynamicVariables(telVars, NO);
@@ -30,6 +30,8 @@
 #import "NGLSLSource.h"
 #import "NGLSLConstructor.h"
 
+#import "NGLES2Functions.h"
+
 /*!
  *					<strong>(Internal only)</strong> Creates and makes use of OpenGL ES 2 Shader Programs.
  *
@@ -176,7 +176,7 @@ static GLuint _currentProgram;
 	[self compileShader:&fsh type:GL_FRAGMENT_SHADER data:fragment];
 	
 	// Creates the program name/index.
-	_name = glCreateProgram();
+	_name = ngles2CreateProgram();
 	
 	// Attaches the fragment and vertex shaders to current program.
 	glAttachShader(_name, vsh);
@@ -66,6 +66,28 @@
  */
 typedef float NGLmat4[16];
 
+/*!
+ *					A joint of a skeleton, in the mesh's space. The joints of a mesh are sorted with the
+ *					parents before their children, so the whole skeleton is evaluated in a single pass.
+ *
+ *	@see			nglSkinPalette
+ *
+ *	@var			NGLJoint::parent
+ *					The index of the parent joint or NGL_NOT_FOUND to the roots of the skeleton.
+ *
+ *	@var			NGLJoint::local
+ *					The rest transformation of the joint, relative to its parent.
+ *
+ *	@var			NGLJoint::bind
+ *					The inverse of the joint's world transformation in the bind pose.
+ */
+typedef struct
+{
+	UInt32	parent;
+	NGLmat4	local;
+	NGLmat4	bind;
+} NGLJoint;
+
 /*!
  *					Loads the identity matrix into a NGLmat4.
  *
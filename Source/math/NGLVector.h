@@ -84,6 +84,8 @@ NGL_API NGLvec4 nglColorFromRGBA(unsigned short r, unsigned short g, unsigned sh
  */
 NGL_API NGLvec4 nglColorFromHexadecimal(UInt32 hex);
 
+#ifndef NGL_HEADLESS
+
 /*!
  *					This function generates a color based on an CGColorRef, it must be in RGB color space.
  *	
@@ -114,6 +116,8 @@ NGL_API NGLvec4 nglColorFromUIColor(UIColor *uiColor);
  */
 NGL_API UIColor *nglColorToUIColor(NGLvec4 color);
 
+#endif
+
 /*!
  *					This function generates an hexadecimal color based on a NinevehGL color.
  *	
@@ -203,6 +207,8 @@ NGL_API UInt32 nglTelemetryIDFromColor(NGLvec4 color);
  */
 NGL_API NGLvec2 nglVec2Make(float x, float y);
 
+#ifndef NGL_HEADLESS
+
 /*!
  *					Creates a new NGLvec2 structure based on CGPoint.
  *	
@@ -223,6 +229,8 @@ NGL_API NGLvec2 nglVec2FromCGPoint(CGPoint point);
  */
 NGL_API CGPoint nglVec2ToCGPoint(NGLvec2 vec);
 
+#endif
+
 /*!
  *					Checks if informed vector is null.
  *
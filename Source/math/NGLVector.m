@@ -59,6 +59,8 @@ NGLvec4 nglColorFromHexadecimal(UInt32 hex)
 	return nglColorFromRGBA((hex >> 24) & 0xFF, (hex >> 16) & 0xFF, (hex >> 8) & 0xFF, (hex >> 0) & 0xFF);
 }
 
+#ifndef NGL_HEADLESS
+
 NGLvec4 nglColorFromCGColor(CGColorRef cgColor)
 {
 	NGLvec4 color = kNGLvec4Zero;
@@ -95,6 +97,8 @@ UIColor *nglColorToUIColor(NGLvec4 color)
 	return [UIColor colorWithRed:color.r green:color.g blue:color.b alpha:color.a];
 }
 
+#endif
+
 UInt32 nglColorToHexadecimal(NGLvec4 color)
 {
 	NGLivec4 rgba = (NGLivec4){ color.r * 255.0f, color.g * 255.0f, color.b * 255.0f, color.a * 255.0f };
@@ -139,6 +143,8 @@ NGLvec2 nglVec2Make(float x, float y)
 	return (NGLvec2){ x, y };
 }
 
+#ifndef NGL_HEADLESS
+
 NGLvec2 nglVec2FromCGPoint(CGPoint point)
 {
 	return (NGLvec2){ point.x, point.y };
@@ -149,6 +155,8 @@ CGPoint nglVec2ToCGPoint(NGLvec2 vec)
 	return (CGPoint){ vec.x, vec.y };
 }
 
+#endif
+
 BOOL nglVec2IsZero(NGLvec2 vec)
 {
 	return (vec.x == 0.0f && vec.y == 0.0f);
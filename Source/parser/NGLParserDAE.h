@@ -54,9 +54,11 @@
  *
  *					The supported features for the current NinevehGL version are:
  *
- *						- Libraries assets, images, materials, effects, geometries, visual_scenes, nodes;
+ *						- Libraries assets, images, materials, effects, geometries, controllers,
+ *							visual_scenes, nodes;
  *						- Polygons types: lines, triangle and all other polygons;
  *						- Transformations: all (individually and matrices);
+ *						- Skins: joints, bind poses and up to four weights per vertex (the strongest ones);
  *	
  *					NGLParserDAE works with an Error API which can inform about the problems in the COLLADA
  *					files and also indicates a possible solution to the error. However, it's important that
@@ -67,7 +69,8 @@
  *						- Normal data must have at least 3 values (x y z);
  *						- COLLADA files don't provide any support to the bump maps;
  *						- The unique faces cannot exceed 65535;
- *						- There is no support for animations, controls, cameras or lights.
+ *						- The skins can't have more than NGL_MAX_JOINTS joints in the whole file;
+ *						- There is no support for animations, morphs, cameras or lights.
  *						- There is no support to any kind of external third files.
  *	
  *					Even being the NGLParserDAE a fast parser, you should remember some important tips to
@@ -86,13 +89,11 @@
 	BOOL					_sCache;
 	
 	// Definitions
-	BOOL					_hasTexcoord;
-	//BOOL					_hasNormal;
-	
 	NSMutableDictionary		*_daeGeometries;
 	NSMutableDictionary		*_daeEffects;
 	NSMutableDictionary		*_daeImages;
 	NSMutableDictionary		*_daeMaterials;
+	NSMutableDictionary		*_daeControllers;
 	NSMutableDictionary		*_daeAllNodes;
 	NSMutableArray			*_daeSceneNodes;
 	NSMutableArray			*_daeParentNodes;
@@ -101,6 +102,10 @@
 	NGLmat4					**_matrices;
 	int						_mCount;
 	
+	NSMutableSet			*_skinNames;
+	NSMutableDictionary		*_jointKeys;
+	NGLmat4					*_jointWorlds;
+	
 	NSMutableDictionary		*_tempSource;
 	NSMutableDictionary		*_tempPolygon;
 	NSMutableArray			*_tempArray;
@@ -115,16 +120,21 @@
 	NSDictionary			*_attributes;
 	NSMutableString			*_content;
 	
-	int						_vOffset;
-	int						_vtOffset;
-	//int						_vnOffset;
-	NSArray					*_polyFaces;
-	
 	NSString				*_parent;
 	NSString				*_crossParam;
 	
+	// Streaming
+	void					*_streamValues;
+	UInt32					_streamCount;
+	UInt32					_streamCapacity;
+	UInt32					_streamCarryLength;
+	char					_streamCarry[64];
+	BOOL					_streamFloats;
+	BOOL					_streaming;
+	
 	// Material structure
 	NGLSurface				*_currentSurface;
+	unsigned int			_mtlCount;
 	
 	// Groups
 	NGLivec3				*_groups;
@@ -22,6 +22,7 @@
 
 #import "NGLParserDAE.h"
 
+#import "NGLJob.h"
 #import "NGLRegEx.h"
 
 #pragma mark -
@@ -36,6 +37,15 @@
 // COLLADA normals are very unoptimized and are defined for each single vertex (many times if necessary).
 //#define kDAENormals
 
+// Initial number of values reserved to the streamed arrays of numbers.
+#define DAE_STREAM_CAPACITY	1024
+
+// Maximum length of a number split between two pieces of streamed characters.
+#define DAE_STREAM_CARRY	64
+
+// Initial number of faces reserved to each polygon processed concurrently.
+#define DAE_FACES_CAPACITY	1024
+
 //*************************
 //	NGLParserDAE Errors
 //*************************
@@ -80,6 +90,9 @@ static NSString *const DAE_ERROR_NO_ST = @"Node without \"symbol\" or \"target\"
 By COLLADA specifications the symbol and target attributes are required\
 to the instance_material node of nodes.";
 
+static NSString *const DAE_ERROR_JOINTS = @"Exceeded the maximum number of joints.\n\
+The skins of a COLLADA file can be moved by up to %i joints, all the skins together.";
+
 //*************************
 //	COLLADA XML Patterns
 //*************************
@@ -100,6 +113,7 @@ static NSString *const DAE_LIB_IMG = @"library_images";
 static NSString *const DAE_LIB_MAT = @"library_materials";
 static NSString *const DAE_LIB_EFX = @"library_effects";
 static NSString *const DAE_LIB_GEO = @"library_geometries";
+static NSString *const DAE_LIB_CTR = @"library_controllers";
 static NSString *const DAE_LIB_VSC = @"library_visual_scenes";
 static NSString *const DAE_LIB_NOD = @"library_nodes";
 
@@ -141,6 +155,16 @@ static NSString *const DAE_GEO_POLY_LIST = @"polylist";
 static NSString *const DAE_GEO_TRIANGLES = @"triangles";
 static NSString *const DAE_GEO_POLYGONS = @"polygons";
 
+// Controllers
+static NSString *const DAE_CTR = @"controller";
+static NSString *const DAE_CTR_SKIN = @"skin";
+static NSString *const DAE_CTR_BIND_SHAPE = @"bind_shape_matrix";
+static NSString *const DAE_CTR_NAMES = @"Name_array";
+static NSString *const DAE_CTR_IDREFS = @"IDREF_array";
+static NSString *const DAE_CTR_JOINTS = @"joints";
+static NSString *const DAE_CTR_WEIGHTS = @"vertex_weights";
+static NSString *const DAE_CTR_V = @"v";
+
 // Visual Scenes and Nodes
 static NSString *const DAE_NODE = @"node";
 static NSString *const DAE_NODE_MATRIX = @"matrix";
@@ -149,6 +173,7 @@ static NSString *const DAE_NODE_SCALE = @"scale";
 static NSString *const DAE_NODE_TRANSLATE = @"translate";
 static NSString *const DAE_NODE_NODE = @"instance_node";
 static NSString *const DAE_NODE_GEOMETRY = @"instance_geometry";
+static NSString *const DAE_NODE_CONTROLLER = @"instance_controller";
 static NSString *const DAE_NODE_MATERIAL = @"instance_material";
 
 // Attributes
@@ -174,6 +199,9 @@ static NSString *const DAE_T = @"T";
 static NSString *const DAE_POSITION = @"POSITION";
 static NSString *const DAE_VERTEX = @"VERTEX";
 static NSString *const DAE_TEXCOORD = @"TEXCOORD";
+static NSString *const DAE_JOINT = @"JOINT";
+static NSString *const DAE_WEIGHT = @"WEIGHT";
+static NSString *const DAE_INV_BIND = @"INV_BIND_MATRIX";
 //static NSString *const DAE_NORMAL = @"NORMAL";
 
 //*************************
@@ -403,6 +431,88 @@ static NSString *const NGL_LIMIT = @"limit";
 
 @end
 
+//*************************
+//	Library Controllers
+//*************************
+
+/*!
+ *					<strong>(Internal only)</strong> Tiny class helps to hold and manage the necessary
+ *					memory to a library.
+ *
+ *					Holds the skin of one geometry: its bind shape, sources, inputs and influences. The
+ *					map from the skin's joints to the joints of the mesh is made after the scenes.
+ *
+ *					<strong>Sources</strong>
+ *					<pre>
+ *					Keys:           Values:
+ *					&lt;id&gt;            NSDictionary • array (NSData | NSArray)
+ *					</pre>
+ *
+ *					<strong>Joints</strong>
+ *					<pre>
+ *					Keys:           Values:
+ *
+ *					JOINT           Source URL (NSString)
+ *					INV_BIND_MATRIX Source URL (NSString)
+ *					</pre>
+ *
+ *					<strong>Weights</strong>
+ *					<pre>
+ *					Keys:           Values:
+ *
+ *					JOINT           NSDictionary • offset (NSString)
+ *					                             • semantic (NSString)
+ *					                             • source (NSString)
+ *					WEIGHT          NSDictionary • offset (NSString)
+ *					                             • semantic (NSString)
+ *					                             • source (NSString)
+ *					</pre>
+ */
+@interface DAEController : NSObject
+
+@property (nonatomic, retain) NSString *geometryId;
+@property (nonatomic, retain) NSArray *bindShape;
+@property (nonatomic, retain) NSData *vcount;
+@property (nonatomic, retain) NSData *influences;
+@property (nonatomic, retain) NSData *jointsMap;
+@property (nonatomic, readonly) NSMutableDictionary *sources;
+@property (nonatomic, readonly) NSMutableDictionary *joints;
+@property (nonatomic, readonly) NSMutableDictionary *weights;
+
+@end
+
+@implementation DAEController
+
+@synthesize geometryId, bindShape, vcount, influences, jointsMap, sources, joints, weights;
+
+- (id) init
+{
+	if ((self = [super init]))
+	{
+		sources = [[NSMutableDictionary alloc] init];
+		joints = [[NSMutableDictionary alloc] init];
+		weights = [[NSMutableDictionary alloc] init];
+	}
+	
+	return self;
+}
+
+- (void) dealloc
+{
+	nglRelease(geometryId);
+	nglRelease(bindShape);
+	nglRelease(vcount);
+	nglRelease(influences);
+	nglRelease(jointsMap);
+	nglRelease(sources);
+	nglRelease(joints);
+	nglRelease(weights);
+	
+	[super dealloc];
+}
+
+@end
+
 //*************************
 //	Library Visual Scenes
 //*************************
@@ -411,8 +521,8 @@ static NSString *const NGL_LIMIT = @"limit";
  *					<strong>(Internal only)</strong> Tiny class helps to hold and manage the necessary
  *					memory to a library.
  *
- *					Holds its own id, its parent node, sub nodes, an array of nodes instances, an array
- *					of transformations and geometries.
+ *					Holds its own id, sid and name, its parent node, sub nodes, an array of nodes
+ *					instances, an array of transformations, geometries and controllers.
  *
  *					<strong>Instances</strong>
  *					<pre>
@@ -435,6 +545,12 @@ static NSString *const NGL_LIMIT = @"limit";
  *					&lt;id&gt;            Source URL (NSString)
  *					</pre>
  *
+ *					<strong>Controllers</strong>
+ *					<pre>
+ *					Keys:           Values:
+ *					&lt;id&gt;            Source URL (NSString)
+ *					</pre>
+ *
  *					<strong>Nodes</strong>
  *					<pre>
  *					Elements:
@@ -444,17 +560,20 @@ static NSString *const NGL_LIMIT = @"limit";
 @interface DAEVisualNode : NSObject
 
 @property (nonatomic, retain) NSString *selfId;
+@property (nonatomic, retain) NSString *sid;
+@property (nonatomic, retain) NSString *name;
 @property (nonatomic, retain) NSString *parent;
 @property (nonatomic, readonly) NSMutableArray *instances;
 @property (nonatomic, readonly) NSMutableArray *transforms;
 @property (nonatomic, readonly) NSMutableDictionary *geometries;
+@property (nonatomic, readonly) NSMutableDictionary *controllers;
 @property (nonatomic, readonly) NSMutableArray *nodes;
 
 @end
 
 @implementation DAEVisualNode
 
-@synthesize selfId, parent, instances, transforms, geometries, nodes;
+@synthesize selfId, sid, name, parent, instances, transforms, geometries, controllers, nodes;
 
 - (id) init
 {
@@ -463,6 +582,7 @@ static NSString *const NGL_LIMIT = @"limit";
 		instances = [[NSMutableArray alloc] init];
 		transforms = [[NSMutableArray alloc] init];
 		geometries = [[NSMutableDictionary alloc] init];
+		controllers = [[NSMutableDictionary alloc] init];
 		nodes = [[NSMutableArray alloc] init];
 	}
 	
@@ -472,10 +592,13 @@ static NSString *const NGL_LIMIT = @"limit";
 - (void) dealloc
 {
 	nglRelease(selfId);
+	nglRelease(sid);
+	nglRelease(name);
 	nglRelease(parent);
 	nglRelease(instances);
 	nglRelease(transforms);
 	nglRelease(geometries);
+	nglRelease(controllers);
 	nglRelease(nodes);
 	
 	[super dealloc];
@@ -523,6 +646,7 @@ typedef enum
 	DaePhaseImages,
 	DaePhaseEffects,
 	DaePhaseGeometry,
+	DaePhaseControllers,
 } DaePhase;
 
 DaePhase			_phase;
@@ -536,11 +660,48 @@ typedef enum
 
 DaeUpAxis			_upAxis;
 
+// A polygon (primitive) of a geometry instance. The inputs are resolved in the scene order,
+// the outputs are built by any thread and merged back into the parser in the same order.
+typedef struct
+{
+	// Inputs
+	NSDictionary		*polygon;
+	DAEGeometry			*geometry;
+	NSString			*geometryKey;
+	DAEController		*controller;
+	NGLmat4				matrix;
+	NGLmat4				rotMatrix;
+	unsigned short		identifier;
+	BOOL				newGroup;
+	
+	// Outputs
+	float				*vertices;
+	UInt32				vCount;
+	float				*texcoords;
+	UInt32				tCount;
+	float				*boneIndices;
+	float				*boneWeights;
+#ifdef kDAENormals
+	float				*normals;
+	UInt32				nCount;
+	BOOL				hasNormal;
+	int					vnOffset;
+#endif
+	UInt32				*faces;
+	UInt32				facesCount;
+	UInt32				fCapacity;
+	BOOL				hasTexcoord;
+	int					vOffset;
+	int					vtOffset;
+	NSString			*error;
+} DAEPolygon;
+
 // Temporary variables to work with COLLADA XML Libraries.
 DAEGeometry			*_actualGeometry;
 DAEEffect			*_actualEffect;
 DAEImage			*_actualImage;
 DAEMaterial			*_actualMaterial;
+DAEController		*_actualController;
 DAEVisualNode		*_actualNode;
 
 #pragma mark -
@@ -549,9 +710,6 @@ DAEVisualNode		*_actualNode;
 //	Private Functions
 //**************************************************
 
-// Global count to the materials created by this parse.
-static unsigned int _mtlCount;
-
 // Extracts the "id" format from a COLLADA XML url or source.
 static NSString *daeGetId(NSString *urlOrSource)
 {
@@ -568,6 +726,454 @@ static void daeSetString(NSString **target, NSString *newString)
 	}
 }
 
+// Creates a NSData with a single polygon limit. Where -1 means undefined.
+static NSData *daeLimitData(int limit)
+{
+	return [NSData dataWithBytes:&limit length:NGL_SIZE_INT];
+}
+
+// Creates the correction to the COLLADA up axis, in the same transposed order of the nodes' matrices.
+// The corrections as following:
+// Value     Right Axis      Up Axis        In Axis
+// X-UP      Negative y     Positive x     Positive z  (not noticed yet)
+// Y_UP      Positive x     Positive y     Positive z  (majority of 3D softwares)
+// Z_UP      Positive x     Positive z     Negative y  (3DS Max, Blender, Google SketchUp)
+static void daeUpAxisMatrix(NGLmat4 matrix)
+{
+	NGLQuaternion *quat = [[NGLQuaternion alloc] init];
+	
+	switch (_upAxis)
+	{
+		case DaeUpAxisY:
+			// Doesn't change anything here.
+			break;
+		case DaeUpAxisZ:
+			[quat rotateByAxis:(NGLvec3){1.0f,0.0f,0.0f} angle:90.0f mode:NGLAddModeSet];
+			break;
+		case DaeUpAxisX:
+			[quat rotateByAxis:(NGLvec3){0.0f,0.0f,1.0f} angle:-90.0f mode:NGLAddModeSet];
+			break;
+	}
+	
+	nglMatrixCopy(*quat.matrix, matrix);
+	nglRelease(quat);
+}
+
+// Places a matrix of the skeleton in the corrected up axis, M' = U * M * U^-1. The joints are not transposed,
+// so the correction is the transposed one.
+static void daeUpAxisJoint(NGLmat4 original, NGLmat4 result)
+{
+	NGLmat4 correction, transposed;
+	
+	daeUpAxisMatrix(correction);
+	nglMatrixTranspose(correction, transposed);
+	nglMatrixMultiply(transposed, original, result);
+	nglMatrixMultiply(result, correction, result);
+}
+
+// Gets the names of the joints of a skin.
+static NSArray *daeJointNames(DAEController *controller)
+{
+	NSString *sourceId = [controller.joints objectForKey:DAE_JOINT];
+	NSArray *names = [[controller.sources objectForKey:sourceId] objectForKey:NGL_ARRAY];
+	
+	return ([names isKindOfClass:[NSArray class]]) ? names : [NSArray array];
+}
+
+// Adds a face to the polygon. The indices are kept local, the groups are applied in the merge.
+static void daeAddFace(DAEPolygon *poly, const UInt32 *indices, int index)
+{
+	UInt32 *faces;
+	
+	if (poly->facesCount == poly->fCapacity)
+	{
+		poly->fCapacity = MAX(poly->fCapacity * 2, DAE_FACES_CAPACITY);
+		poly->faces = realloc(poly->faces, NGL_SIZE_UINT * 3 * poly->fCapacity);
+	}
+	
+	faces = poly->faces + (poly->facesCount * 3);
+	
+	*faces++ = indices[index + poly->vOffset];
+	*faces++ = (poly->hasTexcoord) ? indices[index + poly->vtOffset] : 0;
+#ifdef kDAENormals
+	*faces = (poly->hasNormal) ? indices[index + poly->vnOffset] : 0;
+#else
+	*faces = 0;
+#endif
+	
+	++poly->facesCount;
+}
+
+// Builds the joints and weights of each position of a skinned polygon. Only the four strongest influences
+// are kept, the weights of the other ones are shared among them. The influences out of the skeleton, like
+// the bind shape (joint -1), keep their weights in the bind pose.
+static void daeProcessSkin(DAEPolygon *poly)
+{
+	DAEController *controller = poly->controller;
+	NSDictionary *jointInput = [controller.weights objectForKey:DAE_JOINT];
+	NSDictionary *weightInput = [controller.weights objectForKey:DAE_WEIGHT];
+	NSString *sourceId = daeGetId([weightInput objectForKey:DAE_ATT_SOURCE]);
+	NSData *data = [[controller.sources objectForKey:sourceId] objectForKey:NGL_ARRAY];
+	const float *weights = [data bytes];
+	const float *influences = [controller.influences bytes];
+	const UInt32 *vcount = [controller.vcount bytes];
+	const UInt32 *map = [controller.jointsMap bytes];
+	NSUInteger weightsCount = [data length] / NGL_SIZE_FLOAT;
+	NSUInteger influencesCount = [controller.influences length] / NGL_SIZE_FLOAT;
+	NSUInteger mapCount = [controller.jointsMap length] / NGL_SIZE_UINT;
+	NSUInteger jointOffset = [[jointInput objectForKey:DAE_ATT_OFFSET] intValue];
+	NSUInteger weightOffset = [[weightInput objectForKey:DAE_ATT_OFFSET] intValue];
+	NSUInteger stride = MAX(jointOffset, weightOffset) + 1;
+	NSUInteger i, j, k, first, length;
+	float *indices, *values, weight, valid, kept, total;
+	int joint, index;
+	UInt32 boneJoint;
+	
+	poly->boneIndices = calloc(poly->vCount * 4, NGL_SIZE_FLOAT);
+	poly->boneWeights = calloc(poly->vCount * 4, NGL_SIZE_FLOAT);
+	
+	// Each position has its own number of influences, one after another.
+	length = MIN([controller.vcount length] / NGL_SIZE_UINT, poly->vCount);
+	for (i = 0, first = 0; i < length; ++i)
+	{
+		indices = poly->boneIndices + (i * 4);
+		values = poly->boneWeights + (i * 4);
+		valid = total = 0.0f;
+		
+		for (j = first; j < first + vcount[i] && (j + 1) * stride <= influencesCount; ++j)
+		{
+			joint = (int)influences[j * stride + jointOffset];
+			index = (int)influences[j * stride + weightOffset];
+			weight = (index >= 0 && (NSUInteger)index < weightsCount) ? weights[index] : 0.0f;
+			boneJoint = (joint >= 0 && (NSUInteger)joint < mapCount) ? map[joint] : NGL_NOT_FOUND;
+			total += MAX(weight, 0.0f);
+			
+			if (weight <= 0.0f || boneJoint == NGL_NOT_FOUND)
+			{
+				continue;
+			}
+			
+			valid += weight;
+			
+			// Keeps the strongest influences sorted by their weights.
+			for (k = 4; k > 0 && values[k - 1] < weight; --k)
+			{
+				if (k < 4)
+				{
+					values[k] = values[k - 1];
+					indices[k] = indices[k - 1];
+				}
+			}
+			
+			if (k < 4)
+			{
+				values[k] = weight;
+				indices[k] = boneJoint;
+			}
+		}
+		
+		// The weights are never greater than 1.0 all together.
+		kept = values[0] + values[1] + values[2] + values[3];
+		if (kept > 0.0f)
+		{
+			weight = valid / kept / MAX(total, 1.0f);
+			
+			for (k = 0; k < 4; ++k)
+			{
+				values[k] *= weight;
+			}
+		}
+		
+		first += vcount[i];
+	}
+}
+
+// Builds the vertices, texture coordinates and faces of a polygon. It only reads from the COLLADA
+// libraries, which are complete at this point, so many polygons can be processed at the same time.
+static void daeProcessPolygon(DAEPolygon *poly)
+{
+	// Polygons (primitives) and its structures.
+	int sourceOrder, sourceStride, sourceOffset;
+	NSDictionary *polygon = poly->polygon;
+	DAEGeometry *daeGeometry = poly->geometry;
+	NSDictionary *source;
+	NSString *sourceId;
+	NSArray *array;
+	NSData *data;
+	const float *floats;
+	float *values;
+	
+	// Vertices and Normals.
+	NGLvec3 v;
+#ifdef kDAENormals
+	NGLvec3 vn;
+#endif
+	
+	// Faces.
+	int faceStride, faceLimit, faceLoop;
+	int firstIndex;
+	NSDictionary *input;
+	const UInt32 *indices;
+	const int *limits;
+	NSUInteger limit, limitsCount;
+	
+	// Loop elements.
+	NSUInteger i, length;
+	NSUInteger j, lengthJ;
+	
+	// Geometries without polygons only open a new group.
+	if (polygon == nil)
+	{
+		return;
+	}
+	
+	//*************************
+	//	Vertices
+	//*************************
+	
+	sourceId = daeGetId([[polygon objectForKey:DAE_VERTEX] objectForKey:DAE_ATT_SOURCE]);
+	
+	// The "VERTEX" semantic is mandatory to any kind of polygon.
+	if (sourceId == nil)
+	{
+		daeSetString(&poly->error, [NSString stringWithFormat:DAE_ERROR_NO_VERTEX, poly->geometryKey]);
+	}
+	
+	// Checks if the "VERTEX" semantic reffers against the vertices node or source directly.
+	if ([daeGeometry.verticesId isEqualToString:sourceId])
+	{
+		sourceId = [daeGeometry.vertices objectForKey:DAE_POSITION];
+	}
+	
+	// Gets the correct source refferenced by the "VERTEX" semantic.
+	source = [daeGeometry.sources objectForKey:sourceId];
+	
+	// Checks if the source exist in COLLADA XML context.
+	if (source == nil)
+	{
+		daeSetString(&poly->error, [NSString stringWithFormat:DAE_ERROR_NULL_REF, sourceId]);
+	}
+	
+	// Gets the array of floats from the source.
+	data = [source objectForKey:NGL_ARRAY];
+	floats = [data bytes];
+	
+	// Opitional parameters Order, Stride and Offset.
+	sourceOrder = [[source objectForKey:NGL_ORDER] intValue];
+	sourceStride = [[source objectForKey:NGL_STRIDE] intValue];
+	sourceOffset = [[source objectForKey:NGL_OFFSET] intValue];
+	sourceOrder = (sourceOrder == 0) ? kDefaultOrder : sourceOrder;
+	sourceStride = (sourceStride == 0) ? kDefaultStrideV : sourceStride;
+	
+	// The number of vertices is known in advance, so the buffer is allocated only once.
+	length = [data length] / NGL_SIZE_FLOAT;
+	poly->vCount = (length >= (NSUInteger)(sourceOffset + sourceStride)) ? (UInt32)((length - sourceOffset) / sourceStride) : 0;
+	poly->vertices = malloc(poly->vCount * NGL_SIZE_VEC4);
+	values = poly->vertices;
+	
+	for (i = sourceOffset; i + sourceStride <= length; i += sourceStride)
+	{
+		v.x = floats[i + (sourceOrder >> 16 & 0xFF)];
+		v.y = floats[i + (sourceOrder >> 8 & 0xFF)];
+		v.z = floats[i + (sourceOrder >> 0 & 0xFF)];
+		
+		// Applies all transformations to each vertex.
+		v = nglVec3ByMatrixTransposed(v, poly->matrix);
+		
+		*values++ = v.x;
+		*values++ = v.y;
+		*values++ = v.z;
+		*values++ = 1.0f;
+	}
+	
+	//*************************
+	//	Skin
+	//*************************
+	
+	// The influences are given to the same positions of the vertices.
+	if (poly->controller != nil)
+	{
+		daeProcessSkin(poly);
+	}
+	
+	//*************************
+	//	Texture Coordinates
+	//*************************
+	
+	// Gets the correct TEXCOORD source.
+	// It could lie directly in the polygons input or in the vertices inputs.
+	sourceId = daeGetId([[polygon objectForKey:DAE_TEXCOORD] objectForKey:DAE_ATT_SOURCE]);
+	sourceId = (sourceId == nil) ? [daeGeometry.vertices objectForKey:DAE_TEXCOORD] : sourceId;
+	
+	// Gets the correct source refferenced by the "TEXCOORD" semantic.
+	source = [daeGeometry.sources objectForKey:sourceId];
+	
+	poly->hasTexcoord = (source != nil);
+	
+	if (poly->hasTexcoord)
+	{
+		// Gets the array of floats from the source.
+		data = [source objectForKey:NGL_ARRAY];
+		floats = [data bytes];
+		
+		// Opitional parameters Order, Stride and Offset.
+		sourceOrder = [[source objectForKey:NGL_ORDER] intValue];
+		sourceStride = [[source objectForKey:NGL_STRIDE] intValue];
+		sourceOffset = [[source objectForKey:NGL_OFFSET] intValue];
+		sourceOrder = (sourceOrder == 0) ? kDefaultOrder : sourceOrder;
+		sourceStride = (sourceStride == 0) ? kDefaultStrideVT : sourceStride;
+		
+		length = [data length] / NGL_SIZE_FLOAT;
+		poly->tCount = (length >= (NSUInteger)(sourceOffset + sourceStride)) ? (UInt32)((length - sourceOffset) / sourceStride) : 0;
+		poly->texcoords = malloc(poly->tCount * NGL_SIZE_VEC2);
+		values = poly->texcoords;
+		
+		for (i = sourceOffset; i + sourceStride <= length; i += sourceStride)
+		{
+			*values++ = floats[i + (sourceOrder >> 16 & 0xFF)];
+			*values++ = floats[i + (sourceOrder >> 8 & 0xFF)];
+		}
+	}
+	
+#ifdef kDAENormals
+	//*************************
+	//	Normals
+	//*************************
+	
+	// Gets the correct NORMAL source.
+	// It could lie directly in the polygons input or in the vertices inputs.
+	sourceId = daeGetId([[polygon objectForKey:DAE_NORMAL] objectForKey:DAE_ATT_SOURCE]);
+	sourceId = (sourceId == nil) ? [daeGeometry.vertices objectForKey:DAE_NORMAL] : sourceId;
+	
+	// Gets the correct source refferenced by the "NORMAL" semantic.
+	source = [daeGeometry.sources objectForKey:sourceId];
+	
+	poly->hasNormal = (source != nil);
+	
+	if (poly->hasNormal)
+	{
+		// Gets the array of floats from the source.
+		data = [source objectForKey:NGL_ARRAY];
+		floats = [data bytes];
+		
+		// Opitional parameters Order, Stride and Offset.
+		sourceOrder = [[source objectForKey:NGL_ORDER] intValue];
+		sourceStride = [[source objectForKey:NGL_STRIDE] intValue];
+		sourceOffset = [[source objectForKey:NGL_OFFSET] intValue];
+		sourceOrder = (sourceOrder == 0) ? kDefaultOrder : sourceOrder;
+		sourceStride = (sourceStride == 0) ? kDefaultStrideVN : sourceStride;
+		
+		length = [data length] / NGL_SIZE_FLOAT;
+		poly->nCount = (length >= (NSUInteger)(sourceOffset + sourceStride)) ? (UInt32)((length - sourceOffset) / sourceStride) : 0;
+		poly->normals = malloc(poly->nCount * NGL_SIZE_VEC3);
+		values = poly->normals;
+		
+		for (i = sourceOffset; i + sourceStride <= length; i += sourceStride)
+		{
+			vn.x = floats[i + (sourceOrder >> 16 & 0xFF)];
+			vn.y = floats[i + (sourceOrder >> 8 & 0xFF)];
+			vn.z = floats[i + (sourceOrder >> 0 & 0xFF)];
+			
+			// Applies only the rotations transformations to each normal.
+			// Normals are always given in local space and must be adjusted only with rotations.
+			vn = nglVec3Normalize(nglVec3ByMatrixTransposed(vn, poly->rotMatrix));
+			
+			*values++ = vn.x;
+			*values++ = vn.y;
+			*values++ = vn.z;
+		}
+	}
+#endif
+	//*************************
+	//	Faces
+	//*************************
+	
+	// Gets array of faces to construct the polygon.
+	array = [polygon objectForKey:NGL_ARRAY];
+	
+	// Gets the face stride and limit of each polygon.
+	faceStride = [[polygon objectForKey:NGL_STRIDE] intValue];
+	data = [polygon objectForKey:NGL_LIMIT];
+	limits = [data bytes];
+	limitsCount = [data length] / NGL_SIZE_INT;
+	limit = 0;
+	faceLimit = (limitsCount > 0) ? limits[limit] : -1;
+	
+	// Gets the offset to vertex element.
+	input = [polygon objectForKey:DAE_VERTEX];
+	poly->vOffset = [[input objectForKey:DAE_ATT_OFFSET] intValue];
+	
+	// Gets the texcoord offset from the normal element.
+	// Assumes the vertex offset if there is no explict texcoord element.
+	input = [polygon objectForKey:DAE_TEXCOORD];
+	poly->vtOffset = (input != nil) ? [[input objectForKey:DAE_ATT_OFFSET] intValue] : poly->vOffset;
+#ifdef kDAENormals
+	// Gets the normal offset from the normal element.
+	// Assumes the vertex offset if there is no explict normal element.
+	input = [polygon objectForKey:DAE_NORMAL];
+	poly->vnOffset = (input != nil) ? [[input objectForKey:DAE_ATT_OFFSET] intValue] : poly->vOffset;
+#endif
+	// Loops through each set of faces defined in COLLADA XML to the current polygon.
+	length = [array count];
+	for (i = 0; i < length; ++i)
+	{
+		// Takes the face references already parsed into integers.
+		data = [array objectAtIndex:i];
+		indices = [data bytes];
+		
+		// Resets the face loop and first index.
+		faceLoop = firstIndex = 0;
+		
+		// Loops through each value in the faces array respecting the stride.
+		lengthJ = [data length] / NGL_SIZE_UINT;
+		for (j = 0; j + faceStride <= lengthJ; j += faceStride)
+		{
+			// If the current face forms a polygon which has more than 3 vertices,
+			// re-constructs the current face to turn it into multiple triangles.
+			if (faceLoop >= 3)
+			{
+				daeAddFace(poly, indices, firstIndex);
+				daeAddFace(poly, indices, (int)j - faceStride);
+			}
+			
+			// Processes the current face.
+			daeAddFace(poly, indices, (int)j);
+			
+			// Sums one more vertex to the current face.
+			++faceLoop;
+			
+			// Checks if the current face is complete.
+			if (faceLoop == faceLimit)
+			{
+				// Dealing with lines, lines will be transformed into triangles.
+				if (faceLimit == 2)
+				{
+					daeAddFace(poly, indices, firstIndex);
+				}
+				
+				// Gets information to the next face.
+				firstIndex = (int)j + 1;
+				faceLoop = 0;
+				faceLimit = (++limit < limitsCount) ? limits[limit] : faceLimit;
+			}
+		}
+	}
+}
+
+// Frees the outputs of a polygon.
+static void daeFreePolygon(DAEPolygon *poly)
+{
+	nglFree(poly->vertices);
+	nglFree(poly->texcoords);
+	nglFree(poly->boneIndices);
+	nglFree(poly->boneWeights);
+#ifdef kDAENormals
+	nglFree(poly->normals);
+#endif
+	nglFree(poly->faces);
+	nglRelease(poly->error);
+}
+
 #pragma mark -
 #pragma mark Private Definitions
 //**************************************************
@@ -583,14 +1189,27 @@ static void daeSetString(NSString **target, NSString *newString)
 - (NGLTexture *) makeMapTo:(NSString *)filePath;
 
 - (void) defineStride;
-- (void) defineFaceTo:(int)index;
+- (void) mergePolygon:(DAEPolygon *)polygon;
 
 - (unsigned short) makeIdentifierTo:(NSString *)effectKey;
 - (void) defineMatricesTo:(DAEVisualNode *)node final:(NGLmat4)matrix rotation:(NGLmat4)rotMatrix;
-
-- (void) parseNode:(DAEVisualNode *)daeNode;
+- (UInt32) defineJointTo:(DAEVisualNode *)node parent:(UInt32)parentJoint;
+- (void) defineSkinTo:(DAEController *)controller;
+
+- (void) parseGeometry:(NSString *)geometryKey
+			  instance:(NSDictionary *)instance
+			controller:(DAEController *)controller
+				matrix:(NGLmat4)matrix
+			  rotation:(NGLmat4)rotMatrix
+				  into:(NSMutableData *)polygons;
+- (void) parseNode:(DAEVisualNode *)daeNode joint:(UInt32)parentJoint into:(NSMutableData *)polygons;
 - (void) parseDAE;
 
+- (void) startStreamWithCapacity:(UInt32)capacity floats:(BOOL)floats;
+- (void) streamValuesFrom:(const char *)bytes to:(const char *)end;
+- (void) streamCharacters:(NSString *)characters;
+- (NSData *) finishStream;
+
 - (void) parserXML;
 
 @end
@@ -709,29 +1328,131 @@ static void daeSetString(NSString **target, NSString *newString)
 		_stride += 3;
 	}
 #endif
+	// Defines the bones as 4 floats each, if needed. They use the same index of the vertex.
+	if (_jointsCount > 0)
+	{
+		[_meshElements addElement:(NGLElement){NGLComponentBoneIndices, _stride, 4, 0}];
+		_stride += 4;
+		[_meshElements addElement:(NGLElement){NGLComponentBoneWeights, _stride, 4, 0}];
+		_stride += 4;
+	}
+	
 	_sCache = NO;
 }
 
-- (void) defineFaceTo:(int)index
+- (void) mergePolygon:(DAEPolygon *)polygon
 {
+	UInt32 i, length;
 	UInt32 *faces;
+	const UInt32 *polyFaces;
 	NGLivec3 vGroup;
 	
-	_faces = realloc(_faces, NGL_SIZE_INT * (++_facesCount * _facesStride));
-	faces = _faces + ((_facesCount - 1) * _facesStride);
+	// Updates the faces group based on current geometry.
+	// AS to COLLADA XML, each geometry instance can has only one material bound.
+	// Each geometry represents a surface onto a mesh to NinevehGL.
+	if (polygon->newGroup)
+	{
+		[self updateGroups];
+	}
+	
+	// Geometries without polygons have nothing more to merge.
+	if (polygon->polygon == nil)
+	{
+		return;
+	}
+	
+	// Errors are reported in the same order as they were found.
+	if (polygon->error != nil)
+	{
+		_error.message = polygon->error;
+	}
+	
+	//*************************
+	//	Surfaces
+	//*************************
+	
+	// Creates a new surface to deal with this polygon.
+	nglRelease(_currentSurface);
+	_currentSurface = [[NGLSurface alloc] initWithStart:_facesCount
+												 length:polygon->facesCount
+											 identifier:polygon->identifier];
+	
+	// Adds the created surface to the surfaces library.
+	[_surface addSurface:_currentSurface];
+	
+	//*************************
+	//	Vertices, Texcoords and Normals
+	//*************************
+	
+	if (polygon->vCount > 0)
+	{
+		// The bones follow the vertices, the polygons without skin stay in the bind pose.
+		if (_jointsCount > 0)
+		{
+			_boneIndices = realloc(_boneIndices, (_vCount + polygon->vCount) * NGL_SIZE_VEC4);
+			_boneWeights = realloc(_boneWeights, (_vCount + polygon->vCount) * NGL_SIZE_VEC4);
+			
+			if (polygon->boneIndices != NULL)
+			{
+				memcpy(_boneIndices + (_vCount * 4), polygon->boneIndices, polygon->vCount * NGL_SIZE_VEC4);
+				memcpy(_boneWeights + (_vCount * 4), polygon->boneWeights, polygon->vCount * NGL_SIZE_VEC4);
+			}
+			else
+			{
+				memset(_boneIndices + (_vCount * 4), 0, polygon->vCount * NGL_SIZE_VEC4);
+				memset(_boneWeights + (_vCount * 4), 0, polygon->vCount * NGL_SIZE_VEC4);
+			}
+		}
+		
+		_vertices = realloc(_vertices, (_vCount + polygon->vCount) * NGL_SIZE_VEC4);
+		memcpy(_vertices + (_vCount * 4), polygon->vertices, polygon->vCount * NGL_SIZE_VEC4);
+		_vCount += polygon->vCount;
+	}
+	
+	if (polygon->tCount > 0)
+	{
+		_texcoords = realloc(_texcoords, (_tCount + polygon->tCount) * NGL_SIZE_VEC2);
+		memcpy(_texcoords + (_tCount * 2), polygon->texcoords, polygon->tCount * NGL_SIZE_VEC2);
+		_tCount += polygon->tCount;
+	}
+#ifdef kDAENormals
+	if (polygon->nCount > 0)
+	{
+		_normals = realloc(_normals, (_nCount + polygon->nCount) * NGL_SIZE_VEC3);
+		memcpy(_normals + (_nCount * 3), polygon->normals, polygon->nCount * NGL_SIZE_VEC3);
+		_nCount += polygon->nCount;
+	}
+#endif
+	
+	//*************************
+	//	Faces
+	//*************************
+	
+	length = polygon->facesCount;
+	if (length == 0)
+	{
+		return;
+	}
+	
+	_faces = realloc(_faces, NGL_SIZE_UINT * ((_facesCount + length) * _facesStride));
+	faces = _faces + (_facesCount * _facesStride);
+	polyFaces = polygon->faces;
 	
 	vGroup = _groups[_currentGrp];
 	
-	// Must devide because the entire NGLMesh must has the same structure.
-	*faces++ = [[_polyFaces objectAtIndex:index + _vOffset] intValue] + vGroup.x;
-	*faces++ = (_hasTexcoord) ? [[_polyFaces objectAtIndex:index + _vtOffset] intValue] + vGroup.y : 0;
+	for (i = 0; i < length; ++i)
+	{
+		// Must devide because the entire NGLMesh must has the same structure.
+		*faces++ = *polyFaces++ + vGroup.x;
+		*faces++ = *polyFaces++ + ((polygon->hasTexcoord) ? vGroup.y : 0);
 #ifdef kDAENormals
-	*faces = (_hasNormal) ? [[_polyFaces objectAtIndex:index + _vnOffset] intValue] + vGroup.z : 0;
+		*faces++ = *polyFaces++ + ((polygon->hasNormal) ? vGroup.z : 0);
 #else
-	*faces = 0;
+		*faces++ = *polyFaces++;
 #endif
+	}
 	
-	++_currentSurface.lengthData;
+	_facesCount += length;
 }
 
 - (void) defineMatricesTo:(DAEVisualNode *)node final:(NGLmat4)matrix rotation:(NGLmat4)rotMatrix
@@ -845,26 +1566,11 @@ static void daeSetString(NSString **target, NSString *newString)
 	[_transformations setObject:index forKey:node.selfId];
 	++_mCount;
 	
-	// Correction to COLLADA Axis as following:
-	// Value     Right Axis      Up Axis        In Axis
-	// X-UP      Negative y     Positive x     Positive z  (not noticed yet)
-	// Y_UP      Positive x     Positive y     Positive z  (majority of 3D softwares)
-	// Z_UP      Positive x     Positive z     Negative y  (3DS Max, Blender, Google SketchUp)
-	switch (_upAxis)
+	// Before any other transformation, corrects the COLLADA axis.
+	if (_upAxis != DaeUpAxisY)
 	{
-		case DaeUpAxisY:
-			// Doesn't change anything here.
-			break;
-		case DaeUpAxisZ:
-			// Before any other transformation, corrects the COLLADA axis.
-			[quat rotateByAxis:(NGLvec3){1.0f,0.0f,0.0f} angle:90.0f mode:NGLAddModeSet];
-			nglMatrixMultiply(matrix, *quat.matrix, matrix);
-			break;
-		case DaeUpAxisX:
-			// Before any other transformation, corrects the COLLADA axis.
-			[quat rotateByAxis:(NGLvec3){0.0f,0.0f,1.0f} angle:-90.0f mode:NGLAddModeSet];
-			nglMatrixMultiply(matrix, *quat.matrix, matrix);
-			break;
+		daeUpAxisMatrix(tempMatrix);
+		nglMatrixMultiply(matrix, tempMatrix, matrix);
 	}
 #ifdef kDAENormals
 	// Isolates the rotation matrix. It will be used to correct the normals.
@@ -873,6 +1579,189 @@ static void daeSetString(NSString **target, NSString *newString)
 	nglRelease(quat);
 }
 
+- (UInt32) defineJointTo:(DAEVisualNode *)node parent:(UInt32)parentJoint
+{
+	NSString *key = nil;
+	NSArray *names;
+	NSNumber *index;
+	NGLmat4 local, inverse;
+	NGLJoint *joint;
+	
+	// The skins reffer to their joints by the sid, the id or the name of the nodes.
+	if (node.sid != nil && [_skinNames containsObject:node.sid])
+	{
+		key = node.sid;
+	}
+	else if ([_skinNames containsObject:node.selfId])
+	{
+		key = node.selfId;
+	}
+	else if (node.name != nil && [_skinNames containsObject:node.name])
+	{
+		key = node.name;
+	}
+	
+	// The other nodes are not joints, but they still move the joints below them.
+	if (key == nil)
+	{
+		return parentJoint;
+	}
+	
+	// A node instanced many times is always the same joint.
+	if ((index = [_jointKeys objectForKey:key]) != nil)
+	{
+		return [index unsignedIntValue];
+	}
+	
+	if (_jointsCount >= NGL_MAX_JOINTS)
+	{
+		_error.message = [NSString stringWithFormat:DAE_ERROR_JOINTS, NGL_MAX_JOINTS];
+		return parentJoint;
+	}
+	
+	names = [_jointNames arrayByAddingObject:key];
+	nglRelease(_jointNames);
+	_jointNames = [names retain];
+	[_jointKeys setObject:[NSNumber numberWithUnsignedInt:_jointsCount] forKey:key];
+	
+	_joints = realloc(_joints, (_jointsCount + 1) * sizeof(NGLJoint));
+	_jointWorlds = realloc(_jointWorlds, (_jointsCount + 1) * NGL_SIZE_MAT4);
+	joint = &_joints[_jointsCount];
+	joint->parent = parentJoint;
+	
+	// The final matrices of the nodes are transposed.
+	index = [_transformations objectForKey:node.selfId];
+	nglMatrixTranspose(*_matrices[[index intValue]], _jointWorlds[_jointsCount]);
+	
+	// The rest transformation is relative to the parent joint, including the nodes between them.
+	if (parentJoint != NGL_NOT_FOUND)
+	{
+		nglMatrixInverse(_jointWorlds[parentJoint], inverse);
+		nglMatrixMultiply(inverse, _jointWorlds[_jointsCount], local);
+	}
+	else
+	{
+		nglMatrixCopy(_jointWorlds[_jointsCount], local);
+	}
+	
+	daeUpAxisJoint(local, joint->local);
+	
+	// Until a skin defines its bind pose, the joint is bound in the rest pose.
+	nglMatrixInverse(_jointWorlds[_jointsCount], inverse);
+	daeUpAxisJoint(inverse, joint->bind);
+	
+	return _jointsCount++;
+}
+
+- (void) defineSkinTo:(DAEController *)controller
+{
+	NSString *sourceId;
+	NSArray *names;
+	NSData *data;
+	NSNumber *index;
+	const float *floats;
+	UInt32 *map;
+	NGLmat4 bind;
+	NSUInteger i, length, matrices;
+	
+	// The names and the inverse bind matrices of the skin's joints.
+	names = daeJointNames(controller);
+	sourceId = [controller.joints objectForKey:DAE_INV_BIND];
+	data = [[controller.sources objectForKey:sourceId] objectForKey:NGL_ARRAY];
+	floats = [data bytes];
+	matrices = [data length] / NGL_SIZE_MAT4;
+	
+	// Maps the joints of the skin to the joints of the mesh. The missing ones stay in the bind pose.
+	length = [names count];
+	map = malloc(MAX(length, 1) * NGL_SIZE_UINT);
+	
+	for (i = 0; i < length; ++i)
+	{
+		index = [_jointKeys objectForKey:[names objectAtIndex:i]];
+		map[i] = (index != nil) ? [index unsignedIntValue] : NGL_NOT_FOUND;
+		
+		// The COLLADA matrices are given by rows.
+		if (index != nil && i < matrices)
+		{
+			nglMatrixTranspose((float *)floats + (i * 16), bind);
+			daeUpAxisJoint(bind, _joints[map[i]].bind);
+		}
+	}
+	
+	controller.jointsMap = [NSData dataWithBytesNoCopy:map length:length * NGL_SIZE_UINT freeWhenDone:YES];
+}
+
+- (void) parseGeometry:(NSString *)geometryKey
+			  instance:(NSDictionary *)instance
+			controller:(DAEController *)controller
+				matrix:(NGLmat4)matrix
+			  rotation:(NGLmat4)rotMatrix
+				  into:(NSMutableData *)polygons
+{
+	// Geometries.
+	DAEGeometry *daeGeometry = [_daeGeometries objectForKey:geometryKey];
+	
+	// Materials.
+	NSString *materialKey;
+	DAEMaterial *daeMaterial;
+	
+	// Polygons (primitives).
+	NSDictionary *polygon;
+	DAEPolygon poly;
+	
+	// Ignores null geometries. A null geometry could be caught if its
+	// geometric element is not supported by NGLParserDAE or if it has wrong "id".
+	if(daeGeometry == nil)
+	{
+		return;
+	}
+	
+	// The polygons of this geometry instance share the same transformations.
+	// Only the first one opens the faces group for the geometry.
+	memset(&poly, 0, sizeof(DAEPolygon));
+	poly.geometry = daeGeometry;
+	poly.geometryKey = geometryKey;
+	poly.controller = controller;
+	poly.newGroup = YES;
+	memcpy(poly.matrix, matrix, sizeof(NGLmat4));
+	memcpy(poly.rotMatrix, rotMatrix, sizeof(NGLmat4));
+	
+	if ([daeGeometry.polygons count] == 0)
+	{
+		[polygons appendBytes:&poly length:sizeof(DAEPolygon)];
+	}
+	
+	// Loops through all polygons in the current geometry.
+	for (polygon in daeGeometry.polygons)
+	{
+		//*************************
+		//	Materials
+		//*************************
+		
+		// Gets the correct material key to this polygon.
+		// If no material was assigned to this polygon, creates a new one.
+		materialKey = [polygon objectForKey:NGL_MATERIAL];
+		if(materialKey != nil)
+		{
+			materialKey = [instance objectForKey:materialKey];
+			daeMaterial = [_daeMaterials objectForKey:materialKey];
+			materialKey = daeMaterial.url;
+		}
+		else
+		{
+			materialKey = [NSString stringWithFormat:@"DAEMaterial-%i", _mtlCount];
+		}
+		
+		// Retrieves the identifier to the referenced material.
+		// If the material doesn't exist yet, creates it.
+		poly.identifier = [self makeIdentifierTo:materialKey];
+		poly.polygon = polygon;
+		
+		[polygons appendBytes:&poly length:sizeof(DAEPolygon)];
+		poly.newGroup = NO;
+	}
+}
+
 - (unsigned short) makeIdentifierTo:(NSString *)effectKey
 {
 	// Materials.
@@ -1026,7 +1915,7 @@ static void daeSetString(NSString **target, NSString *newString)
 	return identifier;
 }
 
-- (void) parseNode:(DAEVisualNode *)daeNode
+- (void) parseNode:(DAEVisualNode *)daeNode joint:(UInt32)parentJoint into:(NSMutableData *)polygons
 {
 	// Ignores null nodes. A null node could be caught if there is in COLLADA XML an invalid
 	// reference to a node in the library.
@@ -1038,328 +1927,67 @@ static void daeSetString(NSString **target, NSString *newString)
 	// Nodes.
 	NSString *instanceNode;
 	DAEVisualNode *subNode;
+	UInt32 joint;
+	
+	// Geometries and Controllers.
+	NSString *geometryKey;
+	NSString *controllerKey;
+	DAEController *daeController;
 	
-	// Geometries.
-	NSString *geometryKey;
-	NSDictionary *instanceGeometry;
-	DAEGeometry *daeGeometry;
-	
-	// Materials.
-	int identifier;
-	NSString *materialKey;
-	DAEMaterial *daeMaterial;
-	
-	// Polygons (primitives) and its structures.
-	int sourceOrder, sourceStride, sourceOffset;
-	NSDictionary *polygon;
-	NSDictionary *source;
-	NSString *sourceId;
-	NSArray *array;
-	
 	// Transformations.
 	NGLmat4 matrix, rotMatrix;
-	
-	// Vertices, Texcoords and Normals.
-	NGLvec3 v;
-	NGLvec2 vt;
-#ifdef kDAENormals
-	NGLvec3 vn;
-#endif
-	
-	// Faces.
-	int faceStride, faceLimit, faceLoop;
-	int firstIndex;
-	NSDictionary *input;
-	NSEnumerator *limits;
-	NSNumber *limit;
-	
-	// Loop elements.
-	NSUInteger i, length;
-	NSUInteger j, lengthJ;
+	NGLmat4 skinMatrix, skinRotMatrix;
 	
 	// Gets the transformation matrices for this node. If this node has a parent node, the final
 	// matrix and rotation matrix will take into consideration the parent transformations.
 	[self defineMatricesTo:daeNode final:matrix rotation:rotMatrix];
 	
+	// The joints are found in the scene order, so the parents always come before their children.
+	joint = [self defineJointTo:daeNode parent:parentJoint];
+	
 	// Loops through all geometries instances in the current node.
 	for (geometryKey in daeNode.geometries)
 	{
-		// Takes the real geometry stored in the geometry library.
-		instanceGeometry = [daeNode.geometries objectForKey:geometryKey];
-		daeGeometry = [_daeGeometries objectForKey:geometryKey];
+		[self parseGeometry:geometryKey
+				   instance:[daeNode.geometries objectForKey:geometryKey]
+				 controller:nil
+					 matrix:matrix
+				   rotation:rotMatrix
+					   into:polygons];
+	}
+	
+	// Loops through all controllers instances in the current node. As to COLLADA, the skins are placed
+	// by their bind shapes and joints, the transformations of the node don't apply to them.
+	for (controllerKey in daeNode.controllers)
+	{
+		daeController = [_daeControllers objectForKey:controllerKey];
 		
-		// Ignores null geometries. A null geometry could be caught if its
-		// geometric element is not supported by NGLParserDAE or if it has wrong "id".
-		if(daeGeometry == nil)
+		if ([daeController.bindShape count] >= 16)
 		{
-			continue;
+			nglMatrixFromNSArray(daeController.bindShape, skinMatrix);
 		}
-		
-		// Updates the faces group based on current geometry.
-		// AS to COLLADA XML, each geometry instance can has only one material bound.
-		// Each geometry represents a surface onto a mesh to NinevehGL.
-		[self updateGroups];
-		
-		// Loops through all polygons in the current geometry.
-		for (polygon in daeGeometry.polygons)
+		else
 		{
-			//*************************
-			//	Materials
-			//*************************
-			
-			// Gets the correct material key to this polygon.
-			// If no material was assigned to this polygon, creates a new one.
-			materialKey = [polygon objectForKey:NGL_MATERIAL];
-			if(materialKey != nil)
-			{
-				materialKey = [instanceGeometry objectForKey:materialKey];
-				daeMaterial = [_daeMaterials objectForKey:materialKey];
-				materialKey = daeMaterial.url;
-			}
-			else
-			{
-				materialKey = [NSString stringWithFormat:@"DAEMaterial-%i", _mtlCount];
-			}
-			
-			// Retrieves the identifier to the referenced material.
-			// If the material doesn't exist yet, creates it.
-			identifier =  [self makeIdentifierTo:materialKey];
-			
-			//*************************
-			//	Surfaces
-			//*************************
-			
-			// Creates a new surface to deal with this polygon.
-			nglRelease(_currentSurface);
-			_currentSurface = [[NGLSurface alloc] initWithStart:_facesCount length:0 identifier:identifier];
-			
-			// Adds the created surface to the surfaces library.
-			[_surface addSurface:_currentSurface];
-			
-			//*************************
-			//	Vertices
-			//*************************
-			
-			sourceId = daeGetId([[polygon objectForKey:DAE_VERTEX] objectForKey:DAE_ATT_SOURCE]);
-			
-			// The "VERTEX" semantic is mandatory to any kind of polygon.
-			if (sourceId == nil)
-			{
-				_error.message = [NSString stringWithFormat:DAE_ERROR_NO_VERTEX, geometryKey];
-			}
-			
-			// Checks if the "VERTEX" semantic reffers against the vertices node or source directly.
-			if ([daeGeometry.verticesId isEqualToString:sourceId])
-			{
-				sourceId = [daeGeometry.vertices objectForKey:DAE_POSITION];
-			}
-			
-			// Gets the correct source refferenced by the "VERTEX" semantic.
-			source = [daeGeometry.sources objectForKey:sourceId];
-			
-			// Checks if the source exist in COLLADA XML context.
-			if (source == nil)
-			{
-				_error.message = [NSString stringWithFormat:DAE_ERROR_NULL_REF, sourceId];
-			}
-			
-			// Gets the array from the source.
-			array = [source objectForKey:NGL_ARRAY];
-			
-			// Opitional parameters Order, Stride and Offset.
-			sourceOrder = [[source objectForKey:NGL_ORDER] intValue];
-			sourceStride = [[source objectForKey:NGL_STRIDE] intValue];
-			sourceOffset = [[source objectForKey:NGL_OFFSET] intValue];
-			sourceOrder = (sourceOrder == 0) ? kDefaultOrder : sourceOrder;
-			sourceStride = (sourceStride == 0) ? kDefaultStrideV : sourceStride;
-			
-			length = [array count];
-			for (i = sourceOffset; i < length; i += sourceStride)
-			{
-				v.x = [[array objectAtIndex:i + (sourceOrder >> 16 & 0xFF)] floatValue];
-				v.y = [[array objectAtIndex:i + (sourceOrder >> 8 & 0xFF)] floatValue];
-				v.z = [[array objectAtIndex:i + (sourceOrder >> 0 & 0xFF)] floatValue];
-				
-				// Applies all transformations to each vertex.
-				v = nglVec3ByMatrixTransposed(v, matrix);
-				
-				_vertices = realloc(_vertices, ++_vCount * NGL_SIZE_VEC4);
-				float *vertices = _vertices + ((_vCount - 1) * 4);
-				
-				*vertices++ = v.x;
-				*vertices++ = v.y;
-				*vertices++ = v.z;
-				*vertices = 1.0f;
-			}
-			
-			//*************************
-			//	Texture Coordinates
-			//*************************
-			
-			// Gets the correct TEXCOORD source.
-			// It could lie directly in the polygons input or in the vertices inputs.
-			sourceId = daeGetId([[polygon objectForKey:DAE_TEXCOORD] objectForKey:DAE_ATT_SOURCE]);
-			sourceId = (sourceId == nil) ? [daeGeometry.vertices objectForKey:DAE_TEXCOORD] : sourceId;
-			
-			// Gets the correct source refferenced by the "TEXCOORD" semantic.
-			source = [daeGeometry.sources objectForKey:sourceId];
-			
-			_hasTexcoord = (source != nil);
-			
-			if (_hasTexcoord)
-			{
-				// Gets the array from the source.
-				array = [source objectForKey:NGL_ARRAY];
-				
-				// Opitional parameters Order, Stride and Offset.
-				sourceOrder = [[source objectForKey:NGL_ORDER] intValue];
-				sourceStride = [[source objectForKey:NGL_STRIDE] intValue];
-				sourceOffset = [[source objectForKey:NGL_OFFSET] intValue];
-				sourceOrder = (sourceOrder == 0) ? kDefaultOrder : sourceOrder;
-				sourceStride = (sourceStride == 0) ? kDefaultStrideVT : sourceStride;
-				
-				length = [array count];
-				for (i = sourceOffset; i < length; i += sourceStride)
-				{
-					vt.x = [[array objectAtIndex:i + (sourceOrder >> 16 & 0xFF)] floatValue];
-					vt.y = [[array objectAtIndex:i + (sourceOrder >> 8 & 0xFF)] floatValue];
-					
-					_texcoords = realloc(_texcoords, ++_tCount * NGL_SIZE_VEC2);
-					float *texcoord = _texcoords + ((_tCount - 1) * 2);
-					
-					*texcoord++ = vt.x;
-					*texcoord = vt.y;
-				}
-			}
-			
-#ifdef kDAENormals
-			//*************************
-			//	Normals
-			//*************************
-			
-			// Gets the correct NORMAL source.
-			// It could lie directly in the polygons input or in the vertices inputs.
-			sourceId = daeGetId([[polygon objectForKey:DAE_NORMAL] objectForKey:DAE_ATT_SOURCE]);
-			sourceId = (sourceId == nil) ? [daeGeometry.vertices objectForKey:DAE_NORMAL] : sourceId;
-			
-			// Gets the correct source refferenced by the "NORMAL" semantic.
-			source = [daeGeometry.sources objectForKey:sourceId];
-			
-			_hasNormal = (source != nil);
-			
-			if (_hasNormal)
-			{
-				// Gets the array from the source.
-				array = [source objectForKey:NGL_ARRAY];
-				
-				// Opitional parameters Order, Stride and Offset.
-				sourceOrder = [[source objectForKey:NGL_ORDER] intValue];
-				sourceStride = [[source objectForKey:NGL_STRIDE] intValue];
-				sourceOffset = [[source objectForKey:NGL_OFFSET] intValue];
-				sourceOrder = (sourceOrder == 0) ? kDefaultOrder : sourceOrder;
-				sourceStride = (sourceStride == 0) ? kDefaultStrideVN : sourceStride;
-				
-				length = [array count];
-				for (i = sourceOffset; i < length; i += sourceStride)
-				{
-					vn.x = [[array objectAtIndex:i + (sourceOrder >> 16 & 0xFF)] floatValue];
-					vn.y = [[array objectAtIndex:i + (sourceOrder >> 8 & 0xFF)] floatValue];
-					vn.z = [[array objectAtIndex:i + (sourceOrder >> 0 & 0xFF)] floatValue];
-					
-					// Applies only the rotations transformations to each normal.
-					// Normals are always given in local space and must be adjusted only with rotations.
-					vn = nglVec3Normalize(nglVec3ByMatrixTransposed(vn, rotMatrix));
-					
-					_normals = realloc(_normals, ++_nCount * NGL_SIZE_VEC3);
-					float *normals = _normals + ((_nCount - 1) * 3);
-					
-					*normals++ = vn.x;
-					*normals++ = vn.y;
-					*normals = vn.z;
-				}
-			}
-#endif
-			//*************************
-			//	Faces
-			//*************************
-			
-			// Gets array of faces to construct the polygon.
-			array = [polygon objectForKey:NGL_ARRAY];
-			
-			// Gets the face stride and limit of each polygon.
-			faceStride = [[polygon objectForKey:NGL_STRIDE] intValue];
-			limits = [[polygon objectForKey:NGL_LIMIT] objectEnumerator];
-			limit = [limits nextObject];
-			faceLimit = [limit intValue];
-			
-			// Gets the offset to vertex element.
-			input = [polygon objectForKey:DAE_VERTEX];
-			_vOffset = [[input objectForKey:DAE_ATT_OFFSET] intValue];
-			
-			// Gets the texcoord offset from the normal element.
-			// Assumes the vertex offset if there is no explict texcoord element.
-			input = [polygon objectForKey:DAE_TEXCOORD];
-			_vtOffset = (input != nil) ? [[input objectForKey:DAE_ATT_OFFSET] intValue] : _vOffset;
+			nglMatrixIdentity(skinMatrix);
+		}
+		
+		daeUpAxisMatrix(skinRotMatrix);
+		nglMatrixMultiply(skinMatrix, skinRotMatrix, skinMatrix);
 #ifdef kDAENormals
-			// Gets the normal offset from the normal element.
-			// Assumes the vertex offset if there is no explict normal element.
-			input = [polygon objectForKey:DAE_NORMAL];
-			_vnOffset = (input != nil) ? [[input objectForKey:DAE_ATT_OFFSET] intValue] : _vOffset;
+		nglMatrixIsolateRotation(skinMatrix, skinRotMatrix);
 #endif
-			// Loops through each set of faces defined in COLLADA XML to the current polygon.
-			length = [array count];
-			for (i = 0; i < length; ++i)
-			{
-				// Transforms the face reference into a face array (NSArray).
-				_polyFaces = [nglGetArray([array objectAtIndex:i]) retain];
-				
-				// Resets the face loop and first index.
-				faceLoop = firstIndex = 0;
-				
-				// Loops through each value in the faces array respecting the stride.
-				lengthJ = [_polyFaces count];
-				for (j = 0; j < lengthJ; j += faceStride)
-				{
-					// If the current face forms a polygon which has more than 3 vertices,
-					// re-constructs the current face to turn it into multiple triangles.
-					if (faceLoop >= 3)
-					{
-						[self defineFaceTo:firstIndex];
-						[self defineFaceTo:(int)j - faceStride];
-					}
-					
-					// Processes the current face.
-					[self defineFaceTo:(int)j];
-					
-					// Sums one more vertex to the current face.
-					++faceLoop;
-					
-					// Checks if the current face is complete.
-					if (faceLoop == faceLimit)
-					{
-						// Dealing with lines, lines will be transformed into triangles.
-						if (faceLimit == 2)
-						{
-							[self defineFaceTo:firstIndex];
-						}
-						
-						// Gets information to the next face.
-						firstIndex = (int)j + 1;
-						faceLoop = 0;
-						faceLimit = (limit = [limits nextObject]) ? [limit intValue] : faceLimit;
-					}
-				}
-				
-				// Releases the last set of polygon faces.
-				[_polyFaces release];
-			}
-		}
+		[self parseGeometry:daeController.geometryId
+				   instance:[daeNode.controllers objectForKey:controllerKey]
+				 controller:daeController
+					 matrix:skinMatrix
+				   rotation:skinRotMatrix
+					   into:polygons];
 	}
 	
 	// Processes each subnode in the current node.
 	for (subNode in daeNode.nodes)
 	{
-		[self parseNode:subNode];
+		[self parseNode:subNode joint:joint into:polygons];
 	}
 	
 	// Processes each referenced node instance in the current node.
@@ -1368,7 +1996,7 @@ static void daeSetString(NSString **target, NSString *newString)
 		subNode = [_daeAllNodes objectForKey:instanceNode];
 		subNode.parent = daeNode.selfId;
 		
-		[self parseNode:subNode];
+		[self parseNode:subNode joint:joint into:polygons];
 	}
 }
 
@@ -1377,17 +2005,32 @@ static void daeSetString(NSString **target, NSString *newString)
 	// Settings.
 	_vCount = _tCount = _nCount = 0;
 	_gCount = _facesCount = 0;
+	_jointsCount = 0;
+	_mtlCount = 0;
 	_facesStride = 3;
 	
 	// Allocates the temporary variables to parse the DAE.
 	_transformations = [[NSMutableDictionary alloc] init];
 	_matrices = malloc(1);
+	_skinNames = [[NSMutableSet alloc] init];
+	_jointKeys = [[NSMutableDictionary alloc] init];
+	_jointNames = [[NSArray alloc] init];
 	
 	// Prepares node enumerator.
 	// Only the top parent node from the visual scenes library will be processed.
 	DAEVisualNode *daeNode;
+	DAEController *daeController;
+	NSMutableData *data = [[NSMutableData alloc] init];
+	NSUInteger i, length;
 	
-	// Loops through all most top nodes.
+	// The nodes named by the skins become the joints.
+	for (daeController in [_daeControllers objectEnumerator])
+	{
+		[_skinNames addObjectsFromArray:daeJointNames(daeController)];
+	}
+	
+	// Loops through all most top nodes. Materials and transformations are resolved here,
+	// in the scene order, the polygons are just collected to be processed later on.
 	for (daeNode in _daeSceneNodes)
 	{
 		// Canceled status.
@@ -1396,9 +2039,52 @@ static void daeSetString(NSString **target, NSString *newString)
 			break;
 		}
 		
-		[self parseNode:daeNode];
+		[self parseNode:daeNode joint:NGL_NOT_FOUND into:data];
+	}
+	
+	// Maps the joints of the skins, all of them were found in the scenes.
+	for (daeController in [_daeControllers objectEnumerator])
+	{
+		[self defineSkinTo:daeController];
+	}
+	
+	// Processes the polygons concurrently. They only read the COLLADA libraries, not this instance.
+	DAEPolygon *polygons = [data mutableBytes];
+	BOOL *canceled = &_canceled;
+	length = [data length] / sizeof(DAEPolygon);
+	
+#ifdef NGL_MULTITHREADING
+	nglJobFor((UInt32)length, ^(UInt32 index)
+	{
+		NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+		
+		if (!*canceled)
+		{
+			daeProcessPolygon(&polygons[index]);
+		}
+		
+		[pool drain];
+	});
+#else
+	for (i = 0; i < length && !*canceled; ++i)
+	{
+		daeProcessPolygon(&polygons[i]);
+	}
+#endif
+	
+	// Merges the polygons in the scene order, it produces exactly the same result of a serial processing.
+	for (i = 0; i < length; ++i)
+	{
+		if (!_canceled)
+		{
+			[self mergePolygon:&polygons[i]];
+		}
+		
+		daeFreePolygon(&polygons[i]);
 	}
 	
+	nglRelease(data);
+	
 	// Defines the final stride to the array of structures.
 	[self defineStride];
 	
@@ -1409,19 +2095,118 @@ static void daeSetString(NSString **target, NSString *newString)
 	}
 	
 	// Frees the memories.
-	int i;
-	int length = _mCount;
+	length = _mCount;
 	for (i = 0; i < length; ++i)
 	{
 		nglFree(_matrices[i]);
 	}
 	nglFree(_matrices);
+	nglFree(_jointWorlds);
 	
 	nglRelease(_transformations);
+	nglRelease(_skinNames);
+	nglRelease(_jointKeys);
+}
+
+- (void) startStreamWithCapacity:(UInt32)capacity floats:(BOOL)floats
+{
+	// Preallocates the buffer when the number of values is known, like in <float_array count="N">.
+	_streamCapacity = MAX(capacity, DAE_STREAM_CAPACITY);
+	_streamValues = realloc(_streamValues, _streamCapacity * NGL_SIZE_FLOAT);
+	_streamCount = 0;
+	_streamCarryLength = 0;
+	_streamFloats = floats;
+	_streaming = YES;
+}
+
+- (void) streamValuesFrom:(const char *)bytes to:(const char *)end
+{
+	// Each number takes, at least, one character and one separator.
+	UInt32 maximum = _streamCount + (UInt32)((end - bytes) / 2) + 1;
+	
+	if (maximum > _streamCapacity)
+	{
+		_streamCapacity = MAX(maximum, _streamCapacity * 2);
+		_streamValues = realloc(_streamValues, _streamCapacity * NGL_SIZE_FLOAT);
+	}
+	
+	// Floats and UInt32 have the same size, so the same buffer holds both.
+	if (_streamFloats)
+	{
+		_streamCount += nglParseFloats(bytes, end, (float *)_streamValues + _streamCount,
+									   maximum - _streamCount, NULL);
+	}
+	else
+	{
+		_streamCount += nglParseUInts(bytes, end, (UInt32 *)_streamValues + _streamCount,
+									  maximum - _streamCount, NULL);
+	}
+}
+
+- (void) streamCharacters:(NSString *)characters
+{
+	const char *bytes = [characters UTF8String];
+	const char *end = bytes + strlen(bytes);
+	const char *last = end;
+	
+	// Completes the number which was split by the last piece of characters.
+	if (_streamCarryLength > 0)
+	{
+		while (bytes < end && !isspace((unsigned char)*bytes) && _streamCarryLength < DAE_STREAM_CARRY)
+		{
+			_streamCarry[_streamCarryLength++] = *bytes++;
+		}
+		
+		// The whole piece still belongs to the same number.
+		if (bytes == end)
+		{
+			return;
+		}
+		
+		[self streamValuesFrom:_streamCarry to:_streamCarry + _streamCarryLength];
+		_streamCarryLength = 0;
+	}
+	
+	// The last number can continue in the next piece, so it's kept aside.
+	while (last > bytes && !isspace((unsigned char)*(last - 1)))
+	{
+		--last;
+	}
+	
+	[self streamValuesFrom:bytes to:last];
+	
+	_streamCarryLength = (UInt32)MIN(end - last, DAE_STREAM_CARRY);
+	memcpy(_streamCarry, last, _streamCarryLength);
+}
+
+- (NSData *) finishStream
+{
+	NSData *data;
+	
+	if (!_streaming)
+	{
+		return nil;
+	}
+	
+	// Parses the last number.
+	[self streamValuesFrom:_streamCarry to:_streamCarry + _streamCarryLength];
+	
+	// Hands the buffer over to the NSData, without copying it.
+	_streamValues = realloc(_streamValues, MAX(_streamCount, 1) * NGL_SIZE_FLOAT);
+	data = [NSData dataWithBytesNoCopy:_streamValues length:_streamCount * NGL_SIZE_FLOAT freeWhenDone:YES];
+	
+	_streamValues = NULL;
+	_streamCount = _streamCapacity = _streamCarryLength = 0;
+	_streaming = NO;
+	
+	return data;
 }
 
 - (void) parserXML
 {
+	// Takes the numbers streamed from the last element, if any.
+	NSData *stream = [self finishStream];
+	
 	// Avoids processing of null elements.
 	// This happens when NSXMLParser encounter a content without parent element.
 	if (_element == nil)
@@ -1486,7 +2271,7 @@ static void daeSetString(NSString **target, NSString *newString)
 			// Node <float_array> [0,1]
 			else if ([_element isEqualToString:DAE_GEO_ARRAY])
 			{
-				[_tempSource setObject:nglGetArray(content) forKey:NGL_ARRAY];
+				[_tempSource setObject:stream forKey:NGL_ARRAY];
 			}
 //**************************************************
 			//*
@@ -1574,7 +2359,7 @@ static void daeSetString(NSString **target, NSString *newString)
 					 [_element isEqualToString:DAE_GEO_TRIANGLES] ||
 					 [_element isEqualToString:DAE_GEO_LINES]) //
 			{
-				NSArray *polygonLimit = nil;
+				NSData *polygonLimit = nil;
 				
 				_idTemp = [_attributes objectForKey:DAE_ATT_MATERIAL];
 				_sidTemp = [_attributes objectForKey:DAE_ATT_COUNT];
@@ -1593,15 +2378,15 @@ static void daeSetString(NSString **target, NSString *newString)
 				if ([_element isEqualToString:DAE_GEO_POLYGONS] ||
 					[_element isEqualToString:DAE_GEO_POLY_LIST])
 				{
-					polygonLimit = [NSArray arrayWithObject:[NSNumber numberWithInt:-1]];
+					polygonLimit = daeLimitData(-1);
 				}
 				else if ([_element isEqualToString:DAE_GEO_TRIANGLES])
 				{
-					polygonLimit = [NSArray arrayWithObject:[NSNumber numberWithInt:3]];
+					polygonLimit = daeLimitData(3);
 				}
 				else if ([_element isEqualToString:DAE_GEO_LINES])
 				{
-					polygonLimit = [NSArray arrayWithObject:[NSNumber numberWithInt:2]];
+					polygonLimit = daeLimitData(2);
 				}
 				
 				// Retains the parent elements to make distinction between inputs from vertices
@@ -1629,8 +2414,7 @@ static void daeSetString(NSString **target, NSString *newString)
 			else if ([_element isEqualToString:DAE_GEO_VCOUNT]) // - 1
 			{
 				// Updates the polygon limit. This is specific to the Polygon List primitive.
-				NSArray *trianglesCount = nglGetArray(content);
-				[_tempPolygon setObject:trianglesCount forKey:NGL_LIMIT];
+				[_tempPolygon setObject:stream forKey:NGL_LIMIT];
 			}
 			// If the parent element is not supported by NGLParserDAE, skips this step.
 			else if (_parent == nil)
@@ -1661,7 +2445,7 @@ static void daeSetString(NSString **target, NSString *newString)
 			// Node <p> [0,N]
 			else if ([_element isEqualToString:DAE_GEO_INPUT_P]) //
 			{
-				[_tempArray addObject:content];
+				[_tempArray addObject:stream];
 			}
 			// Everything else.
 			else
@@ -1670,6 +2454,114 @@ static void daeSetString(NSString **target, NSString *newString)
 			}
 			break;
 		//*************************
+		//	Library Controllers
+		//*************************
+		case DaePhaseControllers:
+			// Node <controller> [1,N]
+			if ([_element isEqualToString:DAE_CTR])
+			{
+				_idTemp = [_attributes objectForKey:DAE_ATT_ID];
+				
+				// Releases any previous controller to avoid incorrect storages.
+				nglRelease(_actualController);
+				
+				// The "id" is mandatory.
+				if (_idTemp == nil)
+				{
+					_error.message = [NSString stringWithFormat:DAE_ERROR_NO_ID, DAE_CTR];
+					return;
+				}
+				
+				// Allocates a new Controller to work on it.
+				_actualController = [[DAEController alloc] init];
+				
+				// Places the new controller into the Controller storage.
+				[_daeControllers setObject:_actualController forKey:_idTemp];
+			}
+			// Node <skin> [0,1]
+			else if ([_element isEqualToString:DAE_CTR_SKIN])
+			{
+				// Stores the geometry moved by this skin.
+				_actualController.geometryId = daeGetId([_attributes objectForKey:DAE_ATT_SOURCE]);
+			}
+			// Node <bind_shape_matrix> [0,1]
+			else if ([_element isEqualToString:DAE_CTR_BIND_SHAPE])
+			{
+				_actualController.bindShape = nglGetArray(content);
+			}
+			// Node <source> [3,N]
+			else if ([_element isEqualToString:DAE_SOURCE])
+			{
+				_idTemp = [_attributes objectForKey:DAE_ATT_ID];
+				
+				// Releases any previous source to avoid incorrect storages.
+				nglRelease(_tempSource);
+				
+				// The "id" attribute is mandatory.
+				if (_idTemp == nil)
+				{
+					_error.message = [NSString stringWithFormat:DAE_ERROR_NO_ID, DAE_SOURCE];
+					return;
+				}
+				
+				// Prepares a temporary source to work on it.
+				_tempSource = [[NSMutableDictionary alloc] init];
+				
+				// Places the temporary source into the actual controller.
+				[_actualController.sources setObject:_tempSource forKey:_idTemp];
+			}
+			// Node <float_array> [0,1]
+			else if ([_element isEqualToString:DAE_GEO_ARRAY])
+			{
+				[_tempSource setObject:stream forKey:NGL_ARRAY];
+			}
+			// Node <Name_array>, <IDREF_array> [0,1]
+			else if ([_element isEqualToString:DAE_CTR_NAMES] || [_element isEqualToString:DAE_CTR_IDREFS])
+			{
+				[_tempSource setObject:nglGetArray(content) forKey:NGL_ARRAY];
+			}
+			// Node <joints>, <vertex_weights> [1]
+			else if ([_element isEqualToString:DAE_CTR_JOINTS] || [_element isEqualToString:DAE_CTR_WEIGHTS])
+			{
+				// Retains the parent elements to make distinction between inputs from joints
+				// and inputs from weights.
+				daeSetString(&_parent, _element);
+			}
+			// Node <input> [2,N]
+			else if ([_element isEqualToString:DAE_GEO_INPUT])
+			{
+				_idTemp = [_attributes objectForKey:DAE_ATT_SEMANTIC];
+				_sidTemp = [_attributes objectForKey:DAE_ATT_SOURCE];
+				
+				// The "semantic" and "source" attributes are mandatory.
+				if (_idTemp == nil || _sidTemp == nil)
+				{
+					_error.message = DAE_ERROR_NO_SS;
+					return;
+				}
+				
+				// The inputs of the weights also have their offsets.
+				if ([_parent isEqualToString:DAE_CTR_JOINTS])
+				{
+					[_actualController.joints setObject:daeGetId(_sidTemp) forKey:_idTemp];
+				}
+				else
+				{
+					[_actualController.weights setObject:_attributes forKey:_idTemp];
+				}
+			}
+			// Node <vcount> [1]
+			else if ([_element isEqualToString:DAE_GEO_VCOUNT])
+			{
+				_actualController.vcount = stream;
+			}
+			// Node <v> [1]
+			else if ([_element isEqualToString:DAE_CTR_V])
+			{
+				_actualController.influences = stream;
+			}
+			break;
+		//*************************
 		//	Library Effects
 		//*************************
 		case DaePhaseEffects:
@@ -1830,6 +2722,8 @@ static void daeSetString(NSString **target, NSString *newString)
 				nglRelease(_actualNode);
 				_actualNode = [[DAEVisualNode alloc] init];
 				_actualNode.selfId = _idTemp;
+				_actualNode.sid = [_attributes objectForKey:DAE_ATT_SID];
+				_actualNode.name = [_attributes objectForKey:DAE_ATT_NAME];
 				_actualNode.parent = [_daeParentNodes lastObject];
 				
 				// Places the new node as a parent node to use in the next child node.
@@ -1895,6 +2789,18 @@ static void daeSetString(NSString **target, NSString *newString)
 				// Places this geometry reference into the current node.
 				[_actualNode.geometries setObject:_tempSource forKey:_urlTemp];
 			}
+			// Node <instance_controller> [0,N]
+			else if ([_element isEqualToString:DAE_NODE_CONTROLLER])
+			{
+				_urlTemp = daeGetId([_attributes objectForKey:DAE_ATT_URL]);
+				
+				// Prepares a temporary source to work on it.
+				nglRelease(_tempSource);
+				_tempSource = [[NSMutableDictionary alloc] init];
+				
+				// Places this controller reference into the current node.
+				[_actualNode.controllers setObject:_tempSource forKey:_urlTemp];
+			}
 			// Node <instance_material> [1,N]
 			else if ([_element isEqualToString:DAE_NODE_MATERIAL])
 			{
@@ -1975,6 +2881,10 @@ didStartElement:(NSString *)element
 			{
 				_phase = DaePhaseGeometry;
 			}
+			else if ([element isEqualToString:DAE_LIB_CTR])
+			{
+				_phase = DaePhaseControllers;
+			}
 			else if ([element isEqualToString:DAE_LIB_EFX])
 			{
 				_phase = DaePhaseEffects;
@@ -2012,6 +2922,25 @@ didStartElement:(NSString *)element
 	
 	// Clears the current content.
 	[_content setString:@""];
+	
+	// The big arrays of numbers are parsed straight into typed buffers while they are being read,
+	// instead of accumulating all their text.
+	if (_phase == DaePhaseGeometry || _phase == DaePhaseControllers)
+	{
+		if ([element isEqualToString:DAE_GEO_ARRAY])
+		{
+			[self startStreamWithCapacity:[[attributes objectForKey:DAE_ATT_COUNT] intValue] floats:YES];
+		}
+		else if ([element isEqualToString:DAE_GEO_INPUT_P] || [element isEqualToString:DAE_GEO_VCOUNT])
+		{
+			[self startStreamWithCapacity:0 floats:NO];
+		}
+		else if ([element isEqualToString:DAE_CTR_V])
+		{
+			// The influences can reffer to the bind shape with the joint -1.
+			[self startStreamWithCapacity:0 floats:YES];
+		}
+	}
 }
 
 - (void) parser:(NSXMLParser *)parser
@@ -2040,6 +2969,12 @@ didStartElement:(NSString *)element
 				_phase = DaePhaseNone;
 			}
 			break;
+		case DaePhaseControllers:
+			if ([element isEqualToString:DAE_LIB_CTR])
+			{
+				_phase = DaePhaseNone;
+			}
+			break;
 		case DaePhaseEffects:
 			if ([element isEqualToString:DAE_LIB_EFX])
 			{
@@ -2086,7 +3021,14 @@ didStartElement:(NSString *)element
 
 - (void) parser:(NSXMLParser *)parser foundCharacters:(NSString *)content
 {
-	[_content appendString:content];
+	if (_streaming)
+	{
+		[self streamCharacters:content];
+	}
+	else
+	{
+		[_content appendString:content];
+	}
 }
 /*
 - (void) parser:(NSXMLParser *)parser parseErrorOccurred:(NSError *)parseError
@@ -2110,6 +3052,7 @@ didStartElement:(NSString *)element
 	_daeEffects = [[NSMutableDictionary alloc] init];
 	_daeImages = [[NSMutableDictionary alloc] init];
 	_daeMaterials = [[NSMutableDictionary alloc] init];
+	_daeControllers = [[NSMutableDictionary alloc] init];
 	_daeAllNodes = [[NSMutableDictionary alloc] init];
 	_daeSceneNodes = [[NSMutableArray alloc] init];
 	_daeParentNodes = [[NSMutableArray alloc] init];
@@ -2171,6 +3114,7 @@ didStartElement:(NSString *)element
 	nglRelease(_daeEffects);
 	nglRelease(_daeImages);
 	nglRelease(_daeMaterials);
+	nglRelease(_daeControllers);
 	nglRelease(_daeSceneNodes);
 	nglRelease(_daeAllNodes);
 	nglRelease(_daeParentNodes);
@@ -2181,12 +3125,17 @@ didStartElement:(NSString *)element
 	nglRelease(_actualEffect);
 	nglRelease(_actualImage);
 	nglRelease(_actualMaterial);
+	nglRelease(_actualController);
 	nglRelease(_actualNode);
 	
 	// Releases the temporary storages.
 	nglRelease(_tempSource);
 	nglRelease(_tempPolygon);
 	nglRelease(_tempArray);
+	
+	// Releases any stream left by an aborted parsing.
+	nglFree(_streamValues);
+	_streaming = NO;
 }
 
 - (void) dealloc
@@ -2196,7 +3145,10 @@ didStartElement:(NSString *)element
 	nglFree(_vertices);
 	nglFree(_texcoords);
 	nglFree(_normals);
+	nglFree(_boneIndices);
+	nglFree(_boneWeights);
 	nglFree(_groups);
+	nglFree(_streamValues);
 	
 	[super dealloc];
 }
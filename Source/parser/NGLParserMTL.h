@@ -60,6 +60,8 @@
 	NSArray					*_cuted;
 	const char				*_prefix;
 	unsigned char			_cutedCount;
+	float					_values[4];
+	UInt32					_valuesCount;
 	
 	// Materials
 	NGLMaterial				*_currentMaterial;
@@ -123,4 +125,17 @@
  */
 - (void) updateSurfaceLength;
 
+/*!
+ *					Fills the last created surface with many indices at once.
+ *
+ *					This method has the same effect of calling <code>#updateSurfaceLength#</code> once
+ *					for each new index.
+ *
+ *	@param			length
+ *					The number of indices to add to the surface length.
+ *
+ *	@see			updateSurfaceLength
+ */
+- (void) updateSurfaceLengthBy:(UInt32)length;
+
 @end
\ No newline at end of file
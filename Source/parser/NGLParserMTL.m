@@ -77,8 +77,8 @@ static UInt32 _mtlCount;
 
 @interface NGLParserMTL()
 
-// Defines a NGL color based on values from the MTL file.
-- (NGLvec4) makeColorTo:(NSArray *)array;
+// Defines a NGL color based on the values parsed from the current line.
+- (NGLvec4) makeColor;
 
 // Defines a NGLTexture based on a file path from MTL file.
 - (NGLTexture *) makeMapToFile:(NSString *)filePath;
@@ -141,16 +141,16 @@ static UInt32 _mtlCount;
 //	Private Methods
 //**************************************************
 
-- (NGLvec4) makeColorTo:(NSArray *)array
+- (NGLvec4) makeColor
 {
-	NGLvec4 color;
+	NGLvec4 color = kNGLvec4Zero;
 	
 	// Checks for number of values.
-	if ([array count] >= 3)
+	if (_valuesCount >= 3)
 	{
-		color.x = [[array objectAtIndex:1] floatValue];
-		color.y = [[array objectAtIndex:2] floatValue];
-		color.z = [[array objectAtIndex:3] floatValue];
+		color.x = _values[0];
+		color.y = _values[1];
+		color.z = _values[2];
 		color.w = 1.0f;
 	}
 	else
@@ -195,6 +195,23 @@ static UInt32 _mtlCount;
 		
 		// Takes all lower case to avoid upper case conflicts, as files from the 3DS Max.
 		_prefix = [[[_cuted objectAtIndex:0] lowercaseString] UTF8String];
+		
+		// Parses the numeric values right after the prefix, without any intermediate object.
+		const char *cValues = [line UTF8String];
+		const char *cEnd = cValues + strlen(cValues);
+		
+		while (cValues < cEnd && isspace((unsigned char)*cValues))
+		{
+			++cValues;
+		}
+		
+		while (cValues < cEnd && !isspace((unsigned char)*cValues))
+		{
+			++cValues;
+		}
+		
+		memset(_values, 0, sizeof(_values));
+		_valuesCount = nglParseFloats(cValues, cEnd, _values, 4, NULL);
 	}
 	
 	//*************************
@@ -220,12 +237,12 @@ static UInt32 _mtlCount;
 	else if (strcmp(_prefix, "d") == 0)
 	{
 		// The property "d" is the real alpha.
-		_currentMaterial.alpha = [[_cuted objectAtIndex:1] floatValue];
+		_currentMaterial.alpha = _values[0];
 	}
 	else if (strcmp(_prefix, "tr") == 0)
 	{
 		// The property "tr" is the tranparency, the transparency amount is a range of 0% to 100%.
-		_currentMaterial.alpha = 1 - [[_cuted objectAtIndex:1] floatValue];
+		_currentMaterial.alpha = 1 - _values[0];
 	}
 	else if (strcmp(_prefix, "tf") == 0)
 	{
@@ -233,22 +250,16 @@ static UInt32 _mtlCount;
 		_currentMaterial.alpha = 1;
 		
 		float alpha = 0.0f;
-		UInt32 n = 0;
+		UInt32 n = _valuesCount;
 		
 		UInt32 i;
-		UInt32 length = _cutedCount;
-		
-		for (i = 1; i < length; i++)
+		for (i = 0; i < n; i++)
 		{
-			if ([[_cuted objectAtIndex:i] length] > 0)
-			{
-				alpha += [[_cuted objectAtIndex:i] floatValue];
-				++n;
-			}
+			alpha += _values[i];
 		}
 		
 		// Finds the average.
-		_currentMaterial.alpha = alpha / n;
+		_currentMaterial.alpha = (n > 0) ? alpha / n : 1.0f;
 	}
 	//*************************
 	//	illum - Illumination
@@ -271,42 +282,42 @@ static UInt32 _mtlCount;
 	//*************************
 	if (strcmp(_prefix, "ka") == 0)
 	{
-		_currentMaterial.ambientColor = [self makeColorTo:_cuted];
+		_currentMaterial.ambientColor = [self makeColor];
 	}
 	//*************************
 	//	Kd - Diffuse Color
 	//*************************
 	else if (strcmp(_prefix, "kd") == 0)
 	{
-		_currentMaterial.diffuseColor = [self makeColorTo:_cuted];
+		_currentMaterial.diffuseColor = [self makeColor];
 	}
 	//*************************
 	//	Ke - Emissive Color
 	//*************************
 	else if (strcmp(_prefix, "ke") == 0)
 	{
-		_currentMaterial.emissiveColor = [self makeColorTo:_cuted];
+		_currentMaterial.emissiveColor = [self makeColor];
 	}
 	//*************************
 	//	Ks - Specular Color
 	//*************************
 	else if (strcmp(_prefix, "ks") == 0)
 	{
-		_currentMaterial.specularColor = [self makeColorTo:_cuted];
+		_currentMaterial.specularColor = [self makeColor];
 	}
 	//*************************
 	//	Ns - Shininess
 	//*************************
 	else if (strcmp(_prefix, "ns") == 0)
 	{
-		_currentMaterial.shininess = [[_cuted objectAtIndex:1] floatValue];
+		_currentMaterial.shininess = _values[0];
 	}
 	//*************************
 	//	Ni - Refraction
 	//*************************
 	else if (strcmp(_prefix, "ni") == 0)
 	{
-		_currentMaterial.refraction = [[_cuted objectAtIndex:1] floatValue];
+		_currentMaterial.refraction = _values[0];
 	}
 	//*************************
 	//	map_d - Alpha Map
@@ -443,6 +454,11 @@ static UInt32 _mtlCount;
 	++_currentSurface.lengthData;
 }
 
+- (void) updateSurfaceLengthBy:(UInt32)length
+{
+	_currentSurface.lengthData += length;
+}
+
 #pragma mark -
 #pragma mark Override Public Methods
 //**************************************************
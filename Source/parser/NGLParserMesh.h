@@ -25,12 +25,261 @@
 #import "NGLDataType.h"
 #import "NGLError.h"
 #import "NGLVector.h"
+#import "NGLMatrix.h"
 #import "NGLMeshElements.h"
 #import "NGLMaterialMulti.h"
 #import "NGLSurfaceMulti.h"
 
 @class NGLMeshElements, NGLMaterialMulti, NGLSurfaceMulti;
 
+/*!
+ *					The efficiency of an array of indices with the post-transform vertex cache of the GPU.
+ *
+ *	@var			NGLVertexCacheMetrics::acmr
+ *					The average cache miss ratio, the number of transformed vertices per triangle.
+ *					It goes from 3.0, the worst case, down to around 0.5 on regular meshes.
+ *	
+ *	@var			NGLVertexCacheMetrics::atvr
+ *					The average transformed vertex ratio, the number of transformed vertices per vertex.
+ *					The ideal is 1.0, when each vertex is transformed only once.
+ */
+typedef struct
+{
+	float					acmr;
+	float					atvr;
+} NGLVertexCacheMetrics;
+
+/*!
+ *					Measures an array of indices with a FIFO post-transform vertex cache.
+ *
+ *					This function just simulates the cache, it doesn't need the GPU.
+ *
+ *	@param			indices
+ *					The array of indices, with 3 indices per triangle.
+ *
+ *	@param			count
+ *					The number of indices.
+ *
+ *	@param			cacheSize
+ *					The number of vertices in the cache. NinevehGL uses NGL_VERTEX_CACHE.
+ *
+ *	@result			A NGLVertexCacheMetrics with the ACMR and the ATVR.
+ */
+NGL_API NGLVertexCacheMetrics nglVertexCacheMetrics(const UInt32 *indices, UInt32 count, UInt32 cacheSize);
+
+/*!
+ *					Chooses the level of detail to a size on the screen.
+ *
+ *					The chosen level is the simplest one whose error, projected on the screen, doesn't
+ *					exceed the threshold. This function doesn't need the GPU.
+ *
+ *	@param			errors
+ *					The errors of the levels, relative to the mesh's diagonal. The level 0, the original
+ *					mesh, has no error and the errors grow with the levels.
+ *
+ *	@param			count
+ *					The number of levels, including the level 0.
+ *
+ *	@param			size
+ *					The size of the mesh's diagonal on the screen, in pixels.
+ *
+ *	@param			threshold
+ *					The maximum error on the screen, in pixels. NinevehGL uses nglDefaultLODThreshold.
+ *					A threshold of 0.0 always chooses the level 0.
+ *
+ *	@result			The level of detail, from 0 to count - 1.
+ */
+NGL_API UInt32 nglLevelForSize(const float *errors, UInt32 count, float size, float threshold);
+
+/*!
+ *					Finds the visible clusters, the ones inside the frustum and not facing away from the
+ *					eye. The tests are conservative, a cluster is hidden only when none of its triangles
+ *					could be drawn. This function doesn't need the GPU.
+ *
+ *	@param			clusters
+ *					The clusters to test.
+ *
+ *	@param			count
+ *					The number of clusters.
+ *
+ *	@param			mvp
+ *					The MODEL_VIEW_PROJECTION matrix, its frustum is tested against the clusters' bounds.
+ *
+ *	@param			eye
+ *					The position of the eye in the mesh's space.
+ *
+ *	@param			facing
+ *					The side of the faces culled by the GPU: 1.0 culls the clusters facing away from the
+ *					eye, -1.0 the clusters facing it and 0.0 doesn't test the normal cones.
+ *
+ *	@param			visible
+ *					An array with one element per cluster, it receives the visibility of each one.
+ *
+ *	@result			The number of indices in the visible clusters.
+ */
+NGL_API UInt32 nglCullClusters(const NGLCluster *clusters,
+							   UInt32 count,
+							   NGLmat4 mvp,
+							   NGLvec3 eye,
+							   float facing,
+							   BOOL *visible);
+
+/*!
+ *					Finds the window of vertices referenced by a range of indices and by its levels of
+ *					detail, choosing the size of the range's indices on the GPU.
+ *
+ *					The range and its levels are rebased to the first vertex of the window, so a window
+ *					with up to 65536 vertices uses 16 bits indices, even in a mesh with more vertices.
+ *
+ *	@param			indices
+ *					The array of indices.
+ *
+ *	@param			start
+ *					The first index of the range.
+ *
+ *	@param			length
+ *					The number of indices of the range.
+ *
+ *	@param			levels
+ *					The levels of detail. Only the levels of this range are included in the window.
+ *
+ *	@param			levelsCount
+ *					The number of levels. It can be 0.
+ *
+ *	@param			lodIndices
+ *					The array of levels' indices. It can be NULL.
+ *
+ *	@result			A NGLWindow with the first vertex, the number of vertices and the size of the indices.
+ */
+NGL_API NGLWindow nglVertexWindow(const UInt32 *indices,
+								  UInt32 start,
+								  UInt32 length,
+								  const NGLLevel *levels,
+								  UInt32 levelsCount,
+								  const UInt32 *lodIndices);
+
+/*!
+ *					Chooses the compact formats of the elements in the GPU and packs them in a vertex.
+ *
+ *					Each element gets the smallest format whose error stays in the tolerance: normalized
+ *					shorts or half floats for the positions (floats when none fits), normalized bytes for
+ *					the normals, tangents and bitangents, normalized unsigned shorts or half floats for
+ *					the texture coordinates. The positions with all the w equal to 1.0 drop the w.
+ *
+ *	@param			elements
+ *					The elements of the array of structures. Their formats, sizes and offsets are changed.
+ *
+ *	@param			structures
+ *					The array of structures.
+ *
+ *	@param			count
+ *					The number of elements in the array of structures.
+ *
+ *	@param			stride
+ *					The stride of the array of structures.
+ *
+ *	@param			halfFloat
+ *					Indicates if the GPU reads half floats (GL_OES_vertex_half_float). Without them, the
+ *					elements that would be half floats stay as floats.
+ *
+ *	@result			A NGLPrecisionMetrics with the errors of the chosen formats.
+ */
+NGL_API NGLPrecisionMetrics nglDefineFormats(NGLMeshElements *elements,
+											 const float *structures,
+											 UInt32 count,
+											 UInt32 stride,
+											 BOOL halfFloat);
+
+/*!
+ *					Converts the array of structures to the packed vertices, with the formats, sizes and
+ *					offsets of the elements.
+ *
+ *	@param			elements
+ *					The packed elements.
+ *
+ *	@param			structures
+ *					The array of structures.
+ *
+ *	@param			count
+ *					The number of elements in the array of structures.
+ *
+ *	@param			stride
+ *					The stride of the array of structures.
+ *
+ *	@param			output
+ *					The packed vertices. It must have room for the vertices times the packed stride.
+ *
+ *	@see			NGLMeshElements::packedStride
+ */
+NGL_API void nglPackStructures(NGLMeshElements *elements,
+							   const float *structures,
+							   UInt32 count,
+							   UInt32 stride,
+							   void *output);
+
+/*!
+ *					Evaluates the matrix palette of a skeleton, the matrices which move the vertices from
+ *					the bind pose to a pose of the joints.
+ *
+ *					Each matrix of the palette is the world transformation of a joint multiplied by its
+ *					inverse bind matrix. In the rest pose, the palette is made of identities.
+ *
+ *	@param			joints
+ *					The joints of the skeleton, with the parents before their children.
+ *
+ *	@param			pose
+ *					The local transformations of the joints, relative to their parents. NULL uses the
+ *					rest transformations of the joints.
+ *
+ *	@param			count
+ *					The number of joints.
+ *
+ *	@param			palette
+ *					The matrix palette. It must have room for the number of joints.
+ *
+ *	@see			NGLJoint
+ */
+NGL_API void nglSkinPalette(const NGLJoint *joints, NGLmat4 *pose, UInt32 count, NGLmat4 *palette);
+
+/*!
+ *					Moves the vertices of an array of structures with a matrix palette, just like the
+ *					skinned shaders do on the GPU.
+ *
+ *					Each vertex is moved by the sum of the matrices of its joints, scaled by their weights.
+ *					The remaining weight, up to 1.0, keeps the vertex in the bind pose. The normals, the
+ *					tangents and the bitangents are rotated and normalized.
+ *
+ *	@param			elements
+ *					The elements of the array of structures, with the bone indices and the bone weights.
+ *
+ *	@param			structures
+ *					The array of structures.
+ *
+ *	@param			count
+ *					The number of elements in the array of structures.
+ *
+ *	@param			stride
+ *					The stride of the array of structures.
+ *
+ *	@param			palette
+ *					The matrix palette.
+ *
+ *	@param			jointsCount
+ *					The number of matrices in the palette. Bone indices out of it are ignored.
+ *
+ *	@param			output
+ *					The skinned array of structures, with the same count and stride of the original one.
+ *
+ *	@see			nglSkinPalette
+ */
+NGL_API void nglSkinStructures(NGLMeshElements *elements,
+							   const float *structures,
+							   UInt32 count,
+							   UInt32 stride,
+							   NGLmat4 *palette,
+							   UInt32 jointsCount,
+							   float *output);
+
 /*!
  *					<strong>(Internal only)</strong> The core of NinevehGL Parse API.
  *					It's the superclass for all mesh parsing classes.
@@ -44,6 +293,16 @@
  *						- Calculates the bouding box to the mesh;
  *						- Transform brute 3D data into OpenGL friendly format (array of structures and
  *							array of indices).
+ *						- Reorders the triangles for the vertex cache and the overdraw, then the vertices
+ *							in the order they are used by the triangles.
+ *						- Generates the levels of detail, simplified arrays of indices sharing the same
+ *							array of structures.
+ *						- Partitions the ranges of indices in clusters with bounds and normal cones, so
+ *							the hidden parts of a mesh can be skipped at the draw time.
+ *						- Finds the window of vertices of each range, so the ranges with up to 65536
+ *							vertices use 16 bits indices on the GPU.
+ *						- Stores up to four joints per vertex, with their weights, when the mesh has
+ *							a skeleton.
  *
  *					This class needs some information like array of vertices and array of faces. Other
  *					information like array of texcoords and array of normals are optionals. These are
@@ -52,8 +311,13 @@
  *						- Array of Vertices: vx1, vy1, vz1, vw1, vx2, vy2, vz2, vw2, ...
  *						- Array of Texcoords: ts1, tt1, ts2, tt2, ...
  *						- Array of Normals: nx1, ny1, nz1, nx2, ny2, nz2, ...
+ *						- Array of Bone Indices: bi1, bj1, bk1, bl1, bi2, bj2, bk2, bl2, ...
+ *						- Array of Bone Weights: bw1, bx1, by1, bz1, bw2, bx2, by2, bz2, ...
  *						- Array of Faces: iv1, it1, in1, iv2, it2, in2, ...
  *
+ *					The bones have one entry per vertex position, they use the same index of the vertex
+ *					in the array of faces.
+ *
  *					Each index in the array of faces doesn't reffer directly to an index in the desired
  *					array, but instead, it points to an element index. For example:
  *
@@ -117,6 +381,28 @@
 	UInt32                  _stride;
 	UInt32                  *_indices;
 	float					*_structures;
+	NSData					*_mappedData;
+	
+	// Levels of Detail
+	UInt32                  _levelsCount;
+	UInt32                  _lodCount;
+	NGLLevel				*_levels;
+	UInt32                  *_lodIndices;
+	
+	// Clusters
+	UInt32                  _clustersCount;
+	NGLCluster				*_clusters;
+	
+	// Windows
+	UInt32                  _windowsCount;
+	NGLWindow				*_windows;
+	
+	// Skeleton
+	UInt32                  _jointsCount;
+	NGLJoint				*_joints;
+	NSArray					*_jointNames;
+	float					*_boneIndices;
+	float					*_boneWeights;
 	
 	// Mesh Structure
 	NGLMeshElements			*_meshElements;
@@ -138,6 +424,7 @@
 @private
 	// Helpers
 	float					*_adjusted;
+	NGLJoint				*_aJoints;
 	BOOL					_aCache;
 	
 	// Adjusts
@@ -146,6 +433,10 @@
 	NGLvec3					_vMin;
 	NGLvec3					_vMax;
 	NGLvec3					_vCen;
+	
+	// Optimization
+	NGLVertexCacheMetrics	_originalMetrics;
+	NGLVertexCacheMetrics	_optimizedMetrics;
 }
 
 /*!
@@ -186,6 +477,100 @@
  */
 @property (nonatomic, readonly) float *structures;
 
+/*!
+ *					The memory-mapped file in which the array of indices and the array of structures lie.
+ *					It's nil when the arrays were allocated by the parser.
+ *
+ *					The mapped arrays are read only and they are valid only while this data is alive.
+ *					Retaining it is enough to use them without any copy.
+ */
+@property (nonatomic, readonly) NSData *mappedData;
+
+/*!
+ *					The number of ranges in the levels of detail, all the levels together.
+ */
+@property (nonatomic, readonly) UInt32 levelsCount;
+
+/*!
+ *					The ranges of the levels of detail, sorted by level. Each range of the original array
+ *					of indices has one range in each level.
+ *
+ *	@see			NGLLevel
+ */
+@property (nonatomic, readonly) NGLLevel *levels;
+
+/*!
+ *					The number of elements in the array of levels' indices.
+ */
+@property (nonatomic, readonly) UInt32 lodCount;
+
+/*!
+ *					The array of levels' indices. All the levels of detail lie in this array, one after
+ *					another, pointing to the same array of structures as the array of indices.
+ */
+@property (nonatomic, readonly) UInt32 *lodIndices;
+
+/*!
+ *					The number of clusters.
+ */
+@property (nonatomic, readonly) UInt32 clustersCount;
+
+/*!
+ *					The clusters of the array of indices, sorted by their starts. Each range of the array
+ *					(usually a surface) is partitioned in its own clusters.
+ *
+ *	@see			NGLCluster
+ */
+@property (nonatomic, readonly) NGLCluster *clusters;
+
+/*!
+ *					The number of windows.
+ */
+@property (nonatomic, readonly) UInt32 windowsCount;
+
+/*!
+ *					The windows of vertices, one to each range of the array of indices (usually a surface).
+ *					The window also chooses the size of the range's indices on the GPU.
+ *
+ *	@see			NGLWindow
+ */
+@property (nonatomic, readonly) NGLWindow *windows;
+
+/*!
+ *					The number of joints in the skeleton. It's 0 when the mesh has no skeleton.
+ */
+@property (nonatomic, readonly) UInt32 jointsCount;
+
+/*!
+ *					The joints of the skeleton, with the parents before their children. Just like the
+ *					array of structures, the joints follow the auto centralize and auto normalize.
+ *
+ *	@see			NGLJoint
+ */
+@property (nonatomic, readonly) NGLJoint *joints;
+
+/*!
+ *					The names of the joints, in the same order of the joints.
+ */
+@property (nonatomic, readonly) NSArray *jointNames;
+
+/*!
+ *					The vertex cache metrics of the array of indices before the optimization, in the
+ *					original order of the triangles. It's zero when the structure was not defined by this
+ *					parser, like the cached NGL Binary files.
+ *
+ *	@see			NGLVertexCacheMetrics
+ */
+@property (nonatomic, readonly) NGLVertexCacheMetrics originalMetrics;
+
+/*!
+ *					The vertex cache metrics of the optimized array of indices. It's zero when the structure
+ *					was not defined by this parser, like the cached NGL Binary files.
+ *
+ *	@see			NGLVertexCacheMetrics
+ */
+@property (nonatomic, readonly) NGLVertexCacheMetrics optimizedMetrics;
+
 /*!
  *					The elements that forms the mesh structure.
  *
@@ -273,7 +658,8 @@
  *					normals and faces.
  *
  *					This method will create all the arrays necessaries to OpenGL. Besides it calculates
- *					the tangent space.
+ *					the tangent space, reorders the triangles and the vertices for the GPU caches,
+ *					generates the levels of detail and partitions the triangles in clusters.
  */
 - (void) defineStructure;
 
@@ -21,6 +21,7 @@
  */
 
 #import "NGLParserMesh.h"
+#import "NGLJob.h"
 
 #pragma mark -
 #pragma mark Constants
@@ -53,6 +54,122 @@ The number of unique faces in your file should not exceed it.";
 //	Private Definitions
 //**************************************************
 
+// Maximum number of elements in a face vertex, one for each NGLComponent.
+#define MSH_MAX_ELEMENTS	7
+
+// Minimum number of face vertices to partition the deduplication across the processor cores.
+#define MSH_PARTITION_FACES	(1 << 20)
+
+// Marks an empty slot in the hash table. No face vertex can reach this index.
+#define MSH_EMPTY_SLOT		NGL_MAX_32
+
+// Describes which values in the array of faces identify a unique face vertex.
+typedef struct
+{
+	const UInt32	*faces;
+	UInt32			stride;
+	UInt32			count;
+	UInt32			offsets[MSH_MAX_ELEMENTS];
+} MSHFaceKey;
+
+// Minimum number of face vertices to spread the tangent space across the processor cores.
+#define MSH_PARALLEL_FACES	(1 << 14)
+
+// Number of tasks per worker for the tangent space. Positions shared by many faces are unbalanced.
+#define MSH_CORE_TASKS		4
+
+// Shares the data of the tangent space between the concurrent tasks. Each task works on its own range of
+// triangles or vertex positions and never writes to the range of another task.
+typedef struct
+{
+	// Original elements.
+	const UInt32	*faces;
+	const float		*vertices;
+	const float		*normals;
+	const float		*texcoords;
+	UInt32			oldStride, newStride;
+	UInt32			vLength, vOffset;
+	UInt32			nLength, nOffset;
+	UInt32			tLength, tOffset;
+	UInt32			positions;
+	BOOL			hasNormals;
+	BOOL			hasTextures;
+	const BOOL		*canceled;
+	
+	// Face vectors, one for each triangle.
+	NGLvec3			*faceNormals;
+	NGLvec3			*faceTangents;
+	NGLvec3			*faceBitangents;
+	
+	// Flat adjacency from the positions to their face vertices and the smoothing group of each one.
+	// The extras are the number of extra groups of each position, later the slot of its first extra group.
+	UInt32			*starts;
+	UInt32			*corners;
+	UInt32			*groups;
+	UInt32			*extras;
+	
+	// Outputs.
+	UInt32			*newFaces;
+	NGLvec3			*normalBuffer;
+	NGLvec3			*tangentBuffer;
+	NGLvec3			*bitangentBuffer;
+} MSHTangentSpace;
+
+// A cluster of triangles in the array of indices, sorted to reduce the overdraw.
+typedef struct
+{
+	UInt32			start;
+	UInt32			length;
+	float			sort;
+} MSHCluster;
+
+// Symmetric quadric of the squared distances to a set of planes (Garland and Heckbert). The weight is the area
+// of the triangles in the quadric, it turns the summed error into the mean squared distance.
+typedef struct
+{
+	double			a00, a01, a02, a11, a12, a22;
+	double			b0, b1, b2;
+	double			c;
+	double			weight;
+} MSHQuadric;
+
+// A half-edge collapse, the vertex "from" moves onto the vertex "to".
+typedef struct
+{
+	UInt32			from;
+	UInt32			to;
+	double			cost;
+} MSHCollapse;
+
+// Weight of the planes that keep the open borders of the mesh in place, relative to the triangles' planes.
+#define MSH_BORDER_WEIGHT	10.0
+
+// Minimum cosine between the normals of a triangle before and after a collapse. Lower values flip triangles.
+#define MSH_FLIP_COSINE		0.2f
+
+// Extra cost accepted in a pass of collapses, over the cost of the cheapest ones that would reach its goal.
+#define MSH_PASS_SLACK		1.5
+
+// Each level must have at most this ratio of the indices of the previous one, otherwise the chain stops.
+#define MSH_LEVEL_PROGRESS	0.85f
+
+// Minimum number of triangles of a range of indices to generate its levels of detail.
+#define MSH_LEVEL_TRIANGLES	32
+
+// Maximum number of triangles in a cluster.
+#define MSH_CLUSTER_TRIANGLES	128
+
+// Minimum number of triangles in a cluster before it can be closed by a distant or deviating triangle.
+#define MSH_CLUSTER_MIN		32
+
+// Minimum cosine between the normal of a triangle and the average normal of the cluster that takes it.
+#define MSH_CLUSTER_COSINE	0.7f
+
+// Maximum error of the compact positions, relative to the mesh's diagonal.
+#define MSH_FORMAT_TOLERANCE	(1.0f / 4096.0f)
+
+// Maximum error of the compact texture coordinates, a texel of a 4096 texture.
+#define MSH_FORMAT_TEXEL	(1.0f / 4096.0f)
 
 #pragma mark -
 #pragma mark Private Functions
@@ -60,56 +177,1536 @@ The number of unique faces in your file should not exceed it.";
 //	Private Functions
 //**************************************************
 
-// Checks the crease angle for the normal calculations.
-// This function creates and divides the normals to a vertex recursively.
-static UInt32 creaseAngle(UInt32 index,
-								NGLvec3 vector,
-								NGLvec3 **buffer,
-								UInt32 *count,
-								NSMutableDictionary *list)
+// Hashes the valid elements of a face vertex. FNV-1a followed by a final avalanche.
+NGL_INLINE UInt32 meshHashFace(const MSHFaceKey *key, UInt32 face)
+{
+	const UInt32 *values = key->faces + (face * key->stride);
+	UInt32 hash = 2166136261u;
+	UInt32 i;
+	
+	for (i = 0; i < key->count; ++i)
+	{
+		hash = (hash ^ values[key->offsets[i]]) * 16777619u;
+	}
+	
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6Bu;
+	hash ^= hash >> 13;
+	
+	return hash;
+}
+
+// Compares the valid elements of two face vertices.
+NGL_INLINE BOOL meshEqualFaces(const MSHFaceKey *key, UInt32 faceA, UInt32 faceB)
+{
+	const UInt32 *valuesA = key->faces + (faceA * key->stride);
+	const UInt32 *valuesB = key->faces + (faceB * key->stride);
+	UInt32 i;
+	
+	for (i = 0; i < key->count; ++i)
+	{
+		if (valuesA[key->offsets[i]] != valuesB[key->offsets[i]])
+		{
+			return NO;
+		}
+	}
+	
+	return YES;
+}
+
+// Finds, for every face vertex in a partition, the first face vertex with the same valid elements.
+// Each partition owns the face vertices whose hash modulo the number of partitions is equal to its index,
+// so the partitions never share a face vertex and can run concurrently. The hash table is an open
+// addressing table with linear probing that stores the first face vertex of each unique combination.
+static void meshDeduplicatePartition(const MSHFaceKey *key,
+									 const UInt32 *hashes,
+									 UInt32 *firsts,
+									 UInt32 count,
+									 UInt32 partition,
+									 UInt32 partitions,
+									 const BOOL *canceled)
+{
+	UInt32 i, hash, slot, first, mask, size = 2, items = 0;
+	UInt32 *table;
+	
+	// Sizes the table to keep it, at most, half full.
+	for (i = 0; i < count; ++i)
+	{
+		items += (hashes[i] % partitions == partition);
+	}
+	
+	while (size < items * 2)
+	{
+		size <<= 1;
+	}
+	
+	mask = size - 1;
+	table = malloc(size * NGL_SIZE_UINT);
+	memset(table, 0xFF, size * NGL_SIZE_UINT);
+	
+	// Walks the face vertices in order, so the first found is always the first one in the array of faces.
+	for (i = 0; i < count; ++i)
+	{
+		hash = hashes[i];
+		
+		if (hash % partitions != partition)
+		{
+			continue;
+		}
+		
+		// Canceled status.
+		if (*canceled)
+		{
+			break;
+		}
+		
+		slot = (hash / partitions) & mask;
+		while ((first = table[slot]) != MSH_EMPTY_SLOT)
+		{
+			if (hashes[first] == hash && meshEqualFaces(key, first, i))
+			{
+				break;
+			}
+			
+			slot = (slot + 1) & mask;
+		}
+		
+		// Processes new face vertices.
+		if (first == MSH_EMPTY_SLOT)
+		{
+			table[slot] = first = i;
+		}
+		
+		firsts[i] = first;
+	}
+	
+	nglFree(table);
+}
+
+// Calculates the vectors of a range of triangles: the face normal and, with texture coordinates,
+// the face tangent and bitangent. The normal is not normalized, so bigger faces weigh more in the average.
+static void meshFaceVectors(const MSHTangentSpace *space, UInt32 first, UInt32 last)
+{
+	const UInt32 *face;
+	UInt32 i1, i2, i3;
+	NGLvec3 vA, vB, vC;
+	NGLvec2 tA, tB, tC;
+	NGLvec3 distBA, distCA;
+	NGLvec2 tdistBA, tdistCA;
+	NGLvec3 normal, tangent;
+	float area, delta;
+	UInt32 stride = space->oldStride;
+	
+	for (; first < last; ++first)
+	{
+		// Canceled status.
+		if (*space->canceled)
+		{
+			break;
+		}
+		
+		// Triangle Vertices. At this moment the faces are an ordered list of elements' indices:
+		// iv1, it1, in1, iv2, in2, it2, iv3, it3, in3...
+		face = space->faces + (first * 3 * stride);
+		i1 = face[space->vOffset] * space->vLength;
+		i2 = face[stride + space->vOffset] * space->vLength;
+		i3 = face[stride * 2 + space->vOffset] * space->vLength;
+		
+		// Retrieves 3 vertices from the array of vertices.
+		vA = (NGLvec3){space->vertices[i1], space->vertices[i1 + 1], space->vertices[i1 + 2]};
+		vB = (NGLvec3){space->vertices[i2], space->vertices[i2 + 1], space->vertices[i2 + 2]};
+		vC = (NGLvec3){space->vertices[i3], space->vertices[i3 + 1], space->vertices[i3 + 2]};
+		
+		// Calculates the vector of the edges, the distance between the vertices.
+		distBA = nglVec3Subtract(vB, vA);
+		distCA = nglVec3Subtract(vC, vA);
+		
+		//*************************
+		//	Normal
+		//*************************
+		if (!space->hasNormals)
+		{
+			normal = nglVec3Cross(distBA, distCA);
+		}
+		else
+		{
+			// If the parsed file has normals in it, retrieves their indices in the array of normals.
+			i1 = face[space->nOffset] * space->nLength;
+			i2 = face[stride + space->nOffset] * space->nLength;
+			i3 = face[stride * 2 + space->nOffset] * space->nLength;
+			
+			vA = (NGLvec3){space->normals[i1], space->normals[i1 + 1], space->normals[i1 + 2]};
+			vB = (NGLvec3){space->normals[i2], space->normals[i2 + 1], space->normals[i2 + 2]};
+			vC = (NGLvec3){space->normals[i3], space->normals[i3 + 1], space->normals[i3 + 2]};
+			
+			normal = nglVec3Add(nglVec3Add(vA, vB), vC);
+		}
+		
+		space->faceNormals[first] = normal;
+		
+		//*************************
+		//	Tangent and Bitangent
+		//*************************
+		if (space->hasTextures)
+		{
+			i1 = face[space->tOffset] * space->tLength;
+			i2 = face[stride + space->tOffset] * space->tLength;
+			i3 = face[stride * 2 + space->tOffset] * space->tLength;
+			
+			tA = (NGLvec2){space->texcoords[i1], space->texcoords[i1 + 1]};
+			tB = (NGLvec2){space->texcoords[i2], space->texcoords[i2 + 1]};
+			tC = (NGLvec2){space->texcoords[i3], space->texcoords[i3 + 1]};
+			
+			// Calculates the vector of the texture coordinates edges and the triangle's area.
+			tdistBA = nglVec2Subtract(tB, tA);
+			tdistCA = nglVec2Subtract(tC, tA);
+			area = tdistBA.x * tdistCA.y - tdistBA.y * tdistCA.x;
+			
+			if (area == 0.0f)
+			{
+				tangent = kNGLvec3Zero;
+			}
+			else
+			{
+				delta = 1.0f / area;
+				
+				tangent.x = delta * ((distBA.x * tdistCA.y) + (distCA.x * -tdistBA.y));
+				tangent.y = delta * ((distBA.y * tdistCA.y) + (distCA.y * -tdistBA.y));
+				tangent.z = delta * ((distBA.z * tdistCA.y) + (distCA.z * -tdistBA.y));
+			}
+			
+			// The bitangent completes the orthogonalized tangent space.
+			space->faceTangents[first] = tangent;
+			space->faceBitangents[first] = nglVec3Cross(normal, tangent);
+		}
+	}
+}
+
+// Builds the flat adjacency from the vertex positions to their face vertices with a counting sort.
+// The face vertices of the position P are corners[starts[P]] to corners[starts[P + 1] - 1], in the faces order.
+static void meshAdjacency(MSHTangentSpace *space, UInt32 count)
+{
+	UInt32 i, position;
+	UInt32 *cursor;
+	UInt32 stride = space->oldStride;
+	UInt32 offset = space->vOffset;
+	UInt32 length = space->positions;
+	
+	for (i = 0; i < count; ++i)
+	{
+		++space->starts[space->faces[i * stride + offset] + 1];
+	}
+	
+	for (i = 0; i < length; ++i)
+	{
+		space->starts[i + 1] += space->starts[i];
+	}
+	
+	cursor = malloc(length * NGL_SIZE_UINT);
+	memcpy(cursor, space->starts, length * NGL_SIZE_UINT);
+	
+	for (i = 0; i < count; ++i)
+	{
+		position = space->faces[i * stride + offset];
+		space->corners[cursor[position]++] = i;
+	}
+	
+	nglFree(cursor);
+}
+
+// Splits the face vertices of a range of positions by the crease angle. The face vertices are visited in the
+// faces order and each one joins the first smoothing group whose averaged normal forms an acceptable angle
+// with its face normal, otherwise it creates a new group. The first group of a position is the position
+// itself, the number of extra groups is written to the array of extras.
+static void meshCreasePositions(const MSHTangentSpace *space, UInt32 first, UInt32 last)
+{
+	NGLvec3 normal, *sums = NULL;
+	UInt32 i, start, count, group, total, capacity = 0;
+	
+	for (; first < last; ++first)
+	{
+		// Canceled status.
+		if (*space->canceled)
+		{
+			break;
+		}
+		
+		start = space->starts[first];
+		count = space->starts[first + 1] - start;
+		
+		// Each face vertex creates at most one group.
+		if (capacity < count + 1)
+		{
+			capacity = count + 1;
+			sums = realloc(sums, NGL_SIZE_VEC3 * capacity);
+		}
+		
+		sums[0] = kNGLvec3Zero;
+		total = 1;
+		
+		for (i = start; i < start + count; ++i)
+		{
+			normal = space->faceNormals[space->corners[i] / 3];
+			group = 0;
+			
+			// An empty group always accepts the normal. Eliminates the NaN points before the test.
+			sums[group] = nglVec3Cleared(sums[group]);
+			while (!nglVec3IsZero(sums[group]) &&
+				   nglVec3Dot(nglVec3Normalize(normal), nglVec3Normalize(sums[group])) <= kCreaseAngle)
+			{
+				if (++group == total)
+				{
+					sums[total++] = kNGLvec3Zero;
+				}
+				
+				sums[group] = nglVec3Cleared(sums[group]);
+			}
+			
+			space->groups[i] = group;
+			sums[group] = nglVec3Add(normal, sums[group]);
+		}
+		
+		space->extras[first] = total - 1;
+	}
+	
+	nglFree(sums);
+}
+
+// Averages the face vectors into the final slots of a range of positions and writes the new face vertices.
+// The slots of a position are never shared with other positions and the face vertices are visited in the
+// faces order, so the sums are the same regardless the number of concurrent tasks.
+static void meshAccumulatePositions(const MSHTangentSpace *space, UInt32 first, UInt32 last)
+{
+	const UInt32 *inFace;
+	UInt32 *outFace;
+	UInt32 i, j, end, corner, triangle, slot;
+	UInt32 oldStride = space->oldStride;
+	UInt32 newStride = space->newStride;
+	
+	for (; first < last; ++first)
+	{
+		// Canceled status.
+		if (*space->canceled)
+		{
+			break;
+		}
+		
+		end = space->starts[first + 1];
+		for (i = space->starts[first]; i < end; ++i)
+		{
+			corner = space->corners[i];
+			triangle = corner / 3;
+			slot = (space->groups[i] == 0) ? first : space->extras[first] + space->groups[i] - 1;
+			
+			if (!space->hasNormals)
+			{
+				space->normalBuffer[slot] = nglVec3Add(space->faceNormals[triangle], space->normalBuffer[slot]);
+			}
+			
+			if (space->hasTextures)
+			{
+				space->tangentBuffer[slot] = nglVec3Add(space->faceTangents[triangle], space->tangentBuffer[slot]);
+				space->bitangentBuffer[slot] = nglVec3Add(space->faceBitangents[triangle],
+														  space->bitangentBuffer[slot]);
+			}
+			
+			// Copies the oldest face indices and inserts the new created indices.
+			inFace = space->faces + (corner * oldStride);
+			outFace = space->newFaces + (corner * newStride);
+			for (j = 0; j < newStride; ++j)
+			{
+				outFace[j] = (j < oldStride) ? inFace[j] : slot;
+			}
+		}
+	}
+}
+
+// Normalizes a range of the averaged vectors and writes them to the final arrays.
+static void meshNormalizeVectors(const NGLvec3 *buffer, float *output, UInt32 first, UInt32 last)
+{
+	NGLvec3 vector;
+	
+	for (; first < last; ++first)
+	{
+		vector = nglVec3Normalize(buffer[first]);
+		output[first * 3] = vector.x;
+		output[first * 3 + 1] = vector.y;
+		output[first * 3 + 2] = vector.z;
+	}
+}
+
+// Reorders the triangles of a range of indices for the post-transform vertex cache (Tipsify, Sander et al.).
+// The triangles are fanned around a vertex at a time, the next fanning vertex is the candidate that will still be
+// in the cache after its remaining triangles, or the most recent dead-end. The winding of each triangle is kept.
+// The range is split in clusters where the cache is flushed, the first triangle of each cluster is written
+// to the array of clusters and the number of clusters is returned. The local array must have one entry to
+// each vertex in the structures, all set to MSH_EMPTY_SLOT, and it's restored before returning.
+static UInt32 meshTipsify(UInt32 *indices, UInt32 count, UInt32 cacheSize, UInt32 *local, UInt32 *clusters)
+{
+	UInt32 triangles = count / 3;
+	UInt32 i, j, k, t, v, end, vertices = 0, emitted = 0, total = 0;
+	UInt32 stamp = cacheSize + 1, next = 0, deadCount = 0, candidateCount = 0;
+	UInt32 *ids, *globals, *live, *starts, *cursor, *adjacency, *stamps, *deadEnds, *candidates, *output;
+	SInt64 fanning, priority, best;
+	BOOL *done;
+	
+	if (triangles == 0)
+	{
+		return 0;
+	}
+	
+	// Numbers the vertices of this range locally, in the order they are used.
+	ids = malloc(count * NGL_SIZE_UINT);
+	globals = malloc(count * NGL_SIZE_UINT);
+	
+	for (i = 0; i < count; ++i)
+	{
+		v = indices[i];
+		if (local[v] == MSH_EMPTY_SLOT)
+		{
+			local[v] = vertices;
+			globals[vertices++] = v;
+		}
+		
+		ids[i] = local[v];
+	}
+	
+	// Flat adjacency from the vertices to their triangles and the number of live triangles of each vertex.
+	live = calloc(vertices, NGL_SIZE_UINT);
+	starts = calloc(vertices + 1, NGL_SIZE_UINT);
+	cursor = malloc(vertices * NGL_SIZE_UINT);
+	adjacency = malloc(triangles * 3 * NGL_SIZE_UINT);
+	
+	for (i = 0; i < triangles * 3; ++i)
+	{
+		++live[ids[i]];
+	}
+	
+	for (i = 0; i < vertices; ++i)
+	{
+		starts[i + 1] = starts[i] + live[i];
+		cursor[i] = starts[i];
+	}
+	
+	for (i = 0; i < triangles * 3; ++i)
+	{
+		adjacency[cursor[ids[i]]++] = i / 3;
+	}
+	
+	stamps = calloc(vertices, NGL_SIZE_UINT);
+	deadEnds = malloc(triangles * 3 * NGL_SIZE_UINT);
+	candidates = malloc(triangles * 3 * NGL_SIZE_UINT);
+	output = malloc(triangles * 3 * NGL_SIZE_UINT);
+	done = calloc(triangles, sizeof(BOOL));
+	
+	clusters[total++] = 0;
+	fanning = 0;
+	
+	while (fanning >= 0)
+	{
+		// Emits all the live triangles around the fanning vertex.
+		candidateCount = 0;
+		end = starts[fanning + 1];
+		for (j = starts[fanning]; j < end; ++j)
+		{
+			t = adjacency[j];
+			if (done[t])
+			{
+				continue;
+			}
+			
+			for (k = 0; k < 3; ++k)
+			{
+				v = ids[t * 3 + k];
+				output[emitted++] = indices[t * 3 + k];
+				deadEnds[deadCount++] = v;
+				candidates[candidateCount++] = v;
+				--live[v];
+				
+				// Cache miss.
+				if (stamp - stamps[v] > cacheSize)
+				{
+					stamps[v] = stamp++;
+				}
+			}
+			
+			done[t] = YES;
+		}
+		
+		// The best candidate stays in the cache after fanning all its live triangles, the older the better.
+		best = -1;
+		priority = -1;
+		for (j = 0; j < candidateCount; ++j)
+		{
+			v = candidates[j];
+			if (live[v] > 0)
+			{
+				k = (stamp - stamps[v] + 2 * live[v] <= cacheSize) ? stamp - stamps[v] : 0;
+				if ((SInt64)k > priority)
+				{
+					priority = k;
+					best = v;
+				}
+			}
+		}
+		
+		// Dead-end, the most recent vertex with live triangles or the next one in the order of use.
+		// From now on the cache is considered flushed, so a new cluster starts.
+		if (best < 0)
+		{
+			while (best < 0 && deadCount > 0)
+			{
+				v = deadEnds[--deadCount];
+				if (live[v] > 0)
+				{
+					best = v;
+				}
+			}
+			
+			for (; best < 0 && next < vertices; ++next)
+			{
+				if (live[next] > 0)
+				{
+					best = next;
+				}
+			}
+			
+			if (best >= 0)
+			{
+				clusters[total++] = emitted / 3;
+			}
+		}
+		
+		fanning = best;
+	}
+	
+	memcpy(indices, output, emitted * NGL_SIZE_UINT);
+	
+	// Restores the local array.
+	for (i = 0; i < vertices; ++i)
+	{
+		local[globals[i]] = MSH_EMPTY_SLOT;
+	}
+	
+	nglFree(ids);
+	nglFree(globals);
+	nglFree(live);
+	nglFree(starts);
+	nglFree(cursor);
+	nglFree(adjacency);
+	nglFree(stamps);
+	nglFree(deadEnds);
+	nglFree(candidates);
+	nglFree(output);
+	nglFree(done);
+	
+	return total;
+}
+
+// Sorts the clusters with the descending order of the sort value.
+static int meshCompareClusters(const void *a, const void *b)
+{
+	const MSHCluster *clusterA = a, *clusterB = b;
+	
+	if (clusterA->sort != clusterB->sort)
+	{
+		return (clusterA->sort > clusterB->sort) ? -1 : 1;
+	}
+	
+	return (clusterA->start < clusterB->start) ? -1 : 1;
+}
+
+// Reorders the clusters of a range of indices to reduce the overdraw, independent of the view point.
+// The clusters that face outward of the mesh are drawn first, they tend to occlude the others. The sort value is
+// the dot product between the cluster normal and the direction from the mesh center to the cluster center.
+static void meshSortClusters(UInt32 *indices,
+							 UInt32 count,
+							 const UInt32 *starts,
+							 UInt32 total,
+							 const float *positions,
+							 UInt32 stride,
+							 NGLvec3 center)
+{
+	MSHCluster *clusters;
+	UInt32 *output, *outIndices;
+	UInt32 i, t, first, last;
+	const float *pA, *pB, *pC;
+	NGLvec3 vA, vB, vC, normal, sumNormal, sumCenter;
+	float area, sumArea;
+	
+	if (total < 2)
+	{
+		return;
+	}
+	
+	clusters = malloc(total * sizeof(MSHCluster));
+	
+	for (i = 0; i < total; ++i)
+	{
+		first = starts[i];
+		last = (i + 1 < total) ? starts[i + 1] : count / 3;
+		sumNormal = sumCenter = kNGLvec3Zero;
+		sumArea = 0.0f;
+		
+		// Each triangle weighs by its area.
+		for (t = first; t < last; ++t)
+		{
+			pA = positions + indices[t * 3] * stride;
+			pB = positions + indices[t * 3 + 1] * stride;
+			pC = positions + indices[t * 3 + 2] * stride;
+			
+			vA = (NGLvec3){pA[0], pA[1], pA[2]};
+			vB = (NGLvec3){pB[0], pB[1], pB[2]};
+			vC = (NGLvec3){pC[0], pC[1], pC[2]};
+			
+			normal = nglVec3Cross(nglVec3Subtract(vB, vA), nglVec3Subtract(vC, vA));
+			area = nglVec3Length(normal);
+			
+			sumNormal = nglVec3Add(sumNormal, normal);
+			sumCenter = nglVec3Add(sumCenter, nglVec3Multiplyf(nglVec3Add(nglVec3Add(vA, vB), vC), area / 3.0f));
+			sumArea += area;
+		}
+		
+		if (sumArea > 0.0f)
+		{
+			sumCenter = nglVec3Multiplyf(sumCenter, 1.0f / sumArea);
+		}
+		
+		clusters[i].start = first;
+		clusters[i].length = last - first;
+		clusters[i].sort = nglVec3Dot(nglVec3Subtract(sumCenter, center), nglVec3Normalize(sumNormal));
+	}
+	
+	qsort(clusters, total, sizeof(MSHCluster), meshCompareClusters);
+	
+	output = malloc(count * NGL_SIZE_UINT);
+	outIndices = output;
+	
+	for (i = 0; i < total; ++i)
+	{
+		memcpy(outIndices, indices + clusters[i].start * 3, clusters[i].length * 3 * NGL_SIZE_UINT);
+		outIndices += clusters[i].length * 3;
+	}
+	
+	memcpy(indices, output, count * NGL_SIZE_UINT);
+	
+	nglFree(output);
+	nglFree(clusters);
+}
+
+// Reorders the vertices in the order they are first used by the array of indices, so the GPU fetches the
+// array of structures sequentially. The unused vertices, if any, are placed at the end.
+static void meshReorderVertices(UInt32 *indices,
+								UInt32 count,
+								const float *structures,
+								float *output,
+								UInt32 vertices,
+								UInt32 stride)
+{
+	UInt32 i, used = 0;
+	UInt32 *remap = malloc(vertices * NGL_SIZE_UINT);
+	
+	memset(remap, 0xFF, vertices * NGL_SIZE_UINT);
+	
+	for (i = 0; i < count; ++i)
+	{
+		if (remap[indices[i]] == MSH_EMPTY_SLOT)
+		{
+			remap[indices[i]] = used++;
+		}
+		
+		indices[i] = remap[indices[i]];
+	}
+	
+	for (i = 0; i < vertices; ++i)
+	{
+		if (remap[i] == MSH_EMPTY_SLOT)
+		{
+			remap[i] = used++;
+		}
+		
+		memcpy(output + remap[i] * stride, structures + i * stride, stride * NGL_SIZE_FLOAT);
+	}
+	
+	nglFree(remap);
+}
+
+// Sorts unsigned integers in ascending order.
+static int meshCompareUInts(const void *a, const void *b)
+{
+	UInt32 valueA = *(const UInt32 *)a, valueB = *(const UInt32 *)b;
+	
+	return (valueA > valueB) - (valueA < valueB);
+}
+
+// Adds a plane, with unit normal, to a quadric.
+NGL_INLINE void meshQuadricAdd(MSHQuadric *quadric, NGLvec3 normal, float distance, double scale)
+{
+	quadric->a00 += scale * normal.x * normal.x;
+	quadric->a01 += scale * normal.x * normal.y;
+	quadric->a02 += scale * normal.x * normal.z;
+	quadric->a11 += scale * normal.y * normal.y;
+	quadric->a12 += scale * normal.y * normal.z;
+	quadric->a22 += scale * normal.z * normal.z;
+	quadric->b0 += scale * normal.x * distance;
+	quadric->b1 += scale * normal.y * distance;
+	quadric->b2 += scale * normal.z * distance;
+	quadric->c += scale * distance * distance;
+}
+
+// Sums a quadric to another one.
+NGL_INLINE void meshQuadricSum(MSHQuadric *quadric, const MSHQuadric *other)
+{
+	quadric->a00 += other->a00;
+	quadric->a01 += other->a01;
+	quadric->a02 += other->a02;
+	quadric->a11 += other->a11;
+	quadric->a12 += other->a12;
+	quadric->a22 += other->a22;
+	quadric->b0 += other->b0;
+	quadric->b1 += other->b1;
+	quadric->b2 += other->b2;
+	quadric->c += other->c;
+	quadric->weight += other->weight;
+}
+
+// Evaluates the summed squared distance from a point to the planes of a quadric.
+NGL_INLINE double meshQuadricError(const MSHQuadric *quadric, const float *point)
+{
+	double x = point[0], y = point[1], z = point[2];
+	double error;
+	
+	error = quadric->a00 * x * x + quadric->a11 * y * y + quadric->a22 * z * z +
+			2.0 * (quadric->a01 * x * y + quadric->a02 * x * z + quadric->a12 * y * z) +
+			2.0 * (quadric->b0 * x + quadric->b1 * y + quadric->b2 * z) + quadric->c;
+	
+	return (error > 0.0) ? error : 0.0;
+}
+
+// Returns the vector between two positions.
+NGL_INLINE NGLvec3 meshEdge(const float *from, const float *to)
+{
+	return (NGLvec3){to[0] - from[0], to[1] - from[1], to[2] - from[2]};
+}
+
+// Sorts the 64 bits edge keys in ascending order.
+static int meshCompareEdges(const void *a, const void *b)
+{
+	UInt64 valueA = *(const UInt64 *)a, valueB = *(const UInt64 *)b;
+	
+	return (valueA > valueB) - (valueA < valueB);
+}
+
+// Sorts the collapses in ascending order of cost.
+static int meshCompareCollapses(const void *a, const void *b)
+{
+	const MSHCollapse *collapseA = a, *collapseB = b;
+	
+	if (collapseA->cost != collapseB->cost)
+	{
+		return (collapseA->cost < collapseB->cost) ? -1 : 1;
+	}
+	
+	return (collapseA->from < collapseB->from) ? -1 : (collapseA->from > collapseB->from);
+}
+
+// Maps each vertex to the first vertex with the same position, so the vertices split by the other elements
+// (texcoords, normals) are welded back. The locked array marks the welded vertices, they lie on the seams.
+static void meshWeldPositions(const float *positions, UInt32 stride, UInt32 vertices, UInt32 *welds, BOOL *locked)
+{
+	UInt32 i, slot, hash, size = 1;
+	UInt32 *table;
+	UInt32 bits[3];
+	float key[3], other[3];
+	
+	while (size < vertices * 2)
+	{
+		size <<= 1;
+	}
+	
+	table = malloc(size * NGL_SIZE_UINT);
+	memset(table, 0xFF, size * NGL_SIZE_UINT);
+	memset(locked, NO, vertices * sizeof(BOOL));
+	
+	for (i = 0; i < vertices; ++i)
+	{
+		// Adding zero turns -0.0 into 0.0, both must be the same position.
+		key[0] = positions[i * stride] + 0.0f;
+		key[1] = positions[i * stride + 1] + 0.0f;
+		key[2] = positions[i * stride + 2] + 0.0f;
+		memcpy(bits, key, sizeof(bits));
+		
+		hash = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+		hash ^= hash >> 16;
+		slot = hash & (size - 1);
+		
+		while (table[slot] != MSH_EMPTY_SLOT)
+		{
+			other[0] = positions[table[slot] * stride] + 0.0f;
+			other[1] = positions[table[slot] * stride + 1] + 0.0f;
+			other[2] = positions[table[slot] * stride + 2] + 0.0f;
+			
+			if (memcmp(key, other, sizeof(key)) == 0)
+			{
+				break;
+			}
+			
+			slot = (slot + 1) & (size - 1);
+		}
+		
+		if (table[slot] == MSH_EMPTY_SLOT)
+		{
+			table[slot] = i;
+			welds[i] = i;
+		}
+		else
+		{
+			welds[i] = table[slot];
+			locked[i] = YES;
+			locked[table[slot]] = YES;
+		}
+	}
+	
+	nglFree(table);
+}
+
+// Simplifies a range of indices into a chain of levels of detail, with half-edge collapses ordered by the
+// quadric error. A vertex only collapses onto one of its neighbours, so no vertex is created and all the levels
+// share the array of structures. The locked vertices never move, the open borders are kept by extra planes and
+// the collapses that would flip a triangle are rejected. The collapses run in passes, a vertex changes once per
+// pass, until each level has half of the indices of the previous one.
+//
+// The levels are written one after another in the output, which must have room for the levels times the count.
+// The lengths receive the number of indices of each level and the errors its mean distance from the original
+// surface. Returns the number of levels, the chain stops when the simplification can't progress anymore.
+static UInt32 meshSimplify(const UInt32 *indices,
+						   UInt32 count,
+						   const float *positions,
+						   UInt32 stride,
+						   UInt32 vertices,
+						   const UInt32 *welds,
+						   const BOOL *locked,
+						   UInt32 levels,
+						   UInt32 *output,
+						   UInt32 *lengths,
+						   float *errors)
+{
+	UInt32 i, j, k, t, a, b, u, w, end, level, target, removed, goal, degenerated, candidates;
+	UInt32 triangles = count / 3, edgeCount = 0, total = 0;
+	UInt32 *current, *remap, *starts, *adjacency;
+	UInt64 *edges, reverse;
+	MSHQuadric *quadrics, sum;
+	MSHCollapse *collapses;
+	BOOL *dirty, valid;
+	const float *pA, *pB, *pC;
+	NGLvec3 normal, before, after;
+	double limit, maxCost = 0.0;
+	float length, distance;
+	
+	if (triangles < MSH_LEVEL_TRIANGLES || levels == 0)
+	{
+		return 0;
+	}
+	
+	current = malloc(triangles * 3 * NGL_SIZE_UINT);
+	memcpy(current, indices, triangles * 3 * NGL_SIZE_UINT);
+	
+	quadrics = calloc(vertices, sizeof(MSHQuadric));
+	edges = malloc(triangles * 3 * sizeof(UInt64));
+	
+	//*************************
+	//	Quadrics
+	//*************************
+	// Each triangle adds its plane to its positions, weighted by its area.
+	for (t = 0; t < triangles; ++t)
+	{
+		pA = positions + current[t * 3] * stride;
+		pB = positions + current[t * 3 + 1] * stride;
+		pC = positions + current[t * 3 + 2] * stride;
+		
+		normal = nglVec3Cross(meshEdge(pA, pB), meshEdge(pA, pC));
+		length = nglVec3Length(normal);
+		
+		for (k = 0; k < 3; ++k)
+		{
+			edges[edgeCount++] = ((UInt64)welds[current[t * 3 + k]] << 32) | welds[current[t * 3 + (k + 1) % 3]];
+		}
+		
+		if (length > 0.0f)
+		{
+			normal = nglVec3Multiplyf(normal, 1.0f / length);
+			
+			for (k = 0; k < 3; ++k)
+			{
+				a = welds[current[t * 3 + k]];
+				meshQuadricAdd(&quadrics[a], normal, -nglVec3Dot(normal, *(const NGLvec3 *)pA), length * 0.5);
+				quadrics[a].weight += length * 0.5;
+			}
+		}
+	}
+	
+	// The open borders are the edges without a twin in the opposite direction. Each one adds a plane
+	// perpendicular to its triangle, so its vertices only slide along the border.
+	qsort(edges, edgeCount, sizeof(UInt64), meshCompareEdges);
+	
+	for (t = 0; t < triangles; ++t)
+	{
+		for (k = 0; k < 3; ++k)
+		{
+			a = welds[current[t * 3 + k]];
+			b = welds[current[t * 3 + (k + 1) % 3]];
+			reverse = ((UInt64)b << 32) | a;
+			
+			if (bsearch(&reverse, edges, edgeCount, sizeof(UInt64), meshCompareEdges) == NULL)
+			{
+				pA = positions + current[t * 3] * stride;
+				normal = nglVec3Cross(meshEdge(pA, positions + current[t * 3 + 1] * stride),
+									  meshEdge(pA, positions + current[t * 3 + 2] * stride));
+				normal = nglVec3Normalize(nglVec3Cross(meshEdge(positions + a * stride, positions + b * stride),
+													   normal));
+				
+				length = nglVec3Length(meshEdge(positions + a * stride, positions + b * stride));
+				distance = -nglVec3Dot(normal, *(const NGLvec3 *)(positions + a * stride));
+				
+				meshQuadricAdd(&quadrics[a], normal, distance, length * length * MSH_BORDER_WEIGHT);
+				meshQuadricAdd(&quadrics[b], normal, distance, length * length * MSH_BORDER_WEIGHT);
+			}
+		}
+	}
+	
+	nglFree(edges);
+	
+	//*************************
+	//	Collapses
+	//*************************
+	remap = malloc(vertices * NGL_SIZE_UINT);
+	starts = malloc((vertices + 1) * NGL_SIZE_UINT);
+	adjacency = malloc(triangles * 3 * NGL_SIZE_UINT);
+	collapses = malloc(triangles * 3 * sizeof(MSHCollapse));
+	dirty = malloc(vertices * sizeof(BOOL));
+	
+	for (level = 0; level < levels; ++level)
+	{
+		target = (triangles * 3 / 2) / 3 * 3;
+		valid = YES;
+		
+		while (triangles * 3 > target && valid)
+		{
+			// Flat adjacency from the vertices to their triangles.
+			memset(starts, 0, (vertices + 1) * NGL_SIZE_UINT);
+			for (i = 0; i < triangles * 3; ++i)
+			{
+				++starts[current[i] + 1];
+			}
+			
+			for (i = 0; i < vertices; ++i)
+			{
+				starts[i + 1] += starts[i];
+			}
+			
+			for (i = 0; i < triangles * 3; ++i)
+			{
+				adjacency[starts[current[i]]++] = i / 3;
+			}
+			
+			for (i = vertices; i > 0; --i)
+			{
+				starts[i] = starts[i - 1];
+			}
+			
+			starts[0] = 0;
+			
+			// Every half-edge gives a candidate, the cheapest ones come first.
+			candidates = 0;
+			for (i = 0; i < triangles * 3; ++i)
+			{
+				a = current[i];
+				b = current[i - i % 3 + (i + 1) % 3];
+				
+				if (!locked[a])
+				{
+					sum = quadrics[a];
+					meshQuadricSum(&sum, &quadrics[welds[b]]);
+					
+					collapses[candidates].from = a;
+					collapses[candidates].to = b;
+					collapses[candidates].cost = meshQuadricError(&sum, positions + b * stride) /
+												 MAX(sum.weight, 1e-12);
+					++candidates;
+				}
+			}
+			
+			qsort(collapses, candidates, sizeof(MSHCollapse), meshCompareCollapses);
+			
+			for (i = 0; i < vertices; ++i)
+			{
+				remap[i] = i;
+			}
+			
+			memset(dirty, NO, vertices * sizeof(BOOL));
+			removed = 0;
+			goal = (triangles * 3 - target) / 3;
+			valid = NO;
+			
+			// Many candidates are blocked in each pass, so the pass accepts a bit more than the cost that would
+			// reach the goal if none were. The expensive collapses wait for the next passes.
+			limit = (candidates > 0) ? collapses[MIN(goal, candidates - 1)].cost * MSH_PASS_SLACK : 0.0;
+			
+			for (i = 0; i < candidates && removed < goal && collapses[i].cost <= limit; ++i)
+			{
+				a = collapses[i].from;
+				b = collapses[i].to;
+				
+				if (dirty[a] || dirty[b])
+				{
+					continue;
+				}
+				
+				// The triangles around the edge degenerate, the others must not flip.
+				degenerated = 0;
+				end = starts[a + 1];
+				for (j = starts[a]; j < end; ++j)
+				{
+					t = adjacency[j];
+					k = (current[t * 3] == a) ? 0 : ((current[t * 3 + 1] == a) ? 1 : 2);
+					u = current[t * 3 + (k + 1) % 3];
+					w = current[t * 3 + (k + 2) % 3];
+					
+					if (welds[u] == welds[b] || welds[w] == welds[b])
+					{
+						++degenerated;
+						continue;
+					}
+					
+					before = nglVec3Cross(meshEdge(positions + a * stride, positions + u * stride),
+										  meshEdge(positions + a * stride, positions + w * stride));
+					after = nglVec3Cross(meshEdge(positions + b * stride, positions + u * stride),
+										 meshEdge(positions + b * stride, positions + w * stride));
+					
+					if (nglVec3Dot(before, after) <= MSH_FLIP_COSINE * nglVec3Length(before) * nglVec3Length(after))
+					{
+						break;
+					}
+				}
+				
+				if (j < end)
+				{
+					continue;
+				}
+				
+				// The neighbourhood of the collapse can't change again in this pass.
+				for (j = starts[a]; j < end; ++j)
+				{
+					t = adjacency[j];
+					dirty[current[t * 3]] = dirty[current[t * 3 + 1]] = dirty[current[t * 3 + 2]] = YES;
+				}
+				
+				remap[a] = b;
+				meshQuadricSum(&quadrics[welds[b]], &quadrics[a]);
+				maxCost = MAX(maxCost, collapses[i].cost);
+				removed += degenerated;
+				valid = YES;
+			}
+			
+			// Applies the collapses, dropping the degenerated triangles.
+			for (i = 0, j = 0; i < triangles; ++i)
+			{
+				a = remap[current[i * 3]];
+				b = remap[current[i * 3 + 1]];
+				u = remap[current[i * 3 + 2]];
+				
+				if (welds[a] != welds[b] && welds[b] != welds[u] && welds[u] != welds[a])
+				{
+					current[j * 3] = a;
+					current[j * 3 + 1] = b;
+					current[j * 3 + 2] = u;
+					++j;
+				}
+			}
+			
+			triangles = j;
+		}
+		
+		// A level that doesn't reduce enough ends the chain.
+		if (triangles * 3 > (level == 0 ? count : lengths[level - 1]) * MSH_LEVEL_PROGRESS)
+		{
+			break;
+		}
+		
+		memcpy(output + total, current, triangles * 3 * NGL_SIZE_UINT);
+		lengths[level] = triangles * 3;
+		errors[level] = sqrtf(maxCost);
+		total += triangles * 3;
+		
+		if (triangles < MSH_LEVEL_TRIANGLES)
+		{
+			++level;
+			break;
+		}
+	}
+	
+	nglFree(current);
+	nglFree(quadrics);
+	nglFree(remap);
+	nglFree(starts);
+	nglFree(adjacency);
+	nglFree(collapses);
+	nglFree(dirty);
+	
+	return level;
+}
+
+// Unit normal of a triangle, zero if the triangle is degenerate.
+NGL_INLINE NGLvec3 meshTriangleNormal(const UInt32 *triangle, const float *positions, UInt32 stride)
+{
+	const float *pA = positions + triangle[0] * stride;
+	const float *pB = positions + triangle[1] * stride;
+	const float *pC = positions + triangle[2] * stride;
+	
+	return nglVec3Normalize(nglVec3Cross(meshEdge(pA, pB), meshEdge(pA, pC)));
+}
+
+// Computes the bounds and the normal cone of a cluster. The axis is the average of the triangles' normals
+// and the cone opens until the farthest one. Cones of 90 degrees or more can't face away from any eye.
+static void meshClusterBounds(NGLCluster *cluster, const UInt32 *indices, const float *positions, UInt32 stride)
+{
+	UInt32 i;
+	const float *position;
+	NGLvec3 normal, axis = kNGLvec3Zero;
+	float cosine = 1.0f;
+	
+	position = positions + indices[cluster->start] * stride;
+	cluster->bounds.min = cluster->bounds.max = (NGLvec3){position[0], position[1], position[2]};
+	
+	for (i = cluster->start; i < cluster->start + cluster->length; ++i)
+	{
+		position = positions + indices[i] * stride;
+		cluster->bounds.min.x = MIN(cluster->bounds.min.x, position[0]);
+		cluster->bounds.min.y = MIN(cluster->bounds.min.y, position[1]);
+		cluster->bounds.min.z = MIN(cluster->bounds.min.z, position[2]);
+		cluster->bounds.max.x = MAX(cluster->bounds.max.x, position[0]);
+		cluster->bounds.max.y = MAX(cluster->bounds.max.y, position[1]);
+		cluster->bounds.max.z = MAX(cluster->bounds.max.z, position[2]);
+	}
+	
+	for (i = cluster->start; i < cluster->start + cluster->length; i += 3)
+	{
+		axis = nglVec3Add(axis, meshTriangleNormal(indices + i, positions, stride));
+	}
+	
+	axis = nglVec3Normalize(axis);
+	
+	// The degenerate triangles are never drawn, they don't open the cone.
+	for (i = cluster->start; i < cluster->start + cluster->length; i += 3)
+	{
+		normal = meshTriangleNormal(indices + i, positions, stride);
+		
+		if (!nglVec3IsZero(normal))
+		{
+			cosine = MIN(cosine, nglVec3Dot(normal, axis));
+		}
+	}
+	
+	cluster->axis = axis;
+	cluster->cutoff = (!nglVec3IsZero(axis) && cosine > 0.0f) ? sqrtf(1.0f - cosine * cosine) : 1.0f;
+}
+
+// Partitions a range of indices in clusters of consecutive triangles, keeping the order of the triangles.
+// A cluster is closed when it's full or, after a minimum size, when the next triangle doesn't share a vertex
+// with it or deviates from its average normal. The stamps have one element per vertex, set to MSH_EMPTY_SLOT.
+// Returns the number of clusters.
+static UInt32 meshBuildClusters(const UInt32 *indices,
+								UInt32 first,
+								UInt32 count,
+								const float *positions,
+								UInt32 stride,
+								UInt32 *stamps,
+								NGLCluster *output)
+{
+	UInt32 i, j, triangles, total = 0;
+	const UInt32 *triangle;
+	NGLvec3 normal, sum = kNGLvec3Zero;
+	BOOL shared;
+	
+	output[0].start = first;
+	output[0].length = 0;
+	
+	for (i = first; i + 2 < first + count; i += 3)
+	{
+		triangle = indices + i;
+		normal = meshTriangleNormal(triangle, positions, stride);
+		triangles = output[total].length / 3;
+		
+		// The stamp of a vertex is the start of the last cluster that took it.
+		shared = NO;
+		for (j = 0; j < 3; ++j)
+		{
+			shared |= (stamps[triangle[j]] == output[total].start);
+		}
+		
+		if (triangles >= MSH_CLUSTER_TRIANGLES ||
+			(triangles >= MSH_CLUSTER_MIN &&
+			 (!shared || nglVec3Dot(normal, sum) < MSH_CLUSTER_COSINE * nglVec3Length(sum))))
+		{
+			meshClusterBounds(&output[total++], indices, positions, stride);
+			output[total].start = i;
+			output[total].length = 0;
+			sum = kNGLvec3Zero;
+		}
+		
+		for (j = 0; j < 3; ++j)
+		{
+			stamps[triangle[j]] = output[total].start;
+		}
+		
+		sum = nglVec3Add(sum, normal);
+		output[total].length += 3;
+	}
+	
+	if (output[total].length > 0)
+	{
+		meshClusterBounds(&output[total++], indices, positions, stride);
+	}
+	
+	return total;
+}
+
+// Converts a float to a 16 bits float, rounding to the nearest even. Overflows become infinities.
+static UInt16 meshFloatToHalf(float value)
+{
+	union { float f; UInt32 u; } bits = { value };
+	UInt32 sign = (bits.u >> 16) & 0x8000;
+	UInt32 mantissa = bits.u & 0x7FFFFF;
+	SInt32 exponent = (SInt32)((bits.u >> 23) & 0xFF) - 127 + 15;
+	UInt32 half, rest, shift;
+	
+	if (((bits.u >> 23) & 0xFF) == 0xFF)
+	{
+		return sign | 0x7C00 | ((mantissa != 0) ? 0x200 : 0);
+	}
+	
+	if (exponent >= 31)
+	{
+		return sign | 0x7C00;
+	}
+	
+	// Subnormal halves, the implicit bit is shifted into the mantissa.
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			return sign;
+		}
+		
+		mantissa |= 0x800000;
+		shift = 14 - exponent;
+		half = mantissa >> shift;
+		rest = mantissa & ((1 << shift) - 1);
+		
+		if (rest > (1u << (shift - 1)) || (rest == (1u << (shift - 1)) && (half & 1)))
+		{
+			++half;
+		}
+		
+		return sign | half;
+	}
+	
+	// A carry of the rounding goes to the exponent, as it should.
+	half = ((UInt32)exponent << 10) | (mantissa >> 13);
+	rest = mantissa & 0x1FFF;
+	
+	if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+	{
+		++half;
+	}
+	
+	return sign | half;
+}
+
+// Converts a 16 bits float to a float.
+static float meshHalfToFloat(UInt16 half)
+{
+	union { float f; UInt32 u; } bits;
+	UInt32 sign = (UInt32)(half & 0x8000) << 16;
+	UInt32 exponent = (half >> 10) & 0x1F;
+	UInt32 mantissa = half & 0x3FF;
+	
+	if (exponent == 0)
+	{
+		bits.f = ldexpf((float)mantissa, -24);
+		bits.u |= sign;
+	}
+	else if (exponent == 31)
+	{
+		bits.u = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits.u = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+	
+	return bits.f;
+}
+
+// Writes a component in a format. The signed normalized integers follow the OpenGL ES 2 conversion,
+// in which the value is (2 * integer + 1) / (2 ^ bits - 1).
+static void meshPackValue(float value, NGLElementFormat format, void *output)
+{
+	float integer;
+	
+	switch (format)
+	{
+		case NGLElementFormatHalf:
+			*(UInt16 *)output = meshFloatToHalf(value);
+			break;
+		case NGLElementFormatShort:
+			integer = roundf((MAX(MIN(value, 1.0f), -1.0f) * 65535.0f - 1.0f) * 0.5f);
+			*(SInt16 *)output = (SInt16)MAX(MIN(integer, 32767.0f), -32768.0f);
+			break;
+		case NGLElementFormatUShort:
+			*(UInt16 *)output = (UInt16)roundf(MAX(MIN(value, 1.0f), 0.0f) * 65535.0f);
+			break;
+		case NGLElementFormatByte:
+			integer = roundf((MAX(MIN(value, 1.0f), -1.0f) * 255.0f - 1.0f) * 0.5f);
+			*(SInt8 *)output = (SInt8)MAX(MIN(integer, 127.0f), -128.0f);
+			break;
+		default:
+			*(float *)output = value;
+			break;
+	}
+}
+
+// Reads a component in a format, just like the GPU does.
+static float meshUnpackValue(NGLElementFormat format, const void *input)
+{
+	float value;
+	
+	switch (format)
+	{
+		case NGLElementFormatHalf:
+			value = meshHalfToFloat(*(const UInt16 *)input);
+			break;
+		case NGLElementFormatShort:
+			value = (2.0f * *(const SInt16 *)input + 1.0f) / 65535.0f;
+			break;
+		case NGLElementFormatUShort:
+			value = *(const UInt16 *)input / 65535.0f;
+			break;
+		case NGLElementFormatByte:
+			value = (2.0f * *(const SInt8 *)input + 1.0f) / 255.0f;
+			break;
+		default:
+			value = *(const float *)input;
+			break;
+	}
+	
+	return value;
+}
+
+// Returns the value read by the GPU after writing it in a format.
+static float meshRoundTrip(float value, NGLElementFormat format)
 {
-	NSNumber *newIndex, *oldIndex;
+	float output;
+	
+	meshPackValue(value, format, &output);
 	
-	// Eliminates the NaN points.
-	(*buffer)[index] = nglVec3Cleared((*buffer)[index]);
+	return meshUnpackValue(format, &output);
+}
+
+// Returns the maximum error of the first components of an element in a format.
+static float meshFormatError(const float *values,
+							 UInt32 vertices,
+							 UInt32 stride,
+							 UInt32 size,
+							 NGLElementFormat format)
+{
+	UInt32 i, c;
+	float error = 0.0f;
 	
-	// Checks if the informed normal vector is not zero.
-	if (!nglVec3IsZero((*buffer)[index]))
+	for (i = 0; i < vertices; ++i)
 	{
-		// Calculates the cosine of the angle between the current normal vector and the
-		// averaged normal in the buffer.
-		float cos = nglVec3Dot(nglVec3Normalize(vector), nglVec3Normalize((*buffer)[index]));
-		
-		// If the cosine is greater than the crease angle, that means the current normal vector
-		// forms an acceptable angle witht the averaged normal in the buffer. Otherwise, proceeds and
-		// creates a new normal vector to the current triangle face.
-		if (cos <= kCreaseAngle)
+		for (c = 0; c < size; ++c)
 		{
-			// Tries to retrieve an already buffered normal with the same bend.
-			oldIndex = [NSNumber numberWithInt:index];
-			newIndex = [list objectForKey:oldIndex];
+			error = MAX(error, fabsf(meshRoundTrip(values[i * stride + c], format) - values[i * stride + c]));
+		}
+	}
+	
+	return error;
+}
+
+// Chooses the format and the size of an element, the smallest one whose error doesn't exceed the tolerance.
+// The precision of the element is updated with its error. Without half floats, the floats replace them.
+static void meshElementFormat(NGLElement *element,
+							  const float *structures,
+							  UInt32 vertices,
+							  UInt32 stride,
+							  BOOL halfFloat,
+							  NGLPrecisionMetrics *precision)
+{
+	const float *values = structures + (*element).start;
+	UInt32 i, c, length = (*element).length;
+	float low = INFINITY, high = -INFINITY, extent = 0.0f, diagonal = 0.0f, error;
+	float vector[4], decoded[4], size, dot;
+	NGLvec3 vMin, vMax;
+	
+	(*element).format = NGLElementFormatFloat;
+	(*element).size = length;
+	
+	if (vertices == 0)
+	{
+		return;
+	}
+	
+	switch ((*element).component)
+	{
+		//*************************
+		//	Positions
+		//*************************
+		case NGLComponentVertex:
+			// The w is 1.0 in the shaders when it's missing.
+			for (i = 0; length == 4 && i < vertices; ++i)
+			{
+				if (values[i * stride + 3] != 1.0f)
+				{
+					break;
+				}
+			}
 			
-			// If no buffer was found, create a new register to the current normal vector.
-			if (newIndex == nil)
+			(*element).size = (length == 4 && i == vertices) ? 3 : length;
+			
+			vMin = vMax = (NGLvec3){ values[0], values[1], values[2] };
+			for (i = 0; i < vertices; ++i)
 			{
-				// Retrieves the new index and stores its value as a linked list to the old one.
-				newIndex = [NSNumber numberWithInt:*count];
-				[list setObject:newIndex forKey:oldIndex];
-				index = [newIndex intValue];
+				vMin = (NGLvec3){ MIN(vMin.x, values[i * stride]), MIN(vMin.y, values[i * stride + 1]),
+								  MIN(vMin.z, values[i * stride + 2]) };
+				vMax = (NGLvec3){ MAX(vMax.x, values[i * stride]), MAX(vMax.y, values[i * stride + 1]),
+								  MAX(vMax.z, values[i * stride + 2]) };
 				
-				// Reallocates the buffer and set the new buffer value to zero, avoiding NaN.
-				*buffer = realloc(*buffer, NGL_SIZE_VEC3 * ++*count);
-				(*buffer)[index] = kNGLvec3Zero;
+				for (c = 0; c < (*element).size; ++c)
+				{
+					extent = MAX(extent, fabsf(values[i * stride + c]));
+				}
+			}
+			
+			diagonal = nglVec3Length(nglVec3Subtract(vMax, vMin));
+			
+			if (diagonal <= 0.0f)
+			{
+				break;
+			}
+			
+			// The normalized shorts have a fixed precision, but they only reach the unit cube.
+			if (extent <= 1.0f &&
+				(error = meshFormatError(values, vertices, stride, (*element).size, NGLElementFormatShort)) <=
+				diagonal * MSH_FORMAT_TOLERANCE)
+			{
+				(*element).format = NGLElementFormatShort;
+			}
+			else if (halfFloat &&
+					 (error = meshFormatError(values, vertices, stride, (*element).size, NGLElementFormatHalf)) <=
+					 diagonal * MSH_FORMAT_TOLERANCE)
+			{
+				(*element).format = NGLElementFormatHalf;
 			}
-			// Otherwise, repeat the process with the buffered value to check for new crease angles.
 			else
 			{
-				index = creaseAngle([newIndex intValue], vector, buffer, count, list);
+				error = 0.0f;
 			}
-		}
+			
+			(*precision).position = MAX((*precision).position, error / diagonal);
+			break;
+		//*************************
+		//	Directions
+		//*************************
+		case NGLComponentNormal:
+		case NGLComponentTangent:
+		case NGLComponentBitangent:
+			// Only the directions matter, they are normalized in the shaders.
+			(*element).format = NGLElementFormatByte;
+			
+			for (i = 0; i < vertices; ++i)
+			{
+				for (c = 0, size = 0.0f, dot = 0.0f; c < length; ++c)
+				{
+					vector[c] = values[i * stride + c];
+					size += vector[c] * vector[c];
+				}
+				
+				if (size <= 0.0f)
+				{
+					continue;
+				}
+				
+				for (c = 0, size = sqrtf(size), error = 0.0f; c < length; ++c)
+				{
+					vector[c] /= size;
+					decoded[c] = meshRoundTrip(vector[c], NGLElementFormatByte);
+					error += decoded[c] * decoded[c];
+					dot += vector[c] * decoded[c];
+				}
+				
+				dot /= sqrtf(error);
+				(*precision).direction = MAX((*precision).direction, nglRadiansToDegrees(acosf(MIN(dot, 1.0f))));
+			}
+			break;
+		//*************************
+		//	Texture Coordinates
+		//*************************
+		case NGLComponentTexcoord:
+			for (i = 0; i < vertices; ++i)
+			{
+				for (c = 0; c < length; ++c)
+				{
+					low = MIN(low, values[i * stride + c]);
+					high = MAX(high, values[i * stride + c]);
+				}
+			}
+			
+			// The normalized unsigned shorts reach all the texels of the usual range.
+			if (low >= 0.0f && high <= 1.0f)
+			{
+				(*element).format = NGLElementFormatUShort;
+				error = meshFormatError(values, vertices, stride, length, NGLElementFormatUShort);
+			}
+			else if (halfFloat &&
+					 (error = meshFormatError(values, vertices, stride, length, NGLElementFormatHalf)) <=
+					 MSH_FORMAT_TEXEL)
+			{
+				(*element).format = NGLElementFormatHalf;
+			}
+			else
+			{
+				error = 0.0f;
+			}
+			
+			(*precision).texcoord = MAX((*precision).texcoord, error);
+			break;
+		//*************************
+		//	Bones
+		//*************************
+		case NGLComponentBoneIndices:
+			// The indices of the joints are small integers, they are exact in half floats.
+			(*element).format = (halfFloat) ? NGLElementFormatHalf : NGLElementFormatFloat;
+			break;
+		case NGLComponentBoneWeights:
+			// The weights are always in the range from 0.0 to 1.0.
+			(*element).format = NGLElementFormatUShort;
+			break;
 	}
+}
+
+// Moves a matrix of the skeleton to the adjusted space, scaling the joints without moving their origins.
+// The rotation is kept and the translation becomes: t' = (R * before + t - after) * scale.
+static void meshAdjustMatrix(const float *original, NGLvec3 before, NGLvec3 after, float scale, NGLmat4 result)
+{
+	memcpy(result, original, sizeof(NGLmat4));
 	
-	return index;
+	result[12] = (original[0] * before.x + original[4] * before.y + original[8] * before.z +
+				  original[12] - after.x) * scale;
+	result[13] = (original[1] * before.x + original[5] * before.y + original[9] * before.z +
+				  original[13] - after.y) * scale;
+	result[14] = (original[2] * before.x + original[6] * before.y + original[10] * before.z +
+				  original[14] - after.z) * scale;
 }
 
 #pragma mark -
@@ -131,6 +1728,26 @@ static UInt32 creaseAngle(UInt32 index,
 // contains texture coordinates. The creation of Tangent Space is one of the most hard and expensive tasks.
 - (void) defineTangentSpace;
 
+// Reorders the triangles for the post-transform vertex cache and the overdraw, then reorders the vertices
+// in the order they are first used. Also measures the vertex cache before and after it.
+- (void) optimizeStructure;
+
+// Generates the levels of detail of each surface, each level with about half of the previous triangles.
+// Must be called after the optimization, the levels don't change the array of structures.
+- (void) defineLevels;
+
+// Partitions the triangles of each surface in clusters and computes their bounds and normal cones.
+// Must be called after the optimization, the clusters follow the final order of the triangles.
+- (void) defineClusters;
+
+// Finds the window of vertices of each surface and its levels, choosing the size of their indices on the GPU.
+// Must be called after the levels of detail, the windows include them.
+- (void) defineWindows;
+
+// Returns a new array with the start and the length of each range drawn by the mesh, the surfaces or the whole
+// array of indices. The caller must free it.
+- (UInt32 *) copyRanges:(UInt32 *)count;
+
 @end
 
 #pragma mark -
@@ -142,6 +1759,348 @@ static UInt32 creaseAngle(UInt32 index,
 //
 //**********************************************************************************************************
 
+NGLVertexCacheMetrics nglVertexCacheMetrics(const UInt32 *indices, UInt32 count, UInt32 cacheSize)
+{
+	NGLVertexCacheMetrics metrics = {0.0f, 0.0f};
+	UInt32 i, stamp, vertices = 0, unique = 0, misses = 0;
+	UInt32 *stamps;
+	
+	for (i = 0; i < count; ++i)
+	{
+		vertices = MAX(vertices, indices[i] + 1);
+	}
+	
+	stamps = calloc(vertices, NGL_SIZE_UINT);
+	
+	// FIFO cache. A vertex stays in the cache until other cacheSize vertices miss after it.
+	for (i = 0; i < count; ++i)
+	{
+		stamp = stamps[indices[i]];
+		if (stamp == 0 || misses - stamp >= cacheSize)
+		{
+			unique += (stamp == 0);
+			stamps[indices[i]] = ++misses;
+		}
+	}
+	
+	if (count >= 3)
+	{
+		metrics.acmr = misses / (float)(count / 3);
+	}
+	
+	if (unique > 0)
+	{
+		metrics.atvr = misses / (float)unique;
+	}
+	
+	nglFree(stamps);
+	
+	return metrics;
+}
+
+UInt32 nglLevelForSize(const float *errors, UInt32 count, float size, float threshold)
+{
+	UInt32 level = 0;
+	
+	// The errors grow with the levels, so the first one above the threshold ends the search.
+	while (level + 1 < count && errors[level + 1] * size <= threshold)
+	{
+		++level;
+	}
+	
+	return level;
+}
+
+NGLWindow nglVertexWindow(const UInt32 *indices,
+						  UInt32 start,
+						  UInt32 length,
+						  const NGLLevel *levels,
+						  UInt32 levelsCount,
+						  const UInt32 *lodIndices)
+{
+	NGLWindow window = { start, length, 0, 0, NGL_SIZE_USHORT };
+	UInt32 i, l, end, first = NGL_MAX_32, last = 0;
+	const UInt32 *data;
+	
+	// The range and its levels, the levels of the other ranges don't matter.
+	for (l = 0; l <= levelsCount; ++l)
+	{
+		if (l == 0)
+		{
+			data = indices + start;
+			end = length;
+		}
+		else if (lodIndices != NULL && levels[l - 1].rangeStart == start && levels[l - 1].rangeLength == length)
+		{
+			data = lodIndices + levels[l - 1].start;
+			end = levels[l - 1].length;
+		}
+		else
+		{
+			continue;
+		}
+		
+		for (i = 0; i < end; ++i)
+		{
+			first = MIN(first, data[i]);
+			last = MAX(last, data[i]);
+		}
+	}
+	
+	if (first <= last)
+	{
+		window.base = first;
+		window.count = last - first + 1;
+		window.dataSize = (window.count <= NGL_MAX_16 + 1) ? NGL_SIZE_USHORT : NGL_SIZE_UINT;
+	}
+	
+	return window;
+}
+
+NGLPrecisionMetrics nglDefineFormats(NGLMeshElements *elements,
+									 const float *structures,
+									 UInt32 count,
+									 UInt32 stride,
+									 BOOL halfFloat)
+{
+	NGLPrecisionMetrics precision = { 0.0f, 0.0f, 0.0f };
+	NGLElement *element;
+	UInt32 offset = 0, vertices = (stride > 0) ? count / stride : 0;
+	
+	// The elements are packed in their order, each one aligned to 4 bytes.
+	while ((element = [elements nextIterator]))
+	{
+		meshElementFormat(element, structures, vertices, stride, halfFloat, &precision);
+		(*element).offset = offset;
+		offset += ((*element).size * nglElementFormatSize((*element).format) + 3) & ~3;
+	}
+	
+	return precision;
+}
+
+void nglPackStructures(NGLMeshElements *elements,
+					   const float *structures,
+					   UInt32 count,
+					   UInt32 stride,
+					   void *output)
+{
+	NGLElement list[MSH_MAX_ELEMENTS];
+	NGLElement *element;
+	UInt32 i, e, c, total = 0, packed = [elements packedStride];
+	UInt32 vertices = (stride > 0 && packed > 0) ? count / stride : 0;
+	const float *values;
+	UInt8 *vertex;
+	float size;
+	
+	// The elements are copied once, instead of being searched for each vertex.
+	while ((element = [elements nextIterator]))
+	{
+		if (total < MSH_MAX_ELEMENTS)
+		{
+			list[total++] = *element;
+		}
+	}
+	
+	memset(output, 0, vertices * packed);
+	
+	for (i = 0; i < vertices; ++i)
+	{
+		vertex = (UInt8 *)output + i * packed;
+		
+		for (e = 0; e < total; ++e)
+		{
+			values = structures + i * stride + list[e].start;
+			size = 1.0f;
+			
+			// The directions are normalized before the quantization, just like their formats were chosen.
+			if (list[e].format == NGLElementFormatByte)
+			{
+				for (c = 0, size = 0.0f; c < list[e].size; ++c)
+				{
+					size += values[c] * values[c];
+				}
+				
+				size = (size > 0.0f) ? sqrtf(size) : 1.0f;
+			}
+			
+			for (c = 0; c < list[e].size; ++c)
+			{
+				meshPackValue(values[c] / size, list[e].format,
+							  vertex + list[e].offset + c * nglElementFormatSize(list[e].format));
+			}
+		}
+	}
+}
+
+UInt32 nglCullClusters(const NGLCluster *clusters,
+					   UInt32 count,
+					   NGLmat4 mvp,
+					   NGLvec3 eye,
+					   float facing,
+					   BOOL *visible)
+{
+	UInt32 i, j, drawn = 0;
+	NGLvec4 planes[6];
+	NGLvec3 center, extent, view;
+	const NGLCluster *cluster;
+	BOOL inside;
+	
+	// The frustum planes, in the mesh's space, are the sums and the differences of the matrix's rows.
+	for (i = 0; i < 3; ++i)
+	{
+		planes[i * 2] = (NGLvec4){mvp[3] + mvp[i], mvp[7] + mvp[i + 4], mvp[11] + mvp[i + 8], mvp[15] + mvp[i + 12]};
+		planes[i * 2 + 1] = (NGLvec4){mvp[3] - mvp[i], mvp[7] - mvp[i + 4],
+									  mvp[11] - mvp[i + 8], mvp[15] - mvp[i + 12]};
+	}
+	
+	for (i = 0; i < count; ++i)
+	{
+		cluster = &clusters[i];
+		center = nglVec3Multiplyf(nglVec3Add(cluster->bounds.min, cluster->bounds.max), 0.5f);
+		extent = nglVec3Multiplyf(nglVec3Subtract(cluster->bounds.max, cluster->bounds.min), 0.5f);
+		inside = YES;
+		
+		// The box is out of the frustum when its nearest corner to a plane is behind it.
+		for (j = 0; j < 6 && inside; ++j)
+		{
+			inside = (planes[j].x * center.x + planes[j].y * center.y + planes[j].z * center.z + planes[j].w +
+					  fabsf(planes[j].x) * extent.x + fabsf(planes[j].y) * extent.y +
+					  fabsf(planes[j].z) * extent.z >= 0.0f);
+		}
+		
+		// All the normals in the cone face away from every point of the box's sphere.
+		if (inside && facing != 0.0f && cluster->cutoff < 1.0f)
+		{
+			view = nglVec3Subtract(center, eye);
+			inside = (facing * nglVec3Dot(view, cluster->axis) <
+					  cluster->cutoff * nglVec3Length(view) + nglVec3Length(extent));
+		}
+		
+		visible[i] = inside;
+		drawn += (inside) ? cluster->length : 0;
+	}
+	
+	return drawn;
+}
+
+void nglSkinPalette(const NGLJoint *joints, NGLmat4 *pose, UInt32 count, NGLmat4 *palette)
+{
+	UInt32 i, parent;
+	float *local;
+	
+	// The parents come first, so their world transformations are ready before their children.
+	for (i = 0; i < count; ++i)
+	{
+		local = (pose != NULL) ? pose[i] : (float *)joints[i].local;
+		parent = joints[i].parent;
+		
+		if (parent < i)
+		{
+			nglMatrixMultiply(palette[parent], local, palette[i]);
+		}
+		else
+		{
+			nglMatrixCopy(local, palette[i]);
+		}
+	}
+	
+	for (i = 0; i < count; ++i)
+	{
+		nglMatrixMultiply(palette[i], (float *)joints[i].bind, palette[i]);
+	}
+}
+
+void nglSkinStructures(NGLMeshElements *elements,
+					   const float *structures,
+					   UInt32 count,
+					   UInt32 stride,
+					   NGLmat4 *palette,
+					   UInt32 jointsCount,
+					   float *output)
+{
+	NGLElement *indices = [elements elementWithComponent:NGLComponentBoneIndices];
+	NGLElement *weights = [elements elementWithComponent:NGLComponentBoneWeights];
+	NGLElement *element;
+	UInt32 i, j, k, vertices = (stride > 0) ? count / stride : 0;
+	const float *values;
+	float *vector, skin[16], w, rest, x, y, z, size;
+	UInt32 joint;
+	
+	memcpy(output, structures, count * NGL_SIZE_FLOAT);
+	
+	if (indices == NULL || weights == NULL)
+	{
+		return;
+	}
+	
+	for (i = 0; i < vertices; ++i)
+	{
+		values = structures + i * stride;
+		
+		// The skin matrix blends the joints, the remaining weight stays with the identity.
+		memset(skin, 0, sizeof(skin));
+		rest = 1.0f;
+		
+		for (k = 0; k < (*indices).length && k < (*weights).length; ++k)
+		{
+			joint = (UInt32)values[(*indices).start + k];
+			w = values[(*weights).start + k];
+			
+			if (joint < jointsCount && w != 0.0f)
+			{
+				for (j = 0; j < 16; ++j)
+				{
+					skin[j] += palette[joint][j] * w;
+				}
+				
+				rest -= w;
+			}
+		}
+		
+		skin[0] += rest;
+		skin[5] += rest;
+		skin[10] += rest;
+		skin[15] += rest;
+		
+		[elements resetIterator];
+		while ((element = [elements nextIterator]))
+		{
+			vector = output + i * stride + (*element).start;
+			x = vector[0];
+			y = vector[1];
+			z = vector[2];
+			
+			switch ((*element).component)
+			{
+				case NGLComponentVertex:
+					w = ((*element).length == 4) ? vector[3] : 1.0f;
+					vector[0] = skin[0] * x + skin[4] * y + skin[8] * z + skin[12] * w;
+					vector[1] = skin[1] * x + skin[5] * y + skin[9] * z + skin[13] * w;
+					vector[2] = skin[2] * x + skin[6] * y + skin[10] * z + skin[14] * w;
+					break;
+				case NGLComponentNormal:
+				case NGLComponentTangent:
+				case NGLComponentBitangent:
+					vector[0] = skin[0] * x + skin[4] * y + skin[8] * z;
+					vector[1] = skin[1] * x + skin[5] * y + skin[9] * z;
+					vector[2] = skin[2] * x + skin[6] * y + skin[10] * z;
+					
+					size = sqrtf(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+					
+					if (size > 0.0f)
+					{
+						vector[0] /= size;
+						vector[1] /= size;
+						vector[2] /= size;
+					}
+					break;
+				default:
+					break;
+			}
+		}
+	}
+}
+
 @implementation NGLParserMesh
 
 #pragma mark -
@@ -151,9 +2110,13 @@ static UInt32 creaseAngle(UInt32 index,
 //**************************************************
 
 @synthesize indicesCount = _iCount, structuresCount = _sCount, stride = _stride,
-			indices = _indices, meshElements = _meshElements, material = _material, surface = _surface;
+			indices = _indices, meshElements = _meshElements, material = _material, surface = _surface,
+			mappedData = _mappedData, originalMetrics = _originalMetrics, optimizedMetrics = _optimizedMetrics,
+			levels = _levels, levelsCount = _levelsCount, lodIndices = _lodIndices, lodCount = _lodCount,
+			clusters = _clusters, clustersCount = _clustersCount, windows = _windows, windowsCount = _windowsCount,
+			jointsCount = _jointsCount, jointNames = _jointNames;
 
-@dynamic loadedData, hasError, structures, autoCentralize, autoNormalize;
+@dynamic loadedData, hasError, structures, joints, autoCentralize, autoNormalize;
 
 - (float) loadedData
 {
@@ -168,6 +2131,12 @@ static UInt32 creaseAngle(UInt32 index,
 
 - (float *) structures
 {
+	// Without adjusts, the original array is used directly, avoiding a copy of the structures.
+	if (!_autoCentralize && _autoNormalize <= 0.0f)
+	{
+		return _structures;
+	}
+	
 	if (!_aCache)
 	{
 		[self perVertexAdjusts];
@@ -176,6 +2145,22 @@ static UInt32 creaseAngle(UInt32 index,
 	return _adjusted;
 }
 
+- (NGLJoint *) joints
+{
+	// The joints follow the adjusts of the array of structures.
+	if (_jointsCount == 0 || (!_autoCentralize && _autoNormalize <= 0.0f))
+	{
+		return _joints;
+	}
+	
+	if (!_aCache)
+	{
+		[self perVertexAdjusts];
+	}
+	
+	return _aJoints;
+}
+
 - (BOOL) autoCentralize { return _autoCentralize; }
 - (void) setAutoCentralize:(BOOL)value
 {
@@ -239,6 +2224,19 @@ static UInt32 creaseAngle(UInt32 index,
 	_indices = NULL;
 	_structures = NULL;
 	_adjusted = NULL;
+	_levels = NULL;
+	_lodIndices = NULL;
+	_levelsCount = _lodCount = 0;
+	_clusters = NULL;
+	_clustersCount = 0;
+	_windows = NULL;
+	_windowsCount = 0;
+	_joints = NULL;
+	_aJoints = NULL;
+	_jointNames = nil;
+	_jointsCount = 0;
+	_boneIndices = NULL;
+	_boneWeights = NULL;
 	_canceled = NO;
 	_aCache = NO;
 	_autoCentralize = NO;
@@ -316,6 +2314,23 @@ static UInt32 creaseAngle(UInt32 index,
 			_adjusted[n + 1] = (_structures[n + 1] - center.y) * scale;
 			_adjusted[n + 2] = (_structures[n + 2] - center.z) * scale;
 		}
+		
+		//*************************
+		//	Skeleton
+		//*************************
+		if (_jointsCount > 0 && _aJoints == NULL)
+		{
+			_aJoints = malloc(_jointsCount * sizeof(NGLJoint));
+		}
+		
+		// Only the roots are centralized, the children are relative to them.
+		for (i = 0; i < (int)_jointsCount; ++i)
+		{
+			_aJoints[i].parent = _joints[i].parent;
+			meshAdjustMatrix(_joints[i].local, kNGLvec3Zero,
+							 (_joints[i].parent == NGL_NOT_FOUND) ? center : kNGLvec3Zero, scale, _aJoints[i].local);
+			meshAdjustMatrix(_joints[i].bind, center, kNGLvec3Zero, scale, _aJoints[i].bind);
+		}
 	}
 	
 	_aCache = YES;
@@ -323,51 +2338,27 @@ static UInt32 creaseAngle(UInt32 index,
 
 - (void) defineTangentSpace
 {
-	UInt32 i, length;
-	UInt32 j, lengthJ;
-	
-	UInt32 *newFaces, *outFaces;
-	UInt32 oldFaceStride = _facesStride;
-	
-	int i1, i2, i3;
-	int vi1, vi2, vi3;
-	int ti1, ti2, ti3;
-	
-	NGLvec3 vA, vB, vC;
-	NGLvec2 tA, tB, tC;
-	NGLvec3 distBA, distCA;
-	NGLvec2 tdistBA, tdistCA;
-	
-	NGLvec3 normal;
-	NGLvec3 tangent;
-	NGLvec3 bitangent;
-	
-	NGLvec3 *normalBuffer;
-	NGLvec3 *tangentBuffer;
-	NGLvec3 *bitangentBuffer;
-	
-	NSMutableDictionary *multiples;
+	UInt32 i, slot;
+	UInt32 triangles = _facesCount / 3;
+	UInt32 positions = _vCount;
+	UInt32 tasks = 1;
 	
 	NGLElement *element;
-	int vLength, vOffset;
-	int nLength, nOffset;
-	int tLength, tOffset;
-	
-	float area, delta;
-	float *outValue;
+	MSHTangentSpace space;
 	
 	// Checks if the parsed mesh has Normals and Texture Coordinates.
-	BOOL hasNormals = ([_meshElements elementWithComponent:NGLComponentNormal] != NULL);
-	BOOL hasTextures = ([_meshElements elementWithComponent:NGLComponentTexcoord] != NULL);
+	space.hasNormals = ([_meshElements elementWithComponent:NGLComponentNormal] != NULL);
+	space.hasTextures = ([_meshElements elementWithComponent:NGLComponentTexcoord] != NULL);
+	space.oldStride = _facesStride;
 	
 	// Gets the vertex element.
 	element = [_meshElements elementWithComponent:NGLComponentVertex];
-	vLength = (*element).length;
-	vOffset = (*element).offsetInFace;
+	space.vLength = (*element).length;
+	space.vOffset = (*element).offsetInFace;
 	
 	// If the normal element doesn't exist yet, creates a new one.
 	// Reserve an unique slot for normals.
-	if (!hasNormals)
+	if (!space.hasNormals)
 	{
 		[_meshElements addElement:(NGLElement){NGLComponentNormal, _stride, 3, _facesStride++}];
 		_stride += 3;
@@ -375,16 +2366,17 @@ static UInt32 creaseAngle(UInt32 index,
 	
 	// Gets the normal element.
 	element = [_meshElements elementWithComponent:NGLComponentNormal];
-	nLength = (*element).length;
-	nOffset = (*element).offsetInFace;
+	space.nLength = (*element).length;
+	space.nOffset = (*element).offsetInFace;
+	space.tLength = space.tOffset = 0;
 	
 	// If the texture coordinate element exist, gets it and create tangent and bitangent element.
 	// Reserve an unique slots for tangent and bitangent.
-	if (hasTextures)
+	if (space.hasTextures)
 	{
 		element = [_meshElements elementWithComponent:NGLComponentTexcoord];
-		tLength = (*element).length;
-		tOffset = (*element).offsetInFace;
+		space.tLength = (*element).length;
+		space.tOffset = (*element).offsetInFace;
 		
 		[_meshElements addElement:(NGLElement){NGLComponentTangent, _stride, 3, _facesStride++}];
 		_stride += 3;
@@ -393,24 +2385,197 @@ static UInt32 creaseAngle(UInt32 index,
 		_stride += 3;
 	}
 	
-	// Allocates memory to the new faces.
-	newFaces = malloc(NGL_SIZE_INT * (_facesCount * _facesStride));
+	space.faces = _faces;
+	space.vertices = _vertices;
+	space.normals = _normals;
+	space.texcoords = _texcoords;
+	space.newStride = _facesStride;
+	space.positions = _vCount;
+	space.canceled = &_canceled;
+	
+	// Must use calloc to generate 0 (zero) values. Canceled loads leave valid indices in the new faces.
+	space.newFaces = calloc(_facesCount * _facesStride, NGL_SIZE_UINT);
+	space.faceNormals = malloc(triangles * NGL_SIZE_VEC3);
+	space.faceTangents = (space.hasTextures) ? malloc(triangles * NGL_SIZE_VEC3) : NULL;
+	space.faceBitangents = (space.hasTextures) ? malloc(triangles * NGL_SIZE_VEC3) : NULL;
+	space.starts = calloc(_vCount + 1, NGL_SIZE_UINT);
+	space.corners = malloc(_facesCount * NGL_SIZE_UINT);
+	space.groups = calloc(_facesCount, NGL_SIZE_UINT);
+	space.extras = calloc(_vCount, NGL_SIZE_UINT);
+	
+#ifdef NGL_MULTITHREADING
+	// Big meshes are split in ranges of triangles and positions across the workers of the job system.
+	if (_facesCount >= MSH_PARALLEL_FACES)
+	{
+		tasks = nglJobWorkers() * MSH_CORE_TASKS;
+	}
+#endif
+	
+	const MSHTangentSpace *tangentSpace = &space;
+	
+	//*************************
+	//	Face Vectors
+	//*************************
+	nglJobFor(tasks, ^(UInt32 task)
+	{
+		meshFaceVectors(tangentSpace, (UInt32)(triangles * task / tasks),
+						(UInt32)(triangles * (task + 1) / tasks));
+	});
+	
+	//*************************
+	//	Crease Angle
+	//*************************
+	// Each position walks its own faces, the normals from the file are never split.
+	meshAdjacency(&space, _facesCount);
+	
+	if (!space.hasNormals)
+	{
+		nglJobFor(tasks, ^(UInt32 task)
+		{
+			meshCreasePositions(tangentSpace, (UInt32)(positions * task / tasks),
+								(UInt32)(positions * (task + 1) / tasks));
+		});
+	}
+	
+	// The first slot of each position is the position itself, the extra slots are placed after all positions.
+	// Normals, Tangents and Bitangents always have the same number of elements.
+	_nCount = _vCount;
+	for (i = 0; i < _vCount; ++i)
+	{
+		slot = space.extras[i];
+		space.extras[i] = _nCount;
+		_nCount += slot;
+	}
+	
+	_taCount = _biCount = _nCount;
+	
+	//*************************
+	//	Averages
+	//*************************
+	space.normalBuffer = (space.hasNormals) ? NULL : calloc(_nCount, NGL_SIZE_VEC3);
+	space.tangentBuffer = (space.hasTextures) ? calloc(_nCount, NGL_SIZE_VEC3) : NULL;
+	space.bitangentBuffer = (space.hasTextures) ? calloc(_nCount, NGL_SIZE_VEC3) : NULL;
+	
+	nglJobFor(tasks, ^(UInt32 task)
+	{
+		meshAccumulatePositions(tangentSpace, (UInt32)(positions * task / tasks),
+								(UInt32)(positions * (task + 1) / tasks));
+	});
+	
+	// Commits the changes for the original array of faces. At this time, it could looks like:
+	// iv1, it1, in1, ita1, ibt1, iv2, it2, in2, ita2, ibt2,...
+	nglFree(_faces);
+	_faces = space.newFaces;
+	
+	// Reallocates the memory for the array of normals, if needed.
+	if (!space.hasNormals)
+	{
+		_normals = realloc(_normals, NGL_SIZE_VEC3 * _nCount);
+	}
+	
+	// Reallocates the memory for the array of tangents and array of bitangents, if needed.
+	if (space.hasTextures)
+	{
+		_tangents = realloc(_tangents, NGL_SIZE_VEC3 * _taCount);
+		_bitangents = realloc(_bitangents, NGL_SIZE_VEC3 * _biCount);
+	}
+	
+	// Normalizes all the averaged vectors. Isn't necessary here the Gram–Schmidt Orthogonalization process,
+	// because all the vectors of the tangent space are already orthogonalized in reason of the crease angle.
+	UInt32 count = _nCount;
+	float *normals = _normals, *tangents = _tangents, *bitangents = _bitangents;
+	
+	nglJobFor(tasks, ^(UInt32 task)
+	{
+		UInt32 first = (UInt32)(count * task / tasks);
+		UInt32 last = (UInt32)(count * (task + 1) / tasks);
+		
+		if (!tangentSpace->hasNormals)
+		{
+			meshNormalizeVectors(tangentSpace->normalBuffer, normals, first, last);
+		}
+		
+		if (tangentSpace->hasTextures)
+		{
+			meshNormalizeVectors(tangentSpace->tangentBuffer, tangents, first, last);
+			meshNormalizeVectors(tangentSpace->bitangentBuffer, bitangents, first, last);
+		}
+	});
+	
+	_parsedData += _facesCount;
+	
+	// Frees the memories.
+	nglFree(space.faceNormals);
+	nglFree(space.faceTangents);
+	nglFree(space.faceBitangents);
+	nglFree(space.starts);
+	nglFree(space.corners);
+	nglFree(space.groups);
+	nglFree(space.extras);
+	nglFree(space.normalBuffer);
+	nglFree(space.tangentBuffer);
+	nglFree(space.bitangentBuffer);
+}
+
+- (void) optimizeStructure
+{
+	NGLElement *element = [_meshElements elementWithComponent:NGLComponentVertex];
+	NGLSurfaceMulti *surfaces = [self surface];
+	NGLSurface *surface;
+	UInt32 i, first, last, total, count, splitCount = 0;
+	UInt32 vertices = (_stride > 0) ? _sCount / _stride : 0;
+	UInt32 *splits, *local, *clusters;
+	float *positions, *structures;
+	NGLvec3 center = kNGLvec3Zero;
+	
+	// Canceled status.
+	if (_canceled)
+	{
+		return;
+	}
+	
+	_originalMetrics = nglVertexCacheMetrics(_indices, _iCount, NGL_VERTEX_CACHE);
+	_optimizedMetrics = _originalMetrics;
+	
+	if (_iCount < 3 || vertices == 0 || element == NULL)
+	{
+		return;
+	}
+	
+	// The center of the mesh, used to sort the clusters.
+	positions = _structures + (*element).start;
+	for (i = 0; i < vertices; ++i)
+	{
+		center = nglVec3Add(center, (NGLvec3){positions[i * _stride],
+											  positions[i * _stride + 1],
+											  positions[i * _stride + 2]});
+	}
+	
+	center = nglVec3Multiplyf(center, 1.0f / vertices);
+	
+	//*************************
+	//	Triangles
+	//*************************
+	// Each surface must keep its range of indices, so the triangles are only reordered inside the ranges.
+	count = [surfaces count];
+	splits = malloc((count * 2 + 2) * NGL_SIZE_UINT);
+	splits[splitCount++] = 0;
+	splits[splitCount++] = _iCount;
 	
-	// A priori, assumes that for each vertex exists only one normal.
-	_nCount = _taCount = _biCount = _vCount;
+	for (i = 0; i < count; ++i)
+	{
+		surface = [surfaces surfaceAtIndex:i];
+		splits[splitCount++] = MIN(surface.startData, _iCount);
+		splits[splitCount++] = MIN(surface.startData + surface.lengthData, _iCount);
+	}
 	
-	// Initializes the buffers for the tangent space elements.
-	// Must use calloc to generate 0 (zero) values, otherwise NaN values can be generated.
-	normalBuffer = calloc(_nCount, NGL_SIZE_VEC3);
-	tangentBuffer = calloc(_taCount, NGL_SIZE_VEC3);
-	bitangentBuffer = calloc(_biCount, NGL_SIZE_VEC3);
+	qsort(splits, splitCount, NGL_SIZE_UINT, meshCompareUInts);
 	
-	// Initializes the dictionaries to deal with vertices with multiple normals.
-	multiples = [[NSMutableDictionary alloc] init];
+	local = malloc(vertices * NGL_SIZE_UINT);
+	memset(local, 0xFF, vertices * NGL_SIZE_UINT);
+	clusters = malloc((_iCount / 3 + 1) * NGL_SIZE_UINT);
 	
-	// Loop through each triangle.
-	length = _facesCount;
-	for (i = 0; i < length; i += 3, _parsedData += 3)
+	for (i = 0; i + 1 < splitCount; ++i)
 	{
 		// Canceled status.
 		if (_canceled)
@@ -418,221 +2583,260 @@ static UInt32 creaseAngle(UInt32 index,
 			break;
 		}
 		
-		// Triangle Vertices. At this moment _faces is an ordered list of elements' indices:
-		// iv1, it1, in1, iv2, in2, it2, iv3, it3, in3...
-		//  |			   |			  |
-		//  V			   V			  V
-		// iv1,			  iv2,			 iv3
-		// So the following lines will extract the indices of vertices that form a triangle.
-		i1 = _faces[i * oldFaceStride + vOffset];
-		i2 = _faces[(i + 1) * oldFaceStride + vOffset];
-		i3 = _faces[(i + 2) * oldFaceStride + vOffset];
-		
-		// Calculates the vertex indices in the array of vertices.
-		vi1 = i1 * vLength;
-		vi2 = i2 * vLength;
-		vi3 = i3 * vLength;
+		// Only whole triangles are reordered.
+		first = splits[i];
+		last = splits[i + 1];
+		last -= (last - first) % 3;
 		
-		// Retrieves 3 vertices from the array of vertices.
-		vA = (NGLvec3){_vertices[vi1], _vertices[vi1 + 1], _vertices[vi1 + 2]};
-		vB = (NGLvec3){_vertices[vi2], _vertices[vi2 + 1], _vertices[vi2 + 2]};
-		vC = (NGLvec3){_vertices[vi3], _vertices[vi3 + 1], _vertices[vi3 + 2]};
+		if (first % 3 == 0 && last > first)
+		{
+			total = meshTipsify(_indices + first, last - first, NGL_VERTEX_CACHE, local, clusters);
+			meshSortClusters(_indices + first, last - first, clusters, total, positions, _stride, center);
+		}
+	}
+	
+	//*************************
+	//	Vertices
+	//*************************
+	if (!_canceled)
+	{
+		structures = malloc(_sCount * NGL_SIZE_FLOAT);
+		meshReorderVertices(_indices, _iCount, _structures, structures, vertices, _stride);
+		nglFree(_structures);
+		_structures = structures;
+	}
+	
+	_optimizedMetrics = nglVertexCacheMetrics(_indices, _iCount, NGL_VERTEX_CACHE);
+	
+	nglFree(splits);
+	nglFree(local);
+	nglFree(clusters);
+}
+
+- (void) defineLevels
+{
+	NGLElement *element = [_meshElements elementWithComponent:NGLComponentVertex];
+	UInt32 i, l, r, k, first, length, total, rangesCount, maxLevels = 0;
+	UInt32 vertices = (_stride > 0) ? _sCount / _stride : 0;
+	UInt32 *ranges, *rangeLevels, *offsets, *lengths, *welds, *local, *clusters, *output;
+	float *errors, *positions;
+	float diagonal;
+	BOOL *locked;
+	NGLvec3 vertex, vMin, vMax, center;
+	
+	if (_iCount < 3 || vertices == 0 || element == NULL || _canceled)
+	{
+		return;
+	}
+	
+	// The errors are relative to the diagonal of the mesh.
+	positions = _structures + (*element).start;
+	vMin = vMax = (NGLvec3){positions[0], positions[1], positions[2]};
+	for (i = 1; i < vertices; ++i)
+	{
+		vertex = (NGLvec3){positions[i * _stride], positions[i * _stride + 1], positions[i * _stride + 2]};
+		vMin = (NGLvec3){MIN(vMin.x, vertex.x), MIN(vMin.y, vertex.y), MIN(vMin.z, vertex.z)};
+		vMax = (NGLvec3){MAX(vMax.x, vertex.x), MAX(vMax.y, vertex.y), MAX(vMax.z, vertex.z)};
+	}
+	
+	diagonal = nglVec3Length(nglVec3Subtract(vMax, vMin));
+	center = nglVec3Multiplyf(nglVec3Add(vMin, vMax), 0.5f);
+	
+	if (diagonal <= 0.0f)
+	{
+		return;
+	}
+	
+	ranges = [self copyRanges:&rangesCount];
+	
+	welds = malloc(vertices * NGL_SIZE_UINT);
+	locked = malloc(vertices * sizeof(BOOL));
+	meshWeldPositions(positions, _stride, vertices, welds, locked);
+	
+	local = malloc(vertices * NGL_SIZE_UINT);
+	memset(local, 0xFF, vertices * NGL_SIZE_UINT);
+	clusters = malloc((_iCount / 3 + 1) * NGL_SIZE_UINT);
+	
+	rangeLevels = calloc(rangesCount, NGL_SIZE_UINT);
+	offsets = calloc(rangesCount * NGL_LOD_LEVELS, NGL_SIZE_UINT);
+	lengths = calloc(rangesCount * NGL_LOD_LEVELS, NGL_SIZE_UINT);
+	errors = calloc(rangesCount * NGL_LOD_LEVELS, NGL_SIZE_FLOAT);
+	
+	//*************************
+	//	Simplification
+	//*************************
+	for (r = 0; r < rangesCount && !_canceled; ++r)
+	{
+		// Only whole triangles are simplified.
+		first = ranges[r * 2];
+		length = (first % 3 == 0) ? ranges[r * 2 + 1] - ranges[r * 2 + 1] % 3 : 0;
 		
-		// Calculates the vector of the edges, the distance between the vertices.
-		distBA = nglVec3Subtract(vB, vA);
-		distCA = nglVec3Subtract(vC, vA);
+		output = malloc(MAX(length, 1) * (NGL_LOD_LEVELS - 1) * NGL_SIZE_UINT);
+		rangeLevels[r] = meshSimplify(_indices + first, length, positions, _stride, vertices, welds, locked,
+									  NGL_LOD_LEVELS - 1, output, lengths + r * NGL_LOD_LEVELS,
+									  errors + r * NGL_LOD_LEVELS);
 		
-		//*************************
-		//	Normals
-		//*************************
-		if (!hasNormals)
+		// A range that can't be simplified keeps its original triangles in all the levels.
+		if (rangeLevels[r] == 0)
 		{
-			// Calculates the face normal to the current triangle.
-			normal = nglVec3Cross(distBA, distCA);
-			
-			// Searches for crease angles considering the adjacent triangles.
-			// This function also initialize new blocks of memory to the buffer, setting them to 0 (zero).
-			i1 = creaseAngle(i1, normal, &normalBuffer, &_nCount, multiples);
-			i2 = creaseAngle(i2, normal, &normalBuffer, &_nCount, multiples);
-			i3 = creaseAngle(i3, normal, &normalBuffer, &_nCount, multiples);
-			
-			// Averages the new normal vector with the oldest buffered.
-			normalBuffer[i1] = nglVec3Add(normal, normalBuffer[i1]);
-			normalBuffer[i2] = nglVec3Add(normal, normalBuffer[i2]);
-			normalBuffer[i3] = nglVec3Add(normal, normalBuffer[i3]);
+			memcpy(output, _indices + first, length * NGL_SIZE_UINT);
+			lengths[r * NGL_LOD_LEVELS] = length;
 		}
-		else
+		
+		maxLevels = MAX(maxLevels, rangeLevels[r]);
+		
+		// Appends the levels, each one reordered for the vertex cache and the overdraw as well.
+		total = 0;
+		for (l = 0; l < MAX(rangeLevels[r], 1); ++l)
 		{
-			// If the parsed file has normals in it, retrieves their indices in the array of normals.
-			vi1 = _faces[i * oldFaceStride + nOffset] * nLength;
-			vi2 = _faces[(i + 1) * oldFaceStride + nOffset] * nLength;
-			vi3 = _faces[(i + 2) * oldFaceStride + nOffset] * nLength;
-			
-			// Retrieves the normals.
-			vA = (NGLvec3){_normals[vi1], _normals[vi1 + 1], _normals[vi1 + 2]};
-			vB = (NGLvec3){_normals[vi2], _normals[vi2 + 1], _normals[vi2 + 2]};
-			vC = (NGLvec3){_normals[vi3], _normals[vi3 + 1], _normals[vi3 + 2]};
-			
-			// Calculates the face normal to the current triangle.
-			normal = nglVec3Add(nglVec3Add(vA, vB), vC);
+			total += lengths[r * NGL_LOD_LEVELS + l];
 		}
 		
-		//*************************
-		//	Tangent Space
-		//*************************
-		if (hasTextures)
+		_lodIndices = realloc(_lodIndices, (_lodCount + total) * NGL_SIZE_UINT);
+		memcpy(_lodIndices + _lodCount, output, total * NGL_SIZE_UINT);
+		
+		for (l = 0; l < MAX(rangeLevels[r], 1); ++l)
 		{
-			// The crease angle process produces splits on the per-vertex normals, as the tangent space
-			// must be orthogonalized, the tangent and bitanget follow those splits.
-			if (_nCount > _taCount)
-			{
-				// Normals, Tangents and Bitangents buffers will always have the same number of elements.
-				tangentBuffer = realloc(tangentBuffer, NGL_SIZE_VEC3 * _nCount);
-				bitangentBuffer = realloc(bitangentBuffer, NGL_SIZE_VEC3 * _nCount);
-				
-				// Setting the brand new buffers to 0 (zero).
-				lengthJ = _nCount;
-				for (j = _taCount - 1; j < lengthJ; ++j)
-				{
-					tangentBuffer[j] = kNGLvec3Zero;
-					bitangentBuffer[j] = kNGLvec3Zero;
-				}
-				
-				_taCount = _biCount = _nCount;
-			}
-			
-			// Retrieves texture coordinate indices.
-			ti1 = _faces[i * oldFaceStride + tOffset] * tLength;
-			ti2 = _faces[(i + 1) * oldFaceStride + tOffset] * tLength;
-			ti3 = _faces[(i + 2) * oldFaceStride + tOffset] * tLength;
-			
-			// Retrieves the texture coordinates.
-			tA = (NGLvec2){_texcoords[ti1], _texcoords[ti1 + 1]};
-			tB = (NGLvec2){_texcoords[ti2], _texcoords[ti2 + 1]};
-			tC = (NGLvec2){_texcoords[ti3], _texcoords[ti3 + 1]};
-			
-			// Calculates the vector of the texture coordinates edges, the distance between them.
-			tdistBA = nglVec2Subtract(tB, tA);
-			tdistCA = nglVec2Subtract(tC, tA);
+			offsets[r * NGL_LOD_LEVELS + l] = _lodCount;
+			length = lengths[r * NGL_LOD_LEVELS + l];
 			
-			// Calculates the triangle's area.
-			area = tdistBA.x * tdistCA.y - tdistBA.y * tdistCA.x;
-			
-			//*************************
-			//	Tangent
-			//*************************
-			if (area == 0.0f)
-			{
-				tangent = kNGLvec3Zero;
-			}
-			else
+			if (length > 0)
 			{
-				delta = 1.0f / area;
-				
-				// Calculates the face tangent to the current triangle.
-				tangent.x = delta * ((distBA.x * tdistCA.y) + (distCA.x * -tdistBA.y));
-				tangent.y = delta * ((distBA.y * tdistCA.y) + (distCA.y * -tdistBA.y));
-				tangent.z = delta * ((distBA.z * tdistCA.y) + (distCA.z * -tdistBA.y));
+				k = meshTipsify(_lodIndices + _lodCount, length, NGL_VERTEX_CACHE, local, clusters);
+				meshSortClusters(_lodIndices + _lodCount, length, clusters, k, positions, _stride, center);
 			}
 			
-			// Averages the new tagent vector with the oldest buffered.
-			tangentBuffer[i1] = nglVec3Add(tangent, tangentBuffer[i1]);
-			tangentBuffer[i2] = nglVec3Add(tangent, tangentBuffer[i2]);
-			tangentBuffer[i3] = nglVec3Add(tangent, tangentBuffer[i3]);
-			
-			//*************************
-			//	Bitangent
-			//*************************
-			// Calculates the face bitangent to the current triangle,
-			// completing the orthogonalized tangent space.
-			bitangent = nglVec3Cross(normal, tangent);
-			
-			// Averages the new bitangent vector with the oldest buffered.
-			bitangentBuffer[i1] = nglVec3Add(bitangent, bitangentBuffer[i1]);
-			bitangentBuffer[i2] = nglVec3Add(bitangent, bitangentBuffer[i2]);
-			bitangentBuffer[i3] = nglVec3Add(bitangent, bitangentBuffer[i3]);
+			_lodCount += length;
 		}
 		
-		// Copies the oldest face indices and inserts the new created indices.
-		outFaces = newFaces + (i * _facesStride);
-		lengthJ = _facesStride;
-		for (j = 0; j < lengthJ; ++j)
-		{
-			*outFaces++ = (j < oldFaceStride) ? _faces[i * oldFaceStride + j] : i1;
-		}
+		nglFree(output);
+	}
+	
+	//*************************
+	//	Levels
+	//*************************
+	// Each range has one entry in each level, the ranges with less levels repeat their last one.
+	if (maxLevels > 0 && !_canceled)
+	{
+		_levelsCount = maxLevels * rangesCount;
+		_levels = malloc(_levelsCount * sizeof(NGLLevel));
 		
-		outFaces = newFaces + ((i + 1) * _facesStride);
-		for (j = 0; j < lengthJ; ++j)
+		for (l = 0; l < maxLevels; ++l)
 		{
-			*outFaces++ = (j < oldFaceStride) ? _faces[(i + 1) * oldFaceStride + j] : i2;
+			for (r = 0; r < rangesCount; ++r)
+			{
+				k = r * NGL_LOD_LEVELS + MIN(l, MAX(rangeLevels[r], 1) - 1);
+				
+				_levels[l * rangesCount + r] = (NGLLevel){ l + 1, ranges[r * 2], ranges[r * 2 + 1],
+														   offsets[k], lengths[k],
+														   (rangeLevels[r] > 0) ? errors[k] / diagonal : 0.0f };
+			}
 		}
+	}
+	else
+	{
+		nglFree(_lodIndices);
+		_lodCount = 0;
+	}
+	
+	nglFree(ranges);
+	nglFree(welds);
+	nglFree(locked);
+	nglFree(local);
+	nglFree(clusters);
+	nglFree(rangeLevels);
+	nglFree(offsets);
+	nglFree(lengths);
+	nglFree(errors);
+}
+
+- (void) defineClusters
+{
+	NGLElement *element = [_meshElements elementWithComponent:NGLComponentVertex];
+	UInt32 i, first, length, rangesCount;
+	UInt32 vertices = (_stride > 0) ? _sCount / _stride : 0;
+	UInt32 *ranges, *stamps;
+	float *positions;
+	
+	if (_iCount < 3 || vertices == 0 || element == NULL || _canceled)
+	{
+		return;
+	}
+	
+	ranges = [self copyRanges:&rangesCount];
+	positions = _structures + (*element).start;
+	stamps = malloc(vertices * NGL_SIZE_UINT);
+	memset(stamps, 0xFF, vertices * NGL_SIZE_UINT);
+	
+	// Each cluster has at least one triangle.
+	_clusters = malloc((_iCount / 3 + 1) * sizeof(NGLCluster));
+	_clustersCount = 0;
+	
+	for (i = 0; i < rangesCount; ++i)
+	{
+		// Only whole triangles are clustered, the ranges that don't start at a triangle are drawn entirely.
+		first = ranges[i * 2];
+		length = (first % 3 == 0) ? ranges[i * 2 + 1] - ranges[i * 2 + 1] % 3 : 0;
 		
-		outFaces = newFaces + ((i + 2) * _facesStride);
-		for (j = 0; j < lengthJ; ++j)
+		if (length > 0)
 		{
-			*outFaces++ = (j < oldFaceStride) ? _faces[(i + 2) * oldFaceStride + j] : i3;
+			_clustersCount += meshBuildClusters(_indices, first, length, positions, _stride, stamps,
+												_clusters + _clustersCount);
 		}
 	}
 	
-	// Commits the changes for the original array of faces. At this time, it could looks like:
-	// iv1, it1, in1, ita1, ibt1, iv2, it2, in2, ita2, ibt2,...
-	_faces = realloc(_faces, NGL_SIZE_INT * (_facesCount * _facesStride));
-	memcpy(_faces, newFaces, NGL_SIZE_INT * (_facesCount * _facesStride));
+	// The clusters must be sorted by their starts (the first member), the surfaces don't need to.
+	qsort(_clusters, _clustersCount, sizeof(NGLCluster), meshCompareUInts);
+	_clusters = realloc(_clusters, MAX(_clustersCount, 1) * sizeof(NGLCluster));
+	
+	nglFree(ranges);
+	nglFree(stamps);
+}
+
+- (void) defineWindows
+{
+	UInt32 i, rangesCount;
+	UInt32 *ranges;
 	
-	// Reallocates the memory for the array of normals, if needed. 
-	if (!hasNormals)
+	if (_iCount == 0 || _canceled)
 	{
-		_normals = realloc(_normals, NGL_SIZE_VEC3 * _nCount);
+		return;
 	}
 	
-	// Reallocates the memory for the array of tangents and array of bitangents, if needed.
-	if (hasTextures)
+	ranges = [self copyRanges:&rangesCount];
+	_windows = malloc(rangesCount * sizeof(NGLWindow));
+	_windowsCount = rangesCount;
+	
+	for (i = 0; i < rangesCount; ++i)
 	{
-		_tangents = realloc(_tangents, NGL_SIZE_VEC3 * _taCount);
-		_bitangents = realloc(_bitangents, NGL_SIZE_VEC3 * _biCount);
+		_windows[i] = nglVertexWindow(_indices, ranges[i * 2], ranges[i * 2 + 1],
+									  _levels, _levelsCount, _lodIndices);
 	}
 	
-	// Loops through all new values of the tangent space, normalizing all the averaged vectors.
-	length = _nCount;
-	for (i = 0; i < length; i++)
+	nglFree(ranges);
+}
+
+- (UInt32 *) copyRanges:(UInt32 *)count
+{
+	NGLSurfaceMulti *surfaces = [self surface];
+	NGLSurface *surface;
+	UInt32 i, length = [surfaces count];
+	UInt32 *ranges;
+	
+	// The ranges are the surfaces or the whole array of indices, the same ones drawn by the mesh.
+	*count = MAX(length, 1);
+	ranges = malloc(*count * 2 * NGL_SIZE_UINT);
+	ranges[0] = 0;
+	ranges[1] = _iCount;
+	
+	for (i = 0; i < length; ++i)
 	{
-		// Puts the new normals, if needed.
-		if (!hasNormals)
-		{
-			normal = nglVec3Normalize(normalBuffer[i]);
-			outValue = _normals + (i * 3);
-			*outValue++ = normal.x;
-			*outValue++ = normal.y;
-			*outValue = normal.z;
-		}
-		
-		// Puts the new tangent and bitangent, if needed.
-		// Isn't necessary here the Gram–Schmidt Orthogonalization process, because all the vectors
-		// of the tangent space are already orthogonalized in reason of the crease angle approach.
-		if (hasTextures)
-		{
-			tangent = nglVec3Normalize(tangentBuffer[i]);
-			bitangent = nglVec3Normalize(bitangentBuffer[i]);
-			
-			outValue = _tangents + (i * 3);
-			*outValue++ = tangent.x;
-			*outValue++ = tangent.y;
-			*outValue = tangent.z;
-			
-			outValue = _bitangents + (i * 3);
-			*outValue++ = bitangent.x;
-			*outValue++ = bitangent.y;
-			*outValue = bitangent.z;
-		}
+		surface = [surfaces surfaceAtIndex:i];
+		ranges[i * 2] = MIN(surface.startData, _iCount);
+		ranges[i * 2 + 1] = MIN(surface.lengthData, _iCount - ranges[i * 2]);
 	}
 	
-	// Frees the memories.
-	nglFree(newFaces);
-	nglFree(normalBuffer);
-	nglFree(tangentBuffer);
-	nglFree(bitangentBuffer);
-	
-	nglRelease(multiples);
+	return ranges;
 }
 
 #pragma mark -
@@ -650,20 +2854,18 @@ static UInt32 creaseAngle(UInt32 index,
 {
 	UInt32 i, lengthI;
 	UInt32 j, lengthJ;
-	UInt32 index, faceIndex;
+	UInt32 e, faceIndex, unique;
 	
 	NGLElement *element;
-	UInt32 eIndex, eStart;
+	NGLElement elements[MSH_MAX_ELEMENTS];
+	UInt32 eIndex;
 	float *eValue;
 	
 	float *outStructure;
-	UInt32 *outIndex;
-	
-	char *faceData;
-	char *faceCString;
-	NSNumber *indexNum;
-	NSString *faceString;
-	NSMutableDictionary *faceProcessed;
+	UInt32 *hashes;
+	UInt32 *firsts;
+	UInt32 partitions = 1;
+	MSHFaceKey key;
 	
 	// Parsing data will loop through the faces twice:
 	// when defining the tangent space and when creating the structure.
@@ -674,22 +2876,73 @@ static UInt32 creaseAngle(UInt32 index,
 	// Calculates the tangent space.
 	[self defineTangentSpace];
 	
-	// Allocates the necessary memory to deal with unique faces.
-	faceData = malloc(NGL_SIZE_CHAR * 64);
-	faceCString = malloc(NGL_SIZE_CHAR * 64);
-	faceProcessed = [[NSMutableDictionary alloc] init];
+	// Checks for the maximum unique faces.
+	if (_facesCount >= MSH_EMPTY_SLOT)
+	{
+		_error.message = MSH_MAX_UINT;
+		[_error showError];
+		return;
+	}
+	
+	// Only the valid elements identify a face vertex, avoiding faces with unreferenced elements.
+	key.faces = _faces;
+	key.stride = _facesStride;
+	key.count = 0;
+	while ((element = [_meshElements nextIterator]))
+	{
+		elements[key.count] = *element;
+		key.offsets[key.count++] = (*element).offsetInFace;
+	}
 	
-	// The final size of the array of structures can't be calculated now,
-	// but the array of indices has the same length of mesh's vertices.
+	// The array of indices has the same length of mesh's vertices.
 	_sCount = 0;
 	_iCount = _facesCount;
-	
-	// Reallocates the array of indices.
 	_indices = realloc(_indices, _iCount * NGL_SIZE_UINT);
-	outIndex = _indices;
 	
-	// Loops through each mesh's vertex.
 	lengthI = _facesCount;
+	hashes = malloc(lengthI * NGL_SIZE_UINT);
+	firsts = malloc(lengthI * NGL_SIZE_UINT);
+	
+#ifdef NGL_MULTITHREADING
+	// Huge meshes are partitioned by the hash values across the workers of the job system.
+	if (lengthI >= MSH_PARTITION_FACES)
+	{
+		partitions = nglJobWorkers();
+	}
+#endif
+	
+	// Finds the first occurrence of each face vertex. The partitions are independent of each other.
+	const MSHFaceKey *faceKey = &key;
+	const BOOL *canceled = &_canceled;
+	
+	nglJobFor(partitions, ^(UInt32 partition)
+	{
+		UInt32 face = (UInt32)(lengthI * partition / partitions);
+		UInt32 last = (UInt32)(lengthI * (partition + 1) / partitions);
+		
+		for (; face < last && !*canceled; ++face)
+		{
+			hashes[face] = meshHashFace(faceKey, face);
+		}
+	});
+	
+	// The hashes of a canceled loading are incomplete, they can't be used to find the unique face vertices.
+	if (_canceled)
+	{
+		nglFree(hashes);
+		nglFree(firsts);
+		return;
+	}
+	
+	nglJobFor(partitions, ^(UInt32 partition)
+	{
+		meshDeduplicatePartition(faceKey, hashes, firsts, lengthI,
+								 partition, partitions, canceled);
+	});
+	
+	// Numbers the unique face vertices in the order they were first seen, which is the same order
+	// the array of structures always had. The array of hashes is reused to store the unique face vertices.
+	unique = 0;
 	for (i = 0; i < lengthI; ++i, ++_parsedData)
 	{
 		// Canceled status.
@@ -698,92 +2951,85 @@ static UInt32 creaseAngle(UInt32 index,
 			break;
 		}
 		
-		faceIndex = i * _facesStride;
-		memset(faceCString, 0, NGL_SIZE_POINTER);
-		
-		// Creates a string representing the face using only the valid elements to avoid faces with 
-		// unreferenced elements. Nevertheless, the string could have coincidences like 11 1 and 1 11.
-		// To avoid that, it's necessary to add a slash: 11/1 and 1/11 is now different.
-		while ((element = [_meshElements nextIterator]))
+		if (firsts[i] == i)
 		{
-			sprintf(faceData, "%i/", (unsigned int)_faces[faceIndex + (*element).offsetInFace]);
-			strcat(faceCString, faceData);
+			hashes[unique] = i;
+			_indices[i] = unique++;
 		}
+		else
+		{
+			_indices[i] = _indices[firsts[i]];
+		}
+	}
+	
+	// Allocates the array of structures once, with its final size.
+	_sCount = unique * _stride;
+	_structures = realloc(_structures, _sCount * NGL_SIZE_FLOAT);
+	outStructure = _structures;
+	
+	// Copies the values from original arrays to the array of structures.
+	for (i = 0; i < unique; ++i, outStructure += _stride)
+	{
+		faceIndex = hashes[i] * _facesStride;
 		
-		//TODO find a faster way to check the faces. VERY EXPENSIVE
-		// Looking for the same face string in the processed list.
-		faceString = [NSString stringWithCString:faceCString encoding:NSUTF8StringEncoding];
-		indexNum = [faceProcessed objectForKey:faceString];
-		
-		// Processes new faces.
-		if (indexNum == nil)
+		for (e = 0; e < key.count; ++e)
 		{
-			// Adds the new face string.
-			index = (UInt32)[faceProcessed count];
-			[faceProcessed setObject:[NSNumber numberWithUnsignedInt:index] forKey:faceString];
+			element = &elements[e];
 			
-			// Reallocates the array of structures and sets a pointer to the following process.
-			_structures = realloc(_structures, (_sCount + _stride) * NGL_SIZE_FLOAT);
-			outStructure = _structures + _sCount;
+			// Retrieves the element index in the array of faces.
+			eIndex = _faces[faceIndex + (*element).offsetInFace];
 			
-			while ((element = [_meshElements nextIterator]))
+			// Sets the pointer to correct original array.
+			switch ((*element).component)
 			{
-				// Retrieves the element index in the array of faces.
-				eIndex = _faces[faceIndex + (*element).offsetInFace];
-				eStart = (*element).start;
-				
-				// Sets the pointer to correct original array.
-				switch ((*element).component)
-				{
-					case NGLComponentVertex:
-						eValue = _vertices + (eIndex * (*element).length);
-						break;
-					case NGLComponentTexcoord:
-						eValue = _texcoords + (eIndex * (*element).length);
-						break;
-					case NGLComponentNormal:
-						eValue = _normals + (eIndex * (*element).length);
-						break;
-					case NGLComponentTangent:
-						eValue = _tangents + (eIndex * (*element).length);
-						break;
-					case NGLComponentBitangent:
-						eValue = _bitangents + (eIndex * (*element).length);
-						break;
-				}
-				
-				// Copies the values from original array to the array of structure.
-				lengthJ = (*element).length;
-				for (j = 0; j < lengthJ; ++j)
-				{
-					outStructure[eStart + j] = *eValue++;
-					++_sCount;
-				}
+				case NGLComponentVertex:
+					eValue = _vertices + (eIndex * (*element).length);
+					break;
+				case NGLComponentTexcoord:
+					eValue = _texcoords + (eIndex * (*element).length);
+					break;
+				case NGLComponentNormal:
+					eValue = _normals + (eIndex * (*element).length);
+					break;
+				case NGLComponentTangent:
+					eValue = _tangents + (eIndex * (*element).length);
+					break;
+				case NGLComponentBitangent:
+					eValue = _bitangents + (eIndex * (*element).length);
+					break;
+				case NGLComponentBoneIndices:
+					eValue = _boneIndices + (eIndex * (*element).length);
+					break;
+				case NGLComponentBoneWeights:
+					eValue = _boneWeights + (eIndex * (*element).length);
+					break;
+			}
+			
+			lengthJ = (*element).length;
+			for (j = 0; j < lengthJ; ++j)
+			{
+				outStructure[(*element).start + j] = eValue[j];
 			}
 		}
-		// If the face was already processed, skips it.
-		else
-		{
-			index = [indexNum unsignedIntValue];
-		}
-		
-		// Copies the array of structure's index to the array of indices.
-		*outIndex++ = index;
 	}
 	
-	// Checks for the maximum unique faces.
-	if ([faceProcessed count] > NGL_MAX_32)
+	// A canceled structure is incomplete, it's not optimized nor split.
+	if (!_canceled)
 	{
-		_error.message = MSH_MAX_UINT;
+		// Reorders the triangles and the vertices for the GPU caches.
+		[self optimizeStructure];
+		
+		// Generates the levels of detail and the clusters from the optimized structure.
+		[self defineLevels];
+		[self defineClusters];
+		[self defineWindows];
 	}
-	 
+	
 	[_error showError];
 	
 	// Frees the memories
-	nglFree(faceCString);
-	nglFree(faceData);
-	
-	nglRelease(faceProcessed);
+	nglFree(hashes);
+	nglFree(firsts);
 }
 
 - (void) cancelLoading
@@ -799,9 +3045,22 @@ static UInt32 creaseAngle(UInt32 index,
 
 - (void) dealloc
 {
-	nglFree(_indices);
-	nglFree(_structures);
+	// The mapped arrays are not owned by the parser.
+	if (_mappedData == nil)
+	{
+		nglFree(_indices);
+		nglFree(_structures);
+	}
+	
+	nglRelease(_mappedData);
 	nglFree(_adjusted);
+	nglFree(_levels);
+	nglFree(_lodIndices);
+	nglFree(_clusters);
+	nglFree(_windows);
+	nglFree(_joints);
+	nglFree(_aJoints);
+	nglRelease(_jointNames);
 	
 	nglFree(_tangents);
 	nglFree(_bitangents);
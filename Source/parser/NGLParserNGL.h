@@ -23,6 +23,179 @@
 #import "NGLRuntime.h"
 #import "NGLParserMesh.h"
 
+/*!
+ *					The statistics of the NinevehGL Binary cache.
+ *
+ *					The counters are related to the current application session, while the entries and
+ *					bytes reflect the files currently in the cache.
+ *
+ *	@var			NGLCacheStats::lookups
+ *					The number of searches for a cached file.
+ *	
+ *	@var			NGLCacheStats::hits
+ *					The number of searches that found a valid cached file.
+ *	
+ *	@var			NGLCacheStats::misses
+ *					The number of searches that didn't find a valid cached file.
+ *	
+ *	@var			NGLCacheStats::evictions
+ *					The number of cached files deleted to respect the disk budget.
+ *	
+ *	@var			NGLCacheStats::entries
+ *					The number of cached files.
+ *	
+ *	@var			NGLCacheStats::bytes
+ *					The size of all cached files, in bytes.
+ *	
+ *	@var			NGLCacheStats::lookupTime
+ *					The total time spent in the searches, in seconds.
+ */
+typedef struct
+{
+	UInt32					lookups;
+	UInt32					hits;
+	UInt32					misses;
+	UInt32					evictions;
+	UInt32					entries;
+	UInt64					bytes;
+	double					lookupTime;
+} NGLCacheStats;
+
+/*!
+ *					Returns the current statistics of the NinevehGL Binary cache.
+ *
+ *	@result			A NGLCacheStats with the current values.
+ */
+NGL_API NGLCacheStats nglCacheStats(void);
+
+/*!
+ *					Deletes all the cached NGL Binary files and resets the cache statistics.
+ *
+ *					The next loading of each 3D file will parse the original file again.
+ */
+NGL_API void nglCacheClear(void);
+
+/*!
+ *					Returns the name of the cached file to an original 3D file and its import settings.
+ *
+ *					This is the name used by the NinevehGL Binary cache. Cached files generated offline
+ *					with these names can be imported by #nglCacheImport#.
+ *
+ *	@param			named
+ *					The original 3D file, using the NinevehGL Path API.
+ *
+ *	@param			settings
+ *					The import settings. The kNGLMeshKeyOriginal, kNGLMeshKeyDynamic and kNGLMeshKeyFormat
+ *					are ignored, they don't change the cached file. It can be nil.
+ *
+ *	@result			A NSString with the file name or nil if the original file doesn't exist.
+ */
+NGL_API NSString *nglCacheName(NSString *named, NSDictionary *settings);
+
+/*!
+ *					Imports the pre-generated NGL Binary files in a folder to the cache.
+ *
+ *					Only the files named by #nglCacheName# and not cached yet are copied. A good place to
+ *					call this function is at the first launch of the application, with a folder in the
+ *					application bundle, so the first loading of each mesh will not parse the original file.
+ *
+ *	@param			folder
+ *					The full path to the folder with the NGL Binary files.
+ *
+ *	@result			The number of imported files.
+ */
+NGL_API UInt32 nglCacheImport(NSString *folder);
+
+/*!
+ *					Compresses an array of structures to be saved in a NGL Binary file.
+ *
+ *					Each element is encoded based on its component. Positions and texture coordinates are
+ *					quantized to 16 bits inside their bounding box, normals, tangents and bitangents are
+ *					stored as two 16 bits octahedral coordinates (as unit vectors). Any other element is
+ *					kept in floats. The maximum position error is half of a quantization step.
+ *
+ *					This function will return an autoreleased instance of NSData.
+ *
+ *	@param			structures
+ *					A pointer to the array of structures.
+ *
+ *	@param			count
+ *					The number of floats in the array of structures.
+ *
+ *	@param			stride
+ *					The number of floats of each structure.
+ *
+ *	@param			elements
+ *					The NGLMeshElements describing the structure.
+ *
+ *	@result			An autoreleased instance of NSData.
+ */
+NGL_API NSData *nglCompressStructures(const float *structures, UInt32 count, UInt32 stride,
+									  NGLMeshElements *elements);
+
+/*!
+ *					Decompresses an array of structures created by #nglCompressStructures#.
+ *
+ *					The elements are decoded directly into the interleaved array, 4 structures at once,
+ *					using the vector unit of the device.
+ *
+ *	@param			bytes
+ *					A pointer to the compressed data.
+ *
+ *	@param			length
+ *					The length of the compressed data, in bytes.
+ *
+ *	@param			structures
+ *					A pointer to the output array of structures, with room for "count" floats.
+ *
+ *	@param			count
+ *					The number of floats in the array of structures.
+ *
+ *	@param			stride
+ *					The number of floats of each structure.
+ *
+ *	@result			A BOOL indicating if the data was valid. The output is undefined when it returns NO.
+ */
+NGL_API BOOL nglDecompressStructures(const void *bytes, UInt32 length, float *structures,
+									 UInt32 count, UInt32 stride);
+
+/*!
+ *					Compresses an array of indices to be saved in a NGL Binary file.
+ *
+ *					The indices are stored as the difference to the previous index, in variable length
+ *					integers. Optimized meshes reuse the near indices, so most of them take only 1 byte.
+ *
+ *					This function will return an autoreleased instance of NSData.
+ *
+ *	@param			indices
+ *					A pointer to the array of indices.
+ *
+ *	@param			count
+ *					The number of indices.
+ *
+ *	@result			An autoreleased instance of NSData.
+ */
+NGL_API NSData *nglCompressIndices(const UInt32 *indices, UInt32 count);
+
+/*!
+ *					Decompresses an array of indices created by #nglCompressIndices#.
+ *
+ *	@param			bytes
+ *					A pointer to the compressed data.
+ *
+ *	@param			length
+ *					The length of the compressed data, in bytes.
+ *
+ *	@param			indices
+ *					A pointer to the output array of indices, with room for "count" indices.
+ *
+ *	@param			count
+ *					The number of indices.
+ *
+ *	@result			A BOOL indicating if the data was valid. The output is undefined when it returns NO.
+ */
+NGL_API BOOL nglDecompressIndices(const void *bytes, UInt32 length, UInt32 *indices, UInt32 count);
+
 /*!
  *					<strong>(Internal only)</strong> Loads, parses, constructs and saves the NinevehGL
  *					Binary files (.ngl).
@@ -39,14 +212,16 @@
  *					This local path is properly backed-up by the iTunes/iCloud. That means if your
  *					application has been updated, the cached files on the user's device will not be erased.
  *					NinevehGL will compare the both files, the cached .ngl and the original 3D file.
- *					If the original 3D file has a newer version, it will be used instead the .ngl file,
+ *					If the original 3D file has changed, it will be used instead the .ngl file,
  *					otherwise the cached NinevehGL Binary file will be used.
  *
- *					The binary file is linked with he original one by the name. For example, a cached file
- *					<code>wall.ngl</code> represents a 3D file with name <code>wall.&lt;extension&gt;</code>.
- *					So is advisible to avoid repeating the same name to two different 3D files, like wall.obj
- *					and wall.dae. Because in this case, NinevehGL will cache only one binary file to
- *					both files.
+ *					The binary file is linked with the original one by its content and by the import
+ *					settings. The cached file is named with a hash of the original file's bytes plus a hash
+ *					of the settings, so different 3D files with the same name have their own cached files
+ *					and changing the import settings never reuses a cached file made with other settings.
+ *					An index file in the same folder remembers the hash of each original file (so it's only
+ *					computed again when the file changes) and the last access to each cached file. When the
+ *					cache exceeds the disk budget, the least recently used files are deleted.
  *
  *					There are many advantages with the NinevehGL Binary file, it's lighter, cleaner and
  *					OpenGL Friendly. But the greatest advantage is the performance when loading and parsing.
@@ -67,11 +242,33 @@
  *							http://nineveh.gl/binary</a> in the official NinevehGL Web Site;
  *						- Automatically generated by NinevehGL Parse API.
  *
- *					The NinevehGL Binary file format follows the following data flow:
+ *					The NinevehGL Binary file (version 2.0) starts with a header and a table of sections.
+ *					Every section starts at a 16 bytes aligned offset, so the file is memory-mapped and its
+ *					array of indices and array of structures are sent directly to OpenGL, without any copy.
+ *					Files in the old version 1.1 (the same sections in sequence, right after the version,
+ *					without header and table) are still loaded. Cached files in the old version, or not valid
+ *					version 2.0 files, are discarded and rebuilt from the original files. If the cache index
+ *					is lost, the valid cached files are indexed again.
+ *
+ *					Optionally, the indices and structures sections can be replaced by compressed sections
+ *					(types 7 and 8), see #nglCompressIndices# and #nglCompressStructures#. These files are
+ *					around 2 times smaller, but the arrays are decoded at the loading instead of mapped.
  *
  *					<pre>
  *
  *					|--- 4 bytes (float)            NGL Binary file version
+ *					|--- 4 bytes (UInt32)     Count - Sections
+ *					|--- 4 bytes (UInt32)           File length
+ *					|--- 4 bytes (UInt32)           Reserved
+ *					|
+ *					|--- 16 bytes             Section Node
+ *					|   |
+ *					|   |--- 4 bytes (UInt32)           Type (elements, mesh, indices, structures, ...)
+ *					|   |--- 4 bytes (UInt32)           Offset (multiple of 16)
+ *					|   |--- 4 bytes (UInt32)           Length
+ *					|   |--- 4 bytes (UInt32)           Reserved
+ *					|
+ *					|--- x bytes                    Sections, in the following order:
  *					|
  *					|--- 4 bytes (UInt32)     Count - Elements Node
  *					|   |
@@ -84,7 +281,7 @@
  *					|--- 4 bytes (UInt32)     Count - Structures
  *					|--- 4 bytes (UInt32)     Stride
  *					|
- *					|--- x bytes (unsigned short)   Indices array
+ *					|--- x bytes (UInt32)           Indices array
  *					|--- x bytes (float)            Structure array
  *					|
  *					|--- 4 bytes (UInt32)     Count - Materials Node
@@ -115,11 +312,32 @@
  *					|           |--- 1 byte (unsigned char)     Optimize
  *					|
  *					|--- 4 bytes (UInt32)     Count - Surface Node
+ *					|   |
+ *					|   |--- 2 bytes (unsigned short)   Identifier
+ *					|   |          
+ *					|   |--- 4 bytes (UInt32)     Start data
+ *					|   |--- 4 bytes (UInt32)     Length data
+ *					|
+ *					|--- 4 bytes (UInt32)     Count - Level Node (optional)
+ *					|--- 4 bytes (UInt32)     Count - Levels' indices
+ *					|   |
+ *					|   |--- 24 bytes                   NGLLevel
+ *					|
+ *					|--- x bytes (UInt32)           Levels' indices array
+ *					|
+ *					|--- x bytes              Cluster Nodes (optional, until the section's length)
+ *					|   |
+ *					|   |--- 48 bytes                   NGLCluster
+ *					|
+ *					|--- x bytes              Window Nodes (optional, until the section's length)
+ *					|   |
+ *					|   |--- 20 bytes                   NGLWindow
+ *					|
+ *					|--- 4 bytes (UInt32)     Count - Joint Node (optional)
  *					    |
- *					    |--- 2 bytes (unsigned short)   Identifier
- *					    |          
- *					    |--- 4 bytes (UInt32)     Start data
- *					    |--- 4 bytes (UInt32)     Length data
+ *					    |--- 2 bytes (unsigned short)   Name length
+ *					    |--- x bytes (char)             Name
+ *					    |--- 132 bytes                  NGLJoint
  *
  *					</pre>
  *	
@@ -131,11 +349,21 @@
 @private
 	// Helpers
 	UInt32			_rangeIndex;
+	float			_version;
+	BOOL			_compressed;
 }
 
 /*!
- *					Indicates if a NGL Binary has a  valid binary cache for it, that means, if the
- *					binary file exists and is newer than the original 3D file.
+ *					Indicates if the next NGL Binary files will be saved with compressed geometry.
+ *
+ *					The compressed files are smaller, but they need to be decoded while loading.
+ *					The default value is NO.
+ */
+@property (nonatomic) BOOL compressed;
+
+/*!
+ *					Indicates if a 3D file has a valid binary cache for it, that means, if there is a
+ *					binary file made from the same content with the same import settings.
  *
  *	@param			named
  *					In NinevehGL the "named" parameter is always related to the NinevehGL Path API, so you
@@ -143,16 +371,18 @@
  *					system. If only the file's name is informed, NinevehGL will search for the file at the
  *					global path.
  *
+ *	@param			settings
+ *					The import settings used to parse the original file. It can be nil.
+ *
  *	@result			A BOOL data type representing if there is a valid cache for the informed path.
  */
-- (BOOL) hasCache:(NSString *)named;
+- (BOOL) hasCache:(NSString *)named settings:(NSDictionary *)settings;
 
 /*!
  *					Loads and parse a NGL Binary file from a local path.
  *
- *					Based on a path to an original 3D file, this method will search for a NGL Binary file
- *					and compare both files. If the NGL Binary file is newer than the original one, it will
- *					be loaded and the property <code>#isCached#</code> will be turned to YES.
+ *					Based on a path to an original 3D file and its import settings, this method will search
+ *					for the cached NGL Binary file and load it.
  *
  *	@param			named
  *					In NinevehGL the "named" parameter is always related to the NinevehGL Path API, so you
@@ -160,15 +390,19 @@
  *					system. If only the file's name is informed, NinevehGL will search for the file at the
  *					global path.
  *
- *	@see			isCached
+ *	@param			settings
+ *					The import settings used to parse the original file. It can be nil.
+ *
+ *	@see			hasCache:settings:
  */
-- (void) decodeCache:(NSString *)named;
+- (void) decodeCache:(NSString *)named settings:(NSDictionary *)settings;
 
 /*!
  *					Saves a NGL Binary file based on a parsed mesh.
  *
- *					Based on a path to an original 3D file, this method will create and save a NGL Binary
- *					File.
+ *					Based on a path to an original 3D file and its import settings, this method will create
+ *					and save a NGL Binary File. If the cache exceeds the disk budget after saving, the least
+ *					recently used files are deleted.
  *
  *	@param			mesh
  *					A #NGLParserMesh# containing a parsed file.
@@ -178,7 +412,23 @@
  *					can inform the only the file's name or full path. The full path is related to the file
  *					system. If only the file's name is informed, NinevehGL will search for the file at the
  *					global path.
+ *
+ *	@param			settings
+ *					The import settings used to parse the original file. It can be nil.
+ *
+ *	@see			nglGlobalCacheBudget
+ */
+- (void) encodeCache:(NGLParserMesh *)mesh withName:(NSString *)named settings:(NSDictionary *)settings;
+
+/*!
+ *					Saves a NGL Binary file based on a parsed mesh at any path, out of the cache.
+ *
+ *	@param			mesh
+ *					A #NGLParserMesh# containing a parsed file.
+ *
+ *	@param			fullPath
+ *					The full path to the new NGL Binary file.
  */
-- (void) encodeCache:(NGLParserMesh *)mesh withName:(NSString *)named;
+- (void) encodeFile:(NGLParserMesh *)mesh path:(NSString *)fullPath;
 
 @end
@@ -21,6 +21,7 @@
  */
 
 #import "NGLParserNGL.h"
+#import "NGLGlobal.h"
 
 #pragma mark -
 #pragma mark Constants
@@ -32,12 +33,43 @@
 //**********************************************************************************************************
 
 // Current NGL Binary file version.
-#define NGL_FILE_VERSION		1.1f
+#define NGL_FILE_VERSION		2.0f
+
+// Oldest NGL Binary file version still supported. It has no sections, so its arrays are always copied.
+#define NGL_FILE_VERSION_1		1.1f
+
+// Alignment of each section in the NGL Binary file, in bytes.
+#define NGL_SECTION_ALIGN		16
 
 static NSString *const NGL_EXTENSION = @"ngl";
 
 static NSString *const NGL_FOLDER = @"NinevehGL";
 
+// The cache index, inside the NGL folder, and its keys.
+static NSString *const NGL_CACHE_INDEX = @"index.plist";
+static NSString *const NGL_CACHE_ENTRIES = @"entries";
+static NSString *const NGL_CACHE_SOURCES = @"sources";
+static NSString *const NGL_CACHE_LENGTH = @"length";
+static NSString *const NGL_CACHE_ACCESS = @"access";
+static NSString *const NGL_CACHE_SIZE = @"size";
+static NSString *const NGL_CACHE_DATE = @"date";
+static NSString *const NGL_CACHE_HASH = @"hash";
+
+// The import settings that don't change the cached bytes, they are not hashed. The same values of
+// kNGLMeshKeyOriginal, which chooses the file, kNGLMeshKeyDynamic, which only changes the buffers,
+// and kNGLMeshKeyFormat, whose vertices are packed when they are uploaded.
+static NSString *const NGL_CACHE_IGNORED_ORIGINAL = @"useOriginal";
+static NSString *const NGL_CACHE_IGNORED_DYNAMIC = @"dynamic";
+static NSString *const NGL_CACHE_IGNORED_FORMAT = @"format";
+
+// Revision of the parsed meshes. It changes when the parsers generate another mesh from the same file,
+// so the files cached by older revisions are not used anymore.
+static NSString *const NGL_CACHE_REVISION = @"revision=6;";
+
+// FNV-1a 64 bits parameters, used to hash the original files and the import settings.
+#define NGL_HASH_SEED			14695981039346656037ull
+#define NGL_HASH_PRIME			1099511628211ull
+
 static NSString *const NGL_ERROR_HEADER = @"Error while processing NGLParserNGL with file \"%@\".";
 
 static NSString *const NGL_ERROR_NOT_FOUND = @"NinevehGL binary file was not found in the path.\n\
@@ -51,6 +83,10 @@ Please, clear your cache files by following the instructions:\n\
 - On the device: Delete the APP.\n\
 - On the simulator: Delete ~/Library/Application Support/iPhone Simulator/<iOS version>/Applications/*.*";
 
+static NSString *const NGL_ERROR_CORRUPTED = @"The NinevehGL binary file is corrupted.\n\
+One of its sections lies outside the file or doesn't match the mesh structure.\n\
+Delete the NGL binary file to generate a new one from the original 3D file.";
+
 #pragma mark -
 #pragma mark Private Interface
 #pragma mark -
@@ -130,9 +166,713 @@ typedef struct
 	UInt32	lengthData;
 } NGLSurfaceBody;
 
+// NGL Binary section identifier structure.
+typedef enum
+{
+	NGLSectionElements		= 0x01,
+	NGLSectionMesh			= 0x02,
+	NGLSectionIndices		= 0x03,
+	NGLSectionStructures	= 0x04,
+	NGLSectionMaterials		= 0x05,
+	NGLSectionSurfaces		= 0x06,
+	NGLSectionIndicesCodec	= 0x07,
+	NGLSectionStructuresCodec	= 0x08,
+	NGLSectionLevels		= 0x09,
+	NGLSectionClusters		= 0x0A,
+	NGLSectionWindows		= 0x0B,
+	NGLSectionJoints		= 0x0C,
+} NGLSectionType;
+
+// Number of sections written to a file and the greatest section type known by this version.
+#define NGL_SECTIONS_COUNT		10
+#define NGL_SECTIONS_MAX		12
+
+// NGL Binary levels of detail structure, followed by the NGLLevel ranges and the levels' indices.
+// 8 bytes: 2 UInt32.
+typedef struct
+{
+	UInt32	levelsCount;
+	UInt32	lodCount;
+} NGLLevelsBody;
+
+// NGL Binary header structure.
+// 16 bytes: 1 float + 3 UInt32.
+typedef struct
+{
+	float	version;
+	UInt32	sectionsCount;
+	UInt32	length;
+	UInt32	reserved;
+} NGLHeaderBody;
+
+// NGL Binary section structure.
+// 16 bytes: 4 UInt32.
+typedef struct
+{
+	UInt32	type;
+	UInt32	offset;
+	UInt32	length;
+	UInt32	reserved;
+} NGLSectionBody;
+
+// Compressed element encodings in the NGL Binary file.
+typedef enum
+{
+	NGLCodecRaw				= 0x00,
+	NGLCodecQuantized		= 0x01,
+	NGLCodecOctahedral		= 0x02,
+} NGLCodecType;
+
+// Compressed element structure.
+// 4 bytes: 4 UInt8.
+typedef struct
+{
+	UInt8	type;
+	UInt8	start;
+	UInt8	length;
+	UInt8	reserved;
+} NGLCodecBody;
+
+// Compressed structures header.
+// 8 bytes: 2 UInt32.
+typedef struct
+{
+	UInt32	vertices;
+	UInt32	elements;
+} NGLCodecHeader;
+
+// Vectors of 4 lanes, mapped by the compiler to NEON (or SSE on the simulator).
+typedef float	NGLCodecFloat4 __attribute__((vector_size(16)));
+typedef int		NGLCodecInt4 __attribute__((vector_size(16)));
+typedef UInt16	NGLCodecUShort4 __attribute__((vector_size(8)));
+typedef SInt16	NGLCodecShort4 __attribute__((vector_size(8)));
+
 // Full path to the NinevehGL binary folder in the Library directory.
 static NSString		*_nglPath;
 
+// The cache index. Maps each cache key to its entry (length and last access) and each original file
+// to the hash of its content. Every access to the index must be done with the mutex locked.
+static NSMutableDictionary	*_cacheEntries = nil;
+static NSMutableDictionary	*_cacheSources = nil;
+static BOOL					_cacheChanged = NO;
+static NGLCacheStats		_cacheStats;
+static pthread_mutex_t		_cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+#pragma mark -
+#pragma mark Private Functions
+//**************************************************
+//	Private Functions
+//**************************************************
+
+// Creates the NinevehGL binary folder once.
+static NSString *binaryFolder(void)
+{
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		// Create the full path to NinevehGL binary folder.
+		NSArray *doc = NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES);
+		_nglPath = [[[doc objectAtIndex:0] stringByAppendingPathComponent:NGL_FOLDER] copy];
+		
+		// Create the folder with default configurations. This method automatically skips if the
+		// folder already exist.
+		[[NSFileManager defaultManager] createDirectoryAtPath:_nglPath
+								  withIntermediateDirectories:YES
+												   attributes:nil
+														error:nil];
+	});
+	
+	return _nglPath;
+}
+
+// FNV-1a hash, it can be chained by passing the previous hash.
+static UInt64 cacheHash(const void *bytes, NSUInteger length, UInt64 hash)
+{
+	const UInt8 *data = bytes;
+	NSUInteger i;
+	
+	for (i = 0; i < length; ++i)
+	{
+		hash = (hash ^ data[i]) * NGL_HASH_PRIME;
+	}
+	
+	return hash;
+}
+
+// Hashes the import settings, independent of the keys order, and the revision of the parsed meshes.
+// The settings that don't change the cached bytes are ignored, so they share the same cached file.
+static UInt64 cacheSettingsHash(NSDictionary *settings)
+{
+	NSArray *keys = [[settings allKeys] sortedArrayUsingSelector:@selector(compare:)];
+	NSMutableString *string = [NSMutableString stringWithString:NGL_CACHE_REVISION];
+	NSString *key;
+	const char *utf8;
+	
+	for (key in keys)
+	{
+		if ([key isEqualToString:NGL_CACHE_IGNORED_ORIGINAL] ||
+			[key isEqualToString:NGL_CACHE_IGNORED_DYNAMIC] ||
+			[key isEqualToString:NGL_CACHE_IGNORED_FORMAT])
+		{
+			continue;
+		}
+		
+		[string appendFormat:@"%@=%@;", key, [settings objectForKey:key]];
+	}
+	
+	utf8 = [string UTF8String];
+	
+	return cacheHash(utf8, strlen(utf8), NGL_HASH_SEED);
+}
+
+// Full path to a cached file.
+static NSString *cacheFile(NSString *key)
+{
+	return [binaryFolder() stringByAppendingPathComponent:[key stringByAppendingPathExtension:NGL_EXTENSION]];
+}
+
+// Saves the index, if it has changed. The mutex must be locked.
+static void cacheSave(void)
+{
+	NSDictionary *index;
+	
+	if (_cacheChanged)
+	{
+		index = [NSDictionary dictionaryWithObjectsAndKeys:_cacheEntries, NGL_CACHE_ENTRIES,
+				 _cacheSources, NGL_CACHE_SOURCES, nil];
+		[index writeToFile:[binaryFolder() stringByAppendingPathComponent:NGL_CACHE_INDEX] atomically:YES];
+		_cacheChanged = NO;
+	}
+}
+
+// Updates the last access of an entry. The mutex must be locked.
+static void cacheTouch(NSString *key, NSNumber *length)
+{
+	NSNumber *access = [NSNumber numberWithDouble:[NSDate timeIntervalSinceReferenceDate]];
+	
+	[_cacheEntries setObject:[NSDictionary dictionaryWithObjectsAndKeys:length, NGL_CACHE_LENGTH,
+							  access, NGL_CACHE_ACCESS, nil] forKey:key];
+	_cacheChanged = YES;
+}
+
+// Checks if a file out of the index is a valid cached file: named by a cache key and starting with a
+// version 2.0 header that matches its length. Returns its length or nil if it's not valid.
+static NSNumber *cacheRecover(NSString *file)
+{
+	NSString *key = [file stringByDeletingPathExtension];
+	NSCharacterSet *digits = [NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdef"];
+	NSFileHandle *handle;
+	NSData *data;
+	NSNumber *size;
+	NGLHeaderBody header;
+	
+	if ([key length] != 32 ||
+		[key rangeOfCharacterFromSet:[digits invertedSet]].location != NSNotFound)
+	{
+		return nil;
+	}
+	
+	handle = [NSFileHandle fileHandleForReadingAtPath:cacheFile(key)];
+	data = [handle readDataOfLength:sizeof(NGLHeaderBody)];
+	[handle closeFile];
+	
+	if ([data length] != sizeof(NGLHeaderBody))
+	{
+		return nil;
+	}
+	
+	[data getBytes:&header length:sizeof(NGLHeaderBody)];
+	size = [[[NSFileManager defaultManager] attributesOfItemAtPath:cacheFile(key) error:nil]
+			objectForKey:NSFileSize];
+	
+	if (header.version != NGL_FILE_VERSION || header.length != [size unsignedLongLongValue])
+	{
+		return nil;
+	}
+	
+	return size;
+}
+
+// Loads the index once. The mutex must be locked.
+static void cacheLoad(void)
+{
+	NSFileManager *manager;
+	NSDictionary *index;
+	NSString *file, *key;
+	NSNumber *length;
+	
+	if (_cacheEntries != nil)
+	{
+		return;
+	}
+	
+	manager = [NSFileManager defaultManager];
+	index = [NSDictionary dictionaryWithContentsOfFile:[binaryFolder() stringByAppendingPathComponent:NGL_CACHE_INDEX]];
+	_cacheEntries = [[NSMutableDictionary alloc] initWithDictionary:[index objectForKey:NGL_CACHE_ENTRIES]];
+	_cacheSources = [[NSMutableDictionary alloc] initWithDictionary:[index objectForKey:NGL_CACHE_SOURCES]];
+	
+	// A lost or corrupted index doesn't lose the cache, the valid files out of the index are indexed again.
+	// The others, including the old versions and the caches named by them, are deleted to be rebuilt.
+	for (file in [manager contentsOfDirectoryAtPath:binaryFolder() error:nil])
+	{
+		key = [file stringByDeletingPathExtension];
+		
+		if (![[file pathExtension] isEqualToString:NGL_EXTENSION] || [_cacheEntries objectForKey:key] != nil)
+		{
+			continue;
+		}
+		
+		if ((length = cacheRecover(file)) != nil)
+		{
+			cacheTouch(key, length);
+		}
+		else
+		{
+			[manager removeItemAtPath:[binaryFolder() stringByAppendingPathComponent:file] error:nil];
+		}
+	}
+	
+	// Forgets the entries without files and the original files that don't exist anymore.
+	for (key in [_cacheEntries allKeys])
+	{
+		if (![manager fileExistsAtPath:cacheFile(key)])
+		{
+			[_cacheEntries removeObjectForKey:key];
+			_cacheChanged = YES;
+		}
+	}
+	
+	for (key in [_cacheSources allKeys])
+	{
+		if (![manager fileExistsAtPath:key])
+		{
+			[_cacheSources removeObjectForKey:key];
+			_cacheChanged = YES;
+		}
+	}
+}
+
+// Deletes the least recently used files until the cache fits in the budget. The mutex must be locked.
+static void cacheTrim(NSString *keep)
+{
+	NSDictionary *entry;
+	NSString *key;
+	NSArray *keys;
+	UInt64 total = 0;
+	
+	for (entry in [_cacheEntries objectEnumerator])
+	{
+		total += [[entry objectForKey:NGL_CACHE_LENGTH] unsignedLongLongValue];
+	}
+	
+	if (nglDefaultCacheBudget == 0 || total <= nglDefaultCacheBudget)
+	{
+		return;
+	}
+	
+	keys = [_cacheEntries keysSortedByValueUsingComparator:^NSComparisonResult(id a, id b)
+	{
+		return [[a objectForKey:NGL_CACHE_ACCESS] compare:[b objectForKey:NGL_CACHE_ACCESS]];
+	}];
+	
+	for (key in keys)
+	{
+		if (total <= nglDefaultCacheBudget)
+		{
+			break;
+		}
+		
+		// The file just saved is never evicted by itself.
+		if ([key isEqualToString:keep])
+		{
+			continue;
+		}
+		
+		total -= [[[_cacheEntries objectForKey:key] objectForKey:NGL_CACHE_LENGTH] unsignedLongLongValue];
+		[[NSFileManager defaultManager] removeItemAtPath:cacheFile(key) error:nil];
+		[_cacheEntries removeObjectForKey:key];
+		_cacheChanged = YES;
+		++_cacheStats.evictions;
+	}
+}
+
+// Generates the cache key to an original file: the hash of its content plus the hash of the settings.
+// The content is only hashed again when the file's size or modification date change.
+// Returns nil if the original file doesn't exist.
+static NSString *cacheKey(NSString *named, NSDictionary *settings)
+{
+	NSString *fullPath = nglMakePath(named);
+	NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:fullPath error:nil];
+	NSDictionary *source;
+	NSNumber *size, *date;
+	NSString *hash = nil;
+	NSData *data;
+	
+	if (attributes == nil)
+	{
+		return nil;
+	}
+	
+	size = [attributes objectForKey:NSFileSize];
+	date = [NSNumber numberWithDouble:[[attributes objectForKey:NSFileModificationDate]
+									   timeIntervalSinceReferenceDate]];
+	
+	pthread_mutex_lock(&_cacheMutex);
+	
+	cacheLoad();
+	source = [_cacheSources objectForKey:fullPath];
+	
+	if ([[source objectForKey:NGL_CACHE_SIZE] isEqualToNumber:size] &&
+		[[source objectForKey:NGL_CACHE_DATE] isEqualToNumber:date])
+	{
+		hash = [[[source objectForKey:NGL_CACHE_HASH] retain] autorelease];
+	}
+	
+	pthread_mutex_unlock(&_cacheMutex);
+	
+	// Hashes the content out of the lock, other threads can use the cache meanwhile.
+	if (hash == nil)
+	{
+		data = nglMappedDataFromFile(fullPath);
+		hash = [NSString stringWithFormat:@"%016llx", cacheHash([data bytes], [data length], NGL_HASH_SEED)];
+		source = [NSDictionary dictionaryWithObjectsAndKeys:size, NGL_CACHE_SIZE, date, NGL_CACHE_DATE,
+				  hash, NGL_CACHE_HASH, nil];
+		
+		pthread_mutex_lock(&_cacheMutex);
+		[_cacheSources setObject:source forKey:fullPath];
+		_cacheChanged = YES;
+		pthread_mutex_unlock(&_cacheMutex);
+	}
+	
+	return [hash stringByAppendingFormat:@"%016llx", cacheSettingsHash(settings)];
+}
+
+// Rounds an offset up to the next section alignment.
+static NSUInteger binaryAlign(NSUInteger offset)
+{
+	return (offset + (NGL_SECTION_ALIGN - 1)) & ~(NSUInteger)(NGL_SECTION_ALIGN - 1);
+}
+
+// Rounds a size up to the next multiple of 4 bytes, keeping the compressed blocks aligned.
+static UInt32 codecAlign4(UInt32 size)
+{
+	return (size + 3) & ~3u;
+}
+
+// Returns the size in bytes of a compressed element, without its header.
+static UInt32 codecSize(const NGLCodecBody *body, UInt32 vertices)
+{
+	switch (body->type)
+	{
+		case NGLCodecQuantized:
+			return body->length * 2 * NGL_SIZE_FLOAT + codecAlign4(body->length * vertices * NGL_SIZE_USHORT);
+		case NGLCodecOctahedral:
+			return 2 * vertices * NGL_SIZE_USHORT;
+		default:
+			return body->length * vertices * NGL_SIZE_FLOAT;
+	}
+}
+
+// Maps a float in the range [-1.0, 1.0] to a signed 16 bits value.
+static SInt16 codecSnorm(float value)
+{
+	value = (value < -1.0f) ? -1.0f : ((value > 1.0f) ? 1.0f : value);
+	return (SInt16)lrintf(value * 32767.0f);
+}
+
+// Decodes a single octahedral value. The same math of the vectorized kernel.
+static NGLvec3 codecOctDecode(SInt16 u, SInt16 v)
+{
+	NGLvec3 n;
+	float t, length;
+	
+	n.x = u * (1.0f / 32767.0f);
+	n.y = v * (1.0f / 32767.0f);
+	n.z = 1.0f - fabsf(n.x) - fabsf(n.y);
+	t = (n.z < 0.0f) ? -n.z : 0.0f;
+	n.x += (n.x >= 0.0f) ? -t : t;
+	n.y += (n.y >= 0.0f) ? -t : t;
+	
+	length = 1.0f / sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+	
+	return (NGLvec3){n.x * length, n.y * length, n.z * length};
+}
+
+// Encodes an unit vector with the octahedral mapping. The 4 nearest 16 bits values are tested,
+// keeping the one with the smallest error after decoding.
+static void codecOctEncode(const float *vector, SInt16 *u, SInt16 *v)
+{
+	float x = vector[0], y = vector[1], z = vector[2];
+	float l1 = fabsf(x) + fabsf(y) + fabsf(z);
+	float px, py, ox, oy, nx, ny, nz, error, best = 8.0f;
+	SInt16 cu, cv;
+	NGLvec3 n;
+	int i;
+	
+	// Degenerated vectors are stored as the +Z axis.
+	if (l1 == 0.0f)
+	{
+		*u = 0;
+		*v = 0;
+		return;
+	}
+	
+	// The unit vector, to measure the error of each candidate.
+	error = 1.0f / sqrtf(x * x + y * y + z * z);
+	nx = x * error;
+	ny = y * error;
+	nz = z * error;
+	
+	px = x / l1;
+	py = y / l1;
+	
+	// Folds the lower hemisphere over the upper one.
+	if (z < 0.0f)
+	{
+		ox = (1.0f - fabsf(py)) * ((px >= 0.0f) ? 1.0f : -1.0f);
+		oy = (1.0f - fabsf(px)) * ((py >= 0.0f) ? 1.0f : -1.0f);
+		px = ox;
+		py = oy;
+	}
+	
+	for (i = 0; i < 4; ++i)
+	{
+		cu = codecSnorm(((i & 1) ? ceilf(px * 32767.0f) : floorf(px * 32767.0f)) / 32767.0f);
+		cv = codecSnorm(((i & 2) ? ceilf(py * 32767.0f) : floorf(py * 32767.0f)) / 32767.0f);
+		n = codecOctDecode(cu, cv);
+		
+		// The best candidate is the closest one to the original unit vector.
+		error = (n.x - nx) * (n.x - nx) + (n.y - ny) * (n.y - ny) + (n.z - nz) * (n.z - nz);
+		if (error < best)
+		{
+			best = error;
+			*u = cu;
+			*v = cv;
+		}
+	}
+}
+
+// Encodes one element of the array of structures into a compressed block.
+static void codecEncode(const NGLCodecBody *body, const float *structures, UInt32 stride,
+						UInt32 vertices, UInt8 *out)
+{
+	UInt32 i, c, length = body->length;
+	const float *in = structures + body->start;
+	float min[4], max[4], scale[4], value;
+	UInt16 *plane;
+	SInt16 *planeU, *planeV;
+	
+	switch (body->type)
+	{
+		case NGLCodecQuantized:
+			// Finds the bounds of each component.
+			for (c = 0; c < length; ++c)
+			{
+				min[c] = (vertices > 0) ? in[c] : 0.0f;
+				max[c] = min[c];
+			}
+			
+			for (i = 0; i < vertices; ++i)
+			{
+				for (c = 0; c < length; ++c)
+				{
+					value = in[i * stride + c];
+					min[c] = (value < min[c]) ? value : min[c];
+					max[c] = (value > max[c]) ? value : max[c];
+				}
+			}
+			
+			for (c = 0; c < length; ++c)
+			{
+				scale[c] = (max[c] - min[c]) / 65535.0f;
+			}
+			
+			memcpy(out, min, length * NGL_SIZE_FLOAT);
+			memcpy(out + length * NGL_SIZE_FLOAT, scale, length * NGL_SIZE_FLOAT);
+			plane = (UInt16 *)(out + length * 2 * NGL_SIZE_FLOAT);
+			
+			// Each component is stored in its own plane, so the decoder reads 4 values at once.
+			for (c = 0; c < length; ++c)
+			{
+				for (i = 0; i < vertices; ++i)
+				{
+					value = (scale[c] > 0.0f) ? (in[i * stride + c] - min[c]) / scale[c] : 0.0f;
+					value = (value > 65535.0f) ? 65535.0f : value;
+					plane[c * vertices + i] = (UInt16)lrintf(value);
+				}
+			}
+			break;
+		case NGLCodecOctahedral:
+			planeU = (SInt16 *)out;
+			planeV = planeU + vertices;
+			
+			for (i = 0; i < vertices; ++i)
+			{
+				codecOctEncode(in + i * stride, &planeU[i], &planeV[i]);
+			}
+			break;
+		default:
+			for (i = 0; i < vertices; ++i)
+			{
+				memcpy(out + i * length * NGL_SIZE_FLOAT, in + i * stride, length * NGL_SIZE_FLOAT);
+			}
+			break;
+	}
+}
+
+// Decodes one compressed block straight into the interleaved array of structures.
+// Groups of 4 vertices are processed with vector instructions, the remaining ones one by one.
+static void codecDecode(const NGLCodecBody *body, const UInt8 *in, float *structures, UInt32 stride,
+						UInt32 vertices)
+{
+	UInt32 i, c, k, length = body->length;
+	UInt32 groups = vertices & ~3u;
+	float *out = structures + body->start;
+	float min[4], scale[4];
+	const UInt16 *plane;
+	const SInt16 *planeU, *planeV;
+	NGLCodecUShort4 q;
+	NGLCodecShort4 su, sv;
+	NGLCodecFloat4 value, x, y, z, t, squared;
+	NGLCodecInt4 mask;
+	NGLvec3 n;
+	
+	switch (body->type)
+	{
+		case NGLCodecQuantized:
+			memcpy(min, in, length * NGL_SIZE_FLOAT);
+			memcpy(scale, in + length * NGL_SIZE_FLOAT, length * NGL_SIZE_FLOAT);
+			plane = (const UInt16 *)(in + length * 2 * NGL_SIZE_FLOAT);
+			
+			for (i = 0; i < groups; i += 4)
+			{
+				for (c = 0; c < length; ++c)
+				{
+					memcpy(&q, plane + c * vertices + i, sizeof(q));
+					value = __builtin_convertvector(q, NGLCodecFloat4) * scale[c] + min[c];
+					
+					for (k = 0; k < 4; ++k)
+					{
+						out[(i + k) * stride + c] = value[k];
+					}
+				}
+			}
+			
+			for (; i < vertices; ++i)
+			{
+				for (c = 0; c < length; ++c)
+				{
+					out[i * stride + c] = plane[c * vertices + i] * scale[c] + min[c];
+				}
+			}
+			break;
+		case NGLCodecOctahedral:
+			planeU = (const SInt16 *)in;
+			planeV = planeU + vertices;
+			
+			for (i = 0; i < groups; i += 4)
+			{
+				memcpy(&su, planeU + i, sizeof(su));
+				memcpy(&sv, planeV + i, sizeof(sv));
+				
+				x = __builtin_convertvector(su, NGLCodecFloat4) * (1.0f / 32767.0f);
+				y = __builtin_convertvector(sv, NGLCodecFloat4) * (1.0f / 32767.0f);
+				
+				// z = 1 - |x| - |y|, the absolute values just clear the sign bits.
+				z = 1.0f - (NGLCodecFloat4)((NGLCodecInt4)x & 0x7FFFFFFF) -
+					(NGLCodecFloat4)((NGLCodecInt4)y & 0x7FFFFFFF);
+				
+				// t = max(-z, 0), unfolding the lower hemisphere.
+				mask = (-z > 0.0f);
+				t = (NGLCodecFloat4)((NGLCodecInt4)-z & mask);
+				
+				// x += (x >= 0) ? -t : t, the comparison results in -1 for true.
+				x += t * (__builtin_convertvector((x >= 0.0f), NGLCodecFloat4) * 2.0f + 1.0f);
+				y += t * (__builtin_convertvector((y >= 0.0f), NGLCodecFloat4) * 2.0f + 1.0f);
+				
+				squared = x * x + y * y + z * z;
+				
+				for (k = 0; k < 4; ++k)
+				{
+					t[k] = 1.0f / sqrtf(squared[k]);
+					out[(i + k) * stride] = x[k] * t[k];
+					out[(i + k) * stride + 1] = y[k] * t[k];
+					out[(i + k) * stride + 2] = z[k] * t[k];
+				}
+			}
+			
+			for (; i < vertices; ++i)
+			{
+				n = codecOctDecode(planeU[i], planeV[i]);
+				out[i * stride] = n.x;
+				out[i * stride + 1] = n.y;
+				out[i * stride + 2] = n.z;
+			}
+			break;
+		default:
+			for (i = 0; i < vertices; ++i)
+			{
+				memcpy(out + i * stride, in + i * length * NGL_SIZE_FLOAT, length * NGL_SIZE_FLOAT);
+			}
+			break;
+	}
+}
+
+// Writes an unsigned value as a variable length integer, 7 bits per byte.
+static UInt8 *codecPutVarint(UInt8 *out, UInt32 value)
+{
+	while (value >= 0x80)
+	{
+		*out++ = (UInt8)(value | 0x80);
+		value >>= 7;
+	}
+	
+	*out++ = (UInt8)value;
+	
+	return out;
+}
+
+// Reads a variable length integer. Returns NULL if the value exceeds the bytes.
+static const UInt8 *codecGetVarint(const UInt8 *bytes, const UInt8 *end, UInt32 *value)
+{
+	UInt32 result = 0;
+	UInt32 shift = 0;
+	
+	while (bytes < end && shift < 35)
+	{
+		result |= (UInt32)(*bytes & 0x7F) << shift;
+		
+		if (!(*bytes++ & 0x80))
+		{
+			*value = result;
+			return bytes;
+		}
+		
+		shift += 7;
+	}
+	
+	return NULL;
+}
+
+// Encodes the array of indices as zigzag deltas in variable length integers.
+// The output must have room to 5 bytes per index. Returns the number of bytes written.
+static UInt32 codecEncodeIndices(const UInt32 *indices, UInt32 count, UInt8 *out)
+{
+	UInt8 *cursor = out;
+	UInt32 i, previous = 0;
+	SInt32 delta;
+	
+	for (i = 0; i < count; ++i)
+	{
+		// Indices are mostly close to the previous ones, so the deltas are small numbers.
+		delta = (SInt32)(indices[i] - previous);
+		previous = indices[i];
+		
+		cursor = codecPutVarint(cursor, ((UInt32)delta << 1) ^ (UInt32)(delta >> 31));
+	}
+	
+	return (UInt32)(cursor - out);
+}
+
 #pragma mark -
 #pragma mark Private Category
 //**************************************************
@@ -147,22 +887,281 @@ static NSString		*_nglPath;
 // Increments and returns a new locator/pointer to work on the bit stream.
 - (NSRange) rangeUntil:(UInt32)length;
 
+// Checks if a length can be read from the current locator without passing the end.
+- (BOOL) canRead:(UInt64)length until:(UInt32)end;
+
 // Extracts the data from a NGL Binary file.
 - (void) extractDataFromFile:(NSString *)fullPath;
 
+// Extracts a NGL Binary file version 1.1, copying its arrays. Returns NO if the file is corrupted.
+- (BOOL) extractVersion1:(NSData *)data;
+
+// Extracts a NGL Binary file version 2.0, pointing its arrays directly into the mapped data.
+- (BOOL) extractVersion2:(NSData *)data;
+
+// Extracts the mesh elements, materials and surfaces from the current locator, none of them passes
+// the length. Returns NO if they don't fit in the length or don't match the mesh.
+- (BOOL) extractElements:(NSData *)data length:(UInt32)length;
+- (BOOL) extractMaterials:(NSData *)data length:(UInt32)length;
+- (BOOL) extractSurfaces:(NSData *)data length:(UInt32)length;
+
+// Checks the mesh elements against the stride.
+- (BOOL) checkElements;
+
+// Extracts the levels of detail from the current locator. Returns NO if they don't match the mesh.
+- (BOOL) extractLevels:(NSData *)data length:(UInt32)length;
+
+// Extracts the clusters from the current locator. Returns NO if they don't match the mesh.
+- (BOOL) extractClusters:(NSData *)data length:(UInt32)length;
+
+// Extracts the windows from the current locator. Returns NO if they don't match the mesh.
+- (BOOL) extractWindows:(NSData *)data length:(UInt32)length;
+
+// Extracts the skeleton from the current locator. Returns NO if it's not a valid skeleton.
+- (BOOL) extractJoints:(NSData *)data length:(UInt32)length;
+
 // Creates and saves a NGL Binary file.
 - (void) compressData:(NGLParserMesh *)parse file:(NSString *)fullPath;
 
-@end
+// Creates the streams of mesh elements, materials and surfaces.
+- (NSData *) compressElements:(NGLParserMesh *)parse;
+- (NSData *) compressMaterials:(NGLParserMesh *)parse;
+- (NSData *) compressSurfaces:(NGLParserMesh *)parse;
+- (NSData *) compressLevels:(NGLParserMesh *)parse;
+- (NSData *) compressClusters:(NGLParserMesh *)parse;
+- (NSData *) compressWindows:(NGLParserMesh *)parse;
+- (NSData *) compressJoints:(NGLParserMesh *)parse;
+
+@end
+
+#pragma mark -
+#pragma mark Public Interface
+#pragma mark -
+//**********************************************************************************************************
+//
+//	Public Interface
+//
+//**********************************************************************************************************
+
+NGLCacheStats nglCacheStats(void)
+{
+	NGLCacheStats stats;
+	NSDictionary *entry;
+	
+	pthread_mutex_lock(&_cacheMutex);
+	
+	cacheLoad();
+	_cacheStats.entries = (UInt32)[_cacheEntries count];
+	_cacheStats.bytes = 0;
+	
+	for (entry in [_cacheEntries objectEnumerator])
+	{
+		_cacheStats.bytes += [[entry objectForKey:NGL_CACHE_LENGTH] unsignedLongLongValue];
+	}
+	
+	stats = _cacheStats;
+	
+	pthread_mutex_unlock(&_cacheMutex);
+	
+	return stats;
+}
+
+void nglCacheClear(void)
+{
+	NSString *key;
+	
+	pthread_mutex_lock(&_cacheMutex);
+	
+	cacheLoad();
+	
+	for (key in _cacheEntries)
+	{
+		[[NSFileManager defaultManager] removeItemAtPath:cacheFile(key) error:nil];
+	}
+	
+	[_cacheEntries removeAllObjects];
+	[_cacheSources removeAllObjects];
+	memset(&_cacheStats, 0, sizeof(NGLCacheStats));
+	
+	_cacheChanged = YES;
+	cacheSave();
+	
+	pthread_mutex_unlock(&_cacheMutex);
+}
+
+NSString *nglCacheName(NSString *named, NSDictionary *settings)
+{
+	NSString *key = cacheKey(named, settings);
+	
+	return (key != nil) ? [key stringByAppendingPathExtension:NGL_EXTENSION] : nil;
+}
+
+UInt32 nglCacheImport(NSString *folder)
+{
+	NSFileManager *manager = [NSFileManager defaultManager];
+	NSDictionary *attributes;
+	NSString *file, *key, *fullPath;
+	UInt32 count = 0;
+	
+	pthread_mutex_lock(&_cacheMutex);
+	
+	cacheLoad();
+	
+	for (file in [manager contentsOfDirectoryAtPath:folder error:nil])
+	{
+		key = [file stringByDeletingPathExtension];
+		fullPath = [folder stringByAppendingPathComponent:file];
+		
+		if (![[file pathExtension] isEqualToString:NGL_EXTENSION] || [_cacheEntries objectForKey:key] != nil)
+		{
+			continue;
+		}
+		
+		if ([manager copyItemAtPath:fullPath toPath:cacheFile(key) error:nil])
+		{
+			attributes = [manager attributesOfItemAtPath:fullPath error:nil];
+			cacheTouch(key, [attributes objectForKey:NSFileSize]);
+			++count;
+		}
+	}
+	
+	cacheTrim(nil);
+	cacheSave();
+	
+	pthread_mutex_unlock(&_cacheMutex);
+	
+	return count;
+}
+
+NSData *nglCompressStructures(const float *structures, UInt32 count, UInt32 stride, NGLMeshElements *elements)
+{
+	NSMutableData *data = [NSMutableData data];
+	NGLCodecHeader header;
+	NGLCodecBody body;
+	NGLElement *element;
+	NSUInteger offset;
+	
+	header.vertices = (stride > 0) ? count / stride : 0;
+	header.elements = [elements count];
+	[data appendBytes:&header length:sizeof(NGLCodecHeader)];
+	
+	[elements resetIterator];
+	while ((element = [elements nextIterator]))
+	{
+		body.start = (*element).start;
+		body.length = (*element).length;
+		body.reserved = 0;
+		
+		// Chooses the encoding based on the component. Unknown components are kept as floats.
+		switch ((*element).component)
+		{
+			case NGLComponentVertex:
+			case NGLComponentTexcoord:
+				body.type = (body.length <= 4) ? NGLCodecQuantized : NGLCodecRaw;
+				break;
+			case NGLComponentNormal:
+			case NGLComponentTangent:
+			case NGLComponentBitangent:
+				body.type = (body.length == 3) ? NGLCodecOctahedral : NGLCodecRaw;
+				break;
+			default:
+				body.type = NGLCodecRaw;
+				break;
+		}
+		
+		[data appendBytes:&body length:sizeof(NGLCodecBody)];
+		
+		// Encodes the element directly into the stream.
+		offset = [data length];
+		[data increaseLengthBy:codecSize(&body, header.vertices)];
+		codecEncode(&body, structures, stride, header.vertices, (UInt8 *)[data mutableBytes] + offset);
+	}
+	
+	return data;
+}
+
+BOOL nglDecompressStructures(const void *data, UInt32 length, float *structures, UInt32 count, UInt32 stride)
+{
+	const UInt8 *bytes = data;
+	const UInt8 *end = bytes + length;
+	NGLCodecHeader header;
+	NGLCodecBody body;
+	UInt32 i, size;
+	
+	if (length < sizeof(NGLCodecHeader) || stride == 0 || count % stride != 0)
+	{
+		return NO;
+	}
+	
+	memcpy(&header, bytes, sizeof(NGLCodecHeader));
+	bytes += sizeof(NGLCodecHeader);
+	
+	if (header.vertices != count / stride)
+	{
+		return NO;
+	}
+	
+	for (i = 0; i < header.elements; ++i)
+	{
+		if ((UInt32)(end - bytes) < sizeof(NGLCodecBody))
+		{
+			return NO;
+		}
+		
+		memcpy(&body, bytes, sizeof(NGLCodecBody));
+		bytes += sizeof(NGLCodecBody);
+		
+		// Each element must fit in the structure and have a valid length to its encoding.
+		if (body.length == 0 || body.start + body.length > stride || body.type > NGLCodecOctahedral ||
+			(body.type == NGLCodecQuantized && body.length > 4) ||
+			(body.type == NGLCodecOctahedral && body.length != 3))
+		{
+			return NO;
+		}
+		
+		size = codecSize(&body, header.vertices);
+		
+		if ((UInt32)(end - bytes) < size)
+		{
+			return NO;
+		}
+		
+		codecDecode(&body, bytes, structures, stride, header.vertices);
+		bytes += size;
+	}
+	
+	return YES;
+}
+
+NSData *nglCompressIndices(const UInt32 *indices, UInt32 count)
+{
+	// Reserves the worst case, 5 bytes per index, then trims to the real length.
+	NSMutableData *data = [NSMutableData dataWithLength:count * 5];
+	
+	[data setLength:codecEncodeIndices(indices, count, [data mutableBytes])];
+	
+	return data;
+}
 
-#pragma mark -
-#pragma mark Public Interface
-#pragma mark -
-//**********************************************************************************************************
-//
-//	Public Interface
-//
-//**********************************************************************************************************
+BOOL nglDecompressIndices(const void *data, UInt32 length, UInt32 *indices, UInt32 count)
+{
+	const UInt8 *bytes = data;
+	const UInt8 *end = bytes + length;
+	UInt32 i, value, previous = 0;
+	
+	for (i = 0; i < count; ++i)
+	{
+		if ((bytes = codecGetVarint(bytes, end, &value)) == NULL)
+		{
+			return NO;
+		}
+		
+		previous += (value >> 1) ^ (0u - (value & 1));
+		indices[i] = previous;
+	}
+	
+	return YES;
+}
 
 @implementation NGLParserNGL
 
@@ -172,6 +1171,8 @@ static NSString		*_nglPath;
 //	Properties
 //**************************************************
 
+@synthesize compressed = _compressed;
+
 #pragma mark -
 #pragma mark Constructors
 //**************************************************
@@ -183,19 +1184,7 @@ static NSString		*_nglPath;
 	if ((self = [super init]))
 	{
 		// Allocate once.
-		if (_nglPath == nil)
-		{
-			// Create the full path to NinevehGL binary folder.
-			NSArray *doc = NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES);
-			_nglPath = [[[doc objectAtIndex:0] stringByAppendingPathComponent:NGL_FOLDER] copy];
-			
-			// Create the folder with default configurations. This method automatically skips if the
-			// folder already exist.
-			[[NSFileManager defaultManager] createDirectoryAtPath:_nglPath
-									  withIntermediateDirectories:YES
-													   attributes:nil
-															error:nil];
-		}
+		binaryFolder();
 	}
 	
 	return self;
@@ -231,14 +1220,30 @@ static NSString		*_nglPath;
 	return range;
 }
 
+- (BOOL) canRead:(UInt64)length until:(UInt32)end
+{
+	return (_rangeIndex <= end && length <= end - _rangeIndex);
+}
+
 - (void) extractDataFromFile:(NSString *)fullPath
 {
-	NSData *data = nglDataFromFile(fullPath);
-	UInt32 i, j;
+	// Maps the NGL binary file into the memory, the bytes are paged in on demand.
+	NSData *data = nglMappedDataFromFile(fullPath);
 	
 	// Resets the helpers.
 	[self resetRange];
 	
+	// Drops the arrays from any previous extraction. The mapped ones are not owned by this parser.
+	if (_mappedData == nil)
+	{
+		nglFree(_indices);
+		nglFree(_structures);
+	}
+	
+	_indices = NULL;
+	_structures = NULL;
+	nglRelease(_mappedData);
+	
 	// Gets the total data.
 	_totalData = [data length];
 	
@@ -246,33 +1251,292 @@ static NSString		*_nglPath;
 	//	Header
 	//*************************
 	
-	// File version.
-	float version;
-	
 	// Retrieves the NGL binary file version.
-	[data getBytes:&version range:[self rangeUntil:NGL_SIZE_FLOAT]];
+	_version = 0.0f;
+	if ([data length] >= NGL_SIZE_FLOAT)
+	{
+		[data getBytes:&_version length:NGL_SIZE_FLOAT];
+	}
 	
 	// Prevents incorrect bytes count.
-	if (version < NGL_FILE_VERSION)
+	if (_version < NGL_FILE_VERSION_1)
 	{
 		NSString *header = [NSString stringWithFormat:NGL_ERROR_HEADER, fullPath];
 		[NGLError errorInstantlyWithHeader:header andMessage:NGL_ERROR_OUTDATED];
 		return;
 	}
 	
+	// The old version has no sections and is read sequentially.
+	if ((_version < NGL_FILE_VERSION) ? ![self extractVersion1:data] : ![self extractVersion2:data])
+	{
+		NSString *header = [NSString stringWithFormat:NGL_ERROR_HEADER, fullPath];
+		[NGLError errorInstantlyWithHeader:header andMessage:NGL_ERROR_CORRUPTED];
+	}
+}
+
+- (BOOL) extractVersion1:(NSData *)data
+{
+	UInt32 length = (UInt32)[data length];
+	NGLMeshBody meshBody;
+	
+	// Skips the file version.
+	[self rangeUntil:NGL_SIZE_FLOAT];
+	
+	//*************************
+	//	Mesh structure
+	//*************************
+	
+	if (![self extractElements:data length:length - _rangeIndex] ||
+		![self canRead:sizeof(NGLMeshBody) until:length])
+	{
+		return NO;
+	}
+	
+	// Retrieves the mesh properties.
+	[data getBytes:&meshBody range:[self rangeUntil:sizeof(NGLMeshBody)]];
+	
+	// Checks the arrays against the file length.
+	if (meshBody.stride == 0 ||
+		![self canRead:(UInt64)meshBody.indicesCount * NGL_SIZE_UINT +
+		 (UInt64)meshBody.structuresCount * NGL_SIZE_FLOAT until:length])
+	{
+		return NO;
+	}
+	
+	// Constructs the parsed properties.
+	_iCount = meshBody.indicesCount;
+	_sCount = meshBody.structuresCount;
+	_stride = meshBody.stride;
+	
+	if (![self checkElements])
+	{
+		return NO;
+	}
+	
+	// Prepare to retrieve the mesh's arrays.
+	_indices = realloc(_indices, _iCount * NGL_SIZE_UINT);
+	_structures = realloc(_structures, _sCount * NGL_SIZE_FLOAT);
+	
+	// Retrieves the mesh's arrays.
+	[data getBytes:_indices range:[self rangeUntil:_iCount * NGL_SIZE_UINT]];
+	[data getBytes:_structures range:[self rangeUntil:_sCount * NGL_SIZE_FLOAT]];
+	
+	//*************************
+	//	Materials and Surfaces
+	//*************************
+	
+	if (![self extractMaterials:data length:length - _rangeIndex])
+	{
+		return NO;
+	}
+	
+	return [self extractSurfaces:data length:length - _rangeIndex];
+}
+
+- (BOOL) extractVersion2:(NSData *)data
+{
+	const char *bytes = [data bytes];
+	UInt32 length = (UInt32)[data length];
+	UInt32 i, count;
+	NGLHeaderBody header;
+	NGLSectionBody section;
+	NGLSectionBody sections[NGL_SECTIONS_MAX + 1];
+	BOOL compressed;
+	NGLMeshBody meshBody;
+	
+	// Retrieves the header and checks if the whole section table is inside the file.
+	if (length < sizeof(NGLHeaderBody))
+	{
+		return NO;
+	}
+	
+	[data getBytes:&header range:[self rangeUntil:sizeof(NGLHeaderBody)]];
+	count = header.sectionsCount;
+	
+	if (header.length != length || count > (length - sizeof(NGLHeaderBody)) / sizeof(NGLSectionBody))
+	{
+		return NO;
+	}
+	
+	//*************************
+	//	Sections
+	//*************************
+	
+	// Unknown sections are ignored, so newer files can add sections without breaking this reader.
+	memset(sections, 0, sizeof(sections));
+	for (i = 0; i < count; ++i)
+	{
+		[data getBytes:&section range:[self rangeUntil:sizeof(NGLSectionBody)]];
+		
+		if (section.offset > length || section.length > length - section.offset)
+		{
+			return NO;
+		}
+		
+		if (section.type > 0 && section.type <= NGL_SECTIONS_MAX)
+		{
+			sections[section.type] = section;
+		}
+	}
+	
+	// The counted sections and the mesh properties are mandatory.
+	if (sections[NGLSectionElements].length < NGL_SIZE_UINT ||
+		sections[NGLSectionMaterials].length < NGL_SIZE_UINT ||
+		sections[NGLSectionSurfaces].length < NGL_SIZE_UINT ||
+		sections[NGLSectionMesh].length < sizeof(NGLMeshBody))
+	{
+		return NO;
+	}
+	
+	// Checks the mesh properties against the arrays sizes and alignments.
+	
+	memcpy(&meshBody, bytes + sections[NGLSectionMesh].offset, sizeof(NGLMeshBody));
+	
+	compressed = (sections[NGLSectionIndicesCodec].length > 0 && sections[NGLSectionStructuresCodec].length > 0);
+	
+	if (meshBody.stride == 0)
+	{
+		return NO;
+	}
+	
+	if (!compressed &&
+		(sections[NGLSectionIndices].length != (UInt64)meshBody.indicesCount * NGL_SIZE_UINT ||
+		 sections[NGLSectionStructures].length != (UInt64)meshBody.structuresCount * NGL_SIZE_FLOAT ||
+		 sections[NGLSectionIndices].offset % NGL_SECTION_ALIGN != 0 ||
+		 sections[NGLSectionStructures].offset % NGL_SECTION_ALIGN != 0))
+	{
+		return NO;
+	}
+	
 	//*************************
 	//	Mesh structure
 	//*************************
 	
+	// Constructs the parsed properties.
+	_iCount = meshBody.indicesCount;
+	_sCount = meshBody.structuresCount;
+	_stride = meshBody.stride;
+	
+	_rangeIndex = sections[NGLSectionElements].offset;
+	if (![self extractElements:data length:sections[NGLSectionElements].length] || ![self checkElements])
+	{
+		return NO;
+	}
+	
+	if (compressed)
+	{
+		// The compressed arrays are decoded into their own memory, the file is not kept mapped.
+		_indices = calloc(_iCount, NGL_SIZE_UINT);
+		_structures = calloc(_sCount, NGL_SIZE_FLOAT);
+		
+		if (!nglDecompressIndices(bytes + sections[NGLSectionIndicesCodec].offset,
+								  sections[NGLSectionIndicesCodec].length, _indices, _iCount) ||
+			!nglDecompressStructures(bytes + sections[NGLSectionStructuresCodec].offset,
+									 sections[NGLSectionStructuresCodec].length, _structures, _sCount, _stride))
+		{
+			return NO;
+		}
+	}
+	else
+	{
+		// The arrays are used straight from the mapped file, they are ready to be sent to OpenGL.
+		// The mapped data is retained to keep them alive.
+		_mappedData = [data retain];
+		_indices = (UInt32 *)(bytes + sections[NGLSectionIndices].offset);
+		_structures = (float *)(bytes + sections[NGLSectionStructures].offset);
+	}
+	
+	//*************************
+	//	Materials and Surfaces
+	//*************************
+	
+	_rangeIndex = sections[NGLSectionMaterials].offset;
+	if (![self extractMaterials:data length:sections[NGLSectionMaterials].length])
+	{
+		return NO;
+	}
+	
+	_rangeIndex = sections[NGLSectionSurfaces].offset;
+	if (![self extractSurfaces:data length:sections[NGLSectionSurfaces].length])
+	{
+		return NO;
+	}
+	
+	//*************************
+	//	Levels of Detail
+	//*************************
+	
+	// The levels are optional, the meshes too small to be simplified don't have them.
+	_rangeIndex = sections[NGLSectionLevels].offset;
+	if (sections[NGLSectionLevels].length > 0 && ![self extractLevels:data length:sections[NGLSectionLevels].length])
+	{
+		return NO;
+	}
+	
+	//*************************
+	//	Clusters
+	//*************************
+	
+	// The clusters are optional as well, without them the mesh is always drawn entirely.
+	_rangeIndex = sections[NGLSectionClusters].offset;
+	if (sections[NGLSectionClusters].length > 0 &&
+		![self extractClusters:data length:sections[NGLSectionClusters].length])
+	{
+		return NO;
+	}
+	
+	//*************************
+	//	Windows
+	//*************************
+	
+	// The windows are optional too, without them the windows are found again when uploading the indices.
+	_rangeIndex = sections[NGLSectionWindows].offset;
+	if (sections[NGLSectionWindows].length > 0 &&
+		![self extractWindows:data length:sections[NGLSectionWindows].length])
+	{
+		return NO;
+	}
+	
+	//*************************
+	//	Joints
+	//*************************
+	
+	// Only the skinned meshes have joints.
+	_rangeIndex = sections[NGLSectionJoints].offset;
+	if (sections[NGLSectionJoints].length > 0 &&
+		![self extractJoints:data length:sections[NGLSectionJoints].length])
+	{
+		return NO;
+	}
+	
+	// The sections are not read in the file order, so the loaded data is completed at the end.
+	_loadedData = _totalData;
+	
+	return YES;
+}
+
+- (BOOL) extractElements:(NSData *)data length:(UInt32)length
+{
+	UInt32 i, end = _rangeIndex + length;
+	
 	// Basic body properties.
 	UInt32 elementCount;
 	NGLElementBody elementBody;
 	NGLElement element;
-	NGLMeshBody meshBody;
 	
-	// Retrieves the mesh elements count.
+	// Retrieves the mesh elements count and checks them against the length.
+	if (![self canRead:NGL_SIZE_UINT until:end])
+	{
+		return NO;
+	}
+	
 	[data getBytes:&elementCount range:[self rangeUntil:NGL_SIZE_UINT]];
 	
+	if (![self canRead:(UInt64)elementCount * sizeof(NGLElementBody) until:end])
+	{
+		return NO;
+	}
+	
 	i = 0;
 	while (i < elementCount)
 	{
@@ -291,25 +1555,26 @@ static NSString		*_nglPath;
 		++i;
 	}
 	
-	// Retrieves the mesh properties.
-	[data getBytes:&meshBody range:[self rangeUntil:sizeof(NGLMeshBody)]];
-	
-	// Constructs the parsed properties.
-	_iCount = meshBody.indicesCount;
-	_sCount = meshBody.structuresCount;
-	_stride = meshBody.stride;
-	
-	// Prepare to retrieve the mesh's arrays.
-	_indices = realloc(_indices, _iCount * NGL_SIZE_UINT);
-	_structures = realloc(_structures, _sCount * NGL_SIZE_FLOAT);
+	return YES;
+}
+
+- (BOOL) checkElements
+{
+	NGLElement *element;
+	BOOL valid = YES;
 	
-	// Retrieves the mesh's arrays.
-	[data getBytes:_indices range:[self rangeUntil:_iCount * NGL_SIZE_UINT]];
-	[data getBytes:_structures range:[self rangeUntil:_sCount * NGL_SIZE_FLOAT]];
+	// Each element must lie inside the stride.
+	while ((element = [[self meshElements] nextIterator]))
+	{
+		valid = (valid && (UInt64)(*element).start + (*element).length <= _stride);
+	}
 	
-	//*************************
-	//	Materials
-	//*************************
+	return valid;
+}
+
+- (BOOL) extractMaterials:(NSData *)data length:(UInt32)length
+{
+	UInt32 i, j, end = _rangeIndex + length;
 	
 	// Names.
 	unsigned short nameLength;
@@ -328,19 +1593,40 @@ static NSString		*_nglPath;
 	NGLMapBody mapBody;
 	
 	// Retrieves the materials count.
+	if (![self canRead:NGL_SIZE_UINT until:end])
+	{
+		return NO;
+	}
+	
 	[data getBytes:&materialsCount range:[self rangeUntil:NGL_SIZE_UINT]];
 	
 	i = 0;
 	while (i < materialsCount)
 	{
-		// Retrieves the material's indentifier.
-		[data getBytes:&materialID range:[self rangeUntil:NGL_SIZE_UINT]];
+		// Retrieves the material's indentifier and the length of its name.
+		if (![self canRead:NGL_SIZE_UINT + NGL_SIZE_USHORT until:end])
+		{
+			return NO;
+		}
 		
-		// Retrieves the material's name
+		[data getBytes:&materialID range:[self rangeUntil:NGL_SIZE_UINT]];
 		[data getBytes:&nameLength range:[self rangeUntil:NGL_SIZE_USHORT]];
+		
+		if (nameLength == 0 || ![self canRead:nameLength * NGL_SIZE_CHAR + sizeof(NGLMaterialBody) until:end])
+		{
+			return NO;
+		}
+		
+		// Retrieves the material's name, it must be a C string.
 		name = malloc(nameLength * NGL_SIZE_CHAR);
 		[data getBytes:name range:[self rangeUntil:nameLength * NGL_SIZE_CHAR]];
 		
+		if (name[nameLength - 1] != '\0')
+		{
+			nglFree(name);
+			return NO;
+		}
+		
 		// Retrieves the material's body
 		[data getBytes:&materialBody range:[self rangeUntil:sizeof(NGLMaterialBody)]];
 		
@@ -362,18 +1648,43 @@ static NSString		*_nglPath;
 		j = 0;
 		
 		// Retrieves the textures count.
+		if (![self canRead:NGL_SIZE_UINT until:end])
+		{
+			nglRelease(material);
+			return NO;
+		}
+		
 		[data getBytes:&mapsCount range:[self rangeUntil:NGL_SIZE_UINT]];
 		
 		while (j < mapsCount)
 		{
-			// Retrieves the kind of texture.
-			[data getBytes:&mapKind range:[self rangeUntil:NGL_SIZE_USHORT]];
+			// Retrieves the kind of texture and the length of its identifier.
+			if (![self canRead:NGL_SIZE_USHORT * 2 until:end])
+			{
+				nglRelease(material);
+				return NO;
+			}
 			
-			// Retrieves the texture's indentifier.
+			[data getBytes:&mapKind range:[self rangeUntil:NGL_SIZE_USHORT]];
 			[data getBytes:&nameLength range:[self rangeUntil:NGL_SIZE_USHORT]];
+			
+			if (nameLength == 0 || ![self canRead:nameLength * NGL_SIZE_CHAR + sizeof(NGLMapBody) until:end])
+			{
+				nglRelease(material);
+				return NO;
+			}
+			
+			// Retrieves the texture's indentifier, it must be a C string.
 			name = malloc(nameLength * NGL_SIZE_CHAR);
 			[data getBytes:name range:[self rangeUntil:nameLength * NGL_SIZE_CHAR]];
 			
+			if (name[nameLength - 1] != '\0')
+			{
+				nglFree(name);
+				nglRelease(material);
+				return NO;
+			}
+			
 			// Retrieves the texture's body.
 			[data getBytes:&mapBody range:[self rangeUntil:sizeof(NGLMapBody)]];
 			
@@ -430,9 +1741,12 @@ static NSString		*_nglPath;
 		++i;
 	}
 	
-	//*************************
-	//	Surfaces
-	//*************************
+	return YES;
+}
+
+- (BOOL) extractSurfaces:(NSData *)data length:(UInt32)length
+{
+	UInt32 i, end = _rangeIndex + length;
 	
 	// Surfaces.
 	UInt32 surfacesCount;
@@ -440,18 +1754,33 @@ static NSString		*_nglPath;
 	NGLSurface *surface;
 	NGLSurfaceBody surfaceBody;
 	
-	// Retrieves the materials count.
+	// Retrieves the surfaces count and checks them against the length.
+	if (![self canRead:NGL_SIZE_UINT until:end])
+	{
+		return NO;
+	}
+	
 	[data getBytes:&surfacesCount range:[self rangeUntil:NGL_SIZE_UINT]];
 	
+	if (![self canRead:(UInt64)surfacesCount * (NGL_SIZE_UINT + sizeof(NGLSurfaceBody)) until:end])
+	{
+		return NO;
+	}
+	
 	i = 0;
 	while (i < surfacesCount)
 	{
 		// Retrieves the surface's indentifier.
 		[data getBytes:&surfaceID range:[self rangeUntil:NGL_SIZE_UINT]];
 		
-		// Retrieves the surface's body
+		// Retrieves the surface's body, it must lie inside the array of indices.
 		[data getBytes:&surfaceBody range:[self rangeUntil:sizeof(NGLSurfaceBody)]];
 		
+		if ((UInt64)surfaceBody.startData + surfaceBody.lengthData > _iCount)
+		{
+			return NO;
+		}
+		
 		// Constructs the surface's properties.
 		surface = [[NGLSurface alloc] initWithStart:surfaceBody.startData
 											 length:surfaceBody.lengthData
@@ -465,31 +1794,298 @@ static NSString		*_nglPath;
 		
 		++i;
 	}
+	
+	return YES;
+}
+
+- (BOOL) extractLevels:(NSData *)data length:(UInt32)length
+{
+	UInt32 i;
+	NGLLevelsBody levelsBody;
+	NGLLevel *level;
+	
+	if (length < sizeof(NGLLevelsBody))
+	{
+		return NO;
+	}
+	
+	// Retrieves the counts and checks them against the section's length.
+	[data getBytes:&levelsBody range:[self rangeUntil:sizeof(NGLLevelsBody)]];
+	
+	if ((UInt64)levelsBody.levelsCount * sizeof(NGLLevel) + (UInt64)levelsBody.lodCount * NGL_SIZE_UINT !=
+		length - sizeof(NGLLevelsBody))
+	{
+		return NO;
+	}
+	
+	_levelsCount = levelsBody.levelsCount;
+	_lodCount = levelsBody.lodCount;
+	_levels = realloc(_levels, _levelsCount * sizeof(NGLLevel));
+	_lodIndices = realloc(_lodIndices, _lodCount * NGL_SIZE_UINT);
+	
+	// The levels are small, they are always copied.
+	[data getBytes:_levels range:[self rangeUntil:_levelsCount * (UInt32)sizeof(NGLLevel)]];
+	[data getBytes:_lodIndices range:[self rangeUntil:_lodCount * NGL_SIZE_UINT]];
+	
+	// Each range must lie inside its array of indices.
+	for (i = 0; i < _levelsCount; ++i)
+	{
+		level = &_levels[i];
+		
+		if ((UInt64)level->start + level->length > _lodCount ||
+			(UInt64)level->rangeStart + level->rangeLength > _iCount ||
+			level->level == 0 || level->level >= NGL_LOD_LEVELS)
+		{
+			_levelsCount = _lodCount = 0;
+			return NO;
+		}
+	}
+	
+	return YES;
+}
+
+- (BOOL) extractClusters:(NSData *)data length:(UInt32)length
+{
+	UInt32 i, end = 0;
+	
+	if (length % sizeof(NGLCluster) != 0)
+	{
+		return NO;
+	}
+	
+	_clustersCount = length / (UInt32)sizeof(NGLCluster);
+	_clusters = realloc(_clusters, _clustersCount * sizeof(NGLCluster));
+	
+	// The clusters are small, they are always copied.
+	[data getBytes:_clusters range:[self rangeUntil:length]];
+	
+	// The clusters must be sorted and lie inside the array of indices.
+	for (i = 0; i < _clustersCount; ++i)
+	{
+		if (_clusters[i].start < end || (UInt64)_clusters[i].start + _clusters[i].length > _iCount)
+		{
+			_clustersCount = 0;
+			return NO;
+		}
+		
+		end = _clusters[i].start + _clusters[i].length;
+	}
+	
+	return YES;
+}
+
+- (BOOL) extractWindows:(NSData *)data length:(UInt32)length
+{
+	UInt32 i, vertices = (_stride > 0) ? _sCount / _stride : 0;
+	NGLWindow *window;
+	
+	if (length % sizeof(NGLWindow) != 0)
+	{
+		return NO;
+	}
+	
+	_windowsCount = length / (UInt32)sizeof(NGLWindow);
+	_windows = realloc(_windows, _windowsCount * sizeof(NGLWindow));
+	
+	[data getBytes:_windows range:[self rangeUntil:length]];
+	
+	// The windows must lie inside the arrays and their indices must fit in the recorded size.
+	for (i = 0; i < _windowsCount; ++i)
+	{
+		window = &_windows[i];
+		
+		if ((UInt64)window->rangeStart + window->rangeLength > _iCount ||
+			(UInt64)window->base + window->count > vertices ||
+			(window->dataSize != NGL_SIZE_UINT &&
+			 (window->dataSize != NGL_SIZE_USHORT || window->count > NGL_MAX_16 + 1)))
+		{
+			_windowsCount = 0;
+			return NO;
+		}
+	}
+	
+	return YES;
+}
+
+- (BOOL) extractJoints:(NSData *)data length:(UInt32)length
+{
+	UInt32 i, count, end = _rangeIndex + length;
+	unsigned short nameLength;
+	char *name;
+	NSString *string;
+	NSMutableArray *names;
+	
+	if (length < NGL_SIZE_UINT)
+	{
+		return NO;
+	}
+	
+	[data getBytes:&count range:[self rangeUntil:NGL_SIZE_UINT]];
+	
+	if (count > NGL_MAX_JOINTS)
+	{
+		return NO;
+	}
+	
+	names = [NSMutableArray arrayWithCapacity:count];
+	_joints = realloc(_joints, MAX(count, 1) * sizeof(NGLJoint));
+	
+	for (i = 0; i < count; ++i)
+	{
+		// Each joint must lie inside the section.
+		if ((UInt64)_rangeIndex + NGL_SIZE_USHORT > end)
+		{
+			return NO;
+		}
+		
+		[data getBytes:&nameLength range:[self rangeUntil:NGL_SIZE_USHORT]];
+		
+		if (nameLength == 0 || (UInt64)_rangeIndex + nameLength + sizeof(NGLJoint) > end)
+		{
+			return NO;
+		}
+		
+		// Retrieves the joint's name.
+		name = malloc(nameLength * NGL_SIZE_CHAR);
+		[data getBytes:name range:[self rangeUntil:nameLength * NGL_SIZE_CHAR]];
+		name[nameLength - 1] = '\0';
+		string = [NSString stringWithCString:name encoding:NSUTF8StringEncoding];
+		[names addObject:(string != nil) ? string : @""];
+		nglFree(name);
+		
+		// Retrieves the joint's body. The parents must come before their children.
+		[data getBytes:&_joints[i] range:[self rangeUntil:sizeof(NGLJoint)]];
+		
+		if (_joints[i].parent != NGL_NOT_FOUND && _joints[i].parent >= i)
+		{
+			return NO;
+		}
+	}
+	
+	_jointsCount = count;
+	nglRelease(_jointNames);
+	_jointNames = [names retain];
+	
+	return YES;
 }
 
 - (void) compressData:(NGLParserMesh *)parse file:(NSString *)fullPath
 {
 	NSMutableData *data = [[NSMutableData alloc] init];
+	NSData *streams[NGL_SECTIONS_COUNT];
+	UInt32 types[NGL_SECTIONS_COUNT] = { NGLSectionElements, NGLSectionMesh, NGLSectionIndices,
+										 NGLSectionStructures, NGLSectionMaterials, NGLSectionSurfaces,
+										 NGLSectionLevels, NGLSectionClusters, NGLSectionWindows,
+										 NGLSectionJoints };
+	NGLHeaderBody header;
+	NGLSectionBody section;
+	NGLMeshBody meshBody;
+	UInt32 i, offset, padding;
+	char zeros[NGL_SECTION_ALIGN] = { 0 };
+	
+	// Prepares the mesh's properties.
+	meshBody.indicesCount = parse.indicesCount;
+	meshBody.structuresCount = parse.structuresCount;
+	meshBody.stride = parse.stride;
+	
+	// Prepares all the sections. The mesh's arrays are not copied at this point.
+	streams[0] = [self compressElements:parse];
+	streams[1] = [NSData dataWithBytes:&meshBody length:sizeof(NGLMeshBody)];
+	streams[2] = [NSData dataWithBytesNoCopy:parse.indices
+									  length:parse.indicesCount * NGL_SIZE_UINT
+								freeWhenDone:NO];
+	streams[3] = [NSData dataWithBytesNoCopy:parse.structures
+									  length:parse.structuresCount * NGL_SIZE_FLOAT
+								freeWhenDone:NO];
+	streams[4] = [self compressMaterials:parse];
+	streams[5] = [self compressSurfaces:parse];
+	streams[6] = [self compressLevels:parse];
+	streams[7] = [self compressClusters:parse];
+	streams[8] = [self compressWindows:parse];
+	streams[9] = [self compressJoints:parse];
+	
+	// The compressed arrays replace the raw ones.
+	if (_compressed)
+	{
+		types[2] = NGLSectionIndicesCodec;
+		types[3] = NGLSectionStructuresCodec;
+		streams[2] = nglCompressIndices(parse.indices, parse.indicesCount);
+		streams[3] = nglCompressStructures(parse.structures, parse.structuresCount,
+										   parse.stride, parse.meshElements);
+	}
 	
 	//*************************
 	//	Header
 	//*************************
 	
-	// File version.
-	float version = NGL_FILE_VERSION;
+	// The section table comes right after the header, the sections come after the table.
+	offset = sizeof(NGLHeaderBody) + NGL_SECTIONS_COUNT * sizeof(NGLSectionBody);
+	
+	for (i = 0; i < NGL_SECTIONS_COUNT; ++i)
+	{
+		offset = binaryAlign(offset) + (UInt32)[streams[i] length];
+	}
+	
+	header.version = NGL_FILE_VERSION;
+	header.sectionsCount = NGL_SECTIONS_COUNT;
+	header.length = offset;
+	header.reserved = 0;
 	
-	// Inserts the file version.
-	[data appendBytes:&version length:NGL_SIZE_FLOAT];
+	// Inserts the header.
+	[data appendBytes:&header length:sizeof(NGLHeaderBody)];
 	
 	//*************************
-	//	Mesh structure
+	//	Section table
+	//*************************
+	
+	offset = sizeof(NGLHeaderBody) + NGL_SECTIONS_COUNT * sizeof(NGLSectionBody);
+	
+	for (i = 0; i < NGL_SECTIONS_COUNT; ++i)
+	{
+		// Every section starts at an aligned offset, so it can be used directly from the mapped file.
+		offset = binaryAlign(offset);
+		
+		section.type = types[i];
+		section.offset = offset;
+		section.length = (UInt32)[streams[i] length];
+		section.reserved = 0;
+		
+		[data appendBytes:&section length:sizeof(NGLSectionBody)];
+		
+		offset += section.length;
+	}
+	
+	//*************************
+	//	Sections
+	//*************************
+	
+	for (i = 0; i < NGL_SECTIONS_COUNT; ++i)
+	{
+		// Pads the previous section.
+		padding = (UInt32)(binaryAlign([data length]) - [data length]);
+		[data appendBytes:zeros length:padding];
+		
+		[data appendData:streams[i]];
+	}
+	
+	//*************************
+	//	Saving file
 	//*************************
 	
+	[data writeToFile:fullPath atomically:YES];
+	
+	// Frees the memories.
+	nglRelease(data);
+}
+
+- (NSData *) compressElements:(NGLParserMesh *)parse
+{
+	NSMutableData *data = [NSMutableData data];
+	
 	// Basic body properties.
 	UInt32 elementCount;
 	NGLElementBody elementBody;
 	NGLElement *element;
-	NGLMeshBody meshBody;
 	NGLMeshElements *elements = parse.meshElements;
 	
 	// Prepares the mesh elements count.
@@ -510,21 +2106,12 @@ static NSString		*_nglPath;
 		[data appendBytes:&elementBody length:sizeof(NGLElementBody)];
 	}
 	
-	// Prepares the mesh's properties.
-	meshBody.indicesCount = parse.indicesCount;
-	meshBody.structuresCount = parse.structuresCount;
-	meshBody.stride = parse.stride;
-	
-	// Inserts the mesh's properties.
-	[data appendBytes:&meshBody length:sizeof(NGLMeshBody)];
-	
-	// Inserts the mesh's arrays.
-	[data appendBytes:parse.indices length:parse.indicesCount * NGL_SIZE_UINT];
-	[data appendBytes:parse.structures length:parse.structuresCount * NGL_SIZE_FLOAT];
-	
-	//*************************
-	//	Materials
-	//*************************
+	return data;
+}
+
+- (NSData *) compressMaterials:(NGLParserMesh *)parse
+{
+	NSMutableData *data = [NSMutableData data];
 	
 	// Material Library.
 	NGLMaterialMulti *mtlLib = parse.material;
@@ -657,9 +2244,12 @@ static NSString		*_nglPath;
 		}
 	}
 	
-	//*************************
-	//	Surfaces
-	//*************************
+	return data;
+}
+
+- (NSData *) compressSurfaces:(NGLParserMesh *)parse
+{
+	NSMutableData *data = [NSMutableData data];
 	
 	// Surface library.
 	NGLSurfaceMulti		*sufLib = parse.surface;
@@ -690,111 +2280,172 @@ static NSString		*_nglPath;
 		[data appendBytes:&surfaceBody length:sizeof(NGLSurfaceBody)];
 	}
 	
-	//*************************
-	//	Saving file
-	//*************************
+	return data;
+}
+
+- (NSData *) compressLevels:(NGLParserMesh *)parse
+{
+	NSMutableData *data = [NSMutableData data];
+	NGLLevelsBody levelsBody;
 	
-	[data writeToFile:fullPath atomically:YES];
+	// Prepares the counts.
+	levelsBody.levelsCount = parse.levelsCount;
+	levelsBody.lodCount = parse.lodCount;
+	[data appendBytes:&levelsBody length:sizeof(NGLLevelsBody)];
 	
-	// Frees the memories.
-	nglRelease(data);
+	// Inserts the ranges and the levels' indices.
+	[data appendBytes:parse.levels length:levelsBody.levelsCount * sizeof(NGLLevel)];
+	[data appendBytes:parse.lodIndices length:levelsBody.lodCount * NGL_SIZE_UINT];
+	
+	return data;
 }
 
-#pragma mark -
-#pragma mark Self Public Methods
-//**************************************************
-//	Self Public Methods
-//**************************************************
+- (NSData *) compressClusters:(NGLParserMesh *)parse
+{
+	return [NSData dataWithBytes:parse.clusters length:parse.clustersCount * sizeof(NGLCluster)];
+}
 
-- (BOOL) hasCache:(NSString *)named
+- (NSData *) compressWindows:(NGLParserMesh *)parse
 {
-	NSString *fullPath;
-	NSDictionary *attributes;
-	
-	// Constructs the NGL file's name based on an original name.
-	// The NGL file's name will be "<OriginalName>.<NGL_EXTENSION>".
-	NSString *nglFile = [nglGetFileName(named) stringByAppendingPathExtension:NGL_EXTENSION];
+	return [NSData dataWithBytes:parse.windows length:parse.windowsCount * sizeof(NGLWindow)];
+}
+
+- (NSData *) compressJoints:(NGLParserMesh *)parse
+{
+	NSMutableData *data = [NSMutableData data];
+	NGLJoint *joints = parse.joints;
+	UInt32 i, count = parse.jointsCount;
+	unsigned short nameLength;
+	const char *name;
 	
-	//*************************
-	//	Original file
-	//*************************
+	// The meshes without skeleton have no joints section.
+	if (count == 0)
+	{
+		return data;
+	}
 	
-	// Gets the file attributes from the original file.
-	fullPath = nglMakePath(named);
-	attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:fullPath error:nil];
+	[data appendBytes:&count length:NGL_SIZE_UINT];
 	
-	// Cheks if the original file exists.
-	if (attributes == nil)
+	for (i = 0; i < count; ++i)
 	{
-		return NO;
+		// Inserts the joint's name.
+		name = [[parse.jointNames objectAtIndex:i] UTF8String];
+		nameLength = strlen(name) + 1;
+		[data appendBytes:&nameLength length:NGL_SIZE_USHORT];
+		[data appendBytes:name length:nameLength * NGL_SIZE_CHAR];
+		
+		// Inserts the joint's body.
+		[data appendBytes:&joints[i] length:sizeof(NGLJoint)];
 	}
 	
-	// Gets the modification date from the original file.
-	NSDate *originalDate = [attributes objectForKey:NSFileModificationDate];
+	return data;
+}
+
+#pragma mark -
+#pragma mark Self Public Methods
+//**************************************************
+//	Self Public Methods
+//**************************************************
+
+- (BOOL) hasCache:(NSString *)named settings:(NSDictionary *)settings
+{
+	NSTimeInterval start = [NSDate timeIntervalSinceReferenceDate];
+	NSString *key = cacheKey(named, settings);
+	NSDictionary *entry;
+	BOOL hit = NO;
 	
-	//*************************
-	//	NGL file
-	//*************************
+	pthread_mutex_lock(&_cacheMutex);
 	
-	// Gets the file attributes from the NGL file.
-	fullPath = [_nglPath stringByAppendingPathComponent:nglFile];
-	attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:fullPath error:nil];
+	cacheLoad();
+	entry = (key != nil) ? [_cacheEntries objectForKey:key] : nil;
 	
-	// Checks if the NGL file exists.
-	if (attributes == nil)
+	// The entry is only valid if its file still exists.
+	if (entry != nil)
 	{
-		return NO;
+		hit = [[NSFileManager defaultManager] fileExistsAtPath:cacheFile(key)];
+		
+		if (hit)
+		{
+			cacheTouch(key, [entry objectForKey:NGL_CACHE_LENGTH]);
+		}
+		else
+		{
+			[_cacheEntries removeObjectForKey:key];
+			_cacheChanged = YES;
+		}
 	}
 	
-	// Gets the modification date from the NGL file.
-	NSDate *nglDate = [attributes objectForKey:NSFileModificationDate];
-	
-	//*************************
-	//	Original VS NGL
-	//*************************
+	// Updates the statistics.
+	++_cacheStats.lookups;
+	_cacheStats.hits += (hit) ? 1 : 0;
+	_cacheStats.misses += (hit) ? 0 : 1;
+	_cacheStats.lookupTime += [NSDate timeIntervalSinceReferenceDate] - start;
 	
-	// If the original file is a new version compared to NGL file, ignore the NGL file.
-	// Positive time interval, comparing the modification date from the original file with the
-	// NGL file, means wich the original is newer than NGL file, so use the original one.
-	if ([originalDate timeIntervalSinceDate:nglDate] > 0)
-	{
-		return NO;
-	}
+	pthread_mutex_unlock(&_cacheMutex);
 	
-	return YES;
+	return hit;
 }
 
-- (void) decodeCache:(NSString *)named
+- (void) decodeCache:(NSString *)named settings:(NSDictionary *)settings
 {
-	// Constructs the NGL file's name based on an original name.
-	// The NGL file's name will be "<OriginalName>.<NGL_EXTENSION>".
-	NSString *nglFile = [nglGetFileName(named) stringByAppendingPathExtension:NGL_EXTENSION];
-	
-	// NGL file always is saved inside a reserved folder in <APPLICATION_HOME>/Library path.
-	// This is a secure path properly backuped by application's transfers and updatefileName
-	NSString *fullPath = [_nglPath stringByAppendingPathComponent:nglFile];
+	NSString *key = cacheKey(named, settings);
 	
 	// Proceeds processing the NGL file data. Only valid path at this point.
-	[self extractDataFromFile:fullPath];
+	if (key != nil)
+	{
+		[self extractDataFromFile:cacheFile(key)];
+	}
+	
+	// Persists the last accesses, so the eviction order survives to the next sessions.
+	pthread_mutex_lock(&_cacheMutex);
+	cacheSave();
+	pthread_mutex_unlock(&_cacheMutex);
 }
 
-- (void) encodeCache:(NGLParserMesh *)parser withName:(NSString *)named
+- (void) encodeCache:(NGLParserMesh *)parser withName:(NSString *)named settings:(NSDictionary *)settings
 {
+	NSString *key, *fullPath;
+	NSDictionary *attributes;
+	
 	// Aborts the encode process if the original parse was invalid.
 	if (parser == nil)
 	{
 		return;
 	}
 	
-	// Constructs the NGL file's name based on an original name.
-	// The NGL file's name will be "<OriginalName>.<NGL_EXTENSION>".
-	NSString *nglFile = [nglGetFileName(named) stringByAppendingPathExtension:NGL_EXTENSION];
+	key = cacheKey(named, settings);
 	
-	// NGL file always is saved inside a reserved folder in <APPLICATION_HOME>/Library path.
-	// This is a secure path properly backuped by application's transfers and updatefileName
-	NSString *fullPath = [_nglPath stringByAppendingPathComponent:nglFile];
+	if (key == nil)
+	{
+		return;
+	}
 	
+	// NGL file always is saved inside a reserved folder in <APPLICATION_HOME>/Library path.
+	// This is a secure path properly backuped by application's transfers and updates.
+	fullPath = cacheFile(key);
 	[self compressData:parser file:fullPath];
+	attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:fullPath error:nil];
+	
+	// Registers the new file and respects the disk budget.
+	if (attributes != nil)
+	{
+		pthread_mutex_lock(&_cacheMutex);
+		
+		cacheTouch(key, [attributes objectForKey:NSFileSize]);
+		cacheTrim(key);
+		cacheSave();
+		
+		pthread_mutex_unlock(&_cacheMutex);
+	}
+}
+
+- (void) encodeFile:(NGLParserMesh *)parser path:(NSString *)fullPath
+{
+	// Aborts the encode process if the original parse was invalid.
+	if (parser != nil)
+	{
+		[self compressData:parser file:fullPath];
+	}
 }
 
 #pragma mark -
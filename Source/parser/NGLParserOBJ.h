@@ -76,6 +76,11 @@
  *						- There is no support to any kind of pre-processed or pre-compiled third
  *							files like: .mpc, .mps, .mpb .cxc, .cxs, .cxb, .rfl, .rla.
  *	
+ *					The OBJ file is mapped into the memory and tokenized directly over its bytes, so huge
+ *					files don't need to be entirely copied or converted into strings before the parsing.
+ *					Large files are also split into line aligned chunks which are parsed concurrently,
+ *					one per processor core, and merged in the file order.
+ *
  *					Even being the NGLParserOBJ a fast parser, you should remember some important tips to
  *					boost its performance:
  *
@@ -87,11 +92,15 @@
 @private
 	// Helpers
 	UInt32			_lines;
+	int64_t					_loadedBytes;
 	NSString				*_finalPath;
 	NSMutableDictionary		*_faceStore;
-	NSArray					*_cuted;
-	const char				*_prefix;
-	unsigned char			_cutedCount;
+	
+	// Capacities
+	UInt32					_vCapacity;
+	UInt32					_tCapacity;
+	UInt32					_nCapacity;
+	UInt32					_fCapacity;
 	
 	// Caches
 	BOOL					_sCache;
@@ -22,6 +22,7 @@
 
 #import "NGLParserOBJ.h"
 
+#import "NGLJob.h"
 #import "NGLRegEx.h"
 
 #pragma mark -
@@ -33,6 +34,15 @@
 //
 //**********************************************************************************************************
 
+// Initial number of elements reserved to each growing array.
+#define OBJ_INITIAL_CAPACITY	1024
+
+// Minimum size, in bytes, of each chunk parsed concurrently. Smaller files are parsed in a single chunk.
+#define OBJ_CHUNK_SIZE			(4 * 1024 * 1024)
+
+// Number of lines parsed between each update of the loaded data.
+#define OBJ_PROGRESS_LINES		4096
+
 static NSString *const OBJ_ERROR_HEADER = @"Error while processing NGLParserOBJ with file \"%@\".";
 
 static NSString *const OBJ_ERROR_NO_FILE = @"At line %i.\n\
@@ -66,307 +76,654 @@ should be assigned. So only the first assigned material will be valid.";
 //**********************************************************************************************************
 
 #pragma mark -
-#pragma mark Private Functions
+#pragma mark Private Definitions
 //**************************************************
-//	Private Functions
+//	Private Definitions
 //**************************************************
 
-// Converts the OBJ face format into a vector, NGLivec3.
-static NGLivec3 objFaceToVector(const char *cFace)
+// The kinds of lines that must be replayed in the file order after the concurrent parsing.
+typedef enum
 {
-	nglCStringReplaceChar((char *)cFace, '/', NGL_BLANK_CHAR);
+	OBJRecordGroup,
+	OBJRecordMaterial,
+	OBJRecordLibrary,
+	OBJRecordError,
+} OBJRecordType;
+
+// An ordered event found in a chunk. All the counts are local to the chunk.
+typedef struct
+{
+	OBJRecordType	type;
+	UInt32			line;
+	UInt32			vCount;
+	UInt32			tCount;
+	UInt32			nCount;
+	UInt32			facesCount;
+	const char		*bytes;
+	UInt32			length;
+	NSString		*message;
+} OBJRecord;
+
+// A line aligned piece of the OBJ file and all the data parsed from it.
+// The faces hold the original OBJ indices, which are fixed up only when the chunks are merged.
+typedef struct
+{
+	// Bytes
+	const char		*start;
+	const char		*end;
+	UInt32			lines;
 	
-	// By setting the default face to 1 avoids incorrect indices, since the first index in OBJ files is 1.
-	NGLivec3 face = (NGLivec3){1,1,1};
-	char *cTempFace;
+	// Structure Components
+	UInt32			vCount;
+	UInt32			tCount;
+	UInt32			nCount;
+	UInt32			facesCount;
+	UInt32			vCapacity;
+	UInt32			tCapacity;
+	UInt32			nCapacity;
+	UInt32			fCapacity;
+	float			*vertices;
+	float			*texcoords;
+	float			*normals;
+	int				*faces;
 	
-	face.x = (int)strtol(cFace, &cTempFace, 10);
-	face.y = (cTempFace[1] != NGL_BLANK_CHAR) ? (int)strtol(cTempFace, &cTempFace, 10) : 1;
-	face.z = (cTempFace[2] != NGL_BLANK_CHAR) ? (int)strtol(cTempFace, &cTempFace, 10) : 1;
+	// Records
+	UInt32			rCount;
+	UInt32			rCapacity;
+	OBJRecord		*records;
 	
-	return face;
-}
+	// Tokens
+	UInt32			tokensCount;
+	UInt32			tokensCapacity;
+	const char		**tokens;
+	UInt32			*tokensLength;
+} OBJChunk;
 
 #pragma mark -
-#pragma mark Private Category
+#pragma mark Private Functions
 //**************************************************
-//	Private Category
+//	Private Functions
 //**************************************************
 
-@interface NGLParserOBJ()
-
-- (void) defineStride;
-- (void) updateGroups;
-
-- (void) processFace:(NSString *)face;
-- (void) processLine:(NSString *)line;
-
-@end
-
-#pragma mark -
-#pragma mark Public Interface
-#pragma mark -
-//**********************************************************************************************************
-//
-//	Public Interface
-//
-//**********************************************************************************************************
-
-@implementation NGLParserOBJ
-
-#pragma mark -
-#pragma mark Properties
-//**************************************************
-//	Properties
-//**************************************************
+// Checks if a character is a blank character inside a line.
+NGL_INLINE BOOL objIsBlank(char c)
+{
+	return (c == ' ' || c == '\t');
+}
 
+// Checks if a character is a line break. The vertical tab and the form feed also end the lines, as they did
+// with the NSString lines.
+NGL_INLINE BOOL objIsBreak(char c)
+{
+	return (c == '\n' || c == '\r' || c == '\v' || c == '\f');
+}
 
+// Checks if a character can start an integer number.
+NGL_INLINE BOOL objIsInteger(char c)
+{
+	return ((c >= '0' && c <= '9') || c == '-' || c == '+');
+}
 
-#pragma mark -
-#pragma mark Constructors
-//**************************************************
-//	Constructors
-//**************************************************
+// Compares a token with a lower case tag, ignoring the case of the token, as files from the 3DS Max.
+NGL_INLINE BOOL objTokenIsTag(const char *token, UInt32 length, const char *tag)
+{
+	return (strlen(tag) == length && strncasecmp(token, tag, length) == 0);
+}
 
-- (id) init
+// Grows a buffer geometrically to hold, at least, the desired number of elements.
+static void *objGrow(void *buffer, UInt32 *capacity, UInt32 count, size_t size)
 {
-	if ((self = [super init]))
+	if (count > *capacity)
 	{
-		// Allocates once.
-		if (_mtlParser == nil)
+		UInt32 newCapacity = (*capacity > 0) ? *capacity : OBJ_INITIAL_CAPACITY;
+		
+		while (newCapacity < count)
 		{
-			_mtlParser = [[NGLParserMTL alloc] init];
+			newCapacity *= 2;
 		}
+		
+		buffer = realloc(buffer, newCapacity * size);
+		*capacity = newCapacity;
 	}
 	
-	return self;
+	return buffer;
 }
 
-#pragma mark -
-#pragma mark Private Methods
-//**************************************************
-//	Private Methods
-//**************************************************
-
-- (void) defineStride
+// Converts the OBJ face format (v/vt/vn) into a vector, NGLivec3.
+static NGLivec3 objFaceToVector(const char *cFace, const char *end)
 {
-	_stride = 0;
-	
-	// Defines the vertex element as a 4 floats.
-	[_meshElements addElement:(NGLElement){NGLComponentVertex, _stride, 4, 0}];
-	_stride = 4;
+	// By setting the default face to 1 avoids incorrect indices, since the first index in OBJ files is 1.
+	NGLivec3 face = (NGLivec3){1,1,1};
+	const char *cTempFace;
 	
-	// Defines the texture coordinate element as a 2 floats, if needed.
-	if (_tCount > 0)
-	{
-		[_meshElements addElement:(NGLElement){NGLComponentTexcoord, _stride, 2, 1}];
-		_stride += 2;
-	}
+	cTempFace = nglParseInt(cFace, end, &face.x);
 	
-	// Defines the normal element as a 3 floats, if needed.
-	if (_nCount > 0)
+	// The texture coordinate is optional, like in "v//vn".
+	if (cTempFace < end && *cTempFace == '/')
 	{
-		[_meshElements addElement:(NGLElement){NGLComponentNormal, _stride, 3, 2}];
-		_stride += 3;
+		++cTempFace;
+		if (cTempFace < end && objIsInteger(*cTempFace))
+		{
+			cTempFace = nglParseInt(cTempFace, end, &face.y);
+		}
+		
+		// The normal is optional, like in "v/vt".
+		if (cTempFace < end && *cTempFace == '/')
+		{
+			++cTempFace;
+			if (cTempFace < end && objIsInteger(*cTempFace))
+			{
+				nglParseInt(cTempFace, end, &face.z);
+			}
+		}
 	}
 	
-	_sCache = NO;
+	return face;
 }
 
-- (void) updateGroups
+// Stores a new ordered record into the chunk, using the current chunk counts.
+static OBJRecord *objAddRecord(OBJChunk *chunk, OBJRecordType type)
 {
-	[_faceStore removeAllObjects];
+	OBJRecord *record;
 	
-	_groups = realloc(_groups, (_gCount + 1) * NGL_SIZE_IVEC3);
-	
-	// Stores the index/stride to the current group elements.
-	_groups[_gCount] = (NGLivec3){_vCount, _tCount, _nCount};
+	chunk->records = objGrow(chunk->records, &chunk->rCapacity, chunk->rCount + 1, sizeof(OBJRecord));
+	record = &chunk->records[chunk->rCount++];
 	
-	// Sets the current group index, which will be used in the faces processing.
-	_currentGrp = _gCount;
+	*record = (OBJRecord){type, chunk->lines, chunk->vCount, chunk->tCount, chunk->nCount,
+		chunk->facesCount, NULL, 0, nil};
 	
-	++_gCount;
+	return record;
 }
 
-- (void) processFace:(NSString *)face
+// Stores the original OBJ indices of a face vertex into the chunk.
+static void objParseFace(OBJChunk *chunk, const char *face, const char *end)
 {
-	UInt32 *faces;
-	NGLivec3 vFace, vGroup;
-	
-	_faces = realloc(_faces, (++_facesCount * _facesStride) * NGL_SIZE_INT);
-	
-	// Prepares the pointer to work with current face.
-	faces = _faces + ((_facesCount - 1) * _facesStride);
-	
-	// Returns a NGLvec3 containing the values for vertex, vertex texture and vertex normal elements.
-	vFace = objFaceToVector([face UTF8String]);
-	vGroup = (_groups != NULL) ? _groups[_currentGrp] : kNGLivec3Zero;
+	NGLivec3 vFace = objFaceToVector(face, end);
+	int *faces;
 	
-	// Processes the face. The elements order to OBJ files is always v/vt/vn.
-	// Besides, deals with 3DS MAX negative face indexing and adjusts the index, OBJ index starts at 1.
-	*faces++ = vFace.x + (vFace.x < 0 ? vGroup.x : -1);
-	*faces++ = vFace.y + (vFace.y < 0 ? vGroup.y : -1);
-	*faces = vFace.z + (vFace.z < 0 ? vGroup.z : -1);
+	chunk->faces = objGrow(chunk->faces, &chunk->fCapacity, (++chunk->facesCount * 3), NGL_SIZE_INT);
 	
-	// Updates the length of the current surface.
-	[_mtlParser updateSurfaceLength];
+	// The elements order to OBJ files is always v/vt/vn.
+	faces = chunk->faces + ((chunk->facesCount - 1) * 3);
+	*faces++ = vFace.x;
+	*faces++ = vFace.y;
+	*faces = vFace.z;
 }
 
-- (void) processLine:(NSString *)line
+// Parses a single line into the chunk. The numbers are parsed in place, never beyond the line end.
+static void objParseLine(OBJChunk *chunk, const char *line, UInt32 length)
 {
-	++_lines;
+	const char *end = line + length;
+	const char *token;
+	OBJRecord *record;
+	
+	++chunk->lines;
 	
 	// Skips the blank and comment lines.
-	if ([line length] < 3 || [line hasPrefix:@"#"])
+	if (length < 3 || *line == '#')
 	{
 		return;
 	}
-	else
+	
+	// Cuts the line into tokens. The tokens just point to the original bytes, nothing is copied.
+	chunk->tokensCount = 0;
+	while (line < end)
 	{
-		// Cuts the line.
-		_cuted = nglGetArray(line);
-		_cutedCount = [_cuted count];
+		// Skips the blank characters between the tokens.
+		while (line < end && objIsBlank(*line))
+		{
+			++line;
+		}
 		
-		// Avoids invalid lines.
-		if (_cutedCount <= 1)
+		if (line == end)
 		{
-			return;
+			break;
+		}
+		
+		// Finds the end of the current token.
+		token = line;
+		while (line < end && !objIsBlank(*line))
+		{
+			++line;
 		}
 		
-		// Takes all lower case to avoid upper case conflicts, as files from the 3DS Max.
-		_prefix = [[[_cuted objectAtIndex:0] lowercaseString] UTF8String];
+		if (chunk->tokensCount == chunk->tokensCapacity)
+		{
+			chunk->tokensCapacity = (chunk->tokensCapacity > 0) ? chunk->tokensCapacity * 2 : 16;
+			chunk->tokens = realloc(chunk->tokens, chunk->tokensCapacity * sizeof(const char *));
+			chunk->tokensLength = realloc(chunk->tokensLength, chunk->tokensCapacity * NGL_SIZE_UINT);
+		}
+		
+		chunk->tokens[chunk->tokensCount] = token;
+		chunk->tokensLength[chunk->tokensCount] = (UInt32)(line - token);
+		++chunk->tokensCount;
+	}
+	
+	UInt32 count = chunk->tokensCount;
+	const char **tokens = chunk->tokens;
+	
+	// Avoids invalid lines.
+	if (count <= 1)
+	{
+		return;
 	}
 	
+	const char *prefix = tokens[0];
+	UInt32 prefixLength = chunk->tokensLength[0];
+	
 	// The process was ordered to optimize the work on the most frequently lines.
 	//*************************
 	//	f - Face
 	//*************************
-	if (strcmp(_prefix, "f") == 0)
+	if (objTokenIsTag(prefix, prefixLength, "f"))
 	{
 		UInt32 i;
-		UInt32 length = (_cutedCount > 4) ? _cutedCount : 4;
+		UInt32 length = (count > 4) ? count : 4;
 		for (i = 1; i < length; i++)
 		{
 			// If the current face forms a polygon which has more than 3 vertices,
 			// re-constructs the current face to turn it into multiple triangles.
 			if (i >= 4)
 			{
-				[self processFace:[_cuted objectAtIndex:1]];
-				[self processFace:[_cuted objectAtIndex:i - 1]];
+				objParseFace(chunk, tokens[1], end);
+				objParseFace(chunk, tokens[i - 1], end);
 			}
 			
 			// Processes current vertex. If the current face forms a line or a point,
 			// this will makes a triangle returning to the first vertex of this face.
-			[self processFace:[_cuted objectAtIndex:(_cutedCount > i) ? i : 1]];
+			objParseFace(chunk, tokens[(count > i) ? i : 1], end);
 		}
 	}
 	//*************************
 	//	vt - Vertex Texture
 	//*************************
-	else if (strcmp(_prefix, "vt") == 0)
+	else if (objTokenIsTag(prefix, prefixLength, "vt"))
 	{
 		// Checks for number of values.
-		if (_cutedCount <= 2)
+		if (count <= 2)
 		{
-			_error.message = [NSString stringWithFormat:OBJ_ERROR_IMCOMPLETE_VALUES, (unsigned int)_lines];
+			objAddRecord(chunk, OBJRecordError)->message = OBJ_ERROR_IMCOMPLETE_VALUES;
 			return;
 		}
 		
-		_texcoords = realloc(_texcoords, ++_tCount * NGL_SIZE_VEC2);
-		float *texcoord = _texcoords + ((_tCount - 1) * 2);
+		chunk->texcoords = objGrow(chunk->texcoords, &chunk->tCapacity, ++chunk->tCount, NGL_SIZE_VEC2);
+		float *texcoord = chunk->texcoords + ((chunk->tCount - 1) * 2);
 		
-		*texcoord++ = [[_cuted objectAtIndex:1] floatValue];
-		*texcoord = [[_cuted objectAtIndex:2] floatValue];
+		nglParseFloat(tokens[1], end, texcoord++);
+		nglParseFloat(tokens[2], end, texcoord);
 	}
 	//*************************
 	//	v - Vertex
 	//*************************
-	else if (strcmp(_prefix, "v") == 0)
+	else if (objTokenIsTag(prefix, prefixLength, "v"))
 	{
 		// Checks for number of values.
-		if (_cutedCount <= 3)
+		if (count <= 3)
 		{
-			_error.message = [NSString stringWithFormat:OBJ_ERROR_IMCOMPLETE_VALUES, (unsigned int)_lines];
+			objAddRecord(chunk, OBJRecordError)->message = OBJ_ERROR_IMCOMPLETE_VALUES;
 			return;
 		}
 		
-		_vertices = realloc(_vertices, ++_vCount * NGL_SIZE_VEC4);
-		float *vertices = _vertices + ((_vCount - 1) * 4);
+		chunk->vertices = objGrow(chunk->vertices, &chunk->vCapacity, ++chunk->vCount, NGL_SIZE_VEC4);
+		float *vertices = chunk->vertices + ((chunk->vCount - 1) * 4);
 		
-		*vertices++ = [[_cuted objectAtIndex:1] floatValue];
-		*vertices++ = [[_cuted objectAtIndex:2] floatValue];
-		*vertices++ = [[_cuted objectAtIndex:3] floatValue];
+		nglParseFloat(tokens[1], end, vertices++);
+		nglParseFloat(tokens[2], end, vertices++);
+		nglParseFloat(tokens[3], end, vertices++);
 		*vertices = 1.0f;
 	}
 	//*************************
 	//	vn - Vertex Normal
 	//*************************
-	else if (strcmp(_prefix, "vn") == 0)
+	else if (objTokenIsTag(prefix, prefixLength, "vn"))
 	{
 		// Checks for number of values.
-		if (_cutedCount <= 3)
+		if (count <= 3)
 		{
-			_error.message = [NSString stringWithFormat:OBJ_ERROR_IMCOMPLETE_VALUES, (unsigned int)_lines];
+			objAddRecord(chunk, OBJRecordError)->message = OBJ_ERROR_IMCOMPLETE_VALUES;
 			return;
 		}
 		
-		_normals = realloc(_normals, ++_nCount * NGL_SIZE_VEC3);
-		float *normals = _normals + ((_nCount - 1) * 3);
+		chunk->normals = objGrow(chunk->normals, &chunk->nCapacity, ++chunk->nCount, NGL_SIZE_VEC3);
+		float *normals = chunk->normals + ((chunk->nCount - 1) * 3);
 		
-		*normals++ = [[_cuted objectAtIndex:1] floatValue];
-		*normals++ = [[_cuted objectAtIndex:2] floatValue];
-		*normals = [[_cuted objectAtIndex:3] floatValue];
+		nglParseFloat(tokens[1], end, normals++);
+		nglParseFloat(tokens[2], end, normals++);
+		nglParseFloat(tokens[3], end, normals);
 	}
 	//*************************
 	//	g - Group
 	//*************************
-	else if (strcmp(_prefix, "g") == 0)
+	else if (objTokenIsTag(prefix, prefixLength, "g"))
 	{
 		// Creates a new group based on current structure.
-		[self updateGroups];
+		objAddRecord(chunk, OBJRecordGroup);
 	}
 	//*************************
 	//	usemtl - Use Material
 	//*************************
-	else if (strcmp(_prefix, "usemtl") == 0)
+	else if (objTokenIsTag(prefix, prefixLength, "usemtl"))
 	{
 		// Checks for multiple materials.
-		if (_cutedCount > 2)
+		if (count > 2)
 		{
-			_error.message = [NSString stringWithFormat:OBJ_ERROR_MULTIPLE_MTL, (unsigned int)_lines];
+			objAddRecord(chunk, OBJRecordError)->message = OBJ_ERROR_MULTIPLE_MTL;
 		}
 		
-		// Mark the material to be used in a specific place into array of indices.
-		[_mtlParser useMaterialWithName:[_cuted objectAtIndex:1] starting:_facesCount];
+		// The materials are processed later on, in the file order. Keeps the names from the file bytes.
+		record = objAddRecord(chunk, OBJRecordMaterial);
+		record->bytes = tokens[1];
+		record->length = (UInt32)(end - tokens[1]);
 	}
 	//*************************
 	//	mtllib - Material Lib
 	//*************************
-	else if (strcmp(_prefix, "mtllib") == 0)
+	else if (objTokenIsTag(prefix, prefixLength, "mtllib"))
+	{
+		// The material libraries are loaded later on, in the file order.
+		record = objAddRecord(chunk, OBJRecordLibrary);
+		record->bytes = tokens[1];
+		record->length = (UInt32)(end - tokens[1]);
+	}
+}
+
+// Parses all the lines in a chunk. This function can run concurrently with other chunks.
+// The chunks only sum their bytes to the loaded ones, the loaded data is computed from them when it's read.
+static void objParseChunk(OBJChunk *chunk, BOOL *canceled, int64_t *loaded)
+{
+	const char *cursor = chunk->start;
+	const char *progress = cursor;
+	const char *line;
+	UInt32 length;
+	
+	while (cursor < chunk->end)
 	{
-		NSMutableString *fullName = [[NSMutableString alloc] init];
+		// Canceled status.
+		if (*canceled)
+		{
+			break;
+		}
 		
-		UInt32 i;
-		UInt32 length = _cutedCount;
-		for (i = 1; i < length; i++)
+		// Finds the end of the current line.
+		line = cursor;
+		while (cursor < chunk->end && !objIsBreak(*cursor))
 		{
-			[fullName appendString:[_cuted objectAtIndex:i]];
-			
-			// Constructs the real name for file within spaces.
-			// Multiple files could be passed at this way.
-			if ([[_cuted objectAtIndex:i] rangeOfString:@"."].length == 0)
-			{
-				[fullName appendString:@" "];
-				continue;
-			}
-			
-			[_mtlParser loadFile:[_finalPath stringByAppendingString:fullName]];
-			
-			[fullName setString:@""];
+			++cursor;
+		}
+		
+		length = (UInt32)(cursor - line);
+		
+		objParseLine(chunk, line, length);
+		
+		// Skips the line break, "\r\n" is a single line break.
+		if (cursor < chunk->end && *cursor++ == '\r' && cursor < chunk->end && *cursor == '\n')
+		{
+			++cursor;
+		}
+		
+		// Updates the loaded bytes, sums the lines length and the line break characters.
+		if (chunk->lines % OBJ_PROGRESS_LINES == 0 || cursor == chunk->end)
+		{
+			__sync_add_and_fetch(loaded, (int64_t)(cursor - progress));
+			progress = cursor;
+		}
+	}
+}
+
+// Frees all the memories allocated by a chunk.
+static void objFreeChunk(OBJChunk *chunk)
+{
+	nglFree(chunk->vertices);
+	nglFree(chunk->texcoords);
+	nglFree(chunk->normals);
+	nglFree(chunk->faces);
+	nglFree(chunk->records);
+	nglFree(chunk->tokens);
+	nglFree(chunk->tokensLength);
+}
+
+#pragma mark -
+#pragma mark Private Category
+//**************************************************
+//	Private Category
+//**************************************************
+
+@interface NGLParserOBJ()
+
+- (void) defineStride;
+- (void) updateGroups:(NGLivec3)group;
+
+- (NSUInteger) chunksCount:(NSUInteger)length;
+
+- (void) loadLibraries:(NSArray *)names;
+- (void) mergeFaces:(const int *)faces count:(UInt32)count;
+- (void) mergeChunk:(OBJChunk *)chunk;
+
+@end
+
+#pragma mark -
+#pragma mark Public Interface
+#pragma mark -
+//**********************************************************************************************************
+//
+//	Public Interface
+//
+//**********************************************************************************************************
+
+@implementation NGLParserOBJ
+
+#pragma mark -
+#pragma mark Properties
+//**************************************************
+//	Properties
+//**************************************************
+
+
+
+#pragma mark -
+#pragma mark Constructors
+//**************************************************
+//	Constructors
+//**************************************************
+
+- (id) init
+{
+	if ((self = [super init]))
+	{
+		// Allocates once.
+		if (_mtlParser == nil)
+		{
+			_mtlParser = [[NGLParserMTL alloc] init];
+		}
+	}
+	
+	return self;
+}
+
+#pragma mark -
+#pragma mark Private Methods
+//**************************************************
+//	Private Methods
+//**************************************************
+
+- (void) defineStride
+{
+	_stride = 0;
+	
+	// Defines the vertex element as a 4 floats.
+	[_meshElements addElement:(NGLElement){NGLComponentVertex, _stride, 4, 0}];
+	_stride = 4;
+	
+	// Defines the texture coordinate element as a 2 floats, if needed.
+	if (_tCount > 0)
+	{
+		[_meshElements addElement:(NGLElement){NGLComponentTexcoord, _stride, 2, 1}];
+		_stride += 2;
+	}
+	
+	// Defines the normal element as a 3 floats, if needed.
+	if (_nCount > 0)
+	{
+		[_meshElements addElement:(NGLElement){NGLComponentNormal, _stride, 3, 2}];
+		_stride += 3;
+	}
+	
+	_sCache = NO;
+}
+
+- (NSUInteger) chunksCount:(NSUInteger)length
+{
+	NSUInteger count = 1;
+	
+#ifdef NGL_MULTITHREADING
+	// Large files are split in one chunk per worker of the job system.
+	count = MIN(nglJobWorkers(), length / OBJ_CHUNK_SIZE);
+	count = MAX(count, 1);
+#endif
+	
+	return count;
+}
+
+- (void) updateGroups:(NGLivec3)group
+{
+	[_faceStore removeAllObjects];
+	
+	_groups = realloc(_groups, (_gCount + 1) * NGL_SIZE_IVEC3);
+	
+	// Stores the index/stride to the current group elements.
+	_groups[_gCount] = group;
+	
+	// Sets the current group index, which will be used in the faces processing.
+	_currentGrp = _gCount;
+	
+	++_gCount;
+}
+
+- (void) loadLibraries:(NSArray *)names
+{
+	NSMutableString *fullName = [[NSMutableString alloc] init];
+	
+	for (NSString *name in names)
+	{
+		[fullName appendString:name];
+		
+		// Constructs the real name for file within spaces.
+		// Multiple files could be passed at this way.
+		if ([name rangeOfString:@"."].length == 0)
+		{
+			[fullName appendString:@" "];
+			continue;
 		}
 		
-		nglRelease(fullName);
+		[_mtlParser loadFile:[_finalPath stringByAppendingString:fullName]];
+		
+		[fullName setString:@""];
+	}
+	
+	nglRelease(fullName);
+}
+
+- (void) mergeFaces:(const int *)faces count:(UInt32)count
+{
+	UInt32 *final;
+	NGLivec3 vGroup;
+	UInt32 i;
+	
+	if (count == 0)
+	{
+		return;
+	}
+	
+	_faces = objGrow(_faces, &_fCapacity, (_facesCount + count) * _facesStride, NGL_SIZE_INT);
+	
+	// Prepares the pointer to work with the new faces.
+	final = _faces + (_facesCount * _facesStride);
+	vGroup = (_groups != NULL) ? _groups[_currentGrp] : kNGLivec3Zero;
+	
+	// Deals with 3DS MAX negative face indexing and adjusts the index, OBJ index starts at 1.
+	for (i = 0; i < count; ++i)
+	{
+		*final++ = faces[0] + (faces[0] < 0 ? vGroup.x : -1);
+		*final++ = faces[1] + (faces[1] < 0 ? vGroup.y : -1);
+		*final++ = faces[2] + (faces[2] < 0 ? vGroup.z : -1);
+		faces += 3;
+	}
+	
+	_facesCount += count;
+	
+	// Updates the length of the current surface.
+	[_mtlParser updateSurfaceLengthBy:count];
+}
+
+- (void) mergeChunk:(OBJChunk *)chunk
+{
+	// The chunk counts are local, the bases place them in the whole file.
+	UInt32 vBase = _vCount;
+	UInt32 tBase = _tCount;
+	UInt32 nBase = _nCount;
+	UInt32 lBase = _lines;
+	UInt32 merged = 0;
+	UInt32 i;
+	OBJRecord *record;
+	NSString *string;
+	NSArray *names;
+	
+	// Appends the elements, they don't need any fix up.
+	_vertices = objGrow(_vertices, &_vCapacity, _vCount + chunk->vCount, NGL_SIZE_VEC4);
+	memcpy(_vertices + (_vCount * 4), chunk->vertices, chunk->vCount * NGL_SIZE_VEC4);
+	_vCount += chunk->vCount;
+	
+	_texcoords = objGrow(_texcoords, &_tCapacity, _tCount + chunk->tCount, NGL_SIZE_VEC2);
+	memcpy(_texcoords + (_tCount * 2), chunk->texcoords, chunk->tCount * NGL_SIZE_VEC2);
+	_tCount += chunk->tCount;
+	
+	_normals = objGrow(_normals, &_nCapacity, _nCount + chunk->nCount, NGL_SIZE_VEC3);
+	memcpy(_normals + (_nCount * 3), chunk->normals, chunk->nCount * NGL_SIZE_VEC3);
+	_nCount += chunk->nCount;
+	
+	// Replays the records in the file order, fixing up the faces between them.
+	for (i = 0; i < chunk->rCount; ++i)
+	{
+		record = &chunk->records[i];
+		
+		[self mergeFaces:chunk->faces + (merged * 3) count:record->facesCount - merged];
+		merged = record->facesCount;
+		
+		switch (record->type)
+		{
+			case OBJRecordGroup:
+				[self updateGroups:(NGLivec3){vBase + record->vCount,
+											  tBase + record->tCount,
+											  nBase + record->nCount}];
+				break;
+			case OBJRecordError:
+				_error.message = [NSString stringWithFormat:record->message, lBase + record->line];
+				break;
+			case OBJRecordMaterial:
+			case OBJRecordLibrary:
+				string = [[NSString alloc] initWithBytes:record->bytes
+												  length:record->length
+												encoding:NSUTF8StringEncoding];
+				names = nglGetArray(string);
+				nglRelease(string);
+				
+				// Mark the material to be used in a specific place into array of indices.
+				if (record->type == OBJRecordMaterial)
+				{
+					[_mtlParser useMaterialWithName:[names objectAtIndex:0] starting:_facesCount];
+				}
+				else
+				{
+					[self loadLibraries:names];
+				}
+				break;
+		}
 	}
+	
+	// Merges the faces after the last record.
+	[self mergeFaces:chunk->faces + (merged * 3) count:chunk->facesCount - merged];
+	
+	_lines += chunk->lines;
 }
 
 #pragma mark -
@@ -391,35 +748,61 @@ static NGLivec3 objFaceToVector(const char *cFace)
 	_vCount = _tCount = _nCount = 0;
 	_gCount = _facesCount = 0;
 	_facesStride = 3;
+	_vCapacity = _tCapacity = _nCapacity = _fCapacity = 0;
 	_finalPath = [nglGetPath(nglMakePath(named)) retain];
 	
 	// Sets the error header.
 	_error.header = [NSString stringWithFormat:OBJ_ERROR_HEADER, named];
 	
-	// Loads the OBJ source.
-	NSString *source = nglSourceFromFile(named);
+	// Maps the OBJ file into the memory, the bytes are paged in on demand.
+	NSData *source = nglMappedDataFromFile(named);
+	const char *bytes = [source bytes];
+	const char *end = bytes + [source length];
+	const char *cursor = bytes;
+	NSUInteger length = [source length];
+	NSUInteger i, count = [self chunksCount:length];
 	
 	// Gets total data.
-	_loadedData = 0;
-	_totalData = [source length];
-	double lineBreak = 0;
-	lineBreak += [source rangeOfString:@"\n"].length;
-	lineBreak += [source rangeOfString:@"\v"].length;
-	lineBreak += [source rangeOfString:@"\f"].length;
-	lineBreak += [source rangeOfString:@"\r"].length;
-	
-	// Processing the loop on every line.
-	// iOS 4.0 or later support a faster and more direct enumeration method.
-	[source enumerateLinesUsingBlock:^(NSString *line, BOOL *stop)
+	_loadedBytes = 0;
+	_totalData = length;
+	
+	// Splits the file bytes into line aligned chunks.
+	OBJChunk *chunks = calloc(count, sizeof(OBJChunk));
+	for (i = 0; i < count; ++i)
 	{
-		// Canceled status.
-		*stop = _canceled;
+		chunks[i].start = cursor;
 		
-		// Updates the loaded data, sums the line length and the line break character.
-		_loadedData += [line length] + lineBreak;
+		if (i == count - 1)
+		{
+			cursor = end;
+		}
+		else
+		{
+			cursor = MAX(cursor, bytes + (length * (i + 1) / count));
+			cursor = memchr(cursor, '\n', end - cursor);
+			cursor = (cursor != NULL) ? cursor + 1 : end;
+		}
 		
-		[self processLine:line];
-	}];
+		chunks[i].end = cursor;
+	}
+	
+	// Parses all the chunks concurrently. The chunks don't touch this instance, just the monitors.
+	BOOL *canceled = &_canceled;
+	int64_t *loadedBytes = &_loadedBytes;
+	
+	nglJobFor((UInt32)count, ^(UInt32 index)
+	{
+		objParseChunk(&chunks[index], canceled, loadedBytes);
+	});
+	
+	// Merges the chunks in the file order, it produces exactly the same result of a serial parsing.
+	for (i = 0; i < count; ++i)
+	{
+		[self mergeChunk:&chunks[i]];
+		objFreeChunk(&chunks[i]);
+	}
+	
+	nglFree(chunks);
 	
 	// Calculates the structure count and stride.
 	[self defineStride];
@@ -427,7 +810,7 @@ static NGLivec3 objFaceToVector(const char *cFace)
 	// Creates a default group if no group exist.
 	if (_gCount == 0)
 	{
-		[self updateGroups];
+		[self updateGroups:(NGLivec3){_vCount, _tCount, _nCount}];
 	}
 	
 	//  Checks for faces count.
@@ -456,6 +839,15 @@ static NGLivec3 objFaceToVector(const char *cFace)
 	nglRelease(_finalPath);
 }
 
+- (float) loadedData
+{
+	// While the chunks are parsed, only the loaded bytes are up to date.
+	double data = (double)__sync_add_and_fetch(&_loadedBytes, 0);
+	
+	data = (data / _totalData * 0.8) + (_parsedData / _totalParsedData * 0.2);
+	return (float)data;
+}
+
 - (NGLMaterialMulti *) material
 {
 	return [_mtlParser materials];
@@ -481,4 +873,4 @@ static NGLivec3 objFaceToVector(const char *cFace)
 	[super dealloc];
 }
 
-@end
\ No newline at end of file
+@end
@@ -59,6 +59,21 @@
  */
 NGL_API void nglConstructShaders(NGLShaders *shaders, NGLMaterial *material, NGLMesh *mesh);
 
+/*!
+ *					<strong>(Internal only)</strong> Checks if the instances of a mesh are drawn in batches.
+ *
+ *					Without the instanced arrays, the instances are drawn in batches of NGL_INSTANCE_BATCH
+ *					copies of the mesh, each copy takes the matrix and the color of its instance from an
+ *					array of uniforms. The dynamic meshes and the skinned ones draw each instance alone,
+ *					their vertices change and the joints' palette fills the uniforms.
+ *
+ *	@param			mesh
+ *					The NGLMesh with the instances.
+ *
+ *	@result			A BOOL indicating if the instances are drawn in batches.
+ */
+NGL_API BOOL nglInstancesBatched(NGLMesh *mesh);
+
 NGL_API void nglPrepareTelemetryShaders(NGLShaders *shaders, void *data);
 
 /*!
@@ -21,6 +21,7 @@
  */
 
 #import "NGLSLConstructor.h"
+#import "NGLES2Functions.h"
 
 #pragma mark -
 #pragma mark Constants
@@ -111,6 +112,94 @@ NGLSLStrings FSH_TELEMETRY =
 	gl_FragColor = u_nglTelemetry;"
 };
 
+#pragma mark -
+#pragma mark Model (Instances & Skin)
+//**************************************************
+//	Model (Instances & Skin)
+//**************************************************
+
+// The instances and the skin build a matrix to each vertex, which places it in the mesh's space.
+// Their bodies come first, so the next bodies use the vertices already placed in the mesh's space.
+NGLSLStrings VSH_MODEL =
+{
+	// Header.
+	@"\
+	highp mat4 _nglModel = mat4(1.0);\n",
+	
+	// Body.
+	@"\
+	#define a_nglPosition (_nglModel * a_nglPosition)\n\
+	#define a_nglNormal (_nglModel * vec4(a_nglNormal, 0.0)).xyz\n\
+	#define a_nglTangent (_nglModel * vec4(a_nglTangent, 0.0)).xyz\n\
+	#define a_nglBitangent (_nglModel * vec4(a_nglBitangent, 0.0)).xyz\n"
+};
+
+// The instanced attributes are not NGLSLVariable, their buffer is set by the polygon at each draw.
+NGLSLStrings VSH_INSTANCE =
+{
+	// Header.
+	@"\
+	attribute highp mat4 a_nglInstance;\n\
+	attribute lowp vec4 a_nglInstanceColor;\n\
+	varying lowp vec4 v_nglInstanceColor;\n",
+	
+	// Body.
+	@"\
+	_nglModel = a_nglInstance * _nglModel;\n\
+	v_nglInstanceColor = a_nglInstanceColor;\n"
+};
+
+// Without the instanced arrays, each vertex of a batch knows its copy, whose instance takes five vectors of the
+// uniforms. The header is a format, it receives the number of vectors.
+NGLSLStrings VSH_INSTANCE_BATCH =
+{
+	// Header.
+	@"\
+	uniform highp vec4 u_nglInstances[%u];\n\
+	attribute highp float a_nglInstanceIndex;\n\
+	varying lowp vec4 v_nglInstanceColor;\n",
+	
+	// Body.
+	@"\
+	int _nglInstance = int(a_nglInstanceIndex) * 5;\n\
+	_nglModel = mat4(u_nglInstances[_nglInstance], u_nglInstances[_nglInstance + 1],\n\
+					 u_nglInstances[_nglInstance + 2], u_nglInstances[_nglInstance + 3]) * _nglModel;\n\
+	v_nglInstanceColor = u_nglInstances[_nglInstance + 4];\n"
+};
+
+NGLSLStrings FSH_INSTANCE =
+{
+	// Header.
+	@"\
+	varying lowp vec4 v_nglInstanceColor;\n",
+	
+	// Body.
+	@"\
+	gl_FragColor *= v_nglInstanceColor;\n"
+};
+
+NGLSLVariable UNI_JOINTS = { NO, @"u_nglJoints", 0, 1, NGL_MAT4, 0, NULL, NULL };
+NGLSLVariable ATT_BONE_INDEX = { YES, @"a_nglBoneIndex", 0, 4, NGL_FLOAT, 0, NULL, NULL };
+NGLSLVariable ATT_BONE_WEIGHT = { YES, @"a_nglBoneWeight", 0, 4, NGL_FLOAT, 0, NULL, NULL };
+
+// The header is a format, it receives the number of joints. The weights missing to 1.0 stay at the rest pose.
+NGLSLStrings VSH_SKIN =
+{
+	// Header.
+	@"\
+	uniform highp mat4 u_nglJoints[%u];\n\
+	attribute highp vec4 a_nglBoneIndex;\n\
+	attribute mediump vec4 a_nglBoneWeight;\n",
+	
+	// Body.
+	@"\
+	_nglModel = u_nglJoints[int(a_nglBoneIndex.x)] * a_nglBoneWeight.x +\n\
+				u_nglJoints[int(a_nglBoneIndex.y)] * a_nglBoneWeight.y +\n\
+				u_nglJoints[int(a_nglBoneIndex.z)] * a_nglBoneWeight.z +\n\
+				u_nglJoints[int(a_nglBoneIndex.w)] * a_nglBoneWeight.w +\n\
+				mat4(1.0 - dot(a_nglBoneWeight, vec4(1.0)));\n"
+};
+
 #pragma mark -
 #pragma mark UV Map (Texcoord)
 //**************************************************
@@ -635,6 +724,24 @@ static void addShaderElement(NGLSLStrings element, NGLSLSource *shader)
 	[shader addBody:element.body mode:NGLSLAddModePrepend];
 }
 
+// Sets the buffer layout of an attribute. The packed vertices replace the array of structures when they exist.
+static void defineAttribute(NGLSLVariable *variable, NGLElement *element, UInt32 stride, UInt32 packed)
+{
+	if (packed > 0)
+	{
+		(*variable).stride = packed;
+		(*variable).count = (*element).size;
+		(*variable).format = (*element).format;
+		(*variable).data = (void *)(UInt64)(*element).offset;
+	}
+	else
+	{
+		(*variable).stride = stride;
+		(*variable).count = (*element).length;
+		(*variable).data = (void *)(UInt64)((*element).start * NGL_SIZE_FLOAT);
+	}
+}
+
 #pragma mark -
 #pragma mark Public Functions
 //**********************************************************************************************************
@@ -645,7 +752,7 @@ static void addShaderElement(NGLSLStrings element, NGLSLSource *shader)
 
 void nglConstructShaders(NGLShaders *shaders, NGLMaterial *material, NGLMesh *mesh)
 {
-	BOOL hasMap, hasNormal, hasTangent;
+	BOOL hasMap, hasNormal, hasTangent, hasSkin;
 	BOOL useMap, useNormal, useTangent, useLight;
 	BOOL alphaEnabled = (nglDefaultColorFormat == NGLColorFormatRGBA);
 	NGLShading shading;
@@ -658,6 +765,7 @@ void nglConstructShaders(NGLShaders *shaders, NGLMaterial *material, NGLMesh *me
 	NGLElement *element;
 	NGLMeshElements *elements = mesh.meshElements;
 	unsigned int stride = mesh.stride * NGL_SIZE_FLOAT;
+	unsigned int packed = [elements packedStride];
 	
 	if (shaders == nil)
 	{
@@ -672,6 +780,8 @@ void nglConstructShaders(NGLShaders *shaders, NGLMaterial *material, NGLMesh *me
 	hasMap = ([elements elementWithComponent:NGLComponentTexcoord] != NULL);
 	hasNormal = ([elements elementWithComponent:NGLComponentNormal] != NULL) && useLight;
 	hasTangent = ([elements elementWithComponent:NGLComponentTangent] != NULL) && hasNormal;
+	hasSkin = (mesh.jointsCount > 0 && [elements elementWithComponent:NGLComponentBoneIndices] != NULL &&
+			   [elements elementWithComponent:NGLComponentBoneWeights] != NULL);
 	
 	//**************************************************
 	//	Global Effects
@@ -699,6 +809,15 @@ void nglConstructShaders(NGLShaders *shaders, NGLMaterial *material, NGLMesh *me
 		addShaderElement(FSH_FOG, shaders.fragment);
 	}
 	
+	//*************************
+	//	Instances
+	//*************************
+	// The color of each instance is applied before the fog.
+	if (mesh.instancesCount > 0)
+	{
+		addShaderElement(FSH_INSTANCE, shaders.fragment);
+	}
+	
 	//*************************
 	//	Shader Technique
 	//*************************
@@ -931,17 +1050,13 @@ void nglConstructShaders(NGLShaders *shaders, NGLMaterial *material, NGLMesh *me
 		element = [elements elementWithComponent:NGLComponentTangent];
 		
 		variable = ATT_TANGENT;
-		variable.stride = stride;
-		variable.count = (*element).length;
-		variable.data = (void *)(UInt64)((*element).start * NGL_SIZE_FLOAT);
+		defineAttribute(&variable, element, stride, packed);
 		[shaders.variables addVariable:variable];
 		
 		element = [elements elementWithComponent:NGLComponentBitangent];
 		
 		variable = ATT_BITANGENT;
-		variable.stride = stride;
-		variable.count = (*element).length;
-		variable.data = (void *)(UInt64)((*element).start * NGL_SIZE_FLOAT);
+		defineAttribute(&variable, element, stride, packed);
 		[shaders.variables addVariable:variable];
 		
 		addShaderElement(VSH_TANGENT, shaders.vertex);
@@ -1004,9 +1119,7 @@ void nglConstructShaders(NGLShaders *shaders, NGLMaterial *material, NGLMesh *me
 		element = [elements elementWithComponent:NGLComponentNormal];
 		
 		variable = ATT_NORMAL;
-		variable.stride = stride;
-		variable.count = (*element).length;
-		variable.data = (void *)(UInt64)((*element).start * NGL_SIZE_FLOAT);
+		defineAttribute(&variable, element, stride, packed);
 		[shaders.variables addVariable:variable];
 		
 		addShaderElement(VSH_NORMAL, shaders.vertex);
@@ -1026,9 +1139,7 @@ void nglConstructShaders(NGLShaders *shaders, NGLMaterial *material, NGLMesh *me
 		element = [elements elementWithComponent:NGLComponentTexcoord];
 		
 		variable = ATT_MAP;
-		variable.stride = stride;
-		variable.count = (*element).length;
-		variable.data = (void *)(UInt64)((*element).start * NGL_SIZE_FLOAT);
+		defineAttribute(&variable, element, stride, packed);
 		[shaders.variables addVariable:variable];
 		
 		addShaderElement(VSH_MAP, shaders.vertex);
@@ -1047,14 +1158,55 @@ void nglConstructShaders(NGLShaders *shaders, NGLMaterial *material, NGLMesh *me
 	[shaders.variables addVariable:variable];
 	
 	variable = ATT_VERTEX;
-	variable.stride = stride;
-	variable.count = (*element).length;
-	variable.data = (void *)(UInt64)((*element).start * NGL_SIZE_FLOAT);
+	defineAttribute(&variable, element, stride, packed);
 	[shaders.variables addVariable:variable];
 	
 	// The base FSH and VSH will always exist.
 	addShaderElement(VSH_BASE, shaders.vertex);
 	addShaderElement(FSH_BASE, shaders.fragment);
+	
+	// The instances and the skin change the vertices before any other shader element.
+	// The skin comes first, it moves the vertices inside the mesh before the instances place them.
+	if (mesh.instancesCount > 0 || hasSkin)
+	{
+		addShaderElement(VSH_MODEL, shaders.vertex);
+	}
+	
+	if (mesh.instancesCount > 0 && nglInstancesBatched(mesh))
+	{
+		addShaderElement((NGLSLStrings){ [NSString stringWithFormat:VSH_INSTANCE_BATCH.header,
+										  NGL_INSTANCE_BATCH * NGL_INSTANCE_LENGTH / 4], VSH_INSTANCE_BATCH.body },
+						 shaders.vertex);
+	}
+	else if (mesh.instancesCount > 0)
+	{
+		addShaderElement(VSH_INSTANCE, shaders.vertex);
+	}
+	
+	if (hasSkin)
+	{
+		variable = UNI_JOINTS;
+		variable.count = mesh.jointsCount;
+		variable.data = mesh.palette;
+		[shaders.variables addVariable:variable];
+		
+		variable = ATT_BONE_INDEX;
+		defineAttribute(&variable, [elements elementWithComponent:NGLComponentBoneIndices], stride, packed);
+		[shaders.variables addVariable:variable];
+		
+		variable = ATT_BONE_WEIGHT;
+		defineAttribute(&variable, [elements elementWithComponent:NGLComponentBoneWeights], stride, packed);
+		[shaders.variables addVariable:variable];
+		
+		addShaderElement((NGLSLStrings){ [NSString stringWithFormat:VSH_SKIN.header, mesh.jointsCount], VSH_SKIN.body },
+						 shaders.vertex);
+	}
+}
+
+BOOL nglInstancesBatched(NGLMesh *mesh)
+{
+	return (mesh.instancesCount > 0 && mesh.jointsCount == 0 && !mesh.isDynamic &&
+			!ngles2HasExtension(@"GL_EXT_instanced_arrays"));
 }
 
 void nglPrepareTelemetryShaders(NGLShaders *shaders, void *data)
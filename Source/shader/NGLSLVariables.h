@@ -78,6 +78,10 @@
  *
  *	@var			NGLSLVariable::glFunction
  *					The pointer to the function necessary to update the variable's value inside the shader.
+ *
+ *	@var			NGLSLVariable::format
+ *					The NGLElementFormat of the dynamic values in the buffer. To static variables this
+ *					field has no effect.
  */
 typedef struct
 {
@@ -89,6 +93,7 @@ typedef struct
 	UInt32 stride;
 	void *data;
 	void *glFunction;
+	unsigned char format; // NGLElementFormat, float by default
 } NGLSLVariable;
 
 /*!
@@ -32,6 +32,53 @@
 
 // #define  NGLARRAY_THREAD_CONTENTION_DEBUG
 
+/*!
+ *					<strong>(Internal only)</strong> An immutable copy of the array values.
+ *
+ *					The snapshots are shared by all the loops until the array changes, so an array that
+ *					doesn't change doesn't allocate anything to be iterated. The snapshots of the arrays
+ *					with the retain option also retain their objects.
+ *	
+ *	@var			NGLArraySnapshot::pointers
+ *					The pointers array.
+ *	
+ *	@var			NGLArraySnapshot::count
+ *					The count/length of the array.
+ *	
+ *	@var			NGLArraySnapshot::references
+ *					The number of owners. The array owns its current snapshot and each loop owns the
+ *					snapshot it is iterating.
+ *	
+ *	@var			NGLArraySnapshot::retainOption
+ *					The retain option of the array.
+ */
+typedef struct
+{
+	void			**pointers;
+	unsigned int	count;
+	int32_t			references;
+	BOOL			retainOption;
+} NGLArraySnapshot;
+
+/*!
+ *					<strong>(Internal only)</strong> The state of a "nglForSnapshot" loop.
+ *	
+ *	@var			NGLArrayCursor::snapshot
+ *					The snapshot being iterated.
+ *	
+ *	@var			NGLArrayCursor::i
+ *					The iterator index.
+ *	
+ *	@var			NGLArrayCursor::retainItems
+ *					Indicates if the loop retained the items of a not retaining array.
+ */
+typedef struct
+{
+	NGLArraySnapshot	*snapshot;
+	unsigned int		i;
+	BOOL				retainItems;
+} NGLArrayCursor;
+
 /*!
  *					<strong>(Internal only)</strong> An object that holds the array values.
  *
@@ -52,6 +99,12 @@
  *	
  *	@var			NGLArrayValues::i
  *					The iterator index.
+ *	
+ *	@var			NGLArrayValues::snapshot
+ *					The current snapshot or NULL if the array changed after the last one.
+ *	
+ *	@var			NGLArrayValues::snapshots_count
+ *					The number of snapshots made by this array, at most one after each change.
  */
 typedef struct
 {
@@ -61,11 +114,15 @@ typedef struct
 	BOOL			retainOption;
 	void			**iterator;
 	unsigned int	i;
+	NGLArraySnapshot *snapshot;
+	unsigned int	snapshots_count;
     pthread_mutex_t mutex; // AH: Adding thread safety to all NGLArray operations.
 #ifdef NGLARRAY_THREAD_CONTENTION_DEBUG
     unsigned int    mutex_lock_count;
     NSString        *callthread;
     NSArray<NSString*> *callstack;
+    unsigned int    mutex_contentions;
+    double          mutex_wait_time;
 #endif
 } NGLArrayValues;
 
@@ -96,6 +153,52 @@ typedef struct
 #define nglFor(p, a)\
 for([a forLoop:(void **)&(p)]; [a forCheck]; p = [a nextIterator])
 
+/*!
+ *					A loop through a snapshot of a NGLArray. The array is locked just to take the snapshot,
+ *					so other threads can change the array during the loop. The changes are not seen by the
+ *					loop in progress, they will be in the next loop.
+ *
+ *					Unlike nglFor, this loop can safely end with "break" or "return". It's meant to the
+ *					arrays that are iterated much more often than changed, like the render loops. Its
+ *					syntax is the same as nglFor:
+ *
+ *					<pre>
+ *
+ *					id variable;
+ *
+ *					nglForSnapshot (variable, myNGLArray)
+ *					{
+ *					    // Do something...
+ *					}
+ *
+ *					</pre>
+ *
+ *	@param			p
+ *					A pointer that will receive the values.
+ *
+ *	@param			a
+ *					The NGLArray instance to loop through.
+ */
+#define nglForSnapshot(p, a)\
+for(NGLArrayCursor _nglCursor __attribute__((cleanup(nglArrayCursorEnd))) = nglArrayCursorStart((a), (void **)&(p));\
+	_nglCursor.i < _nglCursor.snapshot->count; p = nglArrayCursorNext(&_nglCursor))
+
+/*!
+ *					The same as nglForSnapshot, but the items are retained until the loop ends, even if the
+ *					array doesn't retain them. The items are retained with the array locked, so an item
+ *					released by another one during the loop is never freed before the loop reaches it.
+ *
+ *	@param			p
+ *					A pointer that will receive the values.
+ *
+ *	@param			a
+ *					The NGLArray instance to loop through.
+ */
+#define nglForSnapshotRetaining(p, a)\
+for(NGLArrayCursor _nglCursor __attribute__((cleanup(nglArrayCursorEnd))) =\
+	nglArrayCursorStartRetaining((a), (void **)&(p));\
+	_nglCursor.i < _nglCursor.snapshot->count; p = nglArrayCursorNext(&_nglCursor))
+
 /*!
  *					Checks if a pointer is valid or not, that means, if a pointer is really pointing to
  *					a valid object (not released nor deallocated).
@@ -154,6 +257,24 @@ NGL_API BOOL nglPointerIsValidToProtocol(void *pointer, Protocol *aProtocol);
  */
 NGL_API BOOL nglPointerIsValidToSelector(void *pointer, SEL selector);
 
+/*!
+ *					<strong>(Internal only)</strong> Releases a snapshot of a NGLArray.
+ *					You should not call this function directly.
+ *	
+ *	@param			snapshot
+ *					The snapshot. It's freed when its last owner releases it.
+ */
+NGL_API void nglArraySnapshotRelease(NGLArraySnapshot *snapshot);
+
+/*!
+ *					<strong>(Internal only)</strong> Releases the items of a snapshot retained by
+ *					NGLArray::retainSnapshotAndItems. You should not call this function directly.
+ *	
+ *	@param			snapshot
+ *					The snapshot. It's not released by this function.
+ */
+NGL_API void nglArraySnapshotReleaseItems(NGLArraySnapshot *snapshot);
+
 /*!
  *					This class is a collection that works just like an array, however it's generic for
  *					any kind of data type, including basic C types. NGLArray does not retain
@@ -233,6 +354,10 @@ NGL_API BOOL nglPointerIsValidToSelector(void *pointer, SEL selector);
  *
  *							</pre>
  *
+ *						- <b>NGLForSnapshot</b>: <i>The same cost of NGLFor while the array doesn't change</i>.<br />
+ *							Loops through a snapshot, without locking the array during the loop. Good
+ *							for the loops that run every frame while other threads change the array.
+ *
  *					The NGLArray class also provides a pointer to the items and a pointer to the
  *					mutations property. You can use them to implement your own NSFastEnumeration.
  */
@@ -460,6 +585,24 @@ NGL_API BOOL nglPointerIsValidToSelector(void *pointer, SEL selector);
  */
 - (void *) nextIterator;
 
+/*!
+ *					<strong>(Internal only)</strong> Returns the current snapshot of this array, making
+ *					one if the array changed after the last snapshot. The snapshot must be released with
+ *					nglArraySnapshotRelease. You should not call this method directly.
+ *
+ *	@result			A pointer to the snapshot.
+ */
+- (NGLArraySnapshot *) retainSnapshot;
+
+/*!
+ *					<strong>(Internal only)</strong> The same as retainSnapshot, but it also retains the
+ *					items of a not retaining array, with the array locked. The items must be released with
+ *					nglArraySnapshotReleaseItems. You should not call this method directly.
+ *
+ *	@result			A pointer to the snapshot.
+ */
+- (NGLArraySnapshot *) retainSnapshotAndItems;
+
 /*!
  *					Returns an autoreleased instance of NGLArray.
  *
@@ -489,4 +632,53 @@ NGL_API BOOL nglPointerIsValidToSelector(void *pointer, SEL selector);
  */
 - (void) makeAllPointersPerformSelector:(SEL)selector;
 
-@end
\ No newline at end of file
+@end
+
+/*!
+ *					<strong>(Internal only)</strong> Starts a "nglForSnapshot" loop.
+ *					You should not call this function directly.
+ */
+NGL_INLINE NGLArrayCursor nglArrayCursorStart(NGLArray *array, void **target)
+{
+	NGLArraySnapshot *snapshot = [array retainSnapshot];
+	
+	*target = (snapshot->count > 0) ? snapshot->pointers[0] : NULL;
+	
+	return (NGLArrayCursor){ snapshot, 0, NO };
+}
+
+/*!
+ *					<strong>(Internal only)</strong> Starts a "nglForSnapshotRetaining" loop.
+ *					You should not call this function directly.
+ */
+NGL_INLINE NGLArrayCursor nglArrayCursorStartRetaining(NGLArray *array, void **target)
+{
+	NGLArraySnapshot *snapshot = [array retainSnapshotAndItems];
+	
+	*target = (snapshot->count > 0) ? snapshot->pointers[0] : NULL;
+	
+	return (NGLArrayCursor){ snapshot, 0, YES };
+}
+
+/*!
+ *					<strong>(Internal only)</strong> Iterates a "nglForSnapshot" loop.
+ *					You should not call this function directly.
+ */
+NGL_INLINE void *nglArrayCursorNext(NGLArrayCursor *cursor)
+{
+	return (++cursor->i < cursor->snapshot->count) ? cursor->snapshot->pointers[cursor->i] : NULL;
+}
+
+/*!
+ *					<strong>(Internal only)</strong> Ends a "nglForSnapshot" loop, however it ends.
+ *					You should not call this function directly.
+ */
+NGL_INLINE void nglArrayCursorEnd(NGLArrayCursor *cursor)
+{
+	if (cursor->retainItems)
+	{
+		nglArraySnapshotReleaseItems(cursor->snapshot);
+	}
+	
+	nglArraySnapshotRelease(cursor->snapshot);
+}
\ No newline at end of file
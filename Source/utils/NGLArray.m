@@ -80,7 +80,12 @@ static void nglArrayLock(NGLArrayValues *array )
         // EBUSY  = 16
         // EINVAL = 24
         NSLog(@"NGLArray Lock Contention");
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
         pthread_mutex_lock(&array->mutex);
+        
+        // The time this thread was blocked, guarded by the lock itself.
+        array->mutex_contentions++;
+        array->mutex_wait_time += CFAbsoluteTimeGetCurrent() - start;
     }
 
     array->mutex_lock_count++;
@@ -114,6 +119,43 @@ static void nglArrayUnlock(NGLArrayValues *array )
     pthread_mutex_unlock(&array->mutex);
 }
 
+// Makes an immutable copy of the current values. Must be called with the array locked.
+static NGLArraySnapshot *nglArraySnapshotCreate(NGLArrayValues *array)
+{
+	NGLArraySnapshot *snapshot = malloc(sizeof(NGLArraySnapshot));
+	unsigned int i;
+	
+	(*snapshot).count = (*array).count;
+	(*snapshot).pointers = malloc(NGL_SIZE_POINTER * MAX((*array).count, 1));
+	(*snapshot).references = 1;
+	(*snapshot).retainOption = (*array).retainOption;
+	memcpy((*snapshot).pointers, (*array).pointers, NGL_SIZE_POINTER * (*array).count);
+	
+	// The objects live until the last loop through this snapshot ends.
+	if ((*snapshot).retainOption)
+	{
+		for (i = 0; i < (*snapshot).count; ++i)
+		{
+			[(id)(*snapshot).pointers[i] retain];
+		}
+	}
+	
+	++(*array).snapshots_count;
+	
+	return snapshot;
+}
+
+// Releases the current snapshot after any change. The next loop will make a new one.
+// Must be called with the array locked.
+static void nglArraySnapshotDiscard(NGLArrayValues *array)
+{
+	if ((*array).snapshot != NULL)
+	{
+		nglArraySnapshotRelease((*array).snapshot);
+		(*array).snapshot = NULL;
+	}
+}
+
 static void nglArrayResize(NGLArrayValues *array)
 {
 	/*
@@ -178,6 +220,7 @@ static void nglArrayAddPointer(NGLArrayValues *array, void *pointer)
         
         (*array).pointers[(*array).count] = pointer;
         ++(*array).count;
+        nglArraySnapshotDiscard(array);
 
         nglArrayUnlock(array);
     }
@@ -296,6 +339,11 @@ static void nglArrayRemovePointer(NGLArrayValues *array, void *pointer)
 		*itemPtr = item;
         itemPtr++;
 	}
+	
+	if ((*array).count != length)
+	{
+		nglArraySnapshotDiscard(array);
+	}
     
     nglArrayUnlock(array);
 
@@ -354,6 +402,7 @@ static void nglArrayRemovePointerAtIndex(NGLArrayValues *array, unsigned int ind
 		// Moves the memory to ensure the integrity.
 		unsigned int endCount = (*array).count - index;
 		memmove((*array).pointers + index, (*array).pointers + index + 1, NGL_SIZE_POINTER * endCount);
+		nglArraySnapshotDiscard(array);
 	}
     nglArrayUnlock(array);
 
@@ -402,6 +451,7 @@ static void nglArrayRemoveAll(NGLArrayValues *array)
 	(*array).iterator = (*array).pointers;
 	(*array).count = 0;
 	(*array).i = 0;
+	nglArraySnapshotDiscard(array);
     
     nglArrayUnlock(array);
 	//*/
@@ -478,6 +528,39 @@ BOOL nglPointerIsValidToSelector(void *pointer, SEL selector)
 	return class_respondsToSelector(*((Class *)pointer), selector);
 }
 
+void nglArraySnapshotRelease(NGLArraySnapshot *snapshot)
+{
+	unsigned int i;
+	
+	if (__sync_sub_and_fetch(&(*snapshot).references, 1) == 0)
+	{
+		if ((*snapshot).retainOption)
+		{
+			for (i = 0; i < (*snapshot).count; ++i)
+			{
+				[(id)(*snapshot).pointers[i] release];
+			}
+		}
+		
+		free((*snapshot).pointers);
+		free(snapshot);
+	}
+}
+
+void nglArraySnapshotReleaseItems(NGLArraySnapshot *snapshot)
+{
+	unsigned int i;
+	
+	// The retaining arrays already hold their items with the snapshot.
+	if (!(*snapshot).retainOption)
+	{
+		for (i = 0; i < (*snapshot).count; ++i)
+		{
+			[(id)(*snapshot).pointers[i] release];
+		}
+	}
+}
+
 /*
  static sigjmp_buf sigjmp_env;
  
@@ -643,6 +726,8 @@ BOOL nglPointerIsValidToSelector(void *pointer, SEL selector)
 	_values.i = 0;
 	_values.capacity = 0;
 	_values.retainOption = NO;
+	_values.snapshot = NULL;
+	_values.snapshots_count = 0;
 
     // Set up a recursive mutex so code on the same thread can recursively enter.
     pthread_mutexattr_t attr;
@@ -654,6 +739,8 @@ BOOL nglPointerIsValidToSelector(void *pointer, SEL selector)
     _values.mutex_lock_count=0;
     _values.callstack=nil;
     _values.callthread = nil;
+    _values.mutex_contentions = 0;
+    _values.mutex_wait_time = 0.0;
 #endif
 
     nglArrayResize(&_values);
@@ -798,6 +885,55 @@ BOOL nglPointerIsValidToSelector(void *pointer, SEL selector)
 	}
 }
 
+- (NGLArraySnapshot *) retainSnapshot
+{
+	NGLArraySnapshot *snapshot;
+	
+	// The lock is held just to share the current snapshot, never during the loop.
+	nglArrayLock(&_values);
+	
+	if (_values.snapshot == NULL)
+	{
+		_values.snapshot = nglArraySnapshotCreate(&_values);
+	}
+	
+	snapshot = _values.snapshot;
+	__sync_fetch_and_add(&(*snapshot).references, 1);
+	
+	nglArrayUnlock(&_values);
+	
+	return snapshot;
+}
+
+- (NGLArraySnapshot *) retainSnapshotAndItems
+{
+	NGLArraySnapshot *snapshot;
+	unsigned int i;
+	
+	// The items are retained before the lock is released, while they are surely in the array.
+	nglArrayLock(&_values);
+	
+	if (_values.snapshot == NULL)
+	{
+		_values.snapshot = nglArraySnapshotCreate(&_values);
+	}
+	
+	snapshot = _values.snapshot;
+	__sync_fetch_and_add(&(*snapshot).references, 1);
+	
+	if (!(*snapshot).retainOption)
+	{
+		for (i = 0; i < (*snapshot).count; ++i)
+		{
+			[(id)(*snapshot).pointers[i] retain];
+		}
+	}
+	
+	nglArrayUnlock(&_values);
+	
+	return snapshot;
+}
+
 - (void) resetIterator
 {
 	_values.i = 0;
@@ -34,7 +34,8 @@
 
 #define DBG_SIZE		45
 
-static NSString *const DBG_MONITOR = @"NinevehGL Stats - %@\n• Polys: %@    • Verts: %@    • FPS: %.1f";
+// The polys are the drawn ones, with the levels of detail and the culled clusters, followed by the full ones.
+static NSString *const DBG_MONITOR = @"NinevehGL Stats - %@\n• Polys: %@/%@    • Verts: %@    • FPS: %.1f";
 
 static NSString *const DBG_ALL = @"Entire Application";
 
@@ -146,6 +147,7 @@ typedef enum
 	NSString *mode;
 	NSArray *array;
 	unsigned int triangles = 0;
+	unsigned int drawn = 0;
 	unsigned int vertices = 0;
 	float frames = nglDefaultFPS / (float)(CFAbsoluteTimeGetCurrent() - _time);
 	
@@ -173,6 +175,7 @@ typedef enum
 			if (mesh.visible)
 			{
 				triangles += mesh.indicesCount / 3;
+				drawn += mesh.drawnIndicesCount / 3;
 				vertices += mesh.structuresCount / ((mesh.stride > 0) ? mesh.stride : 1);
 			}
 		}
@@ -183,6 +186,7 @@ typedef enum
 		mode = DBG_MESH;
 		
 		triangles += _mesh.indicesCount / 3;
+		drawn += _mesh.drawnIndicesCount / 3;
 		vertices += _mesh.structuresCount / ((_mesh.stride > 0) ? _mesh.stride : 1);
 	}
 	// Tracks the stats for all visible meshes in the application.
@@ -197,6 +201,7 @@ typedef enum
 			if (mesh.visible)
 			{
 				triangles += mesh.indicesCount / 3;
+				drawn += mesh.drawnIndicesCount / 3;
 				vertices += mesh.structuresCount / ((mesh.stride > 0) ? mesh.stride : 1);
 			}
 		}
@@ -204,11 +209,12 @@ typedef enum
 	
 	// Converts the numbers to an user friendly notation.
 	NSString *tri = [_format stringFromNumber:[NSNumber numberWithInt:triangles]];
+	NSString *dra = [_format stringFromNumber:[NSNumber numberWithInt:drawn]];
 	NSString *ver = [_format stringFromNumber:[NSNumber numberWithInt:vertices]];
 	
 	// Updates the debug text.
 	nglRelease(_text);
-	_text = [[NSString alloc] initWithFormat:DBG_MONITOR, mode, tri, ver, frames];
+	_text = [[NSString alloc] initWithFormat:DBG_MONITOR, mode, dra, tri, ver, frames];
 	
 	// Main Thread.
 	[self performSelectorOnMainThread:@selector(uikitAction:)
@@ -8,7 +8,524 @@
 
 #import <UIKit/UIKit.h>
 #import <XCTest/XCTest.h>
+#import <sys/resource.h>
 #import "NinevehGL.h"
+#import "NGLParserNGL.h"
+#import "NGLParserOBJ.h"
+#import "NGLParserDAE.h"
+#import "NGLES2Mesh.h"
+
+#define kCodecStride 12
+#define kCodecVertices 100000
+
+// Fills a typical structure: position (w = 1), texcoord, normal and tangent, all normalized vectors.
+static float *codecStructures(NGLMeshElements *elements)
+{
+    float *structures = malloc(kCodecVertices * kCodecStride * sizeof(float));
+    float *vertex;
+    float length;
+    int i, j;
+    
+    srand(3);
+    for (i = 0; i < kCodecVertices; ++i) {
+        vertex = structures + i * kCodecStride;
+        
+        for (j = 0; j < kCodecStride; ++j) {
+            vertex[j] = (rand() / (float)RAND_MAX) * 2.0f - 1.0f;
+        }
+        
+        vertex[0] *= 50.0f;
+        vertex[1] *= 20.0f;
+        vertex[2] = vertex[2] * 5.0f + 10.0f;
+        vertex[3] = 1.0f;
+        
+        for (j = 6; j < kCodecStride; j += 3) {
+            length = sqrtf(vertex[j] * vertex[j] + vertex[j + 1] * vertex[j + 1] + vertex[j + 2] * vertex[j + 2]);
+            vertex[j] /= length;
+            vertex[j + 1] /= length;
+            vertex[j + 2] /= length;
+        }
+    }
+    
+    [elements addElement:(NGLElement){NGLComponentVertex, 0, 4, 0}];
+    [elements addElement:(NGLElement){NGLComponentTexcoord, 4, 2, 1}];
+    [elements addElement:(NGLElement){NGLComponentNormal, 6, 3, 2}];
+    [elements addElement:(NGLElement){NGLComponentTangent, 9, 3, 3}];
+    
+    return structures;
+}
+
+// Writes a triangle OBJ file in a temporary folder and parses it.
+static NGLParserOBJ *cacheSource(NSString *folder, float x, NSString **path)
+{
+    NSString *directory = [NSTemporaryDirectory() stringByAppendingPathComponent:folder];
+    NSString *obj = [NSString stringWithFormat:@"v %f 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", x];
+    
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES
+                                               attributes:nil error:nil];
+    *path = [directory stringByAppendingPathComponent:@"mesh.obj"];
+    [obj writeToFile:*path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    
+    return [[NGLParserOBJ alloc] initWithFile:*path];
+}
+
+// A heightfield grid with texture coordinates and without normals, to exercise the tangent space.
+@interface NGLGridMesh : NGLParserMesh
+- (id) initWithSize:(UInt32)size;
+- (float *) positions;
+- (UInt32) corner:(UInt32)index;
+- (void) shuffle;
+@end
+
+@implementation NGLGridMesh
+
+- (id) initWithSize:(UInt32)size {
+    if ((self = [super init])) {
+        UInt32 row = size + 1;
+        UInt32 x, y, i = 0;
+        UInt32 *face;
+        
+        _vCount = _tCount = row * row;
+        _vertices = malloc(_vCount * 3 * sizeof(float));
+        _texcoords = malloc(_tCount * 2 * sizeof(float));
+        
+        for (y = 0; y < row; ++y) {
+            for (x = 0; x < row; ++x, ++i) {
+                _vertices[i * 3] = x;
+                _vertices[i * 3 + 1] = sinf(x * 0.3f) * cosf(y * 0.2f);
+                _vertices[i * 3 + 2] = y;
+                _texcoords[i * 2] = x / (float)size;
+                _texcoords[i * 2 + 1] = y / (float)size;
+            }
+        }
+        
+        // Two triangles per quad, the vertex and the texcoord of a face vertex have the same index.
+        _stride = 5;
+        _facesStride = 2;
+        _facesCount = size * size * 6;
+        _faces = malloc(_facesCount * _facesStride * sizeof(UInt32));
+        face = _faces;
+        
+        for (y = 0; y < size; ++y) {
+            for (x = 0; x < size; ++x) {
+                UInt32 a = y * row + x;
+                UInt32 corners[6] = { a, a + row, a + 1, a + 1, a + row, a + row + 1 };
+                
+                for (i = 0; i < 6; ++i) {
+                    *face++ = corners[i];
+                    *face++ = corners[i];
+                }
+            }
+        }
+        
+        [_meshElements addElement:(NGLElement){NGLComponentVertex, 0, 3, 0}];
+        [_meshElements addElement:(NGLElement){NGLComponentTexcoord, 3, 2, 1}];
+    }
+    
+    return self;
+}
+
+- (float *) positions {
+    return _vertices;
+}
+
+- (UInt32) corner:(UInt32)index {
+    return _faces[index * _facesStride];
+}
+
+// Shuffles the triangles, like the meshes scanned or exported from CAD applications.
+- (void) shuffle {
+    UInt32 i, j, size = _facesStride * 3 * sizeof(UInt32);
+    UInt32 *swap = malloc(size);
+    
+    srand(5);
+    for (i = _facesCount / 3 - 1; i > 0; --i) {
+        j = rand() % (i + 1);
+        memcpy(swap, _faces + i * _facesStride * 3, size);
+        memcpy(_faces + i * _facesStride * 3, _faces + j * _facesStride * 3, size);
+        memcpy(_faces + j * _facesStride * 3, swap, size);
+    }
+    
+    free(swap);
+}
+
+- (void) dealloc {
+    free(_faces);
+    free(_vertices);
+    free(_texcoords);
+    free(_normals);
+}
+
+@end
+
+// The private stages of the parsing, overridden by the tests.
+@interface NGLParserMesh (NGLTests)
+- (void) optimizeStructure;
+@end
+
+// A grid canceled right after its structure is built, just before it's optimized.
+@interface NGLCancelingGridMesh : NGLGridMesh
+@end
+
+@implementation NGLCancelingGridMesh
+
+- (void) optimizeStructure {
+    [self cancelLoading];
+    [super optimizeStructure];
+}
+
+@end
+
+// Writes a grid of quads to a temporary OBJ file, with a group every 64 rows. Returns its path.
+static NSString *gridSource(UInt32 size, NSString *name)
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:name];
+    NSMutableData *data = [NSMutableData data];
+    UInt32 x, y, row = size + 1;
+    char buffer[128];
+    int length;
+    
+    for (y = 0; y < row; ++y) {
+        for (x = 0; x < row; ++x) {
+            length = sprintf(buffer, "v %u %.6f %u\nvt %.6f %.6f\n", x, sinf(x * 0.3f) * cosf(y * 0.2f), y,
+                             x / (float)size, y / (float)size);
+            [data appendBytes:buffer length:length];
+        }
+    }
+    
+    for (y = 0; y < size; ++y) {
+        if (y % 64 == 0) {
+            length = sprintf(buffer, "g rows%u\n", y);
+            [data appendBytes:buffer length:length];
+        }
+        
+        for (x = 0; x < size; ++x) {
+            UInt32 a = y * row + x + 1;
+            length = sprintf(buffer, "f %u/%u %u/%u %u/%u %u/%u\n", a, a, a + row, a + row,
+                             a + row + 1, a + row + 1, a + 1, a + 1);
+            [data appendBytes:buffer length:length];
+        }
+    }
+    
+    [data writeToFile:path atomically:YES];
+    
+    return path;
+}
+
+// The private stages of the OBJ parsing, overridden by the tests.
+@interface NGLParserOBJ (NGLTests)
+- (NSUInteger) chunksCount:(NSUInteger)length;
+@end
+
+static NSUInteger _chunks;
+
+// An OBJ parser that splits any file in a fixed number of chunks.
+@interface NGLChunkingOBJ : NGLParserOBJ
+@end
+
+@implementation NGLChunkingOBJ
+
+- (NSUInteger) chunksCount:(NSUInteger)length {
+    return _chunks;
+}
+
+@end
+
+// An OBJ parser that stops right after the tokenizing, without building the structure.
+@interface NGLTokenizingOBJ : NGLChunkingOBJ
+@end
+
+@implementation NGLTokenizingOBJ
+
+- (void) defineStructure {
+}
+
+@end
+
+// Tokenizes an OBJ source like NGLParserOBJ did before the mapped bytes, with NSString lines and tokens.
+// Returns the number of values read.
+static UInt32 stringTokenize(NSString *source)
+{
+    __block UInt32 values = 0;
+    __block float sum = 0.0f;
+    
+    [source enumerateLinesUsingBlock:^(NSString *line, BOOL *stop) {
+        if ([line length] < 3 || [line hasPrefix:@"#"]) {
+            return;
+        }
+        
+        NSArray *tokens = nglGetArray(line);
+        const char *prefix = [[[tokens objectAtIndex:0] lowercaseString] UTF8String];
+        NSUInteger i;
+        
+        if (strcmp(prefix, "f") == 0) {
+            for (i = 1; i < [tokens count]; ++i) {
+                for (NSString *index in [[tokens objectAtIndex:i] componentsSeparatedByString:@"/"]) {
+                    sum += [index intValue];
+                    ++values;
+                }
+            }
+        } else if (strcmp(prefix, "v") == 0 || strcmp(prefix, "vt") == 0 || strcmp(prefix, "vn") == 0) {
+            for (i = 1; i < [tokens count]; ++i) {
+                sum += [[tokens objectAtIndex:i] floatValue];
+                ++values;
+            }
+        }
+    }];
+    
+    return (sum != 0.0f) ? values : 0;
+}
+
+// Appends a formatted piece of text to a file being written.
+static void appendText(NSMutableData *data, NSString *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    NSString *text = [[NSString alloc] initWithFormat:format arguments:args];
+    va_end(args);
+    
+    [data appendData:[text dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+// Writes a COLLADA file to a temporary folder, with a number of grid geometries placed side by side.
+// Each geometry has positions, texcoords and two <triangles>, one to each half of the grid. Returns its path.
+static NSString *colladaSource(UInt32 geometries, UInt32 size, NSString *name)
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:name];
+    NSMutableData *data = [NSMutableData data];
+    UInt32 g, x, y, row = size + 1, half = size / 2;
+    char buffer[64];
+    int length;
+    
+    appendText(data, @"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+               "<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\">\n"
+               "<asset><up_axis>Y_UP</up_axis></asset>\n<library_geometries>\n");
+    
+    for (g = 0; g < geometries; ++g) {
+        appendText(data, @"<geometry id=\"grid%u\"><mesh>\n<source id=\"grid%u-pos\">"
+                   "<float_array id=\"grid%u-pos-array\" count=\"%u\">", g, g, g, row * row * 3);
+        for (y = 0; y < row; ++y) {
+            for (x = 0; x < row; ++x) {
+                length = sprintf(buffer, "%u %.6f %u ", x, sinf((x + g) * 0.3f) * cosf(y * 0.2f), y);
+                [data appendBytes:buffer length:length];
+            }
+        }
+        
+        appendText(data, @"</float_array><technique_common><accessor source=\"#grid%u-pos-array\" count=\"%u\" "
+                   "stride=\"3\"><param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/>"
+                   "<param name=\"Z\" type=\"float\"/></accessor></technique_common></source>\n"
+                   "<source id=\"grid%u-uv\"><float_array id=\"grid%u-uv-array\" count=\"%u\">",
+                   g, row * row, g, g, row * row * 2);
+        for (y = 0; y < row; ++y) {
+            for (x = 0; x < row; ++x) {
+                length = sprintf(buffer, "%.6f %.6f ", x / (float)size, y / (float)size);
+                [data appendBytes:buffer length:length];
+            }
+        }
+        
+        appendText(data, @"</float_array><technique_common><accessor source=\"#grid%u-uv-array\" count=\"%u\" "
+                   "stride=\"2\"><param name=\"S\" type=\"float\"/><param name=\"T\" type=\"float\"/>"
+                   "</accessor></technique_common></source>\n<vertices id=\"grid%u-vtx\">"
+                   "<input semantic=\"POSITION\" source=\"#grid%u-pos\"/></vertices>\n", g, row * row, g, g);
+        
+        for (UInt32 part = 0; part < 2; ++part) {
+            appendText(data, @"<triangles count=\"%u\"><input semantic=\"VERTEX\" source=\"#grid%u-vtx\" "
+                       "offset=\"0\"/><input semantic=\"TEXCOORD\" source=\"#grid%u-uv\" offset=\"1\"/><p>",
+                       half * size * 2, g, g);
+            for (y = part * half; y < (part + 1) * half; ++y) {
+                for (x = 0; x < size; ++x) {
+                    UInt32 a = y * row + x;
+                    length = sprintf(buffer, "%u %u %u %u %u %u %u %u %u %u %u %u ", a, a, a + row, a + row,
+                                     a + 1, a + 1, a + 1, a + 1, a + row, a + row, a + row + 1, a + row + 1);
+                    [data appendBytes:buffer length:length];
+                }
+            }
+            
+            appendText(data, @"</p></triangles>\n");
+        }
+        
+        appendText(data, @"</mesh></geometry>\n");
+    }
+    
+    appendText(data, @"</library_geometries>\n<library_visual_scenes><visual_scene id=\"scene\">\n");
+    for (g = 0; g < geometries; ++g) {
+        appendText(data, @"<node id=\"node%u\"><translate>%u 0 0</translate>"
+                   "<instance_geometry url=\"#grid%u\"/></node>\n", g, g * (size + 1), g);
+    }
+    
+    appendText(data, @"</visual_scene></library_visual_scenes>\n"
+               "<scene><instance_visual_scene url=\"#scene\"/></scene>\n</COLLADA>\n");
+    [data writeToFile:path atomically:YES];
+    
+    return path;
+}
+
+static NSDate *_parseStart;
+static double _firstGeometry;
+
+// A COLLADA parser that takes the time when the first geometry is entirely read.
+@interface NGLTimingDAE : NGLParserDAE
+@end
+
+@implementation NGLTimingDAE
+
+- (void) parser:(NSXMLParser *)parser
+  didEndElement:(NSString *)element
+   namespaceURI:(NSString *)namespace
+  qualifiedName:(NSString *)name {
+    [super parser:parser didEndElement:element namespaceURI:namespace qualifiedName:name];
+    
+    if (_firstGeometry == 0.0 && [element isEqualToString:@"geometry"]) {
+        _firstGeometry = -[_parseStart timeIntervalSinceNow];
+    }
+}
+
+@end
+
+static int compareTimes(const void *a, const void *b)
+{
+    double delta = *(const double *)a - *(const double *)b;
+    return (delta > 0.0) - (delta < 0.0);
+}
+
+// Records when each task starts, to measure how fast a sleeping thread picks up its tasks.
+@interface NGLThreadProbe : NSObject {
+@public
+    CFAbsoluteTime _started[100];
+    volatile UInt32 _count;
+}
+- (void) touch;
+- (void) tick;
+@end
+
+@implementation NGLThreadProbe
+
+- (void) touch {
+    _started[_count] = CFAbsoluteTimeGetCurrent();
+    ++_count;
+}
+
+- (void) tick {
+    ++_count;
+}
+
+@end
+
+// The timer cycle is private, the tests run it without the render thread.
+@interface NGLTimer (NGLTests)
+- (void) timerCycle:(NSTimer *)timer;
+@end
+
+// A job that records the order it started in, and keeps its worker busy for a while.
+@interface NGLJobProbe : NSObject
+@property (nonatomic, assign) volatile int32_t *rank;
+@property (nonatomic, assign) int32_t *ranks;
+- (void) run;
+@end
+
+@implementation NGLJobProbe
+
+- (void) run {
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    *_ranks = __sync_add_and_fetch(_rank, 1);
+    
+    while (CFAbsoluteTimeGetCurrent() - start < 0.005) {
+    }
+}
+
+@end
+
+// A timer item that releases another one from its callback, like a tween that frees its target.
+@interface NGLTimerProbe : NSObject <NGLCoreTimer>
+@property (nonatomic, strong) NGLTimerProbe *victim;
+@property (nonatomic, assign) UInt32 *calls;
+@property (nonatomic, assign) BOOL *freed;
+@end
+
+@implementation NGLTimerProbe
+
+- (void) timerCallBack {
+    ++*_calls;
+    _victim = nil;
+}
+
+- (void) dealloc {
+    [[NGLTimer defaultTimer] removeItem:self];
+    
+    if (_freed != NULL) {
+        *_freed = YES;
+    }
+}
+
+@end
+
+// The private loading stages of the mesh, the tests upload their own structures without a file.
+@interface NGLMesh (NGLTests)
+- (void) updateCoreMesh;
+@end
+
+static volatile UInt32 _compilations;
+
+// A mesh that counts the reloads of its cached file instead of doing them, it has no file.
+@interface NGLCompilingMesh : NGLMesh
+@end
+
+@implementation NGLCompilingMesh
+
+- (void) compileCoreMesh {
+    ++_compilations;
+}
+
+@end
+
+// Uploads the structure of a grid to a mesh, like the end of its loading.
+static void gridToMesh(NGLGridMesh *grid, NGLMesh *mesh)
+{
+    [grid defineStructure];
+    [mesh.meshElements addFromElements:grid.meshElements];
+    [mesh setIndices:grid.indices count:grid.indicesCount];
+    [mesh setStructures:grid.structures count:grid.structuresCount stride:grid.stride];
+    [mesh setLevels:grid.levels count:grid.levelsCount indices:grid.lodIndices lodCount:grid.lodCount];
+    [mesh setClusters:grid.clusters count:grid.clustersCount];
+    [mesh setWindows:grid.windows count:grid.windowsCount];
+    [mesh updateCoreMesh];
+}
+
+// Uploads a grid of two surfaces with instances, on a row along the x.
+static NGLMesh *instancedGrid(UInt32 count)
+{
+    NGLMesh *mesh = [[NGLMesh alloc] init];
+    NGLSurfaceMulti *surfaces = [[NGLSurfaceMulti alloc] init];
+    NGLmat4 *matrices = malloc(count * sizeof(NGLmat4));
+    UInt32 i;
+    
+    for (i = 0; i < count; ++i) {
+        nglMatrixIdentity(matrices[i]);
+        matrices[i][12] = i * 20.0f;
+    }
+    
+    [surfaces addSurface:[NGLSurface surfacetWithStart:0 length:768 identifier:1]];
+    [surfaces addSurface:[NGLSurface surfacetWithStart:768 length:768 identifier:2]];
+    mesh.surface = surfaces;
+    [mesh setInstances:matrices colors:NULL count:count];
+    gridToMesh([[NGLGridMesh alloc] initWithSize:16], mesh);
+    free(matrices);
+    
+    return mesh;
+}
+
+// Counts the recorded calls of a function.
+static UInt32 recordedCount(NGLES2CallName name)
+{
+    UInt32 i, count, found = 0;
+    const NGLES2Call *calls = ngles2RecordedCalls(&count);
+    
+    for (i = 0; i < count; ++i) {
+        found += (calls[i].name == name);
+    }
+    
+    return found;
+}
 
 @interface NinevehGLTests : XCTestCase
 
@@ -31,4 +548,1680 @@
     XCTAssert(YES, @"Pass");
 }
 
+- (void) testParseFloatRoundTrip {
+    char buffer[32];
+    float value, parsed;
+    UInt32 bits;
+    int i, length;
+    
+    // Any finite float printed with 9 significant digits must come back with the same bits.
+    srand(1);
+    for (i = 0; i < 1000000; ++i) {
+        bits = ((UInt32)rand() << 16) ^ (UInt32)rand();
+        memcpy(&value, &bits, sizeof(float));
+        
+        if (!isfinite(value)) {
+            continue;
+        }
+        
+        length = sprintf(buffer, (i % 2) ? "%.9g" : "%.9e", value);
+        nglParseFloat(buffer, buffer + length, &parsed);
+        XCTAssertEqual(memcmp(&value, &parsed, sizeof(float)), 0, @"%s", buffer);
+    }
+}
+
+- (void) testParseFloatFormats {
+    const char *text = " -1.5e3 +.5 7. 0.000001234 1e39 -inf nan x";
+    const char *end = text + strlen(text);
+    const char *next = NULL;
+    float values[8];
+    
+    XCTAssertEqual(nglParseFloats(text, end, values, 8, NULL), 7);
+    XCTAssertEqual(values[0], -1500.0f);
+    XCTAssertEqual(values[1], 0.5f);
+    XCTAssertEqual(values[2], 7.0f);
+    XCTAssertEqual(values[3], 0.000001234f);
+    XCTAssertTrue(isinf(values[4]) && values[4] > 0.0f);
+    XCTAssertTrue(isinf(values[5]) && values[5] < 0.0f);
+    XCTAssertTrue(isnan(values[6]));
+    
+    // An exponent without digits is not consumed, the parsing stops at it.
+    text = " 2 1e 3";
+    XCTAssertEqual(nglParseFloats(text, text + strlen(text), values, 8, &next), 2);
+    XCTAssertEqual(values[1], 1.0f);
+    XCTAssertEqual(*next, 'e');
+    
+    // The parsing never reads beyond the end, even without a null character.
+    XCTAssertEqual(*nglParseFloat("12345", "12345" + 3, &values[0]), '4');
+    XCTAssertEqual(values[0], 123.0f);
+}
+
+- (void) testParseUIntsRun {
+    const char *text = "1 2 3\n 44\t5 x 6";
+    const char *next = NULL;
+    UInt32 values[8];
+    int value;
+    
+    XCTAssertEqual(nglParseUInts(text, text + strlen(text), values, 8, &next), 5);
+    XCTAssertEqual(values[3], 44);
+    XCTAssertEqual(values[4], 5);
+    XCTAssertEqual(*(next + 1), 'x');
+    
+    // OBJ faces use signed integers followed by slashes.
+    XCTAssertEqual(*nglParseInt(" -12/3", " -12/3" + 6, &value), '/');
+    XCTAssertEqual(value, -12);
+}
+
+- (void) testParseFloatsThroughput {
+    NSMutableData *data = [NSMutableData data];
+    char buffer[32];
+    int i, length;
+    
+    // About 8MB of typical exported coordinates.
+    srand(2);
+    for (i = 0; i < 800000; ++i) {
+        length = sprintf(buffer, "%.6f ", (rand() / (double)RAND_MAX) * 200.0 - 100.0);
+        [data appendBytes:buffer length:length];
+    }
+    
+    const char *bytes = [data bytes];
+    const char *end = bytes + [data length];
+    float *values = malloc(800000 * sizeof(float));
+    __block double seconds = 0.0;
+    
+    [self measureBlock:^{
+        NSDate *start = [NSDate date];
+        XCTAssertEqual(nglParseFloats(bytes, end, values, 800000, NULL), 800000);
+        seconds += -[start timeIntervalSinceNow];
+    }];
+    
+    // The measureBlock runs the block 10 times.
+    NSLog(@"nglParseFloats throughput: %.1f MB/s", ([data length] * 10.0 / 1048576.0) / seconds);
+    
+    free(values);
+}
+
+- (void) testCompressStructuresError {
+    NGLMeshElements *elements = [[NGLMeshElements alloc] init];
+    float *structures = codecStructures(elements);
+    UInt32 count = kCodecVertices * kCodecStride;
+    float *decoded = malloc(count * sizeof(float));
+    float extent[2] = { 100.0f, 40.0f };
+    double error, angle, maxAngle = 0.0;
+    double cross[3], dot;
+    float *a, *b;
+    int i, j;
+    
+    NSData *data = nglCompressStructures(structures, count, kCodecStride, elements);
+    
+    // The interleaved floats take 48 bytes per vertex.
+    XCTAssertGreaterThan(count * sizeof(float) / (double)[data length], 2.0);
+    XCTAssertTrue(nglDecompressStructures([data bytes], (UInt32)[data length], decoded, count, kCodecStride));
+    
+    // Truncated data must be refused.
+    XCTAssertFalse(nglDecompressStructures([data bytes], (UInt32)[data length] - 1, decoded, count, kCodecStride));
+    XCTAssertTrue(nglDecompressStructures([data bytes], (UInt32)[data length], decoded, count, kCodecStride));
+    
+    for (i = 0; i < kCodecVertices; ++i) {
+        a = structures + i * kCodecStride;
+        b = decoded + i * kCodecStride;
+        
+        // Positions: at most half of a quantization step (a small slack for the float math).
+        for (j = 0; j < 2; ++j) {
+            error = fabs(a[j] - b[j]);
+            XCTAssertLessThanOrEqual(error, extent[j] / 65535.0 * 0.5 * 1.01 + 1e-6);
+        }
+        
+        XCTAssertEqual(b[3], 1.0f);
+        XCTAssertEqualWithAccuracy(a[4], b[4], 2.0 / 65535.0);
+        
+        // Normals and tangents: the angle between the original and the decoded vectors.
+        for (j = 6; j < kCodecStride; j += 3) {
+            cross[0] = (double)a[j + 1] * b[j + 2] - (double)a[j + 2] * b[j + 1];
+            cross[1] = (double)a[j + 2] * b[j] - (double)a[j] * b[j + 2];
+            cross[2] = (double)a[j] * b[j + 1] - (double)a[j + 1] * b[j];
+            dot = (double)a[j] * b[j] + (double)a[j + 1] * b[j + 1] + (double)a[j + 2] * b[j + 2];
+            angle = atan2(sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]), dot);
+            maxAngle = MAX(maxAngle, angle * 180.0 / M_PI);
+        }
+    }
+    
+    XCTAssertLessThan(maxAngle, 0.01);
+    NSLog(@"nglCompressStructures ratio: %.2f, max normal error: %.4f degrees",
+          count * sizeof(float) / (double)[data length], maxAngle);
+    
+    free(structures);
+    free(decoded);
+}
+
+- (void) testCompressIndices {
+    UInt32 count = 300000;
+    UInt32 *indices = malloc(count * sizeof(UInt32));
+    UInt32 *decoded = malloc(count * sizeof(UInt32));
+    UInt32 i;
+    
+    // A strip-like grid, the usual pattern after the vertex cache optimization, plus the extremes.
+    for (i = 0; i < count; ++i) {
+        indices[i] = i / 3 + (i % 3);
+    }
+    indices[10] = 0xFFFFFFFF;
+    indices[11] = 0;
+    
+    NSData *data = nglCompressIndices(indices, count);
+    
+    XCTAssertLessThan([data length], count * sizeof(UInt32) / 2);
+    XCTAssertTrue(nglDecompressIndices([data bytes], (UInt32)[data length], decoded, count));
+    XCTAssertEqual(memcmp(indices, decoded, count * sizeof(UInt32)), 0);
+    XCTAssertFalse(nglDecompressIndices([data bytes], (UInt32)[data length], decoded, count + 1));
+    
+    free(indices);
+    free(decoded);
+}
+
+- (void) testDecompressStructuresThroughput {
+    NGLMeshElements *elements = [[NGLMeshElements alloc] init];
+    float *structures = codecStructures(elements);
+    UInt32 count = kCodecVertices * kCodecStride;
+    NSData *data = nglCompressStructures(structures, count, kCodecStride, elements);
+    __block double seconds = 0.0;
+    
+    [self measureBlock:^{
+        NSDate *start = [NSDate date];
+        XCTAssertTrue(nglDecompressStructures([data bytes], (UInt32)[data length], structures, count, kCodecStride));
+        seconds += -[start timeIntervalSinceNow];
+    }];
+    
+    // The measureBlock runs the block 10 times. The throughput is measured in decoded bytes.
+    NSLog(@"nglDecompressStructures throughput: %.1f MB/s", (count * sizeof(float) * 10.0 / 1048576.0) / seconds);
+    
+    free(structures);
+}
+
+- (void) testCacheKeys {
+    NGLParserNGL *ngl = [[NGLParserNGL alloc] init];
+    NSString *pathA, *pathB;
+    NGLParserOBJ *objA = cacheSource(@"cacheA", 0.0f, &pathA);
+    NGLParserOBJ *objB = cacheSource(@"cacheB", 0.5f, &pathB);
+    NSDictionary *settings = @{ kNGLMeshKeyCentralize : kNGLMeshCentralizeYes };
+    
+    nglCacheClear();
+    
+    XCTAssertFalse([ngl hasCache:pathA settings:nil]);
+    [ngl encodeCache:objA withName:pathA settings:nil];
+    XCTAssertTrue([ngl hasCache:pathA settings:nil]);
+    
+    // Same name with another content, and same content with other settings, are different entries.
+    XCTAssertFalse([ngl hasCache:pathB settings:nil]);
+    XCTAssertFalse([ngl hasCache:pathA settings:settings]);
+    [ngl encodeCache:objB withName:pathB settings:nil];
+    [ngl encodeCache:objA withName:pathA settings:settings];
+    XCTAssertTrue([ngl hasCache:pathB settings:nil]);
+    XCTAssertTrue([ngl hasCache:pathA settings:settings]);
+    
+    NGLCacheStats stats = nglCacheStats();
+    XCTAssertEqual(stats.entries, 3);
+    XCTAssertEqual(stats.lookups, 7);
+    XCTAssertEqual(stats.hits, 3);
+    XCTAssertEqual(stats.misses, 4);
+    NSLog(@"NGL cache lookup: %.1f us", stats.lookupTime / stats.lookups * 1000000.0);
+    
+    // The settings that don't change the cached bytes share the same entry.
+    NSString *name = nglCacheName(pathA, nil);
+    XCTAssertEqualObjects(nglCacheName(pathA, @{ kNGLMeshKeyDynamic : kNGLMeshDynamicYes }), name);
+    XCTAssertEqualObjects(nglCacheName(pathA, @{ kNGLMeshKeyOriginal : kNGLMeshOriginalYes }), name);
+    XCTAssertEqualObjects(nglCacheName(pathA, @{ kNGLMeshKeyFormat : kNGLMeshFormatCompact }), name);
+    
+    // The cached file keeps the parsed mesh.
+    NGLParserNGL *decoded = [[NGLParserNGL alloc] init];
+    [decoded decodeCache:pathB settings:nil];
+    XCTAssertEqual(decoded.indicesCount, objB.indicesCount);
+    XCTAssertEqual(memcmp(decoded.structures, objB.structures, objB.structuresCount * sizeof(float)), 0);
+    
+    nglCacheClear();
+}
+
+- (void) testCacheEviction {
+    NGLParserNGL *ngl = [[NGLParserNGL alloc] init];
+    NSString *pathA, *pathB, *pathC;
+    NGLParserOBJ *objA = cacheSource(@"cacheA", 0.0f, &pathA);
+    NGLParserOBJ *objB = cacheSource(@"cacheB", 0.5f, &pathB);
+    NGLParserOBJ *objC = cacheSource(@"cacheC", 0.7f, &pathC);
+    
+    nglCacheClear();
+    nglGlobalCacheBudget(0);
+    
+    [ngl encodeCache:objA withName:pathA settings:nil];
+    [ngl encodeCache:objB withName:pathB settings:nil];
+    
+    // Only two files fit in the budget. A is used again, so B is the least recently used.
+    nglGlobalCacheBudget(nglCacheStats().bytes);
+    XCTAssertTrue([ngl hasCache:pathA settings:nil]);
+    [ngl encodeCache:objC withName:pathC settings:nil];
+    
+    XCTAssertTrue([ngl hasCache:pathA settings:nil]);
+    XCTAssertFalse([ngl hasCache:pathB settings:nil]);
+    XCTAssertTrue([ngl hasCache:pathC settings:nil]);
+    
+    NGLCacheStats stats = nglCacheStats();
+    XCTAssertEqual(stats.evictions, 1);
+    XCTAssertEqual(stats.entries, 2);
+    XCTAssertLessThanOrEqual(stats.bytes, nglDefaultCacheBudget);
+    
+    nglGlobalCacheBudget(NGL_CACHE_BUDGET);
+    nglCacheClear();
+}
+
+- (void) testVertexCacheMetrics {
+    UInt32 quad[6] = { 0, 1, 2, 2, 1, 3 };
+    UInt32 fifo[6] = { 0, 1, 2, 3, 0, 1 };
+    NGLVertexCacheMetrics metrics;
+    
+    metrics = nglVertexCacheMetrics(quad, 6, 16);
+    XCTAssertEqualWithAccuracy(metrics.acmr, 2.0f, 1.0e-6f);
+    XCTAssertEqualWithAccuracy(metrics.atvr, 1.0f, 1.0e-6f);
+    
+    // With 3 vertices in the cache, the vertex 3 pushes the 0 out, which pushes the 1 out.
+    metrics = nglVertexCacheMetrics(fifo, 6, 3);
+    XCTAssertEqualWithAccuracy(metrics.acmr, 3.0f, 1.0e-6f);
+    XCTAssertEqualWithAccuracy(metrics.atvr, 1.5f, 1.0e-6f);
+}
+
+- (void) testOptimizeStructure {
+    NGLGridMesh *ordered = [[NGLGridMesh alloc] initWithSize:64];
+    NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:64];
+    UInt32 i, next = 0, count = 64 * 64 * 6;
+    float areaA = 0.0f, areaB = 0.0f;
+    
+    [ordered defineStructure];
+    [mesh shuffle];
+    [mesh defineStructure];
+    
+    NGLVertexCacheMetrics before = mesh.originalMetrics, after = mesh.optimizedMetrics;
+    NSLog(@"Optimized 64 x 64 grid: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+          before.acmr, after.acmr, before.atvr, after.atvr);
+    
+    XCTAssertGreaterThan(before.acmr, 2.5f);
+    XCTAssertLessThan(after.acmr, 0.8f);
+    XCTAssertLessThan(after.atvr, 1.5f);
+    XCTAssertEqual(mesh.indicesCount, count);
+    XCTAssertEqual(mesh.structuresCount, ordered.structuresCount);
+    
+    // The vertices are in the order of first use and all the triangles face up, as the original ones.
+    for (i = 0; i < count; ++i) {
+        XCTAssertLessThanOrEqual(mesh.indices[i], next);
+        next = MAX(next, mesh.indices[i] + 1);
+    }
+    
+    NGLGridMesh *meshes[2] = { ordered, mesh };
+    float *areas[2] = { &areaA, &areaB };
+    for (UInt32 m = 0; m < 2; ++m) {
+        for (i = 0; i < count; i += 3) {
+            float *a = meshes[m].structures + meshes[m].indices[i] * meshes[m].stride;
+            float *b = meshes[m].structures + meshes[m].indices[i + 1] * meshes[m].stride;
+            float *c = meshes[m].structures + meshes[m].indices[i + 2] * meshes[m].stride;
+            float up = (b[2] - a[2]) * (c[0] - a[0]) - (b[0] - a[0]) * (c[2] - a[2]);
+            
+            XCTAssertGreaterThan(up, 0.0f);
+            *areas[m] += up;
+        }
+    }
+    
+    XCTAssertEqualWithAccuracy(areaA, areaB, 1.0e-2f);
+}
+
+- (void) testTangentSpaceSmooth {
+    NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:64];
+    UInt32 count = 65 * 65, corners = 64 * 64 * 6;
+    float *expected = calloc(count * 3, sizeof(float));
+    float *vertices = [mesh positions];
+    UInt32 i, j;
+    
+    [mesh defineStructure];
+    
+    // Without creases, the normal of a vertex is the average of all its faces, weighted by their areas.
+    for (i = 0; i < corners; i += 3) {
+        float *a = vertices + [mesh corner:i] * 3;
+        float *b = vertices + [mesh corner:i + 1] * 3;
+        float *c = vertices + [mesh corner:i + 2] * 3;
+        float ba[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float ca[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float normal[3] = { ba[1] * ca[2] - ba[2] * ca[1], ba[2] * ca[0] - ba[0] * ca[2], ba[0] * ca[1] - ba[1] * ca[0] };
+        
+        XCTAssertGreaterThan(normal[1], 0.0f);
+        for (j = 0; j < 3; ++j) {
+            float *sum = expected + [mesh corner:i + j] * 3;
+            sum[0] += normal[0];
+            sum[1] += normal[1];
+            sum[2] += normal[2];
+        }
+    }
+    
+    // Each position keeps a single normal, so the structure has one vertex per position.
+    XCTAssertEqual(mesh.structuresCount / mesh.stride, count);
+    
+    NGLElement *normals = [mesh.meshElements elementWithComponent:NGLComponentNormal];
+    NGLElement *tangents = [mesh.meshElements elementWithComponent:NGLComponentTangent];
+    XCTAssertTrue(normals != NULL && tangents != NULL);
+    
+    // The triangles and the vertices are reordered, each vertex finds its position by the grid coordinates.
+    for (i = 0; i < count; ++i) {
+        float *structure = mesh.structures + i * mesh.stride;
+        float *n = expected + ((UInt32)roundf(structure[0]) + (UInt32)roundf(structure[2]) * 65) * 3;
+        float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        float *normal = structure + normals->start;
+        float *tangent = structure + tangents->start;
+        
+        XCTAssertEqualWithAccuracy(normal[0], n[0] / length, 1.0e-5f);
+        XCTAssertEqualWithAccuracy(normal[1], n[1] / length, 1.0e-5f);
+        XCTAssertEqualWithAccuracy(normal[2], n[2] / length, 1.0e-5f);
+        
+        // The texture U follows the X axis.
+        XCTAssertEqualWithAccuracy(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2],
+                                   1.0f, 1.0e-4f);
+        XCTAssertGreaterThan(tangent[0], 0.9f);
+    }
+    
+    free(expected);
+}
+
+- (void) testTangentSpaceCrease {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"cube.obj"];
+    NSString *obj = @"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\n"
+                    @"f 1 4 3\nf 1 3 2\nf 5 6 7\nf 5 7 8\nf 1 2 6\nf 1 6 5\n"
+                    @"f 4 8 7\nf 4 7 3\nf 1 5 8\nf 1 8 4\nf 2 3 7\nf 2 7 6\n";
+    UInt32 i, j;
+    
+    [obj writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    NGLParserOBJ *cube = [[NGLParserOBJ alloc] initWithFile:path];
+    
+    // The 90 degrees edges exceed the crease angle, each side has its own 4 vertices.
+    XCTAssertEqual(cube.indicesCount, 36);
+    XCTAssertEqual(cube.structuresCount / cube.stride, 24);
+    
+    NGLElement *vertices = [cube.meshElements elementWithComponent:NGLComponentVertex];
+    NGLElement *normals = [cube.meshElements elementWithComponent:NGLComponentNormal];
+    
+    for (i = 0; i < 36; i += 3) {
+        float *a = cube.structures + cube.indices[i] * cube.stride + vertices->start;
+        float *b = cube.structures + cube.indices[i + 1] * cube.stride + vertices->start;
+        float *c = cube.structures + cube.indices[i + 2] * cube.stride + vertices->start;
+        float ba[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float ca[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float face[3] = { ba[1] * ca[2] - ba[2] * ca[1], ba[2] * ca[0] - ba[0] * ca[2], ba[0] * ca[1] - ba[1] * ca[0] };
+        
+        for (j = 0; j < 3; ++j) {
+            float *normal = cube.structures + cube.indices[i + j] * cube.stride + normals->start;
+            XCTAssertEqualWithAccuracy(normal[0] * face[0] + normal[1] * face[1] + normal[2] * face[2], 1.0f, 1.0e-5f);
+        }
+    }
+}
+
+- (void) testLevelsOfDetail {
+    NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:64];
+    UInt32 i, length = 64 * 64 * 6, vertices;
+    float error = 0.0f;
+    
+    [mesh defineStructure];
+    vertices = mesh.structuresCount / mesh.stride;
+    
+    // A single range, each level keeps about half of the triangles of the previous one.
+    XCTAssertEqual(mesh.levelsCount, NGL_LOD_LEVELS - 1);
+    for (i = 0; i < mesh.levelsCount; ++i) {
+        NGLLevel level = mesh.levels[i];
+        NSLog(@"Level %u: %u triangles, error %.5f", level.level, level.length / 3, level.error);
+        
+        XCTAssertEqual(level.level, i + 1);
+        XCTAssertEqual(level.rangeStart, 0);
+        XCTAssertEqual(level.rangeLength, mesh.indicesCount);
+        XCTAssertLessThan(level.length, length * 0.55f);
+        XCTAssertGreaterThanOrEqual(level.error, error);
+        XCTAssertLessThan(level.error, 0.01f);
+        XCTAssertLessThanOrEqual(level.start + level.length, mesh.lodCount);
+        
+        length = level.length;
+        error = level.error;
+    }
+    
+    for (i = 0; i < mesh.lodCount; ++i) {
+        XCTAssertLessThan(mesh.lodIndices[i], vertices);
+    }
+}
+
+- (void) testLevelForSize {
+    float errors[4] = { 0.0f, 0.001f, 0.01f, 0.1f };
+    
+    // The coarsest level whose error, projected on the screen, stays under the threshold.
+    XCTAssertEqual(nglLevelForSize(errors, 4, 50.0f, 1.0f), 2);
+    XCTAssertEqual(nglLevelForSize(errors, 4, 5.0f, 1.0f), 3);
+    XCTAssertEqual(nglLevelForSize(errors, 4, 100000.0f, 1.0f), 0);
+    XCTAssertEqual(nglLevelForSize(errors, 4, 50.0f, 0.0f), 0);
+    XCTAssertEqual(nglLevelForSize(errors, 1, 5.0f, 1.0f), 0);
+}
+
+- (void) testClusters {
+    NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:64];
+    UInt32 i, j, end = 0;
+    
+    [mesh defineStructure];
+    NGLElement *vertices = [mesh.meshElements elementWithComponent:NGLComponentVertex];
+    NSLog(@"Clusters: %u triangles in %u clusters", mesh.indicesCount / 3, mesh.clustersCount);
+    
+    // The clusters partition the array of indices, in order.
+    XCTAssertGreaterThanOrEqual(mesh.clustersCount, 64 * 64 * 2 / 128);
+    for (i = 0; i < mesh.clustersCount; ++i) {
+        NGLCluster cluster = mesh.clusters[i];
+        
+        XCTAssertEqual(cluster.start, end);
+        XCTAssertEqual(cluster.length % 3, 0);
+        XCTAssertLessThanOrEqual(cluster.length, 128 * 3);
+        XCTAssertLessThan(cluster.cutoff, 1.0f);
+        end += cluster.length;
+        
+        // All the triangles lie inside the bounds and their normals inside the cone.
+        for (j = cluster.start; j < cluster.start + cluster.length; j += 3) {
+            float *a = mesh.structures + mesh.indices[j] * mesh.stride + vertices->start;
+            float *b = mesh.structures + mesh.indices[j + 1] * mesh.stride + vertices->start;
+            float *c = mesh.structures + mesh.indices[j + 2] * mesh.stride + vertices->start;
+            NGLvec3 normal = nglVec3Normalize(nglVec3Cross((NGLvec3){b[0] - a[0], b[1] - a[1], b[2] - a[2]},
+                                                           (NGLvec3){c[0] - a[0], c[1] - a[1], c[2] - a[2]}));
+            
+            XCTAssertGreaterThanOrEqual(nglVec3Dot(normal, cluster.axis),
+                                        sqrtf(1.0f - cluster.cutoff * cluster.cutoff) - 1.0e-4f);
+            XCTAssertTrue(a[0] >= cluster.bounds.min.x && a[0] <= cluster.bounds.max.x &&
+                          a[1] >= cluster.bounds.min.y && a[1] <= cluster.bounds.max.y &&
+                          a[2] >= cluster.bounds.min.z && a[2] <= cluster.bounds.max.z);
+        }
+    }
+    
+    XCTAssertEqual(end, mesh.indicesCount);
+}
+
+- (void) testCullClusters {
+    NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:64];
+    NGLmat4 inside = { 0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 0.01f, 0.0f, 0.0f,
+                       0.0f, 0.0f, 0.01f, 0.0f, -0.32f, 0.0f, -0.32f, 1.0f };
+    NGLmat4 outside = { 0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 0.01f, 0.0f, 0.0f,
+                        0.0f, 0.0f, 0.01f, 0.0f, 2.0f, 0.0f, 0.0f, 1.0f };
+    
+    [mesh defineStructure];
+    UInt32 count = mesh.clustersCount, total = mesh.indicesCount;
+    BOOL *visible = malloc(count * sizeof(BOOL));
+    
+    // The heightfield faces up: it's entirely visible from above and almost entirely hidden from below.
+    XCTAssertEqual(nglCullClusters(mesh.clusters, count, inside, (NGLvec3){32.0f, 50.0f, 32.0f}, 1.0f, visible), total);
+    XCTAssertLessThan(nglCullClusters(mesh.clusters, count, inside, (NGLvec3){32.0f, -50.0f, 32.0f}, 1.0f, visible),
+                      total / 10);
+    XCTAssertEqual(nglCullClusters(mesh.clusters, count, inside, (NGLvec3){32.0f, -50.0f, 32.0f}, -1.0f, visible),
+                   total);
+    XCTAssertEqual(nglCullClusters(mesh.clusters, count, inside, (NGLvec3){32.0f, -50.0f, 32.0f}, 0.0f, visible),
+                   total);
+    
+    // Out of the frustum, nothing is drawn.
+    XCTAssertEqual(nglCullClusters(mesh.clusters, count, outside, (NGLvec3){32.0f, 50.0f, 32.0f}, 1.0f, visible), 0);
+    
+    free(visible);
+}
+
+- (void) testCullClustersThroughput {
+    NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:512];
+    NGLmat4 matrix = { 0.002f, 0.0f, 0.0f, 0.0f, 0.0f, 0.002f, 0.0f, 0.0f,
+                       0.0f, 0.0f, 0.002f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+    __block double seconds = 0.0;
+    __block UInt32 drawn = 0;
+    
+    [mesh defineStructure];
+    UInt32 count = mesh.clustersCount;
+    BOOL *visible = malloc(count * sizeof(BOOL));
+    
+    // 100 cycles for each measure.
+    [self measureBlock:^{
+        NSDate *start = [NSDate date];
+        for (UInt32 i = 0; i < 100; ++i) {
+            drawn = nglCullClusters(mesh.clusters, count, matrix, (NGLvec3){256.0f, -50.0f, 0.0f}, 1.0f, visible);
+        }
+        seconds += -[start timeIntervalSinceNow];
+    }];
+    
+    // The measureBlock runs the block 10 times.
+    NSLog(@"Cluster culling: %u clusters, %.1f ns per cluster, %.1f%% of the triangles drawn",
+          count, seconds * 1.0e9 / (count * 100.0 * 10.0), drawn * 100.0 / mesh.indicesCount);
+    
+    free(visible);
+}
+
+- (void) testVertexWindows {
+    NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:512];
+    UInt32 i, j, rows = 32, length = rows * 512 * 6, bytes = 0;
+    
+    // Sixteen surfaces of 32 rows each, the whole mesh has more vertices than 16 bits indices can reach.
+    for (i = 0; i < 16; ++i) {
+        [mesh.surface addSurface:[NGLSurface surfacetWithStart:i * length length:length identifier:i + 1]];
+    }
+    
+    [mesh defineStructure];
+    XCTAssertGreaterThan(mesh.structuresCount / mesh.stride, NGL_MAX_16 + 1);
+    XCTAssertEqual(mesh.windowsCount, 16);
+    
+    // Each surface is rebased to its own window, which fits in 16 bits.
+    for (i = 0; i < mesh.windowsCount; ++i) {
+        NGLWindow window = mesh.windows[i];
+        
+        XCTAssertEqual(window.rangeStart, i * length);
+        XCTAssertEqual(window.rangeLength, length);
+        XCTAssertEqual(window.dataSize, NGL_SIZE_USHORT);
+        XCTAssertLessThanOrEqual(window.count, NGL_MAX_16 + 1);
+        
+        for (j = window.rangeStart; j < window.rangeStart + window.rangeLength; ++j) {
+            XCTAssertTrue(mesh.indices[j] >= window.base && mesh.indices[j] - window.base < window.count);
+        }
+        
+        bytes += window.rangeLength * window.dataSize;
+    }
+    
+    NSLog(@"Vertex windows: %u bytes of indices instead of %u", bytes, mesh.indicesCount * NGL_SIZE_UINT);
+    
+    // The levels of a surface are inside its window.
+    for (i = 0; i < mesh.levelsCount; ++i) {
+        NGLLevel level = mesh.levels[i];
+        NGLWindow window = mesh.windows[level.rangeStart / length];
+        
+        for (j = level.start; j < level.start + level.length; ++j) {
+            XCTAssertTrue(mesh.lodIndices[j] >= window.base && mesh.lodIndices[j] - window.base < window.count);
+        }
+    }
+    
+    // A single range over the whole mesh keeps 32 bits indices.
+    NGLWindow whole = nglVertexWindow(mesh.indices, 0, mesh.indicesCount, NULL, 0, NULL);
+    XCTAssertEqual(whole.dataSize, NGL_SIZE_UINT);
+    XCTAssertEqual(whole.count, mesh.structuresCount / mesh.stride);
+}
+
+- (void) testCompactFormats {
+    NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:64];
+    UInt32 i, c, vertices;
+    
+    [mesh defineStructure];
+    NGLMeshElements *elements = mesh.meshElements;
+    vertices = mesh.structuresCount / mesh.stride;
+    
+    // The elements use the array of structures until they get their formats.
+    XCTAssertEqual([elements packedStride], 0);
+    
+    NGLPrecisionMetrics precision = nglDefineFormats(elements, mesh.structures, mesh.structuresCount, mesh.stride,
+                                                     YES);
+    UInt32 packed = [elements packedStride];
+    NSLog(@"Compact formats: %u bytes instead of %u, errors %g (position), %.3f degrees, %g (texcoord)",
+          packed, mesh.stride * 4, precision.position, precision.direction, precision.texcoord);
+    
+    NGLElement *position = [elements elementWithComponent:NGLComponentVertex];
+    NGLElement *texcoord = [elements elementWithComponent:NGLComponentTexcoord];
+    NGLElement *normal = [elements elementWithComponent:NGLComponentNormal];
+    
+    XCTAssertEqual(position->format, NGLElementFormatHalf);
+    XCTAssertEqual(texcoord->format, NGLElementFormatUShort);
+    XCTAssertEqual(normal->format, NGLElementFormatByte);
+    XCTAssertLessThanOrEqual(packed, 24);
+    XCTAssertLessThanOrEqual(precision.position, 1.0f / 4096.0f);
+    XCTAssertLessThan(precision.direction, 1.0f);
+    XCTAssertLessThanOrEqual(precision.texcoord, 1.0f / 65535.0f);
+    
+    // The packed values are read back just like the GPU does.
+    UInt8 *data = malloc(vertices * packed);
+    nglPackStructures(elements, mesh.structures, mesh.structuresCount, mesh.stride, data);
+    
+    for (i = 0; i < vertices; ++i) {
+        float *values = mesh.structures + i * mesh.stride;
+        UInt16 *coords = (UInt16 *)(data + i * packed + texcoord->offset);
+        SInt8 *bytes = (SInt8 *)(data + i * packed + normal->offset);
+        NGLvec3 original = nglVec3Normalize((NGLvec3){ values[normal->start], values[normal->start + 1],
+                                                       values[normal->start + 2] });
+        NGLvec3 decoded = nglVec3Normalize((NGLvec3){ (2.0f * bytes[0] + 1.0f) / 255.0f,
+                                                      (2.0f * bytes[1] + 1.0f) / 255.0f,
+                                                      (2.0f * bytes[2] + 1.0f) / 255.0f });
+        
+        XCTAssertGreaterThan(nglVec3Dot(original, decoded), cosf(precision.direction * M_PI / 180.0f) - 1.0e-5f);
+        
+        for (c = 0; c < 2; ++c) {
+            XCTAssertEqualWithAccuracy(coords[c] / 65535.0f, values[texcoord->start + c], precision.texcoord + 1.0e-7f);
+        }
+    }
+    
+    free(data);
+    
+    // Without GL_OES_vertex_half_float, the positions that don't fit in normalized shorts stay as floats.
+    precision = nglDefineFormats(elements, mesh.structures, mesh.structuresCount, mesh.stride, NO);
+    XCTAssertEqual(position->format, NGLElementFormatFloat);
+    XCTAssertEqual(texcoord->format, NGLElementFormatUShort);
+    XCTAssertEqual(precision.position, 0.0f);
+}
+
+- (void) testInstances {
+    NGLMesh *mesh = [[NGLMesh alloc] init];
+    NGLmat4 matrices[3];
+    NGLvec4 colors[3] = { {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 0.5f} };
+    UInt32 i, version = mesh.instancesVersion;
+    
+    for (i = 0; i < 3; ++i) {
+        nglMatrixIdentity(matrices[i]);
+        matrices[i][12] = i * 10.0f;
+    }
+    
+    // Each instance holds its matrix followed by its color, white by default.
+    [mesh setInstances:matrices colors:NULL count:3];
+    XCTAssertEqual(mesh.instancesCount, 3);
+    XCTAssertNotEqual(mesh.instancesVersion, version);
+    
+    for (i = 0; i < 3; ++i) {
+        float *instance = mesh.instances + i * NGL_INSTANCE_LENGTH;
+        XCTAssertEqual(memcmp(instance, matrices[i], sizeof(NGLmat4)), 0);
+        XCTAssertEqual(instance[16] + instance[17] + instance[18] + instance[19], 4.0f);
+    }
+    
+    version = mesh.instancesVersion;
+    [mesh setInstances:matrices colors:colors count:3];
+    XCTAssertNotEqual(mesh.instancesVersion, version);
+    XCTAssertEqual(memcmp(mesh.instances + 2 * NGL_INSTANCE_LENGTH + 16, &colors[2], sizeof(NGLvec4)), 0);
+    
+    // Without instances the mesh is drawn alone.
+    [mesh setInstances:NULL colors:NULL count:0];
+    XCTAssertEqual(mesh.instancesCount, 0);
+    XCTAssertTrue(mesh.instances == NULL);
+}
+
+- (void) testSkinning {
+    NGLMeshElements *elements = [[NGLMeshElements alloc] init];
+    NGLJoint joints[2];
+    NGLmat4 palette[2], pose[2];
+    float output[36];
+    UInt32 i, j;
+    
+    // A vertex moved by the child, another shared by both joints and another with a joint out of the skeleton.
+    float structures[36] = { 1.0f, 0.0f, 0.0f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 0.0f, 0.0f,
+                             2.0f, 0.0f, 0.0f, 1.0f,  0.0f, 1.0f, 0.0f, 0.0f,  0.5f, 0.5f, 0.0f, 0.0f,
+                             3.0f, 0.0f, 0.0f, 1.0f,  5.0f, 0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 0.0f, 0.0f };
+    
+    [elements addElement:(NGLElement){NGLComponentVertex, 0, 4, 0}];
+    [elements addElement:(NGLElement){NGLComponentBoneIndices, 4, 4, 1}];
+    [elements addElement:(NGLElement){NGLComponentBoneWeights, 8, 4, 2}];
+    
+    // The child lies 1.0 along the x of the root, its bind matrix is the inverse of that.
+    for (i = 0; i < 2; ++i) {
+        nglMatrixIdentity(joints[i].local);
+        nglMatrixIdentity(joints[i].bind);
+        nglMatrixIdentity(pose[i]);
+    }
+    
+    joints[0].parent = NGL_NOT_FOUND;
+    joints[1].parent = 0;
+    joints[1].local[12] = 1.0f;
+    joints[1].bind[12] = -1.0f;
+    
+    // The rest pose keeps the vertices.
+    nglSkinPalette(joints, NULL, 2, palette);
+    
+    for (i = 0; i < 2; ++i) {
+        for (j = 0; j < 16; ++j) {
+            XCTAssertEqualWithAccuracy(palette[i][j], (j % 5 == 0) ? 1.0f : 0.0f, 1.0e-6f);
+        }
+    }
+    
+    // Moving the child 2.0 up moves its vertex entirely and the shared vertex halfway.
+    pose[1][12] = 1.0f;
+    pose[1][13] = 2.0f;
+    nglSkinPalette(joints, pose, 2, palette);
+    nglSkinStructures(elements, structures, 36, 12, palette, 2, output);
+    
+    XCTAssertEqualWithAccuracy(output[0], 1.0f, 1.0e-6f);
+    XCTAssertEqualWithAccuracy(output[1], 2.0f, 1.0e-6f);
+    XCTAssertEqualWithAccuracy(output[12], 2.0f, 1.0e-6f);
+    XCTAssertEqualWithAccuracy(output[13], 1.0f, 1.0e-6f);
+    XCTAssertEqualWithAccuracy(output[24], 3.0f, 1.0e-6f);
+    XCTAssertEqualWithAccuracy(output[25], 0.0f, 1.0e-6f);
+    
+    // Moving the root moves the whole skeleton.
+    pose[0][14] = 4.0f;
+    nglSkinPalette(joints, pose, 2, palette);
+    nglSkinStructures(elements, structures, 36, 12, palette, 2, output);
+    
+    XCTAssertEqualWithAccuracy(output[2], 4.0f, 1.0e-6f);
+    XCTAssertEqualWithAccuracy(output[14], 4.0f, 1.0e-6f);
+    XCTAssertEqualWithAccuracy(output[26], 0.0f, 1.0e-6f);
+}
+
+- (void) testThreadLatency {
+    NSString *name = [kNGLThreadHelper stringByAppendingString:@"Benchmark"];
+    NGLThreadProbe *probe = [[NGLThreadProbe alloc] init];
+    NGLThread *thread = nglThreadGet(name);
+    NGLThread *paused = nglThreadGet([name stringByAppendingString:@"Paused"]);
+    double *latencies = malloc(100 * sizeof(double));
+    struct rusage before, after;
+    double idle;
+    UInt32 i;
+    
+    thread.autoExit = NO;
+    paused.autoExit = NO;
+    paused.paused = YES;
+    
+    // Each task is queued after the thread went back to sleep.
+    for (i = 0; i < 100; ++i) {
+        usleep(2000);
+        CFAbsoluteTime queued = CFAbsoluteTimeGetCurrent();
+        [thread performAsync:@selector(touch) target:probe];
+        
+        while (probe->_count == i) {
+            usleep(10);
+        }
+        
+        latencies[i] = probe->_started[i] - queued;
+    }
+    
+    // Every task woke the sleeping thread up.
+    XCTAssertEqual((UInt32)probe->_count, 100);
+    
+    // The sleeping and the paused threads don't use the CPU.
+    getrusage(RUSAGE_SELF, &before);
+    usleep(500000);
+    getrusage(RUSAGE_SELF, &after);
+    idle = (after.ru_utime.tv_sec - before.ru_utime.tv_sec) + (after.ru_stime.tv_sec - before.ru_stime.tv_sec) +
+           (after.ru_utime.tv_usec - before.ru_utime.tv_usec) / 1.0e6 +
+           (after.ru_stime.tv_usec - before.ru_stime.tv_usec) / 1.0e6;
+    
+    // The times depend on the host, they are only reported.
+    qsort(latencies, 100, sizeof(double), compareTimes);
+    NSLog(@"Thread latency: %.1f us (p50), %.1f us (p90), %.1f us (p99), idle CPU %.1f%%",
+          latencies[50] * 1.0e6, latencies[90] * 1.0e6, latencies[99] * 1.0e6, idle * 100.0 / 0.5);
+    
+    free(latencies);
+    [thread exit];
+    [paused exit];
+}
+
+- (void) testThreadTasks {
+    NSString *name = [kNGLThreadHelper stringByAppendingString:@"Tasks"];
+    NGLThreadProbe *probe = [[NGLThreadProbe alloc] init];
+    NGLThread *thread = nglThreadGet(name);
+    double *trips = malloc(1000 * sizeof(double));
+    UInt32 i;
+    
+    thread.autoExit = NO;
+    
+    // The handle is done once the task is performed, the chained task runs after it.
+    NGLThreadTask *task = [thread performAsync:@selector(touch) target:probe];
+    NGLThreadTask *chained = [task chainAsync:@selector(touch) target:probe thread:name];
+    [chained waitUntilDone];
+    
+    XCTAssertTrue(task.isDone);
+    XCTAssertFalse(task.isCancelled);
+    XCTAssertEqual((UInt32)probe->_count, 2);
+    XCTAssertLessThanOrEqual(probe->_started[0], probe->_started[1]);
+    
+    // The canceled tasks are done without being performed, and so are their chains.
+    thread.paused = YES;
+    task = [thread performAsync:@selector(touch) target:probe];
+    chained = [task chainAsync:@selector(touch) target:probe thread:name];
+    [thread cancelAllPendingRequestsForTarget:probe];
+    [chained waitUntilDone];
+    thread.paused = NO;
+    
+    XCTAssertTrue(task.isCancelled);
+    XCTAssertTrue(chained.isCancelled);
+    XCTAssertEqual((UInt32)probe->_count, 2);
+    
+    // The synchronous calls sleep on their handles, they return once the task is performed.
+    for (i = 0; i < 1000; ++i) {
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        [thread performSync:@selector(tick) target:probe];
+        trips[i] = CFAbsoluteTimeGetCurrent() - start;
+        XCTAssertEqual((UInt32)probe->_count, 3 + i);
+    }
+    
+    qsort(trips, 1000, sizeof(double), compareTimes);
+    NSLog(@"performSync round trip: %.1f us (p50), %.1f us (p90), %.1f us (p99)",
+          trips[500] * 1.0e6, trips[900] * 1.0e6, trips[990] * 1.0e6);
+    
+    free(trips);
+    [thread exit];
+}
+
+- (void) testJobs {
+    const UInt32 count = 256;
+    volatile int32_t *runs = calloc(256, sizeof(int32_t));
+    __block volatile double sink = 0.0;
+    NSMutableSet *threads = [NSMutableSet set];
+    NSLock *lock = [[NSLock alloc] init];
+    CFAbsoluteTime start;
+    double serial, parallel;
+    UInt32 i;
+    
+    // Uneven work: one index in each 16 costs 50 times more than the others.
+    void (^work)(UInt32) = ^(UInt32 index) {
+        UInt32 j, steps = (index % 16 == 0) ? 200000 : 4000;
+        double value = 0.0;
+        
+        for (j = 0; j < steps; ++j) {
+            value += sqrt((double)(j + index));
+        }
+        
+        sink += value;
+    };
+    
+    start = CFAbsoluteTimeGetCurrent();
+    for (i = 0; i < count; ++i) {
+        work(i);
+    }
+    serial = CFAbsoluteTimeGetCurrent() - start;
+    
+    // Each index runs exactly once.
+    start = CFAbsoluteTimeGetCurrent();
+    nglJobFor(count, ^(UInt32 index) {
+        work(index);
+        __sync_fetch_and_add(&runs[index], 1);
+        
+        [lock lock];
+        [threads addObject:[NSValue valueWithPointer:(__bridge void *)[NSThread currentThread]]];
+        [lock unlock];
+    });
+    parallel = CFAbsoluteTimeGetCurrent() - start;
+    
+    for (i = 0; i < count; ++i) {
+        XCTAssertEqual(runs[i], 1);
+    }
+    
+    NSLog(@"Jobs: %u workers, %u threads used, serial %.1f ms, parallel %.1f ms, speedup %.2fx",
+          (unsigned int)nglJobWorkers(), (unsigned int)[threads count],
+          serial * 1000.0, parallel * 1000.0, serial / parallel);
+    
+    XCTAssertLessThanOrEqual([threads count], nglJobWorkers());
+    
+    // The dependent jobs run after their dependencies, even when they wait inside other jobs.
+    __block volatile int32_t order = 0;
+    __block int32_t first = 0, second = 0, third = 0;
+    
+    NGLJob *a = nglJobPerformBlock(^{ work(0); first = __sync_add_and_fetch(&order, 1); }, nil);
+    NGLJob *b = nglJobPerformBlock(^{ work(1); second = __sync_add_and_fetch(&order, 1); }, nil);
+    NGLJob *c = nglJobPerformBlock(^{
+        nglJobFor(count, ^(UInt32 index) { work(index % 16 + 1); });
+        third = __sync_add_and_fetch(&order, 1);
+    }, @[a, b]);
+    
+    [c waitUntilDone];
+    
+    XCTAssertTrue(a.isDone && b.isDone && c.isDone);
+    XCTAssertEqual(third, 3);
+    XCTAssertTrue(first > 0 && second > 0);
+    
+    free((void *)runs);
+}
+
+- (void) testJobChurn {
+    UInt32 rounds = 8, loads = nglJobWorkers() * 2, workers = nglJobWorkers();
+    double visible[2] = { 0.0, 0.0 }, wasted = 0.0;
+    UInt32 mode, round, i;
+    
+    // Without multithreading the jobs run in the caller, there are no deques to order.
+    NSThread *caller = [NSThread currentThread];
+    __block BOOL inCaller = NO;
+    [nglJobPerformBlock(^{ inCaller = ([NSThread currentThread] == caller); }, nil) waitUntilDone];
+    
+    // All the workers are held busy while the jobs are queued, so they all wait in the deques together.
+    // The visible job is queued last, after the background ones.
+    __block volatile int32_t busy = 0;
+    __block volatile BOOL released = NO;
+    volatile int32_t *rank = calloc(1, sizeof(int32_t));
+    int32_t *ranks = calloc(workers * 4 + 1, sizeof(int32_t));
+    NSMutableArray *queued = [NSMutableArray array];
+    
+    for (i = 0; i < workers && !inCaller; ++i) {
+        nglJobPerformBlock(^{
+            CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+            __sync_add_and_fetch(&busy, 1);
+            
+            while (!released && CFAbsoluteTimeGetCurrent() - start < 5.0) {
+                usleep(100);
+            }
+        }, nil);
+    }
+    
+    while (!inCaller && busy < (int32_t)workers) {
+        usleep(100);
+    }
+    
+    for (i = 0; i <= workers * 4 && !inCaller; ++i) {
+        NGLJobProbe *probe = [[NGLJobProbe alloc] init];
+        probe.rank = rank;
+        probe.ranks = ranks + i;
+        [queued addObject:nglJobPerformPriority(@selector(run), probe, nil, (i < workers * 4) ?
+                                                NGLJobPriorityBackground : NGLJobPriorityVisible)];
+    }
+    
+    released = YES;
+    for (NGLJob *job in queued) {
+        [job waitUntilDone];
+    }
+    
+    // The released workers take the visible job before the background ones still waiting.
+    if (!inCaller) {
+        XCTAssertLessThanOrEqual(ranks[workers * 4], (int32_t)workers);
+        NSLog(@"Job priorities: the visible job started %d of %u", ranks[workers * 4], workers * 4 + 1);
+    }
+    
+    free((void *)rank);
+    free(ranks);
+    
+    // Each round the user browses to another page: the loads of the last page are not needed anymore.
+    // Mode 0 lets them run as before, mode 1 prefetches them in background and cancels them.
+    for (mode = 0; mode < 2; ++mode) {
+        for (round = 0; round < rounds; ++round) {
+            NSMutableArray *jobs = [NSMutableArray array];
+            NSMutableArray *meshes = [NSMutableArray array];
+            
+            for (i = 0; i < loads; ++i) {
+                NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:128];
+                NGLJob *job = nglJobPerformPriority(@selector(defineStructure), mesh, nil,
+                                                    (mode == 0) ? NGLJobPriorityVisible : NGLJobPriorityBackground);
+                [jobs addObject:job];
+                [meshes addObject:mesh];
+            }
+            
+            usleep(1000);
+            
+            if (mode == 1) {
+                for (i = 0; i < loads; ++i) {
+                    NGLJob *job = [jobs objectAtIndex:i];
+                    
+                    if (![job cancel]) {
+                        [[meshes objectAtIndex:i] cancelLoading];
+                    }
+                }
+            }
+            
+            // The mesh on the screen.
+            CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+            NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:64];
+            NGLJob *job = nglJobPerformBlock(^{
+                [mesh defineStructure];
+            }, nil);
+            [job waitUntilDone];
+            visible[mode] += CFAbsoluteTimeGetCurrent() - start;
+            
+            XCTAssertEqual(mesh.indicesCount, 64 * 64 * 6);
+            XCTAssertFalse(job.isCancelled);
+            
+            // The time spent with the loads of the last page, after they were not needed anymore.
+            start = CFAbsoluteTimeGetCurrent();
+            for (NGLJob *pending in jobs) {
+                [pending waitUntilDone];
+            }
+            
+            if (mode == 1) {
+                wasted += CFAbsoluteTimeGetCurrent() - start;
+            }
+        }
+    }
+    
+    // The times depend on the host, they are only reported.
+    NSLog(@"Job churn: time-to-visible %.1f ms without cancellation, %.1f ms with priorities and cancellation, "
+          "%.1f ms wasted after canceling",
+          visible[0] * 1000.0 / rounds, visible[1] * 1000.0 / rounds, wasted * 1000.0 / rounds);
+}
+
+- (void) testArraySnapshot {
+    NGLArray *array = [[NGLArray alloc] init];
+    double *blocked = calloc(2, sizeof(double));
+    volatile BOOL *drawing = calloc(1, sizeof(BOOL));
+    UInt32 mode, frame, seen;
+    uintptr_t i;
+    void *item;
+    
+    for (i = 1; i <= 100; ++i) {
+        [array addPointer:(void *)i];
+    }
+    
+    // The snapshot is shared until the array changes, the loops don't allocate anything.
+    UInt32 snapshots = array.values->snapshots_count;
+    for (frame = 0; frame < 100; ++frame) {
+        nglForSnapshot (item, array) {
+        }
+    }
+    XCTAssertEqual(array.values->snapshots_count, snapshots + 1);
+    
+    // Each change makes one new snapshot, on the next loop only.
+    for (frame = 0; frame < 100; ++frame) {
+        if (frame % 10 == 0) {
+            [array addPointer:(void *)3000];
+            [array removePointer:(void *)3000];
+        }
+        
+        nglForSnapshot (item, array) {
+        }
+    }
+    XCTAssertEqual(array.values->snapshots_count, snapshots + 11);
+    
+    NGLArraySnapshot *first = [array retainSnapshot];
+    NGLArraySnapshot *second = [array retainSnapshot];
+    XCTAssertEqual(first, second);
+    nglArraySnapshotRelease(second);
+    
+    [array addPointer:(void *)1000];
+    second = [array retainSnapshot];
+    XCTAssertNotEqual(first, second);
+    XCTAssertEqual(first->count, 100);
+    XCTAssertEqual(second->count, 101);
+    nglArraySnapshotRelease(first);
+    nglArraySnapshotRelease(second);
+    [array removePointer:(void *)1000];
+    
+    // A loader thread adds and removes items while the render loop iterates the array.
+    // Mode 0 holds the lock for the whole loop, mode 1 iterates a snapshot.
+    for (mode = 0; mode < 2; ++mode) {
+        __block UInt32 changes = 0;
+        snapshots = array.values->snapshots_count;
+        *drawing = YES;
+        
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            while (*drawing) {
+                CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+                [array addPointer:(void *)2000];
+                [array removePointer:(void *)2000];
+                blocked[mode] += CFAbsoluteTimeGetCurrent() - start;
+                ++changes;
+                usleep(200);
+            }
+            
+            *drawing = YES;
+        });
+        
+        for (frame = 0; frame < 100; ++frame) {
+            seen = 0;
+            
+            if (mode == 0) {
+                nglFor (item, array) {
+                    usleep(20);
+                    seen += ((uintptr_t)item <= 100) ? 1 : 0;
+                }
+            } else {
+                nglForSnapshot (item, array) {
+                    usleep(20);
+                    seen += ((uintptr_t)item <= 100) ? 1 : 0;
+                }
+            }
+            
+            XCTAssertEqual(seen, 100);
+        }
+        
+        // Waits for the loader thread to finish.
+        *drawing = NO;
+        while (!*drawing) {
+            usleep(100);
+        }
+        
+        blocked[mode] /= MAX(changes, 1);
+        snapshots = array.values->snapshots_count - snapshots;
+        
+        // Only the snapshot loops make snapshots, never more than one per frame nor per change.
+        if (mode == 0) {
+            XCTAssertEqual(snapshots, 0);
+        } else {
+            XCTAssertLessThanOrEqual(snapshots, 100);
+            XCTAssertLessThanOrEqual(snapshots, changes * 2 + 1);
+            NSLog(@"NGLArray snapshots: %.2f per frame, %u changes", snapshots / 100.0, changes);
+        }
+    }
+    
+    NSLog(@"NGLArray loader blocked %.1f us per change with nglFor, %.1f us with nglForSnapshot",
+          blocked[0] * 1.0e6, blocked[1] * 1.0e6);
+    
+#ifdef NGLARRAY_THREAD_CONTENTION_DEBUG
+    NSLog(@"NGLArray contention: %u waits, %.1f ms waiting",
+          array.values->mutex_contentions, array.values->mutex_wait_time * 1000.0);
+#endif
+    
+    free(blocked);
+    free((void *)drawing);
+}
+
+- (void) testTimerReleasesItem {
+    UInt32 *calls = calloc(2, sizeof(UInt32));
+    BOOL *freed = calloc(1, sizeof(BOOL));
+    NGLTimerProbe *releaser = [[NGLTimerProbe alloc] init];
+    
+    // The victim is only held by the releaser, which drops it during the same cycle.
+    @autoreleasepool {
+        NGLTimerProbe *victim = [[NGLTimerProbe alloc] init];
+        victim.calls = &calls[1];
+        victim.freed = freed;
+        releaser.calls = &calls[0];
+        releaser.victim = victim;
+        
+        [[NGLTimer defaultTimer] addItem:releaser];
+        [[NGLTimer defaultTimer] addItem:victim];
+    }
+    
+    // The cycle keeps the victim alive until it ends, then the victim removes itself.
+    @autoreleasepool {
+        [[NGLTimer defaultTimer] timerCycle:nil];
+    }
+    
+    XCTAssertEqual(calls[0], 1);
+    XCTAssertEqual(calls[1], 1);
+    XCTAssertTrue(*freed);
+    
+    @autoreleasepool {
+        [[NGLTimer defaultTimer] timerCycle:nil];
+    }
+    
+    XCTAssertEqual(calls[0], 2);
+    XCTAssertEqual(calls[1], 1);
+    
+    [[NGLTimer defaultTimer] removeItem:releaser];
+    free(calls);
+    free(freed);
+}
+
+- (void) testCancelMidParse {
+    UInt32 delay;
+    
+    // Canceled before the structure: the parsing stops right after the hashes, nothing is built.
+    NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:64];
+    [mesh cancelLoading];
+    [mesh defineStructure];
+    XCTAssertTrue(mesh.structures == NULL);
+    XCTAssertEqual(mesh.structuresCount, 0);
+    XCTAssertTrue(mesh.levels == NULL && mesh.clusters == NULL && mesh.windows == NULL);
+    XCTAssertEqual(mesh.originalMetrics.acmr, 0.0f);
+    
+    // Canceled once the structure is built: it's not optimized nor split.
+    NGLCancelingGridMesh *canceling = [[NGLCancelingGridMesh alloc] initWithSize:64];
+    [canceling defineStructure];
+    XCTAssertTrue(canceling.structures != NULL);
+    XCTAssertEqual(canceling.originalMetrics.acmr, 0.0f);
+    XCTAssertTrue(canceling.levels == NULL && canceling.clusters == NULL && canceling.windows == NULL);
+    
+    // Canceled while the structure is defined, at a different stage each time. A stage never runs after
+    // a skipped one, so there are no windows without clusters.
+    for (delay = 0; delay < 16; ++delay) {
+        NGLGridMesh *parsing = [[NGLGridMesh alloc] initWithSize:512];
+        NGLJob *job = nglJobPerformBlock(^{
+            [parsing defineStructure];
+        }, nil);
+        
+        usleep(delay * 500);
+        [parsing cancelLoading];
+        [job waitUntilDone];
+        
+        XCTAssertTrue(parsing.windows == NULL || parsing.clusters != NULL);
+    }
+}
+
+- (void) testCopiesShareBuffers {
+    NGLCamera *camera = [[NGLCamera alloc] init];
+    NGLCompilingMesh *mesh = [[NGLCompilingMesh alloc] init];
+    NSMutableArray *copies = [NSMutableArray array];
+    UInt32 i, copiesCount = 100;
+    
+    nglContextEAGL();
+    gridToMesh([[NGLGridMesh alloc] initWithSize:64], mesh);
+    
+    // The copies construct their polygons on the buffers of the mesh, without uploading nor reloading anything.
+    _compilations = 0;
+    ngles2Record(YES);
+    NSDate *start = [NSDate date];
+    for (i = 0; i < copiesCount; ++i) {
+        [copies addObject:[mesh copyInstance]];
+    }
+    double seconds = -[start timeIntervalSinceNow];
+    
+    for (NGLMesh *copy in copies) {
+        [copy drawMeshWithCamera:camera];
+    }
+    ngles2Record(NO);
+    
+    NSLog(@"Copies: %.3f ms per copy, %u programs created", seconds * 1000.0 / copiesCount,
+          recordedCount(NGLES2CallCreateProgram));
+    XCTAssertEqual(recordedCount(NGLES2CallGenBuffers), 0);
+    XCTAssertEqual(recordedCount(NGLES2CallBufferData), 0);
+    XCTAssertEqual(_compilations, 0);
+    XCTAssertGreaterThanOrEqual(recordedCount(NGLES2CallDrawElements), copiesCount);
+    
+    // A mesh without buffers can't share them, nor the dynamic one. Their copies reload the cached file.
+    NGLCompilingMesh *empty = [[NGLCompilingMesh alloc] init];
+    NGLCompilingMesh *dynamic = [[NGLCompilingMesh alloc] init];
+    dynamic.fileSettings = @{ kNGLMeshKeyDynamic : kNGLMeshDynamicYes };
+    gridToMesh([[NGLGridMesh alloc] initWithSize:16], dynamic);
+    
+    [copies addObject:[empty copyInstance]];
+    XCTAssertEqual(_compilations, 1);
+    [copies addObject:[dynamic copyInstance]];
+    XCTAssertEqual(_compilations, 2);
+}
+
+- (void) testDynamicUploads {
+    NGLCamera *camera = [[NGLCamera alloc] init];
+    NGLMesh *mesh = [[NGLMesh alloc] init];
+    NSMutableSet *buffers = [NSMutableSet set];
+    const NGLES2Call *calls;
+    UInt32 i, frame, count, first = 10, length = 20;
+    UInt32 reversed[6];
+    
+    nglContextEAGL();
+    mesh.fileSettings = @{ kNGLMeshKeyDynamic : kNGLMeshDynamicYes };
+    gridToMesh([[NGLGridMesh alloc] initWithSize:16], mesh);
+    
+    // Moves some vertices up and reverses the first two triangles.
+    UInt32 stride = mesh.stride * sizeof(float);
+    float *data = malloc(length * stride);
+    memcpy(data, mesh.structures + first * mesh.stride, length * stride);
+    for (i = 0; i < length; ++i) {
+        data[i * mesh.stride + 1] += 1.0f;
+    }
+    
+    for (i = 0; i < 6; ++i) {
+        reversed[i] = mesh.indices[5 - i];
+    }
+    
+    [mesh updateStructures:data vertex:first count:length];
+    [mesh updateIndices:reversed start:0 count:6];
+    free(data);
+    
+    // Each buffer of the ring receives the changed ranges once, in the frame it's drawn next. Nothing is created.
+    for (frame = 0; frame <= NGL_BUFFERS_RING; ++frame) {
+        UInt32 vbo = 0, ibo = 0, bytes = 0;
+        
+        ngles2Record(YES);
+        [mesh drawMeshWithCamera:camera];
+        ngles2Record(NO);
+        
+        calls = ngles2RecordedCalls(&count);
+        for (i = 0; i < count; ++i) {
+            XCTAssertTrue(calls[i].name != NGLES2CallGenBuffers && calls[i].name != NGLES2CallBufferData &&
+                          calls[i].name != NGLES2CallCreateProgram);
+            
+            if (calls[i].name == NGLES2CallBufferSubData && calls[i].type == GL_ARRAY_BUFFER) {
+                XCTAssertEqual(calls[i].offset, first * stride);
+                XCTAssertEqual(calls[i].size, length * stride);
+                [buffers addObject:@(calls[i].buffer)];
+                bytes += calls[i].size;
+                ++vbo;
+            } else if (calls[i].name == NGLES2CallBufferSubData) {
+                XCTAssertEqual(calls[i].offset, 0);
+                XCTAssertEqual(calls[i].size, 6 * NGL_SIZE_USHORT);
+                bytes += calls[i].size;
+                ++ibo;
+            }
+        }
+        
+        NSLog(@"Dynamic uploads: frame %u, %u bytes", frame, bytes);
+        XCTAssertEqual(vbo, (frame < NGL_BUFFERS_RING) ? 1 : 0);
+        XCTAssertEqual(ibo, (frame < NGL_BUFFERS_RING) ? 1 : 0);
+    }
+    
+    XCTAssertEqual(buffers.count, NGL_BUFFERS_RING);
+    
+    // An index out of the window is refused, the indices are kept and nothing is uploaded.
+    UInt32 outside[3] = { 0, 1, mesh.structuresCount / mesh.stride };
+    [mesh updateIndices:outside start:0 count:3];
+    XCTAssertEqual(mesh.indices[0], reversed[0]);
+    
+    ngles2Record(YES);
+    for (frame = 0; frame < NGL_BUFFERS_RING; ++frame) {
+        [mesh drawMeshWithCamera:camera];
+    }
+    ngles2Record(NO);
+    
+    XCTAssertEqual(recordedCount(NGLES2CallBufferSubData), 0);
+}
+
+- (void) testInstancedDraws {
+    NGLCamera *camera = [[NGLCamera alloc] init];
+    const NGLES2Call *calls;
+    UInt32 i, count, batches, instances = 30;
+    
+    nglContextEAGL();
+    
+    // With the instanced arrays, each polygon draws all the instances at once.
+    if (ngles2HasExtension(@"GL_EXT_instanced_arrays")) {
+        NGLMesh *mesh = instancedGrid(instances);
+        
+        ngles2Record(YES);
+        [mesh drawMeshWithCamera:camera];
+        ngles2Record(NO);
+        
+        calls = ngles2RecordedCalls(&count);
+        XCTAssertEqual(recordedCount(NGLES2CallDrawElements), 0);
+        XCTAssertEqual(recordedCount(NGLES2CallDrawElementsInstanced), 2);
+        
+        for (i = 0; i < count; ++i) {
+            if (calls[i].name == NGLES2CallDrawElementsInstanced) {
+                XCTAssertEqual(calls[i].instances, instances);
+                XCTAssertEqual(calls[i].size, 768);
+            }
+        }
+    } else {
+        NSLog(@"Instanced draws: GL_EXT_instanced_arrays is not supported, only the batches are tested");
+    }
+    
+    // Without them, each polygon draws the instances in batches, the last batch draws only the remaining ones.
+    ngles2HideExtension(@"GL_EXT_instanced_arrays", YES);
+    NGLMesh *batched = instancedGrid(instances);
+    
+    ngles2Record(YES);
+    [batched drawMeshWithCamera:camera];
+    ngles2Record(NO);
+    ngles2HideExtension(@"GL_EXT_instanced_arrays", NO);
+    
+    calls = ngles2RecordedCalls(&count);
+    batches = (instances + NGL_INSTANCE_BATCH - 1) / NGL_INSTANCE_BATCH;
+    XCTAssertEqual(recordedCount(NGLES2CallDrawElementsInstanced), 0);
+    XCTAssertEqual(recordedCount(NGLES2CallDrawElements), 2 * batches);
+    
+    UInt32 drawn = 0;
+    for (i = 0; i < count; ++i) {
+        if (calls[i].name == NGLES2CallDrawElements) {
+            XCTAssertEqual(calls[i].type, GL_UNSIGNED_SHORT);
+            XCTAssertEqual(calls[i].size % 768, 0);
+            XCTAssertLessThanOrEqual(calls[i].size, NGL_INSTANCE_BATCH * 768);
+            drawn += calls[i].size;
+        }
+    }
+    
+    XCTAssertEqual(drawn, 2 * instances * 768);
+    
+    NSLog(@"Instanced draws: %u instances of 2 polygons in %u draw calls", instances, 2 * batches);
+}
+
+- (void) testClusterDraws {
+    NGLCamera *camera = [[NGLCamera alloc] init];
+    NGLMesh *mesh = [[NGLMesh alloc] init];
+    const NGLES2Call *calls;
+    UInt32 i, c, count, start, length, runs = 0, hidden = 0;
+    
+    nglContextEAGL();
+    gridToMesh([[NGLGridMesh alloc] initWithSize:64], mesh);
+    NGLCluster *clusters = mesh.clusters;
+    
+    // The grid lies below the eye and runs out of the screen on its sides, part of its clusters are hidden.
+    mesh.x = -8.0f;
+    mesh.y = -4.0f;
+    mesh.z = -70.0f;
+    
+    ngles2Record(YES);
+    [mesh drawMeshWithCamera:camera];
+    ngles2Record(NO);
+    
+    BOOL *visible = mesh.visibleClusters;
+    XCTAssertTrue(visible != NULL);
+    calls = ngles2RecordedCalls(&count);
+    c = 0;
+    
+    // Each run of consecutive visible clusters is drawn by a single call, in the order of the clusters.
+    for (i = 0; visible != NULL && i < mesh.clustersCount; ++i) {
+        if (!visible[i]) {
+            ++hidden;
+            continue;
+        }
+    
+        start = clusters[i].start;
+        length = 0;
+        while (i < mesh.clustersCount && visible[i]) {
+            length += clusters[i++].length;
+        }
+        hidden += (i < mesh.clustersCount);
+    
+        while (c < count && calls[c].name != NGLES2CallDrawElements) {
+            ++c;
+        }
+    
+        XCTAssertLessThan(c, count);
+        if (c < count) {
+            XCTAssertEqual(calls[c].type, GL_UNSIGNED_SHORT);
+            XCTAssertEqual(calls[c].offset, start * NGL_SIZE_USHORT);
+            XCTAssertEqual(calls[c].size, length);
+            ++c;
+        }
+    
+        ++runs;
+    }
+    
+    // Nothing else is drawn.
+    XCTAssertEqual(recordedCount(NGLES2CallDrawElements), runs);
+    XCTAssertGreaterThan(hidden, 0);
+    XCTAssertLessThan(hidden, mesh.clustersCount);
+    NSLog(@"Cluster draws: %u of %u clusters visible, in %u draw calls", mesh.clustersCount - hidden,
+          mesh.clustersCount, runs);
+    
+    // Entirely in front of the eye, all the clusters are merged in one call.
+    mesh.scaleX = mesh.scaleY = mesh.scaleZ = 0.1f;
+    mesh.x = -3.2f;
+    mesh.y = -1.0f;
+    mesh.z = -20.0f;
+    
+    ngles2Record(YES);
+    [mesh drawMeshWithCamera:camera];
+    ngles2Record(NO);
+    
+    calls = ngles2RecordedCalls(&count);
+    XCTAssertEqual(recordedCount(NGLES2CallDrawElements), 1);
+    for (i = 0; i < count; ++i) {
+        if (calls[i].name == NGLES2CallDrawElements) {
+            XCTAssertEqual(calls[i].offset, 0);
+            XCTAssertEqual(calls[i].size, mesh.indicesCount);
+        }
+    }
+}
+
+- (void) testIndexUploads {
+    NGLCamera *camera = [[NGLCamera alloc] init];
+    NGLGridMesh *grid = [[NGLGridMesh alloc] initWithSize:512];
+    NGLMesh *mesh = [[NGLMesh alloc] init];
+    const NGLES2Call *calls;
+    UInt32 i, count, draws = 0, length = 32 * 512 * 6, bytes = 0, lodBytes = 0;
+    
+    // Sixteen surfaces of 32 rows each, like testVertexWindows.
+    for (i = 0; i < 16; ++i) {
+        [grid.surface addSurface:[NGLSurface surfacetWithStart:i * length length:length identifier:i + 1]];
+    }
+    
+    nglContextEAGL();
+    mesh.surface = grid.surface;
+    
+    ngles2Record(YES);
+    gridToMesh(grid, mesh);
+    ngles2Record(NO);
+    
+    XCTAssertGreaterThan(mesh.structuresCount / mesh.stride, NGL_MAX_16 + 1);
+    
+    // The IBO holds each surface in 16 bits, followed by its levels of detail, also in 16 bits.
+    for (i = 0; i < mesh.levelsCount; ++i) {
+        lodBytes += mesh.levels[i].length * NGL_SIZE_USHORT;
+    }
+    
+    calls = ngles2RecordedCalls(&count);
+    for (i = 0; i < count; ++i) {
+        if (calls[i].name == NGLES2CallBufferData && calls[i].type == GL_ELEMENT_ARRAY_BUFFER) {
+            bytes += calls[i].size;
+        }
+    }
+    
+    NSLog(@"Index uploads: %u bytes of indices instead of %u", bytes,
+          (mesh.indicesCount + mesh.lodCount) * NGL_SIZE_UINT);
+    XCTAssertEqual(bytes, mesh.indicesCount * NGL_SIZE_USHORT + lodBytes);
+    
+    // Without culling, each surface is drawn at once with 16 bits indices, from its place in the IBO.
+    nglGlobalClusterCulling(NO);
+    ngles2Record(YES);
+    [mesh drawMeshWithCamera:camera];
+    ngles2Record(NO);
+    nglGlobalClusterCulling(YES);
+    
+    calls = ngles2RecordedCalls(&count);
+    for (i = 0; i < count; ++i) {
+        if (calls[i].name == NGLES2CallDrawElements) {
+            XCTAssertEqual(calls[i].type, GL_UNSIGNED_SHORT);
+            XCTAssertEqual(calls[i].size, length);
+            XCTAssertEqual(calls[i].offset % NGL_SIZE_USHORT, 0);
+            ++draws;
+        }
+    }
+    
+    XCTAssertEqual(draws, 16);
+}
+
+- (void) testParseChunks {
+    NSString *path = gridSource(256, @"chunks.obj");
+    
+    // The chunks end in the middle of the groups, their results must merge exactly like a single chunk.
+    _chunks = 1;
+    NGLChunkingOBJ *serial = [[NGLChunkingOBJ alloc] initWithFile:path];
+    _chunks = MAX(nglJobWorkers(), 7);
+    NGLChunkingOBJ *parallel = [[NGLChunkingOBJ alloc] initWithFile:path];
+    
+    XCTAssertFalse(serial.hasError);
+    XCTAssertFalse(parallel.hasError);
+    XCTAssertEqual(serial.indicesCount, 256 * 256 * 6);
+    XCTAssertEqual([serial.surface count], [parallel.surface count]);
+    XCTAssertEqual(serial.stride, parallel.stride);
+    XCTAssertEqual(serial.structuresCount, parallel.structuresCount);
+    XCTAssertEqual(serial.indicesCount, parallel.indicesCount);
+    XCTAssertEqual(memcmp(serial.structures, parallel.structures, serial.structuresCount * sizeof(float)), 0);
+    XCTAssertEqual(memcmp(serial.indices, parallel.indices, serial.indicesCount * sizeof(UInt32)), 0);
+    
+    // All the bytes summed by the chunks are read as the loaded data.
+    XCTAssertGreaterThanOrEqual(parallel.loadedData, 0.8f - 1.0e-4f);
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void) testParseChunksThroughput {
+    NSString *path = gridSource(512, @"sweep.obj");
+    double seconds, serial = 0.0;
+    double megabytes = [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] fileSize] / 1048576.0;
+    
+    // Parses the same file with 1, 2, 4... chunks, up to one chunk per worker of the job system.
+    for (_chunks = 1; _chunks <= nglJobWorkers(); _chunks *= 2) {
+        NSDate *start = [NSDate date];
+        NGLChunkingOBJ *obj = [[NGLChunkingOBJ alloc] initWithFile:path];
+        seconds = -[start timeIntervalSinceNow];
+        serial = (_chunks == 1) ? seconds : serial;
+        
+        XCTAssertFalse(obj.hasError);
+        NSLog(@"OBJ chunks: %u of %u workers, %.1f MB in %.3f s, %.2fx the single chunk", (unsigned int)_chunks,
+              nglJobWorkers(), megabytes, seconds, serial / seconds);
+    }
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void) testParseBreaks {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"breaks.obj"];
+    NSString *obj = @"v 0 0 0\vv 1 0 0\fv 0 1 0\r\nvt 0 0\rf 1/1 2/1 3/1\n";
+    
+    // The vertical tab and the form feed end the lines, like the other line breaks.
+    [obj writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    NGLParserOBJ *parser = [[NGLParserOBJ alloc] initWithFile:path];
+    
+    XCTAssertFalse(parser.hasError);
+    XCTAssertEqual(parser.indicesCount, 3);
+    XCTAssertEqual(parser.structuresCount / parser.stride, 3);
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void) testTokenizerThroughput {
+    NSString *path = gridSource(256, @"tokens.obj");
+    NSString *source = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil];
+    double megabytes = [source lengthOfBytesUsingEncoding:NSUTF8StringEncoding] / 1048576.0;
+    __block double mapped = 0.0, strings = 0.0;
+    
+    // Both sides read the same file in a single chunk, without building the structure.
+    _chunks = 1;
+    [self measureBlock:^{
+        NSDate *start = [NSDate date];
+        XCTAssertFalse([[NGLTokenizingOBJ alloc] initWithFile:path].hasError);
+        mapped += -[start timeIntervalSinceNow];
+        
+        start = [NSDate date];
+        XCTAssertGreaterThan(stringTokenize(source), 0);
+        strings += -[start timeIntervalSinceNow];
+    }];
+    
+    // The measureBlock runs the block 10 times.
+    NSLog(@"OBJ tokenizer: %.1f MB/s over the mapped bytes, %.1f MB/s with NSString tokens, %.1fx faster",
+          megabytes * 10.0 / mapped, megabytes * 10.0 / strings, strings / mapped);
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void) testColladaStreaming {
+    NSString *path = colladaSource(16, 128, @"stream.dae");
+    double megabytes = [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] fileSize] / 1048576.0;
+    struct rusage before, after;
+    
+    // The peak resident memory only grows, so the growth is what the parsing needed above the previous peak.
+    getrusage(RUSAGE_SELF, &before);
+    _firstGeometry = 0.0;
+    _parseStart = [NSDate date];
+    NGLTimingDAE *dae = [[NGLTimingDAE alloc] initWithFile:path];
+    double seconds = -[_parseStart timeIntervalSinceNow];
+    getrusage(RUSAGE_SELF, &after);
+    
+    XCTAssertFalse(dae.hasError);
+    XCTAssertEqual(dae.indicesCount, 16 * 128 * 128 * 6);
+    XCTAssertGreaterThan(_firstGeometry, 0.0);
+    XCTAssertLessThan(_firstGeometry, seconds);
+    
+    // The ru_maxrss is in bytes on iOS and OS X.
+    NSLog(@"COLLADA streaming: %.1f MB file, first geometry in %.1f ms, parsed in %.1f ms, peak memory +%.1f MB",
+          megabytes, _firstGeometry * 1000.0, seconds * 1000.0, (after.ru_maxrss - before.ru_maxrss) / 1048576.0);
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void) testColladaParallel {
+    NSString *path = colladaSource(8, 64, @"parallel.dae");
+    NSString *serialPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"serial.ngl"];
+    NSString *parallelPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"parallel.ngl"];
+    NGLMultithreading multithreading = nglDefaultMultithreading;
+    
+    // Without multithreading, the polygons are processed one by one in the caller.
+    nglDefaultMultithreading = NGLMultithreadingNone;
+    NGLParserDAE *serial = [[NGLParserDAE alloc] initWithFile:path];
+    nglDefaultMultithreading = multithreading;
+    NGLParserDAE *parallel = [[NGLParserDAE alloc] initWithFile:path];
+    
+    XCTAssertFalse(serial.hasError);
+    XCTAssertFalse(parallel.hasError);
+    XCTAssertEqual([parallel.surface count], 16);
+    
+    // Both produce the same NGL binary, byte by byte.
+    [[[NGLParserNGL alloc] init] encodeFile:serial path:serialPath];
+    [[[NGLParserNGL alloc] init] encodeFile:parallel path:parallelPath];
+    NSData *serialData = [NSData dataWithContentsOfFile:serialPath];
+    NSData *parallelData = [NSData dataWithContentsOfFile:parallelPath];
+    
+    XCTAssertGreaterThan([serialData length], 0);
+    XCTAssertEqualObjects(serialData, parallelData);
+    NSLog(@"COLLADA parallel: %u workers, %lu bytes encoded", nglJobWorkers(), (unsigned long)[parallelData length]);
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:serialPath error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:parallelPath error:nil];
+}
+
+- (void) testTangentSpaceThroughput {
+    __block double seconds = 0.0;
+    
+    // 512 x 512 quads, about half million triangles.
+    [self measureBlock:^{
+        NGLGridMesh *mesh = [[NGLGridMesh alloc] initWithSize:512];
+        NSDate *start = [NSDate date];
+        [mesh defineStructure];
+        seconds += -[start timeIntervalSinceNow];
+        XCTAssertEqual(mesh.indicesCount, 512 * 512 * 6);
+    }];
+    
+    // The measureBlock runs the block 10 times.
+    NSLog(@"Tangent space and structure: %.1f ms per million triangles",
+          seconds * 1000.0 / (512 * 512 * 2 * 10 / 1000000.0));
+}
+
 @end
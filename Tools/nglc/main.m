@@ -0,0 +1,265 @@
+/*
+ *	Copyright (c) 2011-2015 NinevehGL. More information at: http://nineveh.gl
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in
+ *	all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *	THE SOFTWARE.
+ */
+
+#import "NGLParserOBJ.h"
+#import "NGLParserDAE.h"
+#import "NGLParserNGL.h"
+
+/*
+ *	nglc - NinevehGL Binary compiler.
+ *
+ *	Converts all the 3D files (.obj and .dae) inside folders to NGL Binary files, using all the cores.
+ *	The output files are named just like the NinevehGL Binary cache names them, so the output folder
+ *	can be shipped in the application bundle and imported with nglCacheImport() on the first launch.
+ *
+ *	Usage: nglc [-c] [-s settings.plist] -o <output folder> <input folder or file>...
+ *
+ *		-c	Saves the files with compressed geometry (the same as kNGLMeshCompressionYes).
+ *		-s	The import settings used by the application to load the meshes, as a plist dictionary.
+ *		-o	The output folder.
+ */
+
+#pragma mark -
+#pragma mark Constants
+#pragma mark -
+//**********************************************************************************************************
+//
+//	Constants
+//
+//**********************************************************************************************************
+
+// The same values of kNGLMeshKeyCompression, kNGLMeshCompressionYes and kNGLMeshKeyOriginal,
+// NGLMesh is not linked here.
+static NSString *const NGLC_KEY_COMPRESSION = @"compression";
+static NSString *const NGLC_COMPRESSION_YES = @"compressionYes";
+static NSString *const NGLC_KEY_ORIGINAL = @"useOriginal";
+
+static NSString *const NGLC_USAGE = @"Usage: nglc [-c] [-s settings.plist] -o <output folder> <input>...";
+
+#pragma mark -
+#pragma mark Private Functions
+#pragma mark -
+//**********************************************************************************************************
+//
+//	Private Functions
+//
+//**********************************************************************************************************
+
+// Returns the parser class to a 3D file or Nil if the file is not supported.
+static Class nglcParserClass(NSString *path)
+{
+	NSString *extension = [[path pathExtension] lowercaseString];
+	
+	if ([extension isEqualToString:@"obj"])
+	{
+		return [NGLParserOBJ class];
+	}
+	else if ([extension isEqualToString:@"dae"])
+	{
+		return [NGLParserDAE class];
+	}
+	
+	return Nil;
+}
+
+// Collects the supported 3D files from the inputs, folders are searched recursively.
+static NSArray *nglcFiles(NSArray *inputs)
+{
+	NSMutableArray *files = [NSMutableArray array];
+	NSFileManager *manager = [NSFileManager defaultManager];
+	NSString *input, *file;
+	BOOL isFolder;
+	
+	for (input in inputs)
+	{
+		if (![manager fileExistsAtPath:input isDirectory:&isFolder])
+		{
+			fprintf(stderr, "nglc: %s was not found.\n", [input UTF8String]);
+		}
+		else if (!isFolder)
+		{
+			[files addObject:input];
+		}
+		else
+		{
+			for (file in [manager enumeratorAtPath:input])
+			{
+				if (nglcParserClass(file) != Nil)
+				{
+					[files addObject:[input stringByAppendingPathComponent:file]];
+				}
+			}
+		}
+	}
+	
+	return files;
+}
+
+// Parses a 3D file and saves its NGL Binary file. Returns NO if the file could not be parsed.
+static BOOL nglcCompile(NSString *path, NSString *output, NSDictionary *settings, NSString **report)
+{
+	NSFileManager *manager = [NSFileManager defaultManager];
+	NGLParserMesh *parser;
+	NGLParserNGL *nglFile;
+	NSString *name, *fullPath;
+	NSTimeInterval start, parsed, encoded;
+	UInt64 sourceSize, nglSize;
+	BOOL success = NO;
+	
+	name = nglCacheName(path, settings);
+	
+	if (name == nil)
+	{
+		*report = [NSString stringWithFormat:@"FAILED  %@ (not found)", path];
+		return NO;
+	}
+	
+	// Parsing.
+	start = [NSDate timeIntervalSinceReferenceDate];
+	parser = [[nglcParserClass(path) alloc] initWithFile:path];
+	parsed = [NSDate timeIntervalSinceReferenceDate];
+	
+	// Encoding.
+	if (![parser hasError] && [parser indicesCount] > 0)
+	{
+		fullPath = [output stringByAppendingPathComponent:name];
+		nglFile = [[NGLParserNGL alloc] init];
+		nglFile.compressed = [[settings objectForKey:NGLC_KEY_COMPRESSION] isEqualToString:NGLC_COMPRESSION_YES];
+		[nglFile encodeFile:parser path:fullPath];
+		nglRelease(nglFile);
+		
+		encoded = [NSDate timeIntervalSinceReferenceDate];
+		sourceSize = [[manager attributesOfItemAtPath:path error:nil] fileSize];
+		nglSize = [[manager attributesOfItemAtPath:fullPath error:nil] fileSize];
+		success = (nglSize > 0);
+		
+		*report = [NSString stringWithFormat:@"%@  %@  parse %.3fs  encode %.3fs  %.1fKB -> %.1fKB  "
+				   "ACMR %.2f -> %.2f  ATVR %.2f -> %.2f  %@",
+				   (success) ? @"OK    " : @"FAILED", path, parsed - start, encoded - parsed,
+				   sourceSize / 1024.0, nglSize / 1024.0,
+				   parser.originalMetrics.acmr, parser.optimizedMetrics.acmr,
+				   parser.originalMetrics.atvr, parser.optimizedMetrics.atvr, name];
+	}
+	else
+	{
+		*report = [NSString stringWithFormat:@"FAILED  %@ (invalid 3D file)", path];
+	}
+	
+	nglRelease(parser);
+	
+	return success;
+}
+
+#pragma mark -
+#pragma mark Main
+#pragma mark -
+//**********************************************************************************************************
+//
+//	Main
+//
+//**********************************************************************************************************
+
+int main(int argc, const char *argv[])
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+	NSMutableDictionary *settings = [NSMutableDictionary dictionary];
+	NSMutableArray *inputs = [NSMutableArray array];
+	NSString *output = nil;
+	NSArray *files;
+	NSTimeInterval start;
+	__block UInt32 failures = 0;
+	int i;
+	
+	//*************************
+	//	Arguments
+	//*************************
+	
+	for (i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-c") == 0)
+		{
+			[settings setObject:NGLC_COMPRESSION_YES forKey:NGLC_KEY_COMPRESSION];
+		}
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+		{
+			[settings addEntriesFromDictionary:[NSDictionary dictionaryWithContentsOfFile:
+												[NSString stringWithUTF8String:argv[++i]]]];
+			
+			// The cached files are named without the setting that chooses the file, just like NGLMesh does.
+			[settings removeObjectForKey:NGLC_KEY_ORIGINAL];
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+		{
+			output = [NSString stringWithUTF8String:argv[++i]];
+		}
+		else
+		{
+			[inputs addObject:[NSString stringWithUTF8String:argv[i]]];
+		}
+	}
+	
+	if (output == nil || [inputs count] == 0)
+	{
+		fprintf(stderr, "%s\n", [NGLC_USAGE UTF8String]);
+		[pool drain];
+		return 2;
+	}
+	
+	[[NSFileManager defaultManager] createDirectoryAtPath:output
+							  withIntermediateDirectories:YES
+											   attributes:nil
+													error:nil];
+	
+	//*************************
+	//	Compiling
+	//*************************
+	
+	files = nglcFiles(inputs);
+	start = [NSDate timeIntervalSinceReferenceDate];
+	
+	// Each file is compiled in its own task, the reports are printed as soon as each one finishes.
+	dispatch_apply([files count], dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index)
+	{
+		NSAutoreleasePool *filePool = [[NSAutoreleasePool alloc] init];
+		NSString *report = nil;
+		
+		if (!nglcCompile([files objectAtIndex:index], output, settings, &report))
+		{
+			__sync_add_and_fetch(&failures, 1);
+		}
+		
+		@synchronized (files)
+		{
+			printf("%s\n", [report UTF8String]);
+			fflush(stdout);
+		}
+		
+		[filePool drain];
+	});
+	
+	printf("%u files, %u failed, %.3fs\n", (unsigned int)[files count], (unsigned int)failures,
+		   [NSDate timeIntervalSinceReferenceDate] - start);
+	
+	[pool drain];
+	
+	return (failures > 0) ? 1 : 0;
+}